@@ -0,0 +1,138 @@
+#!/usr/bin/env node
+// Event-loop lag under concurrent extraction: batches of templates through
+// parseMany on the main thread against parseManyAsync on the libuv
+// threadpool, and the same batch as one catalog Buffer through extractAsync,
+// with 1 to --concurrency requests in flight.
+//
+// Usage: node bench/async.js [--batch N] [--requests N] [--concurrency N] [--seed N] [--json]
+//
+// For each mode and concurrency it reports total throughput and the event
+// loop's delay (p50, p99 and max, from perf_hooks.monitorEventLoopDelay),
+// which is what every other request on the same process waits on. The
+// threadpool has UV_THREADPOOL_SIZE threads (4 by default). parseManyAsync
+// still converts each string to UTF-8 on the main thread; a catalog Buffer
+// is read in place.
+
+const { monitorEventLoopDelay } = require('perf_hooks');
+const Mtlog = require('..');
+
+const LITERALS = [
+  'User ', ' logged in from ', ' at ', 'Processing ', ' items for ', 'Order ',
+  ' created with total ', ' failed: ', 'Request to ', ' returned ', ' in ', ' ms',
+];
+
+const PROPERTIES = [
+  '{UserId}', '{@Order}', '{$Error}', '{Amount:F2}', '{Timestamp:yyyy-MM-dd HH:mm:ss}',
+  '{http.method}', '{service.name}', '{0}', '{{.UserId}}', '${Level:u3}', '{Elapsed:0.000}',
+];
+
+function parseArgs(argv) {
+  const opts = { batch: 10000, requests: 64, concurrency: 16, seed: 1, json: false };
+  for (let i = 2; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === '--json') opts.json = true;
+    else if (arg === '--batch') opts.batch = Number(argv[++i]);
+    else if (arg === '--requests') opts.requests = Number(argv[++i]);
+    else if (arg === '--concurrency') opts.concurrency = Number(argv[++i]);
+    else if (arg === '--seed') opts.seed = Number(argv[++i]);
+    else throw new Error(`unknown argument: ${arg}`);
+  }
+  return opts;
+}
+
+// Deterministic PRNG so runs on different revisions see the same batch.
+function mulberry32(seed) {
+  return () => {
+    seed |= 0;
+    seed = (seed + 0x6d2b79f5) | 0;
+    let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+    t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function elapsedMs(start) {
+  return Number(process.hrtime.bigint() - start) / 1e6;
+}
+
+// Quadrupling, but always ending on `max`.
+function nextConcurrency(concurrency, max) {
+  return concurrency < max && concurrency * 4 > max ? max : concurrency * 4;
+}
+
+// A request handled on the main thread still yields once first, as a server
+// would between requests.
+const MODES = {
+  sync: (batch) => new Promise((resolve) => setImmediate(() => resolve(Mtlog.parseMany(batch)))),
+  async: (batch) => Mtlog.parseManyAsync(batch),
+  catalog: (batch, catalog) => Mtlog.extractAsync(catalog),
+};
+
+async function run(mode, batch, catalog, requests, concurrency) {
+  const histogram = monitorEventLoopDelay({ resolution: 1 });
+  let issued = 0;
+  let segments = 0;
+  const client = async () => {
+    while (issued < requests) {
+      issued++;
+      const result = await MODES[mode](batch, catalog);
+      segments += result.kinds.length;
+    }
+  };
+
+  histogram.enable();
+  const start = process.hrtime.bigint();
+  await Promise.all(Array.from({ length: concurrency }, client));
+  const ms = elapsedMs(start);
+  histogram.disable();
+
+  return {
+    mode,
+    concurrency,
+    ms,
+    templates_per_second: Math.round((requests * batch.length * 1000) / ms),
+    segments,
+    lag_p50_ms: histogram.percentile(50) / 1e6,
+    lag_p99_ms: histogram.percentile(99) / 1e6,
+    lag_max_ms: histogram.max / 1e6,
+  };
+}
+
+async function main() {
+  const opts = parseArgs(process.argv);
+  const random = mulberry32(opts.seed);
+  const pick = (list) => list[Math.floor(random() * list.length)];
+
+  const batch = [];
+  for (let i = 0; i < opts.batch; i++) {
+    let text = `[${i}] `;
+    const fragments = 1 + Math.floor(random() * 5);
+    for (let f = 0; f < fragments; f++) text += pick(LITERALS) + pick(PROPERTIES);
+    batch.push(text);
+  }
+
+  const catalog = Buffer.from(batch.join('\n'));
+
+  const runs = [];
+  for (const mode of Object.keys(MODES)) {
+    const max = opts.concurrency;
+    for (let concurrency = 1; concurrency <= max; concurrency = nextConcurrency(concurrency, max)) {
+      runs.push(await run(mode, batch, catalog, opts.requests, concurrency));
+    }
+  }
+
+  if (opts.json) {
+    console.log(JSON.stringify({ benchmark: 'async', batch: opts.batch, requests: opts.requests, runs }, null, 2));
+    return;
+  }
+  console.log(`${opts.requests} requests of ${opts.batch} templates`);
+  for (const r of runs) {
+    console.log(
+      `${r.mode.padEnd(7)} x${String(r.concurrency).padEnd(3)} ` +
+        `${String(r.templates_per_second).padStart(9)} templates/s  ` +
+        `lag p50 ${r.lag_p50_ms.toFixed(1)} ms  p99 ${r.lag_p99_ms.toFixed(1)} ms  max ${r.lag_max_ms.toFixed(1)} ms`,
+    );
+  }
+}
+
+main();
@@ -0,0 +1,509 @@
+// Standalone throughput benchmark for the mtlog parser and external scanner.
+//
+// Links src/parser.c and src/scanner.c directly against the tree-sitter
+// runtime and parses reproducible generated workloads. Results are written to
+// stdout as JSON: ns per template, bytes/ms, p50/p99 parse latency, heap
+// allocation calls, peak bytes and tree-retained bytes per parse (measured by
+// the src/alloc_stats.h hooks) and, on Linux, hardware counters per input
+// byte (see counters.h). Each workload also reports the GB/s of the
+// tree-free extractor (src/properties.h) and of its structural index
+// (src/structural.h) for every SIMD kernel the CPU supports.
+//
+// With --arena every parse runs as an arena cycle (src/arena.h): the parser
+// and tree are allocated from a bump arena and released by one reset, so the
+// allocation figures show what the arena saves against malloc.
+//
+// Usage: bench [--iterations N] [--seed N] [--no-counters] [--arena] [workload...]
+//
+// Workloads: short, 1kb, multiline, braces, go (default: all).
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "alloc_stats.h"
+#include "arena.h"
+#include "counters.h"
+#include "properties.h"
+#include "structural.h"
+
+#include <tree_sitter/api.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const TSLanguage *tree_sitter_mtlog(void);
+
+// ---------------------------------------------------------------------------
+// Allocation accounting
+
+static MtlogArena *arena; // non-NULL with --arena
+
+// Totals over a workload's timed parses.
+typedef struct {
+  uint64_t calls;
+  uint64_t bytes;
+  int64_t peak_bytes;    // largest per-parse peak above the starting size
+  uint64_t tree_bytes;   // bytes released by ts_tree_delete, summed
+  uint64_t tree_samples;
+} AllocTotals;
+
+// ---------------------------------------------------------------------------
+// Deterministic input generation
+
+typedef struct {
+  char *data;
+  size_t length;
+  size_t capacity;
+} Buffer;
+
+static void buffer_append(Buffer *b, const char *s, size_t n) {
+  if (b->length + n + 1 > b->capacity) {
+    size_t capacity = b->capacity ? b->capacity * 2 : 256;
+    while (capacity < b->length + n + 1) capacity *= 2;
+    b->data = realloc(b->data, capacity);
+    if (!b->data) { perror("realloc"); exit(1); }
+    b->capacity = capacity;
+  }
+  memcpy(b->data + b->length, s, n);
+  b->length += n;
+  b->data[b->length] = '\0';
+}
+
+static void buffer_puts(Buffer *b, const char *s) { buffer_append(b, s, strlen(s)); }
+
+static uint64_t rng_state;
+
+static uint32_t rng_next(void) {
+  // xorshift64*
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return (uint32_t)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static const char *pick(const char *const *items, size_t count) { return items[rng_next() % count]; }
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *const LITERALS[] = {
+  "User ", " logged in from ", " at ", "Processing ", " items for ", "Order ",
+  " created with total ", " failed: ", "Request to ", " returned ", " in ",
+  " ms", "Retrying ", " of ", ", cache hit ratio ", " bytes written to ",
+};
+
+static const char *const PROPERTIES[] = {
+  "{UserId}", "{@Order}", "{$Error}", "{Amount:F2}", "{Timestamp:yyyy-MM-dd HH:mm:ss}",
+  "{http.method}", "{service.name}", "{0}", "{1}", "{{.UserId}}", "{{.Request.Path}}",
+  "${Timestamp:HH:mm:ss}", "${Level:u3}", "${Message}", "{Elapsed:0.000}", "{Count}",
+};
+
+// Alternate literal and property fragments until `target` bytes are reached.
+static void append_template(Buffer *b, size_t target) {
+  size_t start = b->length;
+  while (b->length - start < target) {
+    buffer_puts(b, pick(LITERALS, COUNT(LITERALS)));
+    buffer_puts(b, pick(PROPERTIES, COUNT(PROPERTIES)));
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Workloads
+
+typedef struct {
+  char *data;
+  uint32_t length;
+  uint32_t templates; // lines holding template text
+} Input;
+
+typedef struct {
+  const char *name;
+  const char *description;
+  void (*generate)(Input **inputs, size_t *count);
+} Workload;
+
+static Input input_from_buffer(Buffer *b, uint32_t templates) {
+  Input input = {b->data, (uint32_t)b->length, templates};
+  *b = (Buffer){0};
+  return input;
+}
+
+static void generate_short(Input **inputs, size_t *count) {
+  *count = 10000;
+  *inputs = calloc(*count, sizeof(Input));
+  for (size_t i = 0; i < *count; i++) {
+    Buffer b = {0};
+    append_template(&b, 24 + rng_next() % 64);
+    (*inputs)[i] = input_from_buffer(&b, 1);
+  }
+}
+
+static void generate_1kb(Input **inputs, size_t *count) {
+  *count = 1000;
+  *inputs = calloc(*count, sizeof(Input));
+  for (size_t i = 0; i < *count; i++) {
+    Buffer b = {0};
+    append_template(&b, 1024);
+    (*inputs)[i] = input_from_buffer(&b, 1);
+  }
+}
+
+static void generate_multiline(Input **inputs, size_t *count) {
+  Buffer b = {0};
+  uint32_t lines = 0;
+  while (b.length < 16u << 20) {
+    append_template(&b, 40 + rng_next() % 120);
+    buffer_puts(&b, "\n");
+    lines++;
+  }
+  *count = 1;
+  *inputs = calloc(1, sizeof(Input));
+  (*inputs)[0] = input_from_buffer(&b, lines);
+}
+
+// Long lines of unclosed braces: the shapes that used to make the scanner's
+// close-brace lookahead quadratic.
+static void generate_braces(Input **inputs, size_t *count) {
+  static const char *const UNITS[] = {"{a ", "${a ", "x{:a ", "{{.a ", "{@a.b ", "{0x "};
+  *count = 64;
+  *inputs = calloc(*count, sizeof(Input));
+  for (size_t i = 0; i < *count; i++) {
+    Buffer b = {0};
+    const char *unit = UNITS[i % COUNT(UNITS)];
+    while (b.length < 16384) buffer_puts(&b, unit);
+    buffer_puts(&b, i % 2 ? "}" : "}}");
+    (*inputs)[i] = input_from_buffer(&b, 1);
+  }
+}
+
+// Go source with logging calls, parsed whole as it is when injected into Go.
+static void generate_go(Input **inputs, size_t *count) {
+  static const char *const CALLS[] = {"logger.Info", "logger.Debug", "logger.Error", "log.With(\"key\", v).Warn"};
+  Buffer b = {0};
+  uint32_t lines = 0;
+  buffer_puts(&b, "package main\n\nimport (\n\t\"github.com/willibrandon/mtlog\"\n)\n\n");
+  lines += 6;
+  for (int f = 0; b.length < 1u << 20; f++) {
+    char header[96];
+    snprintf(header, sizeof header, "func handler%d(logger mtlog.Logger, req *Request) error {\n", f);
+    buffer_puts(&b, header);
+    lines++;
+    for (int k = 0; k < 8; k++) {
+      buffer_puts(&b, "\tif err := step(req); err != nil {\n\t\t");
+      buffer_puts(&b, pick(CALLS, COUNT(CALLS)));
+      buffer_puts(&b, "(\"");
+      append_template(&b, 30 + rng_next() % 60);
+      buffer_puts(&b, "\", req.ID, err)\n\t\treturn err\n\t}\n");
+      lines += 4;
+    }
+    buffer_puts(&b, "\treturn nil\n}\n\n");
+    lines += 3;
+  }
+  *count = 1;
+  *inputs = calloc(1, sizeof(Input));
+  (*inputs)[0] = input_from_buffer(&b, lines);
+}
+
+static const Workload WORKLOADS[] = {
+  {"short", "10k single-line templates of 24-88 bytes", generate_short},
+  {"1kb", "1k single-line templates of ~1 KB", generate_1kb},
+  {"multiline", "one 16 MB file of templates, one per line", generate_multiline},
+  {"braces", "64 lines of 16 KB unclosed-brace runs", generate_braces},
+  {"go", "1 MB Go source with logging calls", generate_go},
+};
+
+// ---------------------------------------------------------------------------
+// Measurement
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t *sorted, size_t count, double p) {
+  if (count == 0) return 0;
+  size_t index = (size_t)(p / 100.0 * (double)count + 0.5);
+  if (index > 0) index--;
+  if (index >= count) index = count - 1;
+  return sorted[index];
+}
+
+static void print_counters(const CounterValues *values, double bytes) {
+  printf("      \"counters_per_byte\": {");
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    printf("%s\"%s\": ", i ? ", " : "", COUNTER_NAMES[i]);
+    if (values->available[i]) printf("%.4f", (double)values->values[i] / bytes);
+    else printf("null");
+  }
+  printf("},\n");
+
+  printf("      \"ipc\": ");
+  if (values->available[COUNTER_CYCLES] && values->available[COUNTER_INSTRUCTIONS] &&
+      values->values[COUNTER_CYCLES] > 0) {
+    printf("%.3f", (double)values->values[COUNTER_INSTRUCTIONS] / (double)values->values[COUNTER_CYCLES]);
+  } else {
+    printf("null");
+  }
+  printf(",\n");
+}
+
+// One parse-extract-discard cycle. In arena mode the parser is created inside
+// the cycle and everything is dropped by the reset; otherwise `parser` is
+// reused and the tree is deleted, which also measures what the tree retained.
+static void parse_cycle(TSParser *parser, const Input *input, AllocTotals *totals) {
+  MtlogAllocStats start, parsed, released;
+  mtlog_alloc_stats_reset();
+  mtlog_alloc_stats_get(&start);
+
+  if (arena) {
+    mtlog_arena_activate(arena);
+    parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_mtlog());
+  }
+
+  TSTree *tree = ts_parser_parse_string(parser, NULL, input->data, input->length);
+  volatile uint32_t children = ts_node_named_child_count(ts_tree_root_node(tree));
+  (void)children;
+  mtlog_alloc_stats_get(&parsed);
+
+  if (arena) {
+    mtlog_arena_activate(NULL);
+    mtlog_arena_reset(arena);
+  } else {
+    ts_tree_delete(tree);
+    mtlog_alloc_stats_get(&released);
+    if (totals) {
+      totals->tree_bytes += (uint64_t)(parsed.live_bytes - released.live_bytes);
+      totals->tree_samples++;
+    }
+  }
+
+  if (totals) {
+    totals->calls += mtlog_alloc_stats_calls(&parsed);
+    totals->bytes += parsed.bytes_allocated;
+    if (parsed.peak_bytes - start.live_bytes > totals->peak_bytes) {
+      totals->peak_bytes = parsed.peak_bytes - start.live_bytes;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Tree-free extraction
+
+static bool count_property(const MtlogSegment *segment, void *context) {
+  (void)segment;
+  (*(uint64_t *)context)++;
+  return true;
+}
+
+static double gb_per_s(uint64_t bytes, uint64_t ns) { return ns ? (double)bytes / (double)ns : 0; }
+
+// Index and extract every input `iterations` times with each available kernel.
+static void print_extraction(const Input *inputs, size_t count, unsigned iterations, uint64_t bytes) {
+  static const MtlogStructuralKernel KERNELS[] = {MTLOG_KERNEL_SCALAR, MTLOG_KERNEL_SSE2, MTLOG_KERNEL_AVX2};
+  uint32_t max_length = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (inputs[i].length > max_length) max_length = inputs[i].length;
+  }
+  MtlogStructuralBlock *blocks = malloc((mtlog_structural_block_count(max_length) + 1) * sizeof(MtlogStructuralBlock));
+  MtlogStructuralKernel detected = mtlog_structural_kernel();
+
+  double index_rate[COUNT(KERNELS)], scan_rate[COUNT(KERNELS)];
+  bool available[COUNT(KERNELS)];
+  uint64_t properties = 0;
+  for (size_t k = 0; k < COUNT(KERNELS); k++) {
+    available[k] = mtlog_structural_use_kernel(KERNELS[k]);
+    if (!available[k]) continue;
+
+    uint64_t start = now_ns();
+    for (unsigned it = 0; it < iterations; it++) {
+      for (size_t i = 0; i < count; i++) mtlog_structural_index(inputs[i].data, inputs[i].length, blocks);
+    }
+    index_rate[k] = gb_per_s(bytes * iterations, now_ns() - start);
+
+    properties = 0;
+    start = now_ns();
+    for (unsigned it = 0; it < iterations; it++) {
+      for (size_t i = 0; i < count; i++) {
+        mtlog_scan_properties(inputs[i].data, inputs[i].length, count_property, &properties);
+      }
+    }
+    scan_rate[k] = gb_per_s(bytes * iterations, now_ns() - start);
+  }
+  mtlog_structural_use_kernel(MTLOG_KERNEL_AUTO);
+  free(blocks);
+
+  printf("      \"extract\": {\"kernel\": \"%s\", \"properties\": %llu,\n", mtlog_structural_kernel_name(detected),
+         (unsigned long long)(properties / iterations));
+  const char *labels[] = {"index_gb_per_s", "scan_properties_gb_per_s"};
+  const double *rates[] = {index_rate, scan_rate};
+  for (int r = 0; r < 2; r++) {
+    printf("        \"%s\": {", labels[r]);
+    bool first = true;
+    for (size_t k = 0; k < COUNT(KERNELS); k++) {
+      if (!available[k]) continue;
+      printf("%s\"%s\": %.3f", first ? "" : ", ", mtlog_structural_kernel_name(KERNELS[k]), rates[r][k]);
+      first = false;
+    }
+    printf("}%s\n", r == 0 ? "," : "");
+  }
+  printf("      },\n");
+}
+
+static void run_workload(TSParser *parser, Counters *counters, const Workload *w, unsigned iterations, bool first) {
+  Input *inputs;
+  size_t count;
+  w->generate(&inputs, &count);
+
+  uint64_t bytes = 0, templates = 0;
+  for (size_t i = 0; i < count; i++) {
+    bytes += inputs[i].length;
+    templates += inputs[i].templates;
+  }
+
+  // Warm up caches and the parser's internal buffers.
+  for (size_t i = 0; i < count; i++) parse_cycle(parser, &inputs[i], NULL);
+
+  size_t samples = count * iterations;
+  uint64_t *latencies = malloc(samples * sizeof(uint64_t));
+  AllocTotals allocs = {0};
+  MtlogArenaStats arena_before = {0}, arena_after = {0};
+  if (arena) mtlog_arena_stats(arena, &arena_before);
+  uint64_t total_ns = 0;
+  CounterValues counter_values;
+
+  counters_start(counters);
+  for (unsigned it = 0; it < iterations; it++) {
+    for (size_t i = 0; i < count; i++) {
+      uint64_t start = now_ns();
+      parse_cycle(parser, &inputs[i], &allocs);
+      uint64_t elapsed = now_ns() - start;
+      latencies[it * count + i] = elapsed;
+      total_ns += elapsed;
+    }
+  }
+  counters_stop(counters, &counter_values);
+
+  // Allocations that reached malloc: all of them, or only new arena chunks.
+  uint64_t system_calls = allocs.calls;
+  if (arena) {
+    mtlog_arena_stats(arena, &arena_after);
+    system_calls = arena_after.chunk_allocations - arena_before.chunk_allocations;
+  }
+  qsort(latencies, samples, sizeof(uint64_t), compare_u64);
+
+  double parses = (double)samples;
+  printf("%s    {\n", first ? "" : ",\n");
+  printf("      \"name\": \"%s\",\n", w->name);
+  printf("      \"description\": \"%s\",\n", w->description);
+  printf("      \"inputs\": %zu,\n", count);
+  printf("      \"bytes\": %llu,\n", (unsigned long long)bytes);
+  printf("      \"templates\": %llu,\n", (unsigned long long)templates);
+  printf("      \"iterations\": %u,\n", iterations);
+  printf("      \"ns_per_template\": %.1f,\n", (double)total_ns / ((double)templates * iterations));
+  printf("      \"bytes_per_ms\": %.0f,\n", (double)bytes * iterations / ((double)total_ns / 1e6));
+  printf("      \"latency_ns\": {\"p50\": %llu, \"p99\": %llu, \"max\": %llu},\n",
+         (unsigned long long)percentile(latencies, samples, 50),
+         (unsigned long long)percentile(latencies, samples, 99),
+         (unsigned long long)latencies[samples - 1]);
+  print_counters(&counter_values, (double)bytes * iterations);
+  print_extraction(inputs, count, iterations, bytes);
+  printf("      \"allocs_per_parse\": %.1f,\n", (double)allocs.calls / parses);
+  printf("      \"system_allocs_per_parse\": %.3f,\n", (double)system_calls / parses);
+  printf("      \"alloc_bytes_per_parse\": %.0f,\n", (double)allocs.bytes / parses);
+  printf("      \"peak_bytes_per_parse\": %lld,\n", (long long)allocs.peak_bytes);
+  printf("      \"tree_bytes_per_parse\": ");
+  if (allocs.tree_samples) printf("%.0f\n", (double)allocs.tree_bytes / (double)allocs.tree_samples);
+  else printf("null\n");
+  printf("    }");
+
+  free(latencies);
+  for (size_t i = 0; i < count; i++) free(inputs[i].data);
+  free(inputs);
+}
+
+static void usage(const char *program) {
+  fprintf(stderr, "usage: %s [--iterations N] [--seed N] [--no-counters] [--arena] [workload...]\n\nworkloads:\n", program);
+  for (size_t i = 0; i < COUNT(WORKLOADS); i++) {
+    fprintf(stderr, "  %-10s %s\n", WORKLOADS[i].name, WORKLOADS[i].description);
+  }
+}
+
+int main(int argc, char **argv) {
+  unsigned iterations = 5;
+  uint64_t seed = 42;
+  bool use_counters = true;
+  bool use_arena = false;
+  const Workload *selected[COUNT(WORKLOADS)];
+  size_t selected_count = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--iterations") && i + 1 < argc) {
+      iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--no-counters")) {
+      use_counters = false;
+    } else if (!strcmp(argv[i], "--arena")) {
+      use_arena = true;
+    } else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+      usage(argv[0]);
+      return 0;
+    } else {
+      size_t w = 0;
+      while (w < COUNT(WORKLOADS) && strcmp(argv[i], WORKLOADS[w].name)) w++;
+      if (w == COUNT(WORKLOADS) || selected_count == COUNT(WORKLOADS)) {
+        usage(argv[0]);
+        return 2;
+      }
+      selected[selected_count++] = &WORKLOADS[w];
+    }
+  }
+  if (selected_count == 0) {
+    for (size_t w = 0; w < COUNT(WORKLOADS); w++) selected[selected_count++] = &WORKLOADS[w];
+  }
+  if (iterations == 0) iterations = 1;
+
+  if (use_arena) {
+    mtlog_alloc_stats_set_backend(mtlog_arena_malloc, mtlog_arena_calloc, mtlog_arena_realloc, mtlog_arena_free);
+    arena = mtlog_arena_new(0);
+  }
+  ts_set_allocator(mtlog_alloc_stats_malloc, mtlog_alloc_stats_calloc, mtlog_alloc_stats_realloc, mtlog_alloc_stats_free);
+
+  TSParser *parser = ts_parser_new();
+  if (!ts_parser_set_language(parser, tree_sitter_mtlog())) {
+    fprintf(stderr, "incompatible tree-sitter runtime\n");
+    return 1;
+  }
+
+  Counters counters;
+  bool have_counters = counters_open(&counters);
+  if (!use_counters && have_counters) {
+    counters_close(&counters);
+    have_counters = false;
+  }
+  if (use_counters && !have_counters) {
+    fprintf(stderr, "note: hardware counters unavailable (perf_event_paranoid or non-Linux)\n");
+  }
+
+  printf("{\n  \"benchmark\": \"mtlog\",\n  \"seed\": %llu,\n", (unsigned long long)seed);
+  printf("  \"allocator\": \"%s\",\n", arena ? "arena" : "malloc");
+  printf("  \"hardware_counters\": %s,\n  \"workloads\": [\n", have_counters ? "true" : "false");
+  for (size_t i = 0; i < selected_count; i++) {
+    rng_state = seed ? seed : 1; // every workload sees the same stream
+    run_workload(parser, &counters, selected[i], iterations, i == 0);
+  }
+  printf("\n  ]\n}\n");
+
+  counters_close(&counters);
+  ts_parser_delete(parser);
+  mtlog_arena_delete(arena);
+  return 0;
+}
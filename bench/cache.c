@@ -0,0 +1,208 @@
+// Multi-threaded benchmark for the compiled-template cache (src/template_cache.h).
+//
+// Every thread replays a stream of log events drawn from a fixed set of
+// distinct templates and handles each event four ways:
+//
+//   parse    ts_parser_parse_string with a per-thread parser, then delete
+//   extract  mtlog_scan_properties, no parser and no cache
+//   cache    mtlog_template_cache_acquire + release on a warm cache
+//   hash     mtlog_template_hash alone, the floor a cache hit can reach
+//
+// and reports ns per event for each thread count as JSON, with the cache's
+// hit/miss/eviction counters.
+//
+// Usage: cache [--templates N] [--events N] [--threads N] [--seed N]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "properties.h"
+#include "template_cache.h"
+
+#include <tree_sitter/api.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const TSLanguage *tree_sitter_mtlog(void);
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *const LITERALS[] = {
+  "User ", " logged in from ", " at ", "Processing ", " items for ", "Order ",
+  " created with total ", " failed: ", "Request to ", " returned ", " in ", " ms",
+};
+
+static const char *const PROPERTIES[] = {
+  "{UserId}", "{@Order}", "{$Error}", "{Amount:F2}", "{Timestamp:yyyy-MM-dd HH:mm:ss}",
+  "{http.method}", "{service.name}", "{0}", "{{.UserId}}", "${Level:u3}", "{Elapsed:0.000}",
+};
+
+typedef enum { MODE_PARSE, MODE_EXTRACT, MODE_CACHE, MODE_HASH, MODE_COUNT } Mode;
+
+static const char *const MODE_NAMES[] = {"parse", "extract", "cache", "hash"};
+
+typedef struct {
+  char *text;
+  uint32_t length;
+} Template;
+
+static Template *templates;
+static uint32_t template_count = 2000;
+static uint32_t events_per_thread = 1000000;
+static MtlogTemplateCache *cache;
+
+typedef struct {
+  pthread_t thread;
+  Mode mode;
+  uint32_t seed;
+  uint64_t checksum; // keeps the work observable
+} Worker;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rng_next(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static bool count_property(const MtlogSegment *segment, void *context) {
+  *(uint64_t *)context += segment->name.end - segment->name.start;
+  return true;
+}
+
+static void *run_worker(void *argument) {
+  Worker *worker = (Worker *)argument;
+  uint32_t state = worker->seed;
+  uint64_t checksum = 0;
+  TSParser *parser = NULL;
+  if (worker->mode == MODE_PARSE) {
+    parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_mtlog());
+  }
+
+  // Parsing is orders of magnitude slower; replay fewer events.
+  uint32_t events = worker->mode == MODE_PARSE ? events_per_thread / 100 : events_per_thread;
+  for (uint32_t i = 0; i < events; i++) {
+    const Template *t = &templates[rng_next(&state) % template_count];
+    switch (worker->mode) {
+      case MODE_PARSE: {
+        TSTree *tree = ts_parser_parse_string(parser, NULL, t->text, t->length);
+        checksum += ts_node_named_child_count(ts_tree_root_node(tree));
+        ts_tree_delete(tree);
+        break;
+      }
+      case MODE_EXTRACT:
+        mtlog_scan_properties(t->text, t->length, count_property, &checksum);
+        break;
+      case MODE_CACHE: {
+        const MtlogCompiledTemplate *compiled = mtlog_template_cache_acquire(cache, t->text, t->length);
+        checksum += compiled->property_count;
+        mtlog_template_cache_release(compiled);
+        break;
+      }
+      case MODE_HASH:
+        checksum += mtlog_template_hash(t->text, t->length);
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (parser) ts_parser_delete(parser);
+  worker->checksum = checksum;
+  return NULL;
+}
+
+// ns per event with `threads` workers running `mode` concurrently.
+static double measure(Mode mode, unsigned threads, uint32_t seed) {
+  Worker *workers = calloc(threads, sizeof(Worker));
+  uint64_t start = now_ns();
+  for (unsigned i = 0; i < threads; i++) {
+    workers[i].mode = mode;
+    workers[i].seed = seed + i * 7919 + 1;
+    pthread_create(&workers[i].thread, NULL, run_worker, &workers[i]);
+  }
+  for (unsigned i = 0; i < threads; i++) pthread_join(workers[i].thread, NULL);
+  uint64_t elapsed = now_ns() - start;
+  free(workers);
+
+  uint32_t events = mode == MODE_PARSE ? events_per_thread / 100 : events_per_thread;
+  // Wall time per event on each thread: flat as threads grow means no contention.
+  return (double)elapsed / (double)events;
+}
+
+int main(int argc, char **argv) {
+  unsigned max_threads = 8;
+  uint32_t seed = 42;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--templates") && i + 1 < argc) {
+      template_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--events") && i + 1 < argc) {
+      events_per_thread = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+      max_threads = (unsigned)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--templates N] [--events N] [--threads N] [--seed N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (template_count == 0) template_count = 1;
+  if (events_per_thread < 100) events_per_thread = 100;
+  if (max_threads == 0) max_threads = 1;
+
+  // Distinct templates: a numbered prefix, then literal/property fragments.
+  uint32_t state = seed ? seed : 1;
+  templates = calloc(template_count, sizeof(Template));
+  for (uint32_t i = 0; i < template_count; i++) {
+    char buffer[512];
+    int length = snprintf(buffer, sizeof(buffer), "[%u] ", i);
+    unsigned fragments = 1 + rng_next(&state) % 5;
+    for (unsigned f = 0; f < fragments; f++) {
+      length += snprintf(buffer + length, sizeof(buffer) - (size_t)length, "%s%s",
+                         LITERALS[rng_next(&state) % COUNT(LITERALS)],
+                         PROPERTIES[rng_next(&state) % COUNT(PROPERTIES)]);
+    }
+    templates[i].text = malloc((size_t)length + 1);
+    memcpy(templates[i].text, buffer, (size_t)length + 1);
+    templates[i].length = (uint32_t)length;
+  }
+
+  cache = mtlog_template_cache_new(template_count * 2, 0);
+  for (uint32_t i = 0; i < template_count; i++) {
+    mtlog_template_cache_release(mtlog_template_cache_acquire(cache, templates[i].text, templates[i].length));
+  }
+
+  printf("{\n  \"benchmark\": \"template_cache\",\n  \"templates\": %u,\n  \"events_per_thread\": %u,\n",
+         template_count, events_per_thread);
+  printf("  \"ns_per_event\": [\n");
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+    printf("    {\"threads\": %u", threads);
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+      printf(", \"%s\": %.1f", MODE_NAMES[mode], measure((Mode)mode, threads, seed));
+    }
+    printf("}%s\n", threads * 2 <= max_threads ? "," : "");
+  }
+
+  MtlogTemplateCacheStats stats;
+  mtlog_template_cache_stats(cache, &stats);
+  printf("  ],\n  \"cache\": {\"hits\": %llu, \"misses\": %llu, \"evictions\": %llu, \"entries\": %llu}\n}\n",
+         (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+         (unsigned long long)stats.evictions, (unsigned long long)stats.entries);
+
+  mtlog_template_cache_delete(cache);
+  for (uint32_t i = 0; i < template_count; i++) free(templates[i].text);
+  free(templates);
+  return 0;
+}
@@ -0,0 +1,106 @@
+#define _GNU_SOURCE // syscall()
+
+#include "counters.h"
+
+#include <string.h>
+
+const char *const COUNTER_NAMES[COUNTER_COUNT] = {
+  [COUNTER_CYCLES] = "cycles",
+  [COUNTER_INSTRUCTIONS] = "instructions",
+  [COUNTER_BRANCH_MISSES] = "branch_misses",
+  [COUNTER_L1D_MISSES] = "l1d_misses",
+  [COUNTER_LLC_MISSES] = "llc_misses",
+};
+
+#ifdef __linux__
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const struct {
+  uint32_t type;
+  uint64_t config;
+} EVENTS[COUNTER_COUNT] = {
+  [COUNTER_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  [COUNTER_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  [COUNTER_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  [COUNTER_L1D_MISSES] = {
+    PERF_TYPE_HW_CACHE,
+    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+  },
+  [COUNTER_LLC_MISSES] = {
+    PERF_TYPE_HW_CACHE,
+    PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+  },
+};
+
+bool counters_open(Counters *self) {
+  bool any = false;
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = EVENTS[i].type;
+    attr.config = EVENTS[i].config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Counters are opened separately rather than as a group so that an
+    // unsupported one does not take the rest down; the kernel multiplexes
+    // them when the PMU runs short and the enabled/running times rescale.
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    self->fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (self->fds[i] >= 0) any = true;
+  }
+  return any;
+}
+
+void counters_close(Counters *self) {
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    if (self->fds[i] >= 0) close(self->fds[i]);
+    self->fds[i] = -1;
+  }
+}
+
+void counters_start(Counters *self) {
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    if (self->fds[i] < 0) continue;
+    ioctl(self->fds[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(self->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+void counters_stop(Counters *self, CounterValues *out) {
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    if (self->fds[i] >= 0) ioctl(self->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+  }
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    uint64_t data[3]; // value, time_enabled, time_running
+    out->available[i] = false;
+    out->values[i] = 0;
+    if (self->fds[i] < 0 || read(self->fds[i], data, sizeof data) != (ssize_t)sizeof data) continue;
+    if (data[2] == 0) continue; // never scheduled onto the PMU
+    out->available[i] = true;
+    out->values[i] = data[2] < data[1] ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
+  }
+}
+
+#else
+
+bool counters_open(Counters *self) {
+  for (int i = 0; i < COUNTER_COUNT; i++) self->fds[i] = -1;
+  return false;
+}
+
+void counters_close(Counters *self) { (void)self; }
+
+void counters_start(Counters *self) { (void)self; }
+
+void counters_stop(Counters *self, CounterValues *out) {
+  (void)self;
+  memset(out, 0, sizeof *out);
+}
+
+#endif
@@ -0,0 +1,45 @@
+// Hardware performance counters for the benchmark harness.
+//
+// On Linux the counters are read through perf_event_open(2), counting
+// user-space events of the calling thread. Elsewhere, or when the kernel
+// refuses access (see /proc/sys/kernel/perf_event_paranoid), every counter
+// reports as unavailable and the harness prints null for it.
+
+#ifndef MTLOG_BENCH_COUNTERS_H_
+#define MTLOG_BENCH_COUNTERS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+  COUNTER_CYCLES,
+  COUNTER_INSTRUCTIONS,
+  COUNTER_BRANCH_MISSES,
+  COUNTER_L1D_MISSES,
+  COUNTER_LLC_MISSES,
+  COUNTER_COUNT,
+} CounterId;
+
+typedef struct {
+  int fds[COUNTER_COUNT];
+} Counters;
+
+typedef struct {
+  bool available[COUNTER_COUNT];
+  uint64_t values[COUNTER_COUNT]; // scaled for multiplexing
+} CounterValues;
+
+// JSON key for each counter, e.g. "cycles".
+extern const char *const COUNTER_NAMES[COUNTER_COUNT];
+
+// Opens every counter that the kernel and CPU support; returns false if none.
+bool counters_open(Counters *self);
+void counters_close(Counters *self);
+
+// Zero and enable all open counters.
+void counters_start(Counters *self);
+
+// Disable all open counters and read their values.
+void counters_stop(Counters *self, CounterValues *out);
+
+#endif // MTLOG_BENCH_COUNTERS_H_
@@ -0,0 +1,127 @@
+#!/usr/bin/env node
+// Input encodings on 10 MB: parseMany over the same catalog as a JS string
+// transcoded to UTF-8, as a string read as UTF-16 code units
+// ({encoding: 'utf16'}), as a Buffer and as a Uint8Array slice of a larger
+// buffer. Buffers and slices are read in place. Runs once with Latin-1 text,
+// which V8 stores one byte per character, and once with CJK and emoji,
+// stored as UTF-16. Buffer.from(string) is timed too, as the transcoding an
+// ingest path pays before it has a Buffer at all.
+//
+// Usage: node bench/encoding.js [--megabytes N] [--rounds N] [--seed N] [--json]
+
+const Mtlog = require('..');
+
+const LITERALS = {
+  latin1: [
+    'Usuário ', ' não encontrado em ', ' às ', 'Pedido ', ' criado com total ', ' falhou: ', ' café ', ' ms',
+  ],
+  wide: ['ユーザー ', ' がログイン ', ' 😀 ', '订单 ', ' 已创建 ', ' 失败: ', ' 𝄞 ', ' ms'],
+};
+
+const PROPERTIES = [
+  '{UserId}', '{@Order}', '{$Error}', '{Amount:F2}', '{Timestamp:yyyy-MM-dd HH:mm:ss}',
+  '{http.method}', '{service.name}', '{0}', '{{.UserId}}', '${Level:u3}', '{Elapsed:0.000}',
+];
+
+function parseArgs(argv) {
+  const opts = { megabytes: 10, rounds: 5, seed: 1, json: false };
+  for (let i = 2; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === '--json') opts.json = true;
+    else if (arg === '--megabytes') opts.megabytes = Number(argv[++i]);
+    else if (arg === '--rounds') opts.rounds = Number(argv[++i]);
+    else if (arg === '--seed') opts.seed = Number(argv[++i]);
+    else throw new Error(`unknown argument: ${arg}`);
+  }
+  return opts;
+}
+
+// Deterministic PRNG so runs on different revisions see the same catalog.
+function mulberry32(seed) {
+  return () => {
+    seed |= 0;
+    seed = (seed + 0x6d2b79f5) | 0;
+    let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+    t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function elapsedMs(start) {
+  return Number(process.hrtime.bigint() - start) / 1e6;
+}
+
+function best(rounds, run) {
+  let fastest = Infinity;
+  let result;
+  for (let i = 0; i < rounds; i++) {
+    const start = process.hrtime.bigint();
+    result = run();
+    fastest = Math.min(fastest, elapsedMs(start));
+  }
+  return { ms: fastest, result };
+}
+
+function catalog(literals, bytes, random) {
+  const pick = (list) => list[Math.floor(random() * list.length)];
+  const lines = [];
+  let size = 0;
+  for (let i = 0; size < bytes; i++) {
+    let line = `[${i}] `;
+    const fragments = 1 + Math.floor(random() * 5);
+    for (let f = 0; f < fragments; f++) line += pick(literals) + pick(PROPERTIES);
+    lines.push(line);
+    size += Buffer.byteLength(line) + 1;
+  }
+  // Flattened, as text read from a file or socket would be.
+  return JSON.parse(JSON.stringify(lines.join('\n')));
+}
+
+function main() {
+  const opts = parseArgs(process.argv);
+  const random = mulberry32(opts.seed);
+  const results = [];
+
+  for (const [text, literals] of Object.entries(LITERALS)) {
+    const string = catalog(literals, opts.megabytes << 20, random);
+    const buffer = Buffer.from(string);
+    const padded = Buffer.alloc(buffer.length + 8192);
+    buffer.copy(padded, 4096);
+    const slice = new Uint8Array(padded.buffer, padded.byteOffset + 4096, buffer.length);
+    const megabytes = buffer.length / (1 << 20);
+
+    const modes = {
+      string_utf8: () => Mtlog.parseMany([string]),
+      string_utf16: () => Mtlog.parseMany([string], { encoding: 'utf16' }),
+      buffer: () => Mtlog.parseMany([buffer]),
+      uint8array_slice: () => Mtlog.parseMany([slice]),
+      transcode_only: () => Buffer.from(string),
+    };
+    let segments;
+    for (const [mode, run] of Object.entries(modes)) {
+      const { ms, result } = best(opts.rounds, run);
+      if (result.kinds) {
+        if (segments === undefined) segments = result.kinds.length;
+        else if (result.kinds.length !== segments) process.exitCode = 1;
+      }
+      results.push({ text, mode, utf8_megabytes: megabytes, ms, mb_per_s: megabytes / (ms / 1000) });
+    }
+    results.push({ text, mode: 'segments', count: segments });
+  }
+
+  if (opts.json) {
+    console.log(JSON.stringify({ benchmark: 'encoding', runs: results }, null, 2));
+    return;
+  }
+  for (const r of results) {
+    if (r.mode === 'segments') {
+      console.log(`${r.text.padEnd(6)} ${r.count} segments in every mode`);
+      continue;
+    }
+    const ms = r.ms.toFixed(1).padStart(8);
+    console.log(`${r.text.padEnd(6)} ${r.mode.padEnd(16)} ${ms} ms  ${r.mb_per_s.toFixed(0)} MB/s`);
+  }
+  if (process.exitCode) console.log('segment counts differ between modes');
+}
+
+main();
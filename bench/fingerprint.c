@@ -0,0 +1,165 @@
+// Throughput benchmark for structural fingerprints (src/fingerprint.h).
+//
+// Streams --count templates (default 20 million, the daily volume of distinct
+// template instances we group) drawn from a pool of generated templates, and
+// times each pass over the stream:
+//
+//   extract      mtlog_scan_properties alone, the floor for a single pass
+//   structure    mtlog_fingerprint with no flags (property kinds only)
+//   default      MTLOG_FINGERPRINT_DEFAULT
+//   all          MTLOG_FINGERPRINT_ALL
+//
+// and reports ns per template and GB/s as JSON, plus how many distinct
+// fingerprints each flag set gives over the pool.
+//
+// Usage: fingerprint [--count N] [--pool N] [--seed N]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "fingerprint.h"
+#include "properties.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *const LITERALS[] = {
+  "User ", " logged in from ", " at ", "Processing ", " items for ", "Order ",
+  " created with total ", " failed: ", "Request to ", " returned ", " in ", " ms",
+  "  retrying  ", "\tqueue ", " done",
+};
+
+static const char *const PROPERTIES[] = {
+  "{UserId}", "{@Order}", "{$Error}", "{Amount:F2}", "{Amount:F4}", "{Timestamp:yyyy-MM-dd HH:mm:ss}",
+  "{http.method}", "{service.name}", "{0}", "{{.UserId}}", "${Level:u3}", "{Elapsed:0.000}",
+  "{Elapsed}", "{@Request}", "{Request}",
+};
+
+typedef struct {
+  const char *text;
+  uint32_t length;
+} Template;
+
+typedef struct {
+  const char *name;
+  bool extract_only;
+  uint32_t flags;
+} Pass;
+
+static const Pass PASSES[] = {
+  {"extract", true, 0},
+  {"structure", false, 0},
+  {"default", false, MTLOG_FINGERPRINT_DEFAULT},
+  {"all", false, MTLOG_FINGERPRINT_ALL},
+};
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rng_next(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static bool count_property(const MtlogSegment *segment, void *context) {
+  *(uint64_t *)context += segment->name.end - segment->name.start;
+  return true;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static uint32_t distinct(uint64_t *values, uint32_t count) {
+  qsort(values, count, sizeof(uint64_t), compare_u64);
+  uint32_t result = count ? 1 : 0;
+  for (uint32_t i = 1; i < count; i++) result += values[i] != values[i - 1];
+  return result;
+}
+
+int main(int argc, char **argv) {
+  uint64_t count = 20000000;
+  uint32_t pool_size = 100000;
+  uint32_t seed = 42;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--count") && i + 1 < argc) {
+      count = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--pool") && i + 1 < argc) {
+      pool_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--count N] [--pool N] [--seed N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (pool_size == 0) pool_size = 1;
+
+  // The pool lives in one buffer so the stream is read like a log file would be.
+  uint32_t state = seed ? seed : 1;
+  Template *pool = calloc(pool_size, sizeof(Template));
+  size_t capacity = (size_t)pool_size * 256, used = 0;
+  char *storage = malloc(capacity);
+  for (uint32_t i = 0; i < pool_size; i++) {
+    char *start = storage + used;
+    int length = 0;
+    unsigned fragments = 1 + rng_next(&state) % 5;
+    for (unsigned f = 0; f < fragments; f++) {
+      length += snprintf(start + length, 256 - (size_t)length, "%s%s",
+                         LITERALS[rng_next(&state) % COUNT(LITERALS)],
+                         PROPERTIES[rng_next(&state) % COUNT(PROPERTIES)]);
+    }
+    pool[i].text = start;
+    pool[i].length = (uint32_t)length;
+    used += (size_t)length;
+  }
+
+  uint64_t bytes = 0;
+  for (uint64_t i = 0; i < count; i++) bytes += pool[i % pool_size].length;
+
+  printf("{\n  \"benchmark\": \"fingerprint\",\n  \"templates\": %llu,\n  \"pool\": %u,\n  \"bytes\": %llu,\n",
+         (unsigned long long)count, pool_size, (unsigned long long)bytes);
+  printf("  \"passes\": [\n");
+  uint64_t checksum = 0;
+  uint64_t *values = malloc(sizeof(uint64_t) * pool_size);
+  for (size_t p = 0; p < COUNT(PASSES); p++) {
+    const Pass *pass = &PASSES[p];
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < count; i++) {
+      const Template *t = &pool[i % pool_size];
+      if (pass->extract_only) {
+        mtlog_scan_properties(t->text, t->length, count_property, &checksum);
+      } else {
+        checksum += mtlog_fingerprint(t->text, t->length, pass->flags);
+      }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    printf("    {\"name\": \"%s\", \"ns_per_template\": %.1f, \"gb_per_s\": %.3f", pass->name,
+           count ? (double)elapsed / (double)count : 0.0, elapsed ? (double)bytes / (double)elapsed : 0.0);
+    if (!pass->extract_only) {
+      for (uint32_t i = 0; i < pool_size; i++) {
+        values[i] = mtlog_fingerprint(pool[i].text, pool[i].length, pass->flags);
+      }
+      printf(", \"distinct_in_pool\": %u", distinct(values, pool_size));
+    }
+    printf("}%s\n", p + 1 < COUNT(PASSES) ? "," : "");
+  }
+  printf("  ],\n  \"checksum\": %llu\n}\n", (unsigned long long)checksum);
+
+  free(values);
+  free(storage);
+  free(pool);
+  return 0;
+}
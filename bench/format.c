@@ -0,0 +1,120 @@
+// Per-event cost of date and number formatting (src/format_spec.h).
+//
+// Each event formats one value per format below three ways:
+//
+//   compiled   mtlog_format_* from a descriptor compiled once
+//   reparse    mtlog_format_spec_compile on every event, then format, the
+//              cost of interpreting the format string per event
+//   libc       the closest snprintf/strftime call, as a reference
+//
+// and reports ns per value as JSON.
+//
+// Usage: format [--events N]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "format_spec.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+typedef enum { VALUE_DOUBLE, VALUE_INT, VALUE_TIME } ValueKind;
+
+static const struct {
+  const char *format;
+  ValueKind kind;
+  const char *libc; // printf or strftime format
+} CASES[] = {
+  {"F2", VALUE_DOUBLE, "%.2f"},
+  {"N2", VALUE_DOUBLE, "%'.2f"},
+  {"E3", VALUE_DOUBLE, "%.3E"},
+  {"D8", VALUE_INT, "%08lld"},
+  {"X8", VALUE_INT, "%08llX"},
+  {"yyyy-MM-dd HH:mm:ss", VALUE_TIME, "%Y-%m-%d %H:%M:%S"},
+  {"yyyy-MM-dd HH:mm:ss.fff", VALUE_TIME, "%Y-%m-%d %H:%M:%S"},
+  {"15:04:05.000", VALUE_TIME, "%H:%M:%S"},
+};
+
+typedef enum { MODE_COMPILED, MODE_REPARSE, MODE_LIBC, MODE_COUNT } Mode;
+
+static const char *const MODE_NAMES[] = {"compiled", "reparse", "libc"};
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t format_value(const MtlogFormatSpec *spec, ValueKind kind, uint64_t e, char *out) {
+  switch (kind) {
+    case VALUE_DOUBLE: return mtlog_format_double(spec, (double)e * 1.37 + 0.25, out);
+    case VALUE_INT: return mtlog_format_int(spec, (int64_t)(e * 2654435761u % 100000000), out);
+    default: return mtlog_format_time(spec, 1700000000000000000LL + (int64_t)e * 1234567891, out);
+  }
+}
+
+static uint32_t format_libc(const char *format, ValueKind kind, uint64_t e, char *out) {
+  switch (kind) {
+    case VALUE_DOUBLE:
+      return (uint32_t)snprintf(out, MTLOG_FORMAT_MAX_OUTPUT, format, (double)e * 1.37 + 0.25);
+    case VALUE_INT:
+      return (uint32_t)snprintf(out, MTLOG_FORMAT_MAX_OUTPUT, format, (long long)(e * 2654435761u % 100000000));
+    default: {
+      int64_t nanos = 1700000000000000000LL + (int64_t)e * 1234567891;
+      time_t seconds = (time_t)(nanos / 1000000000);
+      struct tm tm;
+      gmtime_r(&seconds, &tm);
+      return (uint32_t)strftime(out, MTLOG_FORMAT_MAX_OUTPUT, format, &tm);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  uint64_t events = 5000000;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--events") && i + 1 < argc) {
+      events = strtoull(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--events N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (events == 0) events = 1;
+
+  char out[MTLOG_FORMAT_MAX_OUTPUT];
+  uint64_t checksum = 0;
+  printf("{\n  \"benchmark\": \"format\",\n  \"events\": %llu,\n  \"ns_per_value\": [\n", (unsigned long long)events);
+  for (size_t c = 0; c < COUNT(CASES); c++) {
+    const char *format = CASES[c].format;
+    uint32_t format_length = (uint32_t)strlen(format);
+    MtlogFormatSpec compiled;
+    mtlog_format_spec_compile(format, format_length, &compiled);
+
+    printf("    {\"format\": \"%s\"", format);
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+      uint64_t start = now_ns();
+      for (uint64_t e = 0; e < events; e++) {
+        uint32_t length;
+        if (mode == MODE_COMPILED) {
+          length = format_value(&compiled, CASES[c].kind, e, out);
+        } else if (mode == MODE_REPARSE) {
+          MtlogFormatSpec spec;
+          mtlog_format_spec_compile(format, format_length, &spec);
+          length = format_value(&spec, CASES[c].kind, e, out);
+        } else {
+          length = format_libc(CASES[c].libc, CASES[c].kind, e, out);
+        }
+        checksum += length + (unsigned char)out[length / 2];
+      }
+      printf(", \"%s\": %.1f", MODE_NAMES[mode], (double)(now_ns() - start) / (double)events);
+    }
+    printf("}%s\n", c + 1 < COUNT(CASES) ? "," : "");
+  }
+  printf("  ],\n  \"checksum\": %llu\n}\n", (unsigned long long)checksum);
+  return 0;
+}
@@ -0,0 +1,198 @@
+// Highlighting benchmark for the table-driven highlighter (src/highlight.h)
+// against running queries/highlights.scm through a TSQuery, the way a live
+// log tail colorizes each template as it arrives.
+//
+// Reports the one-off cost of compiling the query and, per event, the cost
+// of parsing the template (for scale), of collecting its highlights from
+// TSQueryCursor captures (first capture per node, as tree-sitter-highlight
+// does) and of mtlog_highlight. Both highlighters must find the same number
+// of highlights; the benchmark fails if they do not.
+//
+// Usage: highlight [--templates N] [--events N] [--seed N] [--query PATH]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "highlight.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const TSLanguage *tree_sitter_mtlog(void);
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *const LITERALS[] = {
+  "User ", " logged in from ", " at ", "Processing ", " items for ", "Order ",
+  " created with total ", " failed: ", "Request to ", " returned ", " in ", " ms",
+};
+
+static const char *const PROPERTIES[] = {
+  "{UserId}", "{@Order}", "{$Error}", "{Amount:F2}", "{Timestamp:yyyy-MM-dd HH:mm:ss}",
+  "{http.method}", "{service.name}", "{0}", "{{.UserId}}", "${Level:u3}", "{Elapsed:0.000}",
+};
+
+typedef struct {
+  char *text;
+  uint32_t length;
+  TSTree *tree;
+} Template;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rng_next(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static char *read_file(const char *path, uint32_t *length) {
+  FILE *file = fopen(path, "rb");
+  if (!file) return NULL;
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  char *data = (char *)malloc((size_t)size + 1);
+  size_t read = fread(data, 1, (size_t)size, file);
+  fclose(file);
+  data[read] = '\0';
+  *length = (uint32_t)read;
+  return data;
+}
+
+static bool count_highlight(const MtlogHighlight *highlight, void *context) {
+  (void)highlight;
+  (*(uint64_t *)context)++;
+  return true;
+}
+
+static uint64_t query_highlights(TSQueryCursor *cursor, const TSQuery *query, TSNode root) {
+  uint64_t count = 0;
+  const void *last = NULL;
+  TSQueryMatch match;
+  uint32_t index;
+  ts_query_cursor_exec(cursor, query, root);
+  while (ts_query_cursor_next_capture(cursor, &match, &index)) {
+    TSNode node = match.captures[index].node;
+    if (node.id == last) continue; // a later pattern for the same node
+    last = node.id;
+    if (ts_node_start_byte(node) < ts_node_end_byte(node)) count++;
+  }
+  return count;
+}
+
+int main(int argc, char **argv) {
+  uint32_t template_count = 2000, events = 1000000, seed = 42;
+  const char *query_path = "../queries/highlights.scm";
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--templates") && i + 1 < argc) {
+      template_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--events") && i + 1 < argc) {
+      events = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--query") && i + 1 < argc) {
+      query_path = argv[++i];
+    } else {
+      fprintf(stderr, "usage: %s [--templates N] [--events N] [--seed N] [--query PATH]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (template_count == 0) template_count = 1;
+  if (events == 0) events = 1;
+
+  uint32_t source_length;
+  char *source = read_file(query_path, &source_length);
+  if (!source) {
+    fprintf(stderr, "cannot read %s\n", query_path);
+    return 1;
+  }
+  uint32_t error_offset;
+  TSQueryError error;
+  uint64_t start = now_ns();
+  TSQuery *query = ts_query_new(tree_sitter_mtlog(), source, source_length, &error_offset, &error);
+  uint64_t compile_ns = now_ns() - start;
+  free(source);
+  if (!query) {
+    fprintf(stderr, "%s: query error %d at offset %u\n", query_path, (int)error, error_offset);
+    return 1;
+  }
+
+  // Distinct templates: a numbered prefix, then literal/property fragments.
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_mtlog());
+  uint32_t state = seed ? seed : 1;
+  Template *templates = calloc(template_count, sizeof(Template));
+  for (uint32_t i = 0; i < template_count; i++) {
+    char buffer[512];
+    int length = snprintf(buffer, sizeof(buffer), "[%u] ", i);
+    unsigned fragments = 1 + rng_next(&state) % 5;
+    for (unsigned f = 0; f < fragments; f++) {
+      length += snprintf(buffer + length, sizeof(buffer) - (size_t)length, "%s%s",
+                         LITERALS[rng_next(&state) % COUNT(LITERALS)],
+                         PROPERTIES[rng_next(&state) % COUNT(PROPERTIES)]);
+    }
+    templates[i].text = malloc((size_t)length + 1);
+    memcpy(templates[i].text, buffer, (size_t)length + 1);
+    templates[i].length = (uint32_t)length;
+    templates[i].tree = ts_parser_parse_string(parser, NULL, templates[i].text, templates[i].length);
+  }
+
+  // Every mode replays the same event sequence.
+  uint32_t *sequence = malloc(events * sizeof(uint32_t));
+  for (uint32_t i = 0; i < events; i++) sequence[i] = rng_next(&state) % template_count;
+
+  uint64_t checksum = 0;
+  start = now_ns();
+  for (uint32_t i = 0; i < events; i++) {
+    const Template *t = &templates[sequence[i]];
+    TSTree *tree = ts_parser_parse_string(parser, NULL, t->text, t->length);
+    checksum += ts_node_child_count(ts_tree_root_node(tree));
+    ts_tree_delete(tree);
+  }
+  double parse_ns = (double)(now_ns() - start) / events;
+
+  TSQueryCursor *cursor = ts_query_cursor_new();
+  uint64_t query_count = 0;
+  start = now_ns();
+  for (uint32_t i = 0; i < events; i++) {
+    query_count += query_highlights(cursor, query, ts_tree_root_node(templates[sequence[i]].tree));
+  }
+  double query_ns = (double)(now_ns() - start) / events;
+
+  uint64_t table_count = 0;
+  start = now_ns();
+  for (uint32_t i = 0; i < events; i++) {
+    mtlog_highlight(ts_tree_root_node(templates[sequence[i]].tree), count_highlight, &table_count);
+  }
+  double table_ns = (double)(now_ns() - start) / events;
+
+  printf("{\n  \"benchmark\": \"highlight\",\n  \"templates\": %u,\n  \"events\": %u,\n", template_count, events);
+  printf("  \"query_compile_us\": %.1f,\n", (double)compile_ns / 1000);
+  printf("  \"ns_per_event\": {\"parse\": %.1f, \"query\": %.1f, \"table\": %.1f},\n", parse_ns, query_ns, table_ns);
+  printf("  \"highlights_per_event\": {\"query\": %.2f, \"table\": %.2f},\n", (double)query_count / events,
+         (double)table_count / events);
+  printf("  \"checksum\": %llu\n}\n", (unsigned long long)checksum);
+
+  ts_query_cursor_delete(cursor);
+  ts_query_delete(query);
+  ts_parser_delete(parser);
+  for (uint32_t i = 0; i < template_count; i++) {
+    ts_tree_delete(templates[i].tree);
+    free(templates[i].text);
+  }
+  free(templates);
+  free(sequence);
+  if (query_count != table_count) {
+    fprintf(stderr, "highlight counts differ: query %llu, table %llu\n", (unsigned long long)query_count,
+            (unsigned long long)table_count);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,201 @@
+#!/usr/bin/env node
+// Incremental-edit benchmark: replays editor keystroke sequences against a
+// large generated .mtlog file and reports reparse latency and the fraction of
+// nodes the reparsed tree shares with the previous one.
+//
+// Usage: node bench/incremental.js [--lines N] [--sessions N] [--sample N]
+//                                   [--seed N] [--json]
+//
+// The reused-node ratio walks both trees, so it is only measured on every
+// --sample'th keystroke to keep large files tractable; latency covers all.
+//
+// Run it on two revisions and compare the JSON output to measure a change.
+
+const Parser = require('tree-sitter');
+const Mtlog = require('..');
+
+const TEMPLATES = [
+  'User {UserId} logged in from {IP:15} at {Timestamp:HH:mm:ss}',
+  'Order {@Order} created with total {Amount:F2}',
+  'Service {service.name} in namespace {service.namespace} started',
+  'Processing item {0} of {1}',
+  'User {{.UserId}} performed action {{.Action}}',
+  '[${Timestamp:yyyy-MM-dd HH:mm:ss} ${Level:u3}] ${Message}',
+  'Plain literal line without any properties at all',
+];
+
+// Each session types this text one character at a time, then deletes it.
+const TYPED = ' retried {Attempt} of {MaxAttempts:D2} for {@Request}';
+
+function parseArgs(argv) {
+  const opts = { lines: 100000, sessions: 20, sample: 16, seed: 1, json: false };
+  for (let i = 2; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === '--json') opts.json = true;
+    else if (arg === '--lines') opts.lines = Number(argv[++i]);
+    else if (arg === '--sessions') opts.sessions = Number(argv[++i]);
+    else if (arg === '--sample') opts.sample = Number(argv[++i]);
+    else if (arg === '--seed') opts.seed = Number(argv[++i]);
+    else throw new Error(`unknown argument: ${arg}`);
+  }
+  return opts;
+}
+
+// Deterministic PRNG so runs on different revisions replay the same edits.
+function mulberry32(seed) {
+  return () => {
+    seed |= 0;
+    seed = (seed + 0x6d2b79f5) | 0;
+    let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+    t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function lineStarts(text) {
+  const starts = [0];
+  for (let i = 0; i < text.length; i++) {
+    if (text.charCodeAt(i) === 10) starts.push(i + 1);
+  }
+  return starts;
+}
+
+function collectIds(tree) {
+  const ids = new Set();
+  const cursor = tree.walk();
+  for (;;) {
+    ids.add(cursor.currentNode.id);
+    if (cursor.gotoFirstChild()) continue;
+    while (!cursor.gotoNextSibling()) {
+      if (!cursor.gotoParent()) return ids;
+    }
+  }
+}
+
+// Fraction of nodes in `tree` that are shared with the tree it was reparsed
+// from. A shared node's whole subtree is shared, so it is counted without
+// descending into it.
+function reusedRatio(tree, oldIds) {
+  let total = 0;
+  let reused = 0;
+  const cursor = tree.walk();
+  for (;;) {
+    const node = cursor.currentNode;
+    if (oldIds.has(node.id)) {
+      const count = node.descendantCount;
+      total += count;
+      reused += count;
+    } else {
+      total += 1;
+      if (cursor.gotoFirstChild()) continue;
+    }
+    while (!cursor.gotoNextSibling()) {
+      if (!cursor.gotoParent()) return total === 0 ? 0 : reused / total;
+    }
+  }
+}
+
+function percentile(sorted, p) {
+  if (sorted.length === 0) return 0;
+  const index = Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1);
+  return sorted[Math.max(0, index)];
+}
+
+function main() {
+  const opts = parseArgs(process.argv);
+  const random = mulberry32(opts.seed);
+
+  const lines = [];
+  for (let i = 0; i < opts.lines; i++) lines.push(TEMPLATES[i % TEMPLATES.length]);
+  let text = lines.join('\n') + '\n';
+
+  const parser = new Parser();
+  parser.setLanguage(Mtlog);
+
+  let start = process.hrtime.bigint();
+  let tree = parser.parse(text);
+  const fullParseMs = Number(process.hrtime.bigint() - start) / 1e6;
+
+  const latencies = [];
+  const ratios = [];
+
+  // Every session restores the text it typed, so line offsets never change.
+  const starts = lineStarts(text);
+  let keystroke = 0;
+
+  for (let session = 0; session < opts.sessions; session++) {
+    const row = Math.floor(random() * opts.lines);
+    const column = Math.floor(random() * (lines[row].length + 1));
+    const base = starts[row] + column;
+
+    // Type TYPED character by character, then backspace over it.
+    const steps = [];
+    for (let k = 0; k < TYPED.length; k++) steps.push({ offset: k, insert: TYPED[k] });
+    for (let k = TYPED.length - 1; k >= 0; k--) steps.push({ offset: k, insert: null });
+
+    for (const step of steps) {
+      const index = base + step.offset;
+      const point = { row, column: column + step.offset };
+      if (step.insert !== null) {
+        text = text.slice(0, index) + step.insert + text.slice(index);
+        tree.edit({
+          startIndex: index,
+          oldEndIndex: index,
+          newEndIndex: index + 1,
+          startPosition: point,
+          oldEndPosition: point,
+          newEndPosition: { row, column: point.column + 1 },
+        });
+      } else {
+        text = text.slice(0, index) + text.slice(index + 1);
+        tree.edit({
+          startIndex: index,
+          oldEndIndex: index + 1,
+          newEndIndex: index,
+          startPosition: point,
+          oldEndPosition: { row, column: point.column + 1 },
+          newEndPosition: point,
+        });
+      }
+
+      const sampled = keystroke++ % opts.sample === 0;
+      const oldIds = sampled ? collectIds(tree) : null;
+      start = process.hrtime.bigint();
+      const newTree = parser.parse(text, tree);
+      latencies.push(Number(process.hrtime.bigint() - start) / 1e6);
+      if (sampled) ratios.push(reusedRatio(newTree, oldIds));
+      tree = newTree;
+    }
+  }
+
+  latencies.sort((a, b) => a - b);
+  const mean = (values) => values.reduce((sum, v) => sum + v, 0) / (values.length || 1);
+  const result = {
+    benchmark: 'incremental',
+    lines: opts.lines,
+    bytes: Buffer.byteLength(text),
+    keystrokes: latencies.length,
+    full_parse_ms: fullParseMs,
+    reparse_ms: {
+      mean: mean(latencies),
+      p50: percentile(latencies, 50),
+      p99: percentile(latencies, 99),
+      max: latencies[latencies.length - 1] || 0,
+    },
+    reused_node_ratio: mean(ratios),
+  };
+
+  if (opts.json) {
+    console.log(JSON.stringify(result, null, 2));
+  } else {
+    console.log(`file:          ${result.lines} lines, ${result.bytes} bytes`);
+    console.log(`full parse:    ${result.full_parse_ms.toFixed(3)} ms`);
+    console.log(`keystrokes:    ${result.keystrokes}`);
+    console.log(`reparse mean:  ${result.reparse_ms.mean.toFixed(3)} ms`);
+    console.log(`reparse p50:   ${result.reparse_ms.p50.toFixed(3)} ms`);
+    console.log(`reparse p99:   ${result.reparse_ms.p99.toFixed(3)} ms`);
+    console.log(`reused nodes:  ${(result.reused_node_ratio * 100).toFixed(2)}%`);
+  }
+}
+
+main();
@@ -0,0 +1,176 @@
+// Throughput benchmark for reverse extraction (src/matcher.h).
+//
+// Generates log-like templates from a synthetic vocabulary (a few literal
+// words between properties, some starting with a property, ~10% sharing a
+// common "Request ... completed" shape), renders a pool of lines from them
+// with numbers, ids, paths and words as values, and matches --lines lines for
+// each template count. Reports build time, lines per second, ns per line and
+// MB/s as JSON, plus the share of lines attributed to the
+// template that produced them (the rest went to a template that also fits and
+// has more literal text).
+//
+// Usage: match [--lines N] [--seed N] [TEMPLATE_COUNT...]   (default 100 1000 10000 50000)
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "matcher.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define POOL 65536
+#define MAX_LINE 256
+#define MAX_TEMPLATE 192
+#define VOCABULARY 4096
+
+static uint64_t rng = 0x9e3779b97f4a7c15ull;
+
+static uint32_t rng_next(uint32_t bound) {
+  rng ^= rng << 13;
+  rng ^= rng >> 7;
+  rng ^= rng << 17;
+  return (uint32_t)(rng % bound);
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static char words[VOCABULARY][12];
+
+// Words of two to four consonant-vowel syllables.
+static void make_vocabulary(void) {
+  static const char consonants[] = "bcdfghjklmnprstvwxyz";
+  static const char vowels[] = "aeiou";
+  for (int i = 0; i < VOCABULARY; i++) {
+    int n = 2 + (int)rng_next(3);
+    for (int j = 0; j < n; j++) {
+      words[i][2 * j] = consonants[rng_next(sizeof(consonants) - 1)];
+      words[i][2 * j + 1] = vowels[rng_next(sizeof(vowels) - 1)];
+    }
+    words[i][2 * n] = 0;
+  }
+}
+
+// Word frequencies are skewed, as in real messages.
+static const char *word(void) {
+  uint32_t r = rng_next(VOCABULARY);
+  return words[(r * (uint64_t)r) / VOCABULARY];
+}
+
+static void make_template(char *text) {
+  char *p = text;
+  if (rng_next(10) == 0) {
+    p += sprintf(p, "Request %s {Path} completed with {Status} in {Elapsed:F1} ms", word());
+    return;
+  }
+  if (rng_next(5) == 0) p += sprintf(p, "{Source}: ");
+  int properties = 1 + (int)rng_next(5);
+  for (int i = 0; i < properties; i++) {
+    int n = 1 + (int)rng_next(4);
+    for (int j = 0; j < n; j++) p += sprintf(p, "%s ", word());
+    p += sprintf(p, rng_next(4) ? "{P%d}" : "[{P%d}]", i);
+    if (i + 1 < properties) *p++ = ' ';
+  }
+  if (rng_next(2)) p += sprintf(p, " %s", word());
+  *p = 0;
+}
+
+static uint32_t render(const char *text, char *line) {
+  uint32_t length = 0;
+  for (const char *p = text; *p;) {
+    if (*p != '{') {
+      line[length++] = *p++;
+      continue;
+    }
+    switch (rng_next(4)) {
+      case 0: length += (uint32_t)sprintf(line + length, "%u", rng_next(100000)); break;
+      case 1: length += (uint32_t)sprintf(line + length, "%08x", rng_next(UINT32_MAX)); break;
+      case 2: length += (uint32_t)sprintf(line + length, "/api/v1/%s", word()); break;
+      default: length += (uint32_t)sprintf(line + length, "%s", word()); break;
+    }
+    p = strchr(p, '}') + 1;
+  }
+  line[length] = 0;
+  return length;
+}
+
+int main(int argc, char **argv) {
+  uint64_t lines = 2000000;
+  uint32_t counts[16], count_count = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--lines") && i + 1 < argc) {
+      lines = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      rng = strtoull(argv[++i], NULL, 10) | 1;
+    } else if (argv[i][0] != '-' && count_count < 16) {
+      counts[count_count++] = (uint32_t)strtoul(argv[i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--lines N] [--seed N] [TEMPLATE_COUNT...]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (count_count == 0) {
+    static const uint32_t defaults[] = {100, 1000, 10000, 50000};
+    for (; count_count < 4; count_count++) counts[count_count] = defaults[count_count];
+  }
+  if (lines == 0) lines = 1;
+
+  make_vocabulary();
+  char (*pool)[MAX_LINE] = malloc(sizeof(*pool) * POOL);
+  uint32_t *lengths = malloc(sizeof(uint32_t) * POOL);
+  int32_t *sources = malloc(sizeof(int32_t) * POOL);
+  if (!pool || !lengths || !sources) return 1;
+
+  uint64_t checksum = 0;
+  printf("{\n  \"benchmark\": \"match\",\n  \"lines\": %llu,\n  \"runs\": [\n", (unsigned long long)lines);
+  for (uint32_t c = 0; c < count_count; c++) {
+    uint32_t count = counts[c] ? counts[c] : 1;
+    char (*texts)[MAX_TEMPLATE] = malloc(sizeof(*texts) * count);
+    MtlogMatcher *matcher = mtlog_matcher_new();
+    if (!texts || !matcher) return 1;
+    for (uint32_t i = 0; i < count; i++) {
+      make_template(texts[i]);
+      mtlog_matcher_add(matcher, texts[i], (uint32_t)strlen(texts[i]));
+    }
+    uint64_t start = now_ns();
+    if (!mtlog_matcher_build(matcher)) return 1;
+    double build_ms = (double)(now_ns() - start) / 1e6;
+
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < POOL; i++) {
+      sources[i] = (int32_t)rng_next(count);
+      lengths[i] = render(texts[sources[i]], pool[i]);
+    }
+
+    MtlogSpan captures[8];
+    uint64_t own = 0, matched = 0;
+    start = now_ns();
+    for (uint64_t n = 0; n < lines; n++) {
+      uint32_t i = (uint32_t)(n & (POOL - 1));
+      int32_t id = mtlog_matcher_match(matcher, pool[i], lengths[i], captures, 8);
+      bytes += lengths[i];
+      matched += id >= 0;
+      own += id == sources[i];
+      checksum += (uint32_t)id + captures[0].end;
+    }
+    double seconds = (double)(now_ns() - start) / 1e9;
+
+    printf("    {\"templates\": %u, \"build_ms\": %.1f, \"lines_per_s\": %.0f, \"ns_per_line\": %.1f, "
+           "\"mb_per_s\": %.1f, \"matched\": %.4f, \"own_template\": %.4f}%s\n",
+           count, build_ms, (double)lines / seconds, seconds * 1e9 / (double)lines, (double)bytes / seconds / 1e6,
+           (double)matched / (double)lines, (double)own / (double)lines, c + 1 < count_count ? "," : "");
+    mtlog_matcher_delete(matcher);
+    free(texts);
+  }
+  printf("  ],\n  \"checksum\": %llu\n}\n", (unsigned long long)checksum);
+  free(pool);
+  free(lengths);
+  free(sources);
+  return 0;
+}
@@ -0,0 +1,127 @@
+// Benchmark for multi-threaded extraction of one large file (src/parallel.h).
+//
+// Builds a catalog of --megabytes of template lines (1 GB by default), then
+// times mtlog_ir_from_text on one thread against mtlog_ir_from_text_parallel
+// for 1 to --threads threads, doubling, and reports MB/s and the speedup as
+// JSON, checking that every parallel IR is byte-identical to the serial one.
+// The serial IR is buffered as it is built, so a 1 GB run needs several GB of
+// memory; use a smaller --megabytes on small machines.
+//
+// Usage: parallel [--megabytes N] [--threads N] [--chunk BYTES] [--seed N]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "parallel.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *const LITERALS[] = {
+  "User ", " logged in from ", " at ", "Processing ", " items for ", "Order ",
+  " created with total ", " failed: ", "Request to ", " returned ", " in ", " ms",
+};
+
+static const char *const PROPERTIES[] = {
+  "{UserId}", "{@Order}", "{$Error}", "{Amount:F2}", "{Timestamp:yyyy-MM-dd HH:mm:ss}",
+  "{http.method}", "{service.name}", "{0}", "{{.UserId}}", "${Level:u3}", "{Elapsed:0.000}",
+};
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rng_next(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+// Doubling, but always ending on `max`.
+static unsigned next_count(unsigned count, unsigned max) {
+  return count < max && count * 2 > max ? max : count * 2;
+}
+
+int main(int argc, char **argv) {
+  uint32_t megabytes = 1024, chunk_size = 0, seed = 42;
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned max_threads = processors > 0 ? (unsigned)processors : 1;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--megabytes") && i + 1 < argc) {
+      megabytes = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+      max_threads = (unsigned)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--chunk") && i + 1 < argc) {
+      chunk_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--megabytes N] [--threads N] [--chunk BYTES] [--seed N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (megabytes == 0) megabytes = 1;
+  if (megabytes > 4095) megabytes = 4095; // offsets are 32-bit
+  if (max_threads == 0) max_threads = 1;
+
+  // One template per line: a numbered prefix, then literal/property fragments.
+  uint32_t length = megabytes << 20, state = seed ? seed : 1, at = 0;
+  char *text = malloc(length);
+  if (!text) {
+    fprintf(stderr, "failed to allocate %u MB\n", megabytes);
+    return 1;
+  }
+  while (at < length) {
+    char line[512];
+    int n = snprintf(line, sizeof(line), "[%u] ", rng_next(&state) % 100000);
+    unsigned fragments = 1 + rng_next(&state) % 5;
+    for (unsigned f = 0; f < fragments; f++) {
+      n += snprintf(line + n, sizeof(line) - (size_t)n, "%s%s", LITERALS[rng_next(&state) % COUNT(LITERALS)],
+                    PROPERTIES[rng_next(&state) % COUNT(PROPERTIES)]);
+    }
+    line[n++] = '\n';
+    uint32_t take = length - at < (uint32_t)n ? length - at : (uint32_t)n;
+    memcpy(text + at, line, take);
+    at += take;
+  }
+
+  uint64_t start = now_ns();
+  MtlogTemplateIR *serial = mtlog_ir_from_text(text, length);
+  double serial_seconds = (double)(now_ns() - start) / 1e9;
+
+  printf("{\n  \"benchmark\": \"parallel\",\n  \"megabytes\": %u,\n  \"chunk_size\": %u,\n", megabytes,
+         chunk_size);
+  if (serial) {
+    printf("  \"segments\": %u,\n  \"serial_mb_per_s\": %.1f,\n", serial->segment_count,
+           megabytes / serial_seconds);
+  } else {
+    printf("  \"segments\": null,\n  \"serial_mb_per_s\": null,\n");
+  }
+  printf("  \"parallel\": [\n");
+  int status = serial ? 0 : 1;
+  for (unsigned threads = 1; threads <= max_threads; threads = next_count(threads, max_threads)) {
+    start = now_ns();
+    MtlogTemplateIR *ir = mtlog_ir_from_text_parallel(text, length, threads, chunk_size);
+    double seconds = (double)(now_ns() - start) / 1e9;
+    bool identical = ir && serial && ir->size == serial->size && !memcmp(ir, serial, serial->size);
+    if (!identical) status = 1;
+    printf("    {\"threads\": %u, \"mb_per_s\": %.1f, \"speedup\": %.2f, \"identical\": %s}%s\n", threads,
+           megabytes / seconds, serial ? serial_seconds / seconds : 0.0, identical ? "true" : "false",
+           threads < max_threads ? "," : "");
+    mtlog_ir_delete(ir);
+  }
+  printf("  ]\n}\n");
+
+  mtlog_ir_delete(serial);
+  free(text);
+  return status;
+}
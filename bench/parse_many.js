@@ -0,0 +1,142 @@
+#!/usr/bin/env node
+// Batch extraction benchmark: the properties of a batch of templates through
+// the native parseMany, which crosses into native code once per batch and
+// returns typed arrays, against node-tree-sitter, which parses each template
+// and creates a JS object for every node visited.
+//
+// Usage: node bench/parse_many.js [--templates N] [--rounds N] [--seed N] [--json]
+//
+// Both paths read each property's kind and name span, and their property
+// counts are checked against each other.
+
+const Parser = require('tree-sitter');
+const Mtlog = require('..');
+
+const LITERALS = [
+  'User ', ' logged in from ', ' at ', 'Processing ', ' items for ', 'Order ',
+  ' created with total ', ' failed: ', 'Request to ', ' returned ', ' in ', ' ms',
+];
+
+const PROPERTIES = [
+  '{UserId}', '{@Order}', '{$Error}', '{Amount:F2}', '{Timestamp:yyyy-MM-dd HH:mm:ss}',
+  '{http.method}', '{service.name}', '{0}', '{{.UserId}}', '${Level:u3}', '{Elapsed:0.000}',
+];
+
+const PROPERTY_TYPES = new Set(['property', 'go_property', 'builtin_property']);
+
+function parseArgs(argv) {
+  const opts = { templates: 100000, rounds: 5, seed: 1, json: false };
+  for (let i = 2; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === '--json') opts.json = true;
+    else if (arg === '--templates') opts.templates = Number(argv[++i]);
+    else if (arg === '--rounds') opts.rounds = Number(argv[++i]);
+    else if (arg === '--seed') opts.seed = Number(argv[++i]);
+    else throw new Error(`unknown argument: ${arg}`);
+  }
+  return opts;
+}
+
+// Deterministic PRNG so runs on different revisions see the same batch.
+function mulberry32(seed) {
+  return () => {
+    seed |= 0;
+    seed = (seed + 0x6d2b79f5) | 0;
+    let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+    t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function elapsedMs(start) {
+  return Number(process.hrtime.bigint() - start) / 1e6;
+}
+
+// Returns [property count, sum of name lengths] so the work is observable.
+function viaParseMany(templates) {
+  const { offsets, names, kinds } = Mtlog.parseMany(templates);
+  let properties = 0;
+  let nameBytes = 0;
+  for (let t = 0; t < templates.length; t++) {
+    for (let s = offsets[t]; s < offsets[t + 1]; s++) {
+      if (kinds[s] === Mtlog.SEGMENT.LITERAL) continue;
+      properties++;
+      nameBytes += names[2 * s + 1] - names[2 * s];
+    }
+  }
+  return [properties, nameBytes];
+}
+
+function viaTreeSitter(parser, templates) {
+  let properties = 0;
+  let nameBytes = 0;
+  for (const text of templates) {
+    const tree = parser.parse(text);
+    for (const node of tree.rootNode.namedChildren) {
+      if (!PROPERTY_TYPES.has(node.type)) continue;
+      properties++;
+      const name = node.childForFieldName('name');
+      if (name) nameBytes += name.endIndex - name.startIndex;
+    }
+  }
+  return [properties, nameBytes];
+}
+
+function best(rounds, run) {
+  let fastest = Infinity;
+  let result;
+  for (let i = 0; i < rounds; i++) {
+    const start = process.hrtime.bigint();
+    result = run();
+    fastest = Math.min(fastest, elapsedMs(start));
+  }
+  return { ms: fastest, result };
+}
+
+function main() {
+  const opts = parseArgs(process.argv);
+  const random = mulberry32(opts.seed);
+  const pick = (list) => list[Math.floor(random() * list.length)];
+
+  // Distinct templates: a numbered prefix, then literal/property fragments.
+  const templates = [];
+  for (let i = 0; i < opts.templates; i++) {
+    let text = `[${i}] `;
+    const fragments = 1 + Math.floor(random() * 5);
+    for (let f = 0; f < fragments; f++) text += pick(LITERALS) + pick(PROPERTIES);
+    templates.push(text);
+  }
+
+  const parser = new Parser();
+  parser.setLanguage(Mtlog);
+
+  const native = best(opts.rounds, () => viaParseMany(templates));
+  // Parsing every template is far slower, so take fewer rounds of it.
+  const tree = best(Math.min(opts.rounds, 2), () => viaTreeSitter(parser, templates));
+  const agree = native.result[0] === tree.result[0];
+
+  const result = {
+    benchmark: 'parse_many',
+    templates: opts.templates,
+    properties: native.result[0],
+    parse_many_ms: native.ms,
+    node_tree_sitter_ms: tree.ms,
+    parse_many_templates_per_second: Math.round((opts.templates * 1000) / native.ms),
+    node_tree_sitter_templates_per_second: Math.round((opts.templates * 1000) / tree.ms),
+    speedup: tree.ms / native.ms,
+    property_counts_agree: agree,
+  };
+
+  if (opts.json) {
+    console.log(JSON.stringify(result, null, 2));
+  } else {
+    console.log(`templates:         ${result.templates} (${result.properties} properties)`);
+    console.log(`parseMany:         ${result.parse_many_ms.toFixed(1)} ms`);
+    console.log(`node-tree-sitter:  ${result.node_tree_sitter_ms.toFixed(1)} ms`);
+    console.log(`speedup:           ${result.speedup.toFixed(1)}x`);
+    if (!agree) console.log(`property counts differ: ${native.result[0]} vs ${tree.result[0]}`);
+  }
+  if (!agree) process.exitCode = 1;
+}
+
+main();
@@ -0,0 +1,226 @@
+// Multi-threaded scaling benchmark for the parser pool (src/parser_pool.h).
+//
+// For each thread count from 1 to --threads, doubling, every thread parses
+// a stream of templates three ways:
+//
+//   pool    mtlog_parser_pool_checkout, parse, mtlog_parser_pool_return
+//   thread  one parser per thread, created before the clock starts; the
+//           floor the pool can reach
+//   fresh   ts_parser_new + ts_parser_set_language per parse, what callers
+//           without a pool or a parser of their own pay
+//
+// and reports total parses per second for each, with the pool's contention:
+// probes (slots passed over) per checkout and the checkouts that found it
+// empty. Throughput rising with threads (up to the core count) and probes
+// staying near zero mean the pool adds no contention. --pool smaller than
+// --threads shows what happens when it runs dry.
+//
+// To check the pool and the scanner for data races:
+//
+//   make -C bench run-pool-tsan TREE_SITTER_DIR=~/tree-sitter
+//
+// Usage: pool [--templates N] [--events N] [--threads N] [--pool N] [--seed N]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "parser_pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const TSLanguage *tree_sitter_mtlog(void);
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *const LITERALS[] = {
+  "User ", " logged in from ", " at ", "Processing ", " items for ", "Order ",
+  " created with total ", " failed: ", "Request to ", " returned ", " in ", " ms",
+};
+
+static const char *const PROPERTIES[] = {
+  "{UserId}", "{@Order}", "{$Error}", "{Amount:F2}", "{Timestamp:yyyy-MM-dd HH:mm:ss}",
+  "{http.method}", "{service.name}", "{0}", "{{.UserId}}", "${Level:u3}", "{Elapsed:0.000}",
+};
+
+typedef enum { MODE_POOL, MODE_THREAD, MODE_FRESH, MODE_COUNT } Mode;
+
+static const char *const MODE_NAMES[] = {"pool", "thread", "fresh"};
+
+typedef struct {
+  char *text;
+  uint32_t length;
+} Template;
+
+static Template *templates;
+static uint32_t template_count = 2000;
+static uint32_t events_per_thread = 20000;
+static MtlogParserPool *pool;
+
+typedef struct {
+  pthread_t thread;
+  Mode mode;
+  uint32_t seed;
+  uint64_t checksum; // keeps the work observable
+} Worker;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rng_next(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static uint32_t events_for(Mode mode) {
+  // Creating a parser per parse is several times slower; replay fewer events.
+  return mode == MODE_FRESH ? events_per_thread / 10 : events_per_thread;
+}
+
+static uint64_t parse(TSParser *parser, const Template *t) {
+  TSTree *tree = ts_parser_parse_string(parser, NULL, t->text, t->length);
+  uint64_t children = ts_node_named_child_count(ts_tree_root_node(tree));
+  ts_tree_delete(tree);
+  return children;
+}
+
+static void *run_worker(void *argument) {
+  Worker *worker = (Worker *)argument;
+  uint32_t state = worker->seed;
+  uint64_t checksum = 0;
+  TSParser *own = NULL;
+  if (worker->mode == MODE_THREAD) {
+    own = ts_parser_new();
+    ts_parser_set_language(own, tree_sitter_mtlog());
+  }
+
+  uint32_t events = events_for(worker->mode);
+  for (uint32_t i = 0; i < events; i++) {
+    const Template *t = &templates[rng_next(&state) % template_count];
+    switch (worker->mode) {
+      case MODE_POOL: {
+        TSParser *parser = mtlog_parser_pool_checkout(pool);
+        checksum += parse(parser, t);
+        mtlog_parser_pool_return(pool, parser);
+        break;
+      }
+      case MODE_THREAD:
+        checksum += parse(own, t);
+        break;
+      case MODE_FRESH: {
+        TSParser *parser = ts_parser_new();
+        ts_parser_set_language(parser, tree_sitter_mtlog());
+        checksum += parse(parser, t);
+        ts_parser_delete(parser);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  if (own) ts_parser_delete(own);
+  worker->checksum = checksum;
+  return NULL;
+}
+
+// Parses per second across `threads` workers running `mode` concurrently.
+static double measure(Mode mode, unsigned threads, uint32_t seed) {
+  Worker *workers = calloc(threads, sizeof(Worker));
+  uint64_t start = now_ns();
+  for (unsigned i = 0; i < threads; i++) {
+    workers[i].mode = mode;
+    workers[i].seed = seed + i * 7919 + 1;
+    pthread_create(&workers[i].thread, NULL, run_worker, &workers[i]);
+  }
+  for (unsigned i = 0; i < threads; i++) pthread_join(workers[i].thread, NULL);
+  uint64_t elapsed = now_ns() - start;
+  free(workers);
+  return (double)events_for(mode) * threads * 1e9 / (double)elapsed;
+}
+
+// Doubling, but always ending on `max`.
+static unsigned next_count(unsigned count, unsigned max) {
+  return count < max && count * 2 > max ? max : count * 2;
+}
+
+int main(int argc, char **argv) {
+  unsigned max_threads = 64;
+  uint32_t pool_size = 0, seed = 42;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--templates") && i + 1 < argc) {
+      template_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--events") && i + 1 < argc) {
+      events_per_thread = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+      max_threads = (unsigned)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--pool") && i + 1 < argc) {
+      pool_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--templates N] [--events N] [--threads N] [--pool N] [--seed N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (template_count == 0) template_count = 1;
+  if (events_per_thread < 10) events_per_thread = 10;
+  if (max_threads == 0) max_threads = 1;
+  if (pool_size == 0) pool_size = max_threads;
+
+  // Distinct templates: a numbered prefix, then literal/property fragments.
+  uint32_t state = seed ? seed : 1;
+  templates = calloc(template_count, sizeof(Template));
+  for (uint32_t i = 0; i < template_count; i++) {
+    char buffer[512];
+    int length = snprintf(buffer, sizeof(buffer), "[%u] ", i);
+    unsigned fragments = 1 + rng_next(&state) % 5;
+    for (unsigned f = 0; f < fragments; f++) {
+      length += snprintf(buffer + length, sizeof(buffer) - (size_t)length, "%s%s",
+                         LITERALS[rng_next(&state) % COUNT(LITERALS)],
+                         PROPERTIES[rng_next(&state) % COUNT(PROPERTIES)]);
+    }
+    templates[i].text = malloc((size_t)length + 1);
+    memcpy(templates[i].text, buffer, (size_t)length + 1);
+    templates[i].length = (uint32_t)length;
+  }
+
+  pool = mtlog_parser_pool_new(pool_size);
+  if (!pool) {
+    fprintf(stderr, "failed to create a pool of %u parsers\n", pool_size);
+    return 1;
+  }
+
+  printf("{\n  \"benchmark\": \"parser_pool\",\n  \"templates\": %u,\n  \"events_per_thread\": %u,\n"
+         "  \"pool_size\": %u,\n",
+         template_count, events_per_thread, pool_size);
+  printf("  \"parses_per_second\": [\n");
+  for (unsigned threads = 1; threads <= max_threads; threads = next_count(threads, max_threads)) {
+    MtlogParserPoolStats before, after;
+    printf("    {\"threads\": %u", threads);
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+      if (mode == MODE_POOL) mtlog_parser_pool_stats(pool, &before);
+      printf(", \"%s\": %.0f", MODE_NAMES[mode], measure((Mode)mode, threads, seed));
+      if (mode == MODE_POOL) mtlog_parser_pool_stats(pool, &after);
+    }
+    uint64_t checkouts = (uint64_t)events_for(MODE_POOL) * threads;
+    printf(", \"probes_per_checkout\": %.4f, \"overflows\": %llu}%s\n",
+           (double)(after.probes - before.probes) / (double)checkouts,
+           (unsigned long long)(after.overflows - before.overflows), threads < max_threads ? "," : "");
+  }
+  printf("  ]\n}\n");
+
+  mtlog_parser_pool_delete(pool);
+  for (uint32_t i = 0; i < template_count; i++) free(templates[i].text);
+  free(templates);
+  return 0;
+}
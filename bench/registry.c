@@ -0,0 +1,231 @@
+// Multi-process benchmark for the shared-memory template registry
+// (src/registry.h).
+//
+// For each process count up to --processes, a fresh registry file is created
+// and that many forked workers, released together, each handle events three
+// ways:
+//
+//   insert   intern every distinct template once, in the worker's own order,
+//            all workers racing to register the same templates
+//   lookup   mtlog_registry_intern on a stream of events, all hits
+//   extract  mtlog_ir_from_text + delete per event, what each worker does
+//            without the registry
+//
+// and reports wall-clock ns per event on each worker as JSON (flat as
+// processes grow means no contention), with the IDs claimed, which exceed
+// the templates only when racing inserts gave one up.
+//
+// Usage: registry [--templates N] [--events N] [--processes N] [--path FILE] [--seed N]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "registry.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *const LITERALS[] = {
+  "User ", " logged in from ", " at ", "Processing ", " items for ", "Order ",
+  " created with total ", " failed: ", "Request to ", " returned ", " in ", " ms",
+};
+
+static const char *const PROPERTIES[] = {
+  "{UserId}", "{@Order}", "{$Error}", "{Amount:F2}", "{Timestamp:yyyy-MM-dd HH:mm:ss}",
+  "{http.method}", "{service.name}", "{0}", "{{.UserId}}", "${Level:u3}", "{Elapsed:0.000}",
+};
+
+typedef enum { MODE_INSERT, MODE_LOOKUP, MODE_EXTRACT, MODE_COUNT } Mode;
+
+static const char *const MODE_NAMES[] = {"insert", "lookup", "extract"};
+
+typedef struct {
+  char *text;
+  uint32_t length;
+} Template;
+
+static Template *templates;
+static uint32_t template_count = 10000;
+static uint32_t events_per_process = 1000000;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rng_next(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static uint32_t events_for(Mode mode) {
+  // Extracting is far slower than a lookup; replay fewer events.
+  return mode == MODE_INSERT ? template_count : mode == MODE_EXTRACT ? events_per_process / 10 : events_per_process;
+}
+
+// One worker: wait for the start signal, run `mode`, report elapsed ns, or 0
+// if anything failed.
+static void run_worker(const char *path, Mode mode, uint32_t seed, int start, int out) {
+  MtlogRegistry *registry = mtlog_registry_open(path, 2 * template_count, 0);
+  uint32_t state = seed;
+  uint32_t *order = NULL;
+  if (mode == MODE_INSERT) {
+    // A per-worker shuffle, so workers collide on different templates.
+    order = malloc(sizeof(uint32_t) * template_count);
+    for (uint32_t i = 0; i < template_count; i++) order[i] = i;
+    for (uint32_t i = template_count - 1; i > 0; i--) {
+      uint32_t j = rng_next(&state) % (i + 1);
+      uint32_t swap = order[i];
+      order[i] = order[j];
+      order[j] = swap;
+    }
+  }
+  char signal;
+  ssize_t ready = read(start, &signal, 1);
+  (void)ready;
+
+  uint64_t begin = now_ns(), checksum = 0;
+  bool ok = registry != NULL;
+  uint32_t events = events_for(mode);
+  for (uint32_t i = 0; ok && i < events; i++) {
+    const Template *t = &templates[order ? order[i] : rng_next(&state) % template_count];
+    if (mode == MODE_EXTRACT) {
+      MtlogTemplateIR *ir = mtlog_ir_from_text(t->text, t->length);
+      ok = ir != NULL;
+      if (ir) checksum += ir->property_count;
+      mtlog_ir_delete(ir);
+    } else {
+      int32_t id = mtlog_registry_intern(registry, t->text, t->length);
+      ok = id >= 0 && mtlog_registry_ir(registry, (uint32_t)id) != NULL;
+      if (ok) checksum += mtlog_registry_ir(registry, (uint32_t)id)->property_count;
+    }
+  }
+  uint64_t elapsed = ok && checksum ? now_ns() - begin : 0;
+
+  mtlog_registry_close(registry);
+  free(order);
+  ssize_t written = write(out, &elapsed, sizeof(elapsed));
+  _exit(written == (ssize_t)sizeof(elapsed) ? 0 : 1);
+}
+
+// ns per event on each of `processes` workers running `mode` at once, or a
+// negative value if a worker failed.
+static double measure(const char *path, Mode mode, unsigned processes, uint32_t seed) {
+  int start[2], results[2];
+  if (pipe(start) != 0 || pipe(results) != 0) return -1;
+  for (unsigned i = 0; i < processes; i++) {
+    if (fork() == 0) {
+      close(start[1]);
+      close(results[0]);
+      run_worker(path, mode, seed + i * 7919 + 1, start[0], results[1]);
+    }
+  }
+  close(start[0]);
+  close(results[1]);
+  // Closing the write end releases every worker's read at once.
+  close(start[1]);
+
+  uint64_t slowest = 0;
+  bool ok = true;
+  for (unsigned i = 0; i < processes; i++) {
+    uint64_t elapsed = 0;
+    if (read(results[0], &elapsed, sizeof(elapsed)) != (ssize_t)sizeof(elapsed) || elapsed == 0) ok = false;
+    if (elapsed > slowest) slowest = elapsed;
+  }
+  close(results[0]);
+  for (unsigned i = 0; i < processes; i++) {
+    int status;
+    if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+  }
+  return ok ? (double)slowest / (double)events_for(mode) : -1;
+}
+
+// Doubling, but always ending on `max`.
+static unsigned next_count(unsigned count, unsigned max) {
+  return count < max && count * 2 > max ? max : count * 2;
+}
+
+int main(int argc, char **argv) {
+  unsigned max_processes = 32;
+  uint32_t seed = 42;
+  const char *path = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--templates") && i + 1 < argc) {
+      template_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--events") && i + 1 < argc) {
+      events_per_process = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--processes") && i + 1 < argc) {
+      max_processes = (unsigned)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--path") && i + 1 < argc) {
+      path = argv[++i];
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--templates N] [--events N] [--processes N] [--path FILE] [--seed N]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (template_count == 0) template_count = 1;
+  if (events_per_process < 10) events_per_process = 10;
+  if (max_processes == 0) max_processes = 1;
+  char default_path[64];
+  if (!path) {
+    snprintf(default_path, sizeof(default_path), "%s/mtlog-registry-bench.%ld",
+             access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp", (long)getpid());
+    path = default_path;
+  }
+
+  // Distinct templates: a numbered prefix, then literal/property fragments.
+  uint32_t state = seed ? seed : 1;
+  templates = calloc(template_count, sizeof(Template));
+  for (uint32_t i = 0; i < template_count; i++) {
+    char buffer[512];
+    int length = snprintf(buffer, sizeof(buffer), "[%u] ", i);
+    unsigned fragments = 1 + rng_next(&state) % 5;
+    for (unsigned f = 0; f < fragments; f++) {
+      length += snprintf(buffer + length, sizeof(buffer) - (size_t)length, "%s%s",
+                         LITERALS[rng_next(&state) % COUNT(LITERALS)],
+                         PROPERTIES[rng_next(&state) % COUNT(PROPERTIES)]);
+    }
+    templates[i].text = malloc((size_t)length + 1);
+    memcpy(templates[i].text, buffer, (size_t)length + 1);
+    templates[i].length = (uint32_t)length;
+  }
+
+  printf("{\n  \"benchmark\": \"registry\",\n  \"templates\": %u,\n  \"events_per_process\": %u,\n",
+         template_count, events_per_process);
+  printf("  \"ns_per_event\": [\n");
+  int status = 0;
+  for (unsigned processes = 1; processes <= max_processes; processes = next_count(processes, max_processes)) {
+    unlink(path);
+    printf("    {\"processes\": %u", processes);
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+      double ns = measure(path, (Mode)mode, processes, seed);
+      if (ns < 0) status = 1;
+      printf(", \"%s\": %.1f", MODE_NAMES[mode], ns);
+    }
+    MtlogRegistry *registry = mtlog_registry_open(path, 0, 0);
+    MtlogRegistryStats stats = {0, 0, 0, 0};
+    if (registry) mtlog_registry_stats(registry, &stats);
+    mtlog_registry_close(registry);
+    printf(", \"ids_claimed\": %u, \"record_bytes_used\": %llu}%s\n", stats.templates,
+           (unsigned long long)stats.used_bytes, processes < max_processes ? "," : "");
+  }
+  unlink(path);
+  printf("  ]\n}\n");
+
+  for (uint32_t i = 0; i < template_count; i++) free(templates[i].text);
+  free(templates);
+  return status;
+}
@@ -0,0 +1,137 @@
+// Throughput benchmark for the template renderer (src/render.h).
+//
+// Compiles templates with 1, 5 and 20 properties (plain, formatted, '@' and
+// '$' hinted, builtin and Go properties) and renders --events events into one
+// reused buffer, with a fresh set of values per event. Reports events per
+// second, ns per event and output bytes per event as JSON, plus how often the
+// buffer had to grow after the first event (0 means no per-event allocation).
+//
+// Usage: render [--events N]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "render.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+#define MAX_SLOTS 32
+
+static const struct {
+  const char *properties;
+  const char *text;
+} TEMPLATES[] = {
+  {"1", "User {UserId} logged in"},
+  {"5", "[${Level:u3}] User {UserId} ordered {@Order} for {Amount:F2} via {{.Channel}}"},
+  {"20",
+   "{P0} {P1:D4} {@P2} {$P3} {P4} {P5:F2} {P6} {P7} {@P8} {P9} "
+   "{P10} {P11} {$P12} {P13:HH:mm} {P14} {P15} {P16} {@P17} {P18} ${Timestamp:yyyy-MM-dd}"},
+};
+
+static size_t buffer_grows;
+
+static bool grow(MtlogRenderBuffer *buffer, size_t capacity) {
+  size_t next = buffer->capacity ? buffer->capacity : 64;
+  while (next < capacity) next *= 2;
+  char *data = realloc(buffer->data, next);
+  if (!data) return false;
+  buffer->data = data;
+  buffer->capacity = next;
+  buffer_grows++;
+  return true;
+}
+
+// Stand-ins for a logger's hooks: a fixed-shape destructuring and a quoted
+// string, both written straight into the output buffer.
+static bool destructure(MtlogRenderBuffer *out, const MtlogValue *value, const char *format, uint32_t format_length,
+                        void *context) {
+  (void)value, (void)format, (void)format_length, (void)context;
+  static const char text[] = "{\"Id\": 7, \"Total\": 12.5}";
+  return mtlog_render_append(out, text, sizeof(text) - 1);
+}
+
+static bool stringify(MtlogRenderBuffer *out, const MtlogValue *value, const char *format, uint32_t format_length,
+                      void *context) {
+  (void)format, (void)format_length, (void)context;
+  if (value->kind != MTLOG_VALUE_STRING) return mtlog_render_append(out, "\"?\"", 3);
+  return mtlog_render_append(out, "\"", 1) && mtlog_render_append(out, value->as.string, value->length) &&
+         mtlog_render_append(out, "\"", 1);
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+  uint64_t events = 10000000;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--events") && i + 1 < argc) {
+      events = strtoull(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--events N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  static const char *const STRINGS[] = {"alice", "bob", "carol", "dave"};
+  MtlogRenderHooks hooks = {destructure, stringify, NULL, NULL};
+  MtlogRenderBuffer out = {NULL, 0, 0, grow, NULL};
+  uint64_t checksum = 0;
+
+  printf("{\n  \"benchmark\": \"render\",\n  \"events\": %llu,\n  \"templates\": [\n", (unsigned long long)events);
+  for (size_t t = 0; t < COUNT(TEMPLATES); t++) {
+    MtlogRenderProgram *program = mtlog_render_compile_text(TEMPLATES[t].text, (uint32_t)strlen(TEMPLATES[t].text));
+    uint32_t slots = mtlog_render_slot_count(program);
+    MtlogValue values[MAX_SLOTS];
+
+    // Warm the buffer with one event so growth is not counted per event.
+    for (uint32_t s = 0; s < slots; s++) values[s] = (MtlogValue){MTLOG_VALUE_UINT, 0, {.uinteger = UINT64_MAX}};
+    out.length = 0;
+    mtlog_render(program, values, &hooks, &out);
+    size_t grows_before = buffer_grows;
+
+    uint64_t bytes = 0;
+    uint64_t start = now_ns();
+    for (uint64_t e = 0; e < events; e++) {
+      for (uint32_t s = 0; s < slots; s++) {
+        switch ((e + s) % 3) {
+          case 0:
+            values[s] = (MtlogValue){MTLOG_VALUE_INT, 0, {.integer = (int64_t)(e * 31 + s)}};
+            break;
+          case 1: {
+            const char *text = STRINGS[(e + s) % COUNT(STRINGS)];
+            values[s] = (MtlogValue){MTLOG_VALUE_STRING, (uint32_t)strlen(text), {.string = text}};
+            break;
+          }
+          default:
+            values[s] = (MtlogValue){MTLOG_VALUE_BOOL, 0, {.boolean = (e & 1) != 0}};
+            break;
+        }
+      }
+      out.length = 0;
+      mtlog_render(program, values, &hooks, &out);
+      bytes += out.length;
+      checksum += (unsigned char)out.data[out.length / 2];
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    printf("    {\"properties\": %s, \"slots\": %u, \"ops\": %u, \"events_per_s\": %.0f, \"ns_per_event\": %.1f, "
+           "\"bytes_per_event\": %.1f, \"buffer_grows_after_warmup\": %zu}%s\n",
+           TEMPLATES[t].properties, slots, mtlog_render_op_count(program),
+           elapsed ? (double)events * 1e9 / (double)elapsed : 0.0,
+           events ? (double)elapsed / (double)events : 0.0, events ? (double)bytes / (double)events : 0.0,
+           buffer_grows - grows_before, t + 1 < COUNT(TEMPLATES) ? "," : "");
+    mtlog_render_delete(program);
+  }
+  printf("  ],\n  \"checksum\": %llu\n}\n", (unsigned long long)checksum);
+
+  free(out.data);
+  return 0;
+}
@@ -0,0 +1,211 @@
+// Benchmark for property-name interning (src/symbols.h).
+//
+// Builds --distinct property names, a mix of identifiers and OTEL-style
+// dotted names over a shared segment vocabulary, and measures:
+//
+//   insert   interning each distinct name for the first time
+//   hit      interning a skewed stream of --names names already present
+//   find     looking the same stream up without interning
+//   extract  mtlog_symbols_intern_properties over templates built from the
+//            names, against mtlog_scan_properties alone
+//
+// and reports ns per name, names per second and the table's memory per
+// million distinct names as JSON.
+//
+// Usage: symbols [--distinct N] [--names N] [--seed N]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "properties.h"
+#include "symbols.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+#define TEMPLATE_PROPERTIES 4
+#define REPLAY (1u << 20)
+
+static const char *const WORDS[] = {
+  "http", "request", "response", "method", "status", "code", "url", "path", "host", "port", "service",
+  "name", "version", "user", "id", "session", "trace", "span", "parent", "db", "system", "statement",
+  "operation", "net", "peer", "client", "server", "rpc", "message", "type", "error", "exception",
+  "stacktrace", "thread", "process", "pid", "runtime", "cloud", "region", "zone", "container", "image",
+  "k8s", "pod", "namespace", "deployment", "node", "event", "duration", "size", "count", "queue",
+};
+
+typedef struct {
+  char *text;
+  uint32_t length;
+} Name;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rng_next(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static void capitalize(char *p) {
+  if (*p >= 'a' && *p <= 'z') *p = (char)(*p - 'a' + 'A');
+}
+
+// Name i: half are identifiers such as `UserId17`, half dotted names such as
+// `http.request.method.4`. The numeric suffix keeps them distinct.
+static uint32_t make_name(char *out, uint32_t i, uint32_t *state) {
+  int length = 0;
+  if (rng_next(state) & 1) {
+    unsigned words = 1 + rng_next(state) % 3;
+    for (unsigned w = 0; w < words; w++) {
+      char *word = out + length;
+      length += sprintf(word, "%s", WORDS[rng_next(state) % COUNT(WORDS)]);
+      capitalize(word);
+    }
+    length += sprintf(out + length, "%u", i);
+  } else {
+    unsigned segments = 2 + rng_next(state) % 3;
+    for (unsigned s = 0; s < segments; s++) {
+      length += sprintf(out + length, "%s.", WORDS[rng_next(state) % COUNT(WORDS)]);
+    }
+    length += sprintf(out + length, "%u", i % 1000);
+  }
+  return (uint32_t)length;
+}
+
+static bool count_property(const MtlogSegment *segment, void *context) {
+  *(uint64_t *)context += segment->name.end - segment->name.start;
+  return true;
+}
+
+// Indexes skewed towards the first names, as property names are in practice.
+static uint32_t skewed(uint32_t *state, uint32_t count) {
+  uint64_t r = rng_next(state) % count;
+  return (uint32_t)(r * r / count);
+}
+
+int main(int argc, char **argv) {
+  uint32_t distinct = 1000000, stream = 10000000, seed = 42;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--distinct") && i + 1 < argc) {
+      distinct = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--names") && i + 1 < argc) {
+      stream = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--distinct N] [--names N] [--seed N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (distinct == 0) distinct = 1;
+  if (stream == 0) stream = 1;
+  uint32_t state = seed ? seed : 1;
+
+  // Dotted names can repeat; keep the generated list as is, so `insert`
+  // includes the occasional duplicate like real input would.
+  Name *names = malloc(sizeof(Name) * distinct);
+  uint64_t name_bytes = 0;
+  for (uint32_t i = 0; i < distinct; i++) {
+    char buffer[128];
+    names[i].length = make_name(buffer, i, &state);
+    names[i].text = malloc(names[i].length + 1);
+    memcpy(names[i].text, buffer, names[i].length + 1);
+    name_bytes += names[i].length;
+  }
+  // The stream is replayed from a contiguous copy, as names arrive inside
+  // template text, so the benchmark measures the table rather than fetching
+  // names from all over the heap.
+  uint32_t replay = stream < REPLAY ? stream : REPLAY;
+  Name *order = malloc(sizeof(Name) * replay);
+  char *replay_bytes = malloc((size_t)replay * 64);
+  for (uint32_t i = 0, offset = 0; i < replay; i++) {
+    const Name *name = &names[skewed(&state, distinct)];
+    order[i] = (Name){replay_bytes + offset, name->length};
+    memcpy(replay_bytes + offset, name->text, name->length);
+    offset += name->length;
+  }
+
+  MtlogSymbols *symbols = mtlog_symbols_new();
+  uint64_t checksum = 0;
+  uint64_t start = now_ns();
+  for (uint32_t i = 0; i < distinct; i++) checksum += mtlog_symbols_intern(symbols, names[i].text, names[i].length);
+  double insert_ns = (double)(now_ns() - start) / distinct;
+  uint32_t symbol_count = mtlog_symbols_count(symbols);
+  size_t memory = mtlog_symbols_memory(symbols);
+
+  start = now_ns();
+  for (uint32_t i = 0, k = 0; i < stream; i++, k = k + 1 < replay ? k + 1 : 0) {
+    checksum += mtlog_symbols_intern(symbols, order[k].text, order[k].length);
+  }
+  double hit_ns = (double)(now_ns() - start) / stream;
+
+  start = now_ns();
+  for (uint32_t i = 0, k = 0; i < stream; i++, k = k + 1 < replay ? k + 1 : 0) {
+    checksum += mtlog_symbols_find(symbols, order[k].text, order[k].length);
+  }
+  double find_ns = (double)(now_ns() - start) / stream;
+
+  // Templates of TEMPLATE_PROPERTIES properties drawn from the same names.
+  uint32_t template_count = stream / TEMPLATE_PROPERTIES;
+  if (template_count > 100000) template_count = 100000;
+  if (template_count == 0) template_count = 1;
+  Name *templates = malloc(sizeof(Name) * template_count);
+  for (uint32_t t = 0; t < template_count; t++) {
+    char buffer[1024];
+    int length = 0;
+    for (int p = 0; p < TEMPLATE_PROPERTIES; p++) {
+      length += sprintf(buffer + length, "%s{%s}", p ? " and " : "Event ", names[skewed(&state, distinct)].text);
+    }
+    templates[t].length = (uint32_t)length;
+    templates[t].text = malloc((size_t)length + 1);
+    memcpy(templates[t].text, buffer, (size_t)length + 1);
+  }
+  uint32_t rounds = stream / TEMPLATE_PROPERTIES / template_count;
+  if (rounds == 0) rounds = 1;
+  uint32_t ids[TEMPLATE_PROPERTIES];
+  start = now_ns();
+  for (uint32_t r = 0; r < rounds; r++) {
+    for (uint32_t t = 0; t < template_count; t++) {
+      checksum += mtlog_symbols_intern_properties(symbols, templates[t].text, templates[t].length, ids,
+                                                  TEMPLATE_PROPERTIES);
+      checksum += ids[0];
+    }
+  }
+  double extract_ns = (double)(now_ns() - start) / ((double)rounds * template_count);
+  start = now_ns();
+  for (uint32_t r = 0; r < rounds; r++) {
+    for (uint32_t t = 0; t < template_count; t++) {
+      checksum += mtlog_scan_properties(templates[t].text, templates[t].length, count_property, &checksum);
+    }
+  }
+  double scan_ns = (double)(now_ns() - start) / ((double)rounds * template_count);
+
+  printf("{\n  \"benchmark\": \"symbols\",\n  \"distinct\": %u,\n  \"names\": %u,\n", distinct, stream);
+  printf("  \"symbols\": %u,\n  \"average_name_bytes\": %.1f,\n", symbol_count, (double)name_bytes / distinct);
+  printf("  \"ns_per_name\": {\"insert\": %.1f, \"hit\": %.1f, \"find\": %.1f},\n", insert_ns, hit_ns, find_ns);
+  printf("  \"names_per_s\": {\"insert\": %.0f, \"hit\": %.0f, \"find\": %.0f},\n", 1e9 / insert_ns, 1e9 / hit_ns,
+         1e9 / find_ns);
+  printf("  \"ns_per_template\": {\"intern_properties\": %.1f, \"scan_properties\": %.1f},\n", extract_ns, scan_ns);
+  printf("  \"memory_bytes\": %zu,\n  \"bytes_per_symbol\": %.1f,\n  \"mb_per_million_symbols\": %.1f,\n", memory,
+         (double)memory / symbol_count, (double)memory / symbol_count * 1e6 / (1 << 20));
+  printf("  \"checksum\": %llu\n}\n", (unsigned long long)checksum);
+
+  mtlog_symbols_delete(symbols);
+  for (uint32_t i = 0; i < distinct; i++) free(names[i].text);
+  for (uint32_t t = 0; t < template_count; t++) free(templates[t].text);
+  free(names);
+  free(templates);
+  free(order);
+  free(replay_bytes);
+  return 0;
+}
@@ -0,0 +1,184 @@
+#!/usr/bin/env node
+// Tree-shape benchmark for very large files: node-at-offset lookup and
+// single-character edits on a generated multi-line .mtlog file.
+//
+// Usage: node bench/tree_shape.js [--megabytes N] [--lookups N] [--edits N]
+//                                 [--seed N] [--json]
+//
+// `template` is a repeat, which tree-sitter stores as a balanced binary tree
+// of hidden `template_repeat1` nodes. Lookups by offset descend that tree and
+// stay logarithmic; lookups by child index walk the visible children in order
+// and grow with the index. Both are measured so the difference is visible.
+
+const Parser = require('tree-sitter');
+const Mtlog = require('..');
+
+const TEMPLATES = [
+  'User {UserId} logged in from {IP:15} at {Timestamp:HH:mm:ss}',
+  'Order {@Order} created with total {Amount:F2}',
+  'Service {service.name} in namespace {service.namespace} started',
+  'Processing item {0} of {1}',
+  'User {{.UserId}} performed action {{.Action}}',
+  '[${Timestamp:yyyy-MM-dd HH:mm:ss} ${Level:u3}] ${Message}',
+  'Plain literal line without any properties at all',
+];
+
+function parseArgs(argv) {
+  const opts = { megabytes: 100, lookups: 10000, edits: 50, seed: 1, json: false };
+  for (let i = 2; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === '--json') opts.json = true;
+    else if (arg === '--megabytes') opts.megabytes = Number(argv[++i]);
+    else if (arg === '--lookups') opts.lookups = Number(argv[++i]);
+    else if (arg === '--edits') opts.edits = Number(argv[++i]);
+    else if (arg === '--seed') opts.seed = Number(argv[++i]);
+    else throw new Error(`unknown argument: ${arg}`);
+  }
+  return opts;
+}
+
+// Deterministic PRNG so runs on different revisions probe the same offsets.
+function mulberry32(seed) {
+  return () => {
+    seed |= 0;
+    seed = (seed + 0x6d2b79f5) | 0;
+    let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+    t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function percentile(sorted, p) {
+  if (sorted.length === 0) return 0;
+  const index = Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1);
+  return sorted[Math.max(0, index)];
+}
+
+function summarize(samples) {
+  samples.sort((a, b) => a - b);
+  const mean = samples.reduce((sum, v) => sum + v, 0) / (samples.length || 1);
+  return {
+    mean,
+    p50: percentile(samples, 50),
+    p99: percentile(samples, 99),
+    max: samples[samples.length - 1] || 0,
+  };
+}
+
+function elapsedMs(start) {
+  return Number(process.hrtime.bigint() - start) / 1e6;
+}
+
+// Row and column of `index`, given the sorted start offsets of every line.
+function pointAt(starts, index) {
+  let lo = 0;
+  let hi = starts.length - 1;
+  while (lo < hi) {
+    const mid = (lo + hi + 1) >> 1;
+    if (starts[mid] <= index) lo = mid;
+    else hi = mid - 1;
+  }
+  return { row: lo, column: index - starts[lo] };
+}
+
+function main() {
+  const opts = parseArgs(process.argv);
+  const random = mulberry32(opts.seed);
+
+  const targetBytes = opts.megabytes * 1024 * 1024;
+  const lines = [];
+  const starts = [];
+  let bytes = 0;
+  for (let i = 0; bytes < targetBytes; i++) {
+    const line = TEMPLATES[i % TEMPLATES.length];
+    starts.push(bytes);
+    lines.push(line);
+    bytes += line.length + 1;
+  }
+  let text = lines.join('\n') + '\n';
+
+  const parser = new Parser();
+  parser.setLanguage(Mtlog);
+
+  let start = process.hrtime.bigint();
+  let tree = parser.parse(text);
+  const fullParseMs = elapsedMs(start);
+  const root = tree.rootNode;
+  const childCount = root.childCount;
+
+  const byOffset = [];
+  for (let i = 0; i < opts.lookups; i++) {
+    const offset = Math.floor(random() * text.length);
+    start = process.hrtime.bigint();
+    tree.rootNode.descendantForIndex(offset);
+    byOffset.push(elapsedMs(start));
+  }
+
+  // Indexed child access is far slower on a wide root, so sample fewer.
+  const byIndex = [];
+  for (let i = 0; i < Math.min(opts.lookups, 200); i++) {
+    const index = Math.floor(random() * childCount);
+    start = process.hrtime.bigint();
+    tree.rootNode.child(index);
+    byIndex.push(elapsedMs(start));
+  }
+
+  // Insert one character, reparse, then delete it and reparse again.
+  const edits = [];
+  for (let i = 0; i < opts.edits; i++) {
+    const index = Math.floor(random() * text.length);
+    const point = pointAt(starts, index);
+    const after = { row: point.row, column: point.column + 1 };
+
+    text = text.slice(0, index) + 'x' + text.slice(index);
+    tree.edit({
+      startIndex: index,
+      oldEndIndex: index,
+      newEndIndex: index + 1,
+      startPosition: point,
+      oldEndPosition: point,
+      newEndPosition: after,
+    });
+    start = process.hrtime.bigint();
+    tree = parser.parse(text, tree);
+    edits.push(elapsedMs(start));
+
+    text = text.slice(0, index) + text.slice(index + 1);
+    tree.edit({
+      startIndex: index,
+      oldEndIndex: index + 1,
+      newEndIndex: index,
+      startPosition: point,
+      oldEndPosition: after,
+      newEndPosition: point,
+    });
+    start = process.hrtime.bigint();
+    tree = parser.parse(text, tree);
+    edits.push(elapsedMs(start));
+  }
+
+  const result = {
+    benchmark: 'tree_shape',
+    bytes: text.length,
+    lines: lines.length,
+    root_child_count: childCount,
+    full_parse_ms: fullParseMs,
+    node_at_offset_ms: summarize(byOffset),
+    child_by_index_ms: summarize(byIndex),
+    single_char_edit_ms: summarize(edits),
+  };
+
+  if (opts.json) {
+    console.log(JSON.stringify(result, null, 2));
+  } else {
+    const fmt = (s) => `p50 ${s.p50.toFixed(4)} ms  p99 ${s.p99.toFixed(4)} ms  max ${s.max.toFixed(4)} ms`;
+    console.log(`file:             ${result.lines} lines, ${result.bytes} bytes`);
+    console.log(`root children:    ${result.root_child_count}`);
+    console.log(`full parse:       ${result.full_parse_ms.toFixed(1)} ms`);
+    console.log(`node at offset:   ${fmt(result.node_at_offset_ms)}`);
+    console.log(`child by index:   ${fmt(result.child_by_index_ms)}`);
+    console.log(`single-char edit: ${fmt(result.single_char_edit_ms)}`);
+  }
+}
+
+main();
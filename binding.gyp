@@ -9,7 +9,20 @@
       "sources": [
         "bindings/node/binding.cc",
         "src/parser.c",
-        "src/scanner.c"
+        "src/scanner.c",
+        "src/properties.c",
+        "src/structural.c",
+        "src/template_cache.c",
+        "src/template_ir.c",
+        "src/fingerprint.c",
+        "src/format_spec.c",
+        "src/render.c",
+        "src/matcher.c",
+        "src/registry.c",
+        "src/symbols.c",
+        "src/parallel.c",
+        "src/arena.c",
+        "src/alloc_stats.c"
       ],
       "cflags_c": [
         "-std=c99"
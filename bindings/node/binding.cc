@@ -1,6 +1,19 @@
 #include <nan.h>
 #include "tree_sitter/parser.h"
 #include <node.h>
+#include <node_buffer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fingerprint.h"
+#include "parallel.h"
+#include "properties.h"
+#include "symbols.h"
 
 using namespace v8;
 
@@ -10,6 +23,525 @@ namespace {
 
 NAN_METHOD(New) {}
 
+// fingerprint(template: string | Buffer, flags?: number): bigint
+NAN_METHOD(Fingerprint) {
+  uint32_t flags = MTLOG_FINGERPRINT_DEFAULT;
+  if (info.Length() > 1 && !info[1]->IsUndefined()) {
+    if (!info[1]->IsUint32()) {
+      Nan::ThrowTypeError("flags must be a non-negative integer");
+      return;
+    }
+    flags = Nan::To<uint32_t>(info[1]).FromJust();
+  }
+
+  uint64_t result;
+  if (info.Length() > 0 && node::Buffer::HasInstance(info[0])) {
+    result = mtlog_fingerprint(node::Buffer::Data(info[0]), (uint32_t)node::Buffer::Length(info[0]), flags);
+  } else if (info.Length() > 0 && info[0]->IsString()) {
+    Nan::Utf8String text(info[0]);
+    result = mtlog_fingerprint(*text, (uint32_t)text.length(), flags);
+  } else {
+    Nan::ThrowTypeError("template must be a string or a Buffer");
+    return;
+  }
+  info.GetReturnValue().Set(BigInt::NewFromUnsigned(info.GetIsolate(), result));
+}
+
+// How string arguments reach the extractor. Buffers and other
+// ArrayBufferViews are always UTF-8 and read in place.
+enum class Encoding {
+  UTF8,   // transcoded to UTF-8; offsets in bytes
+  UTF16,  // narrowed code units (mtlog_narrow_utf16); offsets in code units
+};
+
+// Code units narrowed per String::Write, so a two-byte string passes through
+// a stack buffer rather than a full-length copy of its own.
+constexpr uint32_t kNarrowChunk = 4096;
+
+// Template text or a name from a string or a Buffer, as bytes the extractor
+// can scan: UTF-8, or narrowed UTF-16 for strings with Encoding::UTF16.
+class TextArgument {
+ public:
+  explicit TextArgument(Local<Value> value, Encoding encoding = Encoding::UTF8)
+      : utf8_(node::Buffer::HasInstance(value) || encoding == Encoding::UTF16 ? Local<Value>() : value) {
+    if (node::Buffer::HasInstance(value)) {
+      data_ = node::Buffer::Data(value);
+      length_ = (uint32_t)node::Buffer::Length(value);
+      valid_ = true;
+    } else if (value->IsString() && encoding == Encoding::UTF16) {
+      Local<String> string = value.As<String>();
+      length_ = (uint32_t)string->Length();
+      data_ = Narrow(string);
+      valid_ = true;
+    } else if (value->IsString()) {
+      data_ = *utf8_;
+      length_ = (uint32_t)utf8_.length();
+      valid_ = true;
+    }
+  }
+
+  bool valid() const { return valid_; }
+  const char *data() const { return data_; }
+  uint32_t length() const { return length_; }
+
+ private:
+  // V8 has no stable view of a heap string's contents, so the narrowed bytes
+  // are the one copy made. External Latin-1 strings are read in place, and
+  // Latin-1 contents need no narrowing: every byte past ASCII is plain.
+  const char *Narrow(Local<String> string) {
+    if (string->IsExternalOneByte()) return string->GetExternalOneByteStringResource()->data();
+    narrow_.resize(length_);
+    if (string->IsExternalTwoByte()) {
+      mtlog_narrow_utf16(string->GetExternalStringResource()->data(), length_, &narrow_[0]);
+    } else if (string->IsOneByte()) {
+      string->WriteOneByte(Isolate::GetCurrent(), (uint8_t *)&narrow_[0], 0, (int)length_,
+                           String::NO_NULL_TERMINATION);
+    } else {
+      uint16_t units[kNarrowChunk];
+      for (uint32_t start = 0; start < length_; start += kNarrowChunk) {
+        uint32_t count = std::min(kNarrowChunk, length_ - start);
+        string->Write(Isolate::GetCurrent(), units, (int)start, (int)count, String::NO_NULL_TERMINATION);
+        mtlog_narrow_utf16(units, count, &narrow_[start]);
+      }
+    }
+    return narrow_.data();
+  }
+
+  Nan::Utf8String utf8_;
+  std::string narrow_;
+  const char *data_ = nullptr;
+  uint32_t length_ = 0;
+  bool valid_ = false;
+};
+
+// Reads `options.encoding`: undefined, 'utf8' or 'utf16'.
+bool EncodingArgument(Local<Value> options, Encoding *encoding) {
+  *encoding = Encoding::UTF8;
+  if (options.IsEmpty() || options->IsUndefined()) return true;
+  if (options->IsObject()) {
+    Local<Value> value = Nan::Get(options.As<Object>(), Nan::New("encoding").ToLocalChecked()).ToLocalChecked();
+    if (value->IsUndefined()) return true;
+    if (value->IsString()) {
+      Nan::Utf8String name(value);
+      if (!strcmp(*name, "utf8")) return true;
+      if (!strcmp(*name, "utf16")) {
+        *encoding = Encoding::UTF16;
+        return true;
+      }
+    }
+  }
+  Nan::ThrowTypeError("encoding must be 'utf8' or 'utf16'");
+  return false;
+}
+
+// The TypeError for a batch element that is neither a string nor a Buffer.
+void ThrowTemplateError(uint32_t index) {
+  std::string message = "templates[" + std::to_string(index) + "] must be a string or a Buffer";
+  Nan::ThrowTypeError(message.c_str());
+}
+
+Local<Uint32Array> ToUint32Array(const uint32_t *values, uint32_t count) {
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(Isolate::GetCurrent(), count * sizeof(uint32_t));
+  Local<Uint32Array> array = Uint32Array::New(buffer, 0, count);
+  Nan::TypedArrayContents<uint32_t> contents(array);
+  if (count) memcpy(*contents, values, count * sizeof(uint32_t));
+  return array;
+}
+
+Local<Uint8Array> ToUint8Array(const uint8_t *values, uint32_t count) {
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(Isolate::GetCurrent(), count);
+  Local<Uint8Array> array = Uint8Array::New(buffer, 0, count);
+  Nan::TypedArrayContents<uint8_t> contents(array);
+  if (count) memcpy(*contents, values, count);
+  return array;
+}
+
+// The segments of a batch of templates, one column per field. Template i
+// owns segments offsets[i] to offsets[i + 1].
+struct SegmentColumns {
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> spans;  // start, end pairs
+  std::vector<uint32_t> names;
+  std::vector<uint32_t> formats;
+  std::vector<uint8_t> kinds;
+  std::vector<uint8_t> name_kinds;
+  std::vector<uint8_t> hints;
+  uint32_t base = 0;  // added to every offset, for templates within a catalog
+};
+
+bool AppendSegment(const MtlogSegment *segment, void *context) {
+  SegmentColumns *columns = static_cast<SegmentColumns *>(context);
+  uint32_t base = columns->base;
+  columns->spans.insert(columns->spans.end(), {base + segment->span.start, base + segment->span.end});
+  columns->names.insert(columns->names.end(), {base + segment->name.start, base + segment->name.end});
+  columns->formats.insert(columns->formats.end(), {base + segment->format.start, base + segment->format.end});
+  columns->kinds.push_back((uint8_t)segment->kind);
+  columns->name_kinds.push_back((uint8_t)segment->name_kind);
+  columns->hints.push_back((uint8_t)segment->hint);
+  return true;
+}
+
+void ScanTemplate(SegmentColumns *columns, const char *text, uint32_t length, uint32_t base) {
+  columns->offsets.push_back((uint32_t)columns->kinds.size());
+  columns->base = base;
+  mtlog_scan_segments(text, length, AppendSegment, columns);
+}
+
+void SetField(Local<Object> object, const char *name, Local<Value> value) {
+  Nan::Set(object, Nan::New(name).ToLocalChecked(), value);
+}
+
+Local<Object> SegmentsObject(SegmentColumns *columns) {
+  uint32_t segments = (uint32_t)columns->kinds.size();
+  columns->offsets.push_back(segments);
+  Local<Object> result = Nan::New<Object>();
+  SetField(result, "offsets", ToUint32Array(columns->offsets.data(), (uint32_t)columns->offsets.size()));
+  SetField(result, "spans", ToUint32Array(columns->spans.data(), 2 * segments));
+  SetField(result, "names", ToUint32Array(columns->names.data(), 2 * segments));
+  SetField(result, "formats", ToUint32Array(columns->formats.data(), 2 * segments));
+  SetField(result, "kinds", ToUint8Array(columns->kinds.data(), segments));
+  SetField(result, "nameKinds", ToUint8Array(columns->name_kinds.data(), segments));
+  SetField(result, "hints", ToUint8Array(columns->hints.data(), segments));
+  return result;
+}
+
+// parseMany(templates: Array<string | Buffer>, options?: {encoding}):
+// {offsets, spans, names, formats, kinds, nameKinds, hints}
+//
+// Extracts every template in one call and returns the segments of the whole
+// batch as typed arrays. Template i owns segments offsets[i] to
+// offsets[i + 1]; spans, names and formats hold a start, end pair of offsets
+// per segment, empty when absent. Offsets are UTF-8 bytes, or for strings
+// with {encoding: 'utf16'} code units. An element that is neither a string
+// nor a Buffer fails the whole call with a TypeError naming its index.
+NAN_METHOD(ParseMany) {
+  if (info.Length() < 1 || !info[0]->IsArray()) {
+    Nan::ThrowTypeError("templates must be an array");
+    return;
+  }
+  Encoding encoding;
+  if (!EncodingArgument(info[1], &encoding)) return;
+  Local<Array> templates = info[0].As<Array>();
+  uint32_t count = templates->Length();
+  SegmentColumns columns;
+  columns.offsets.reserve(count + 1);
+  for (uint32_t i = 0; i < count; i++) {
+    TextArgument text(Nan::Get(templates, i).ToLocalChecked(), encoding);
+    if (!text.valid()) {
+      ThrowTemplateError(i);
+      return;
+    }
+    ScanTemplate(&columns, text.data(), text.length(), 0);
+  }
+  info.GetReturnValue().Set(SegmentsObject(&columns));
+}
+
+// The handle of a background extraction: cancel() makes the worker stop
+// before its next template and fail with "cancelled".
+class AsyncTask : public Nan::ObjectWrap {
+ public:
+  static void Init() {
+    Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
+    tpl->SetClassName(Nan::New("AsyncTask").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "cancel", Cancel);
+    Constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+  static Local<Object> NewInstance() { return Nan::NewInstance(Nan::New(Constructor())).ToLocalChecked(); }
+
+  bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+ private:
+  static Nan::Persistent<Function> &Constructor() {
+    static Nan::Persistent<Function> constructor;
+    return constructor;
+  }
+
+  static NAN_METHOD(New) {
+    (new AsyncTask())->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  static NAN_METHOD(Cancel) {
+    Nan::ObjectWrap::Unwrap<AsyncTask>(info.Holder())->cancelled_.store(true, std::memory_order_relaxed);
+  }
+
+  std::atomic<bool> cancelled_{false};
+};
+
+// Extracts a batch of templates, or the templates of a catalog, on the libuv
+// threadpool. Execute cannot touch V8, so strings are copied out on the main
+// thread, as UTF-8 or narrowed code units. A catalog Buffer is read in place:
+// its backing store is held until the worker is done, so transferring or
+// detaching the ArrayBuffer meanwhile cannot free the bytes being read.
+class ExtractWorker : public Nan::AsyncWorker {
+ public:
+  ExtractWorker(Nan::Callback *callback, Local<Object> task, Encoding encoding)
+      : Nan::AsyncWorker(callback, "tree-sitter-mtlog:extract"),
+        task_(Nan::ObjectWrap::Unwrap<AsyncTask>(task)),
+        encoding_(encoding) {
+    SaveToPersistent("task", task);
+  }
+
+  // Add one template of a batch; false unless `value` is a string or Buffer.
+  bool AddTemplate(Local<Value> value) {
+    TextArgument text(value, encoding_);
+    if (!text.valid()) return false;
+    starts_.push_back((uint32_t)copy_.size());
+    copy_.append(text.data(), text.length());
+    return true;
+  }
+
+  // Extract `value` as a catalog instead, one template per line.
+  bool SetCatalog(Local<Value> value) {
+    catalog_ = true;
+    if (node::Buffer::HasInstance(value)) {
+      Local<ArrayBufferView> view = value.As<ArrayBufferView>();
+      store_ = view->Buffer()->GetBackingStore();
+      text_ = store_->Data() ? static_cast<const char *>(store_->Data()) + view->ByteOffset() : "";
+      length_ = (uint32_t)view->ByteLength();
+      return true;
+    }
+    TextArgument text(value, encoding_);
+    if (!text.valid()) return false;
+    copy_.assign(text.data(), text.length());
+    return true;
+  }
+
+  void Execute() override {
+    if (!catalog_) {
+      starts_.push_back((uint32_t)copy_.size());
+      columns_.offsets.reserve(starts_.size());
+      for (size_t i = 0; i + 1 < starts_.size(); i++) {
+        if (Cancelled()) return;
+        ScanTemplate(&columns_, copy_.data() + starts_[i], starts_[i + 1] - starts_[i], 0);
+      }
+      return;
+    }
+
+    if (!text_) {
+      text_ = copy_.data();
+      length_ = (uint32_t)copy_.size();
+    }
+    // A template ends at a line end that is not inside a Go-template
+    // property; the line end itself belongs to neither side.
+    for (uint32_t from = 0; from < length_;) {
+      if (Cancelled()) return;
+      uint32_t next = mtlog_line_boundary_after(text_, length_, from, from), end = next;
+      if (end > from && text_[end - 1] == '\n') end--;
+      if (end > from && text_[end - 1] == '\r') end--;
+      templates_.insert(templates_.end(), {from, end});
+      ScanTemplate(&columns_, text_ + from, end - from, from);
+      from = next;
+    }
+  }
+
+  void HandleOKCallback() override {
+    Nan::HandleScope scope;
+    Local<Object> result = SegmentsObject(&columns_);
+    if (catalog_) SetField(result, "templates", ToUint32Array(templates_.data(), (uint32_t)templates_.size()));
+    Local<Value> argv[] = {Nan::Null(), result};
+    callback->Call(2, argv, async_resource);
+  }
+
+ private:
+  bool Cancelled() {
+    if (!task_->cancelled()) return false;
+    SetErrorMessage("cancelled");
+    return true;
+  }
+
+  AsyncTask *task_;
+  Encoding encoding_;
+  bool catalog_ = false;
+  std::string copy_;
+  std::vector<uint32_t> starts_;
+  std::shared_ptr<BackingStore> store_;  // a catalog Buffer's bytes
+  const char *text_ = nullptr;
+  uint32_t length_ = 0;
+  std::vector<uint32_t> templates_;  // start, end pairs, catalogs only
+  SegmentColumns columns_;
+};
+
+bool CallbackArgument(const Nan::FunctionCallbackInfo<Value> &info) {
+  if (info.Length() < 3 || !info[2]->IsFunction()) {
+    Nan::ThrowTypeError("callback must be a function");
+    return false;
+  }
+  return true;
+}
+
+// startParseMany(templates, options, callback(error, result)): AsyncTask
+//
+// parseMany on the threadpool. Wrapped as parseManyAsync in index.js.
+NAN_METHOD(StartParseMany) {
+  if (info.Length() < 1 || !info[0]->IsArray()) {
+    Nan::ThrowTypeError("templates must be an array");
+    return;
+  }
+  Encoding encoding;
+  if (!EncodingArgument(info[1], &encoding) || !CallbackArgument(info)) return;
+  Local<Array> templates = info[0].As<Array>();
+  Local<Object> task = AsyncTask::NewInstance();
+  ExtractWorker *worker = new ExtractWorker(new Nan::Callback(info[2].As<Function>()), task, encoding);
+  for (uint32_t i = 0, count = templates->Length(); i < count; i++) {
+    if (!worker->AddTemplate(Nan::Get(templates, i).ToLocalChecked())) {
+      delete worker;
+      ThrowTemplateError(i);
+      return;
+    }
+  }
+  Nan::AsyncQueueWorker(worker);
+  info.GetReturnValue().Set(task);
+}
+
+// startExtract(catalog: string | Buffer, options, callback(error, result)): AsyncTask
+//
+// Splits a catalog into templates at line ends (see mtlog_line_boundary) and
+// extracts them on the threadpool. The result is that of parseMany with
+// offsets into the catalog, plus `templates`, the start, end pair of each
+// template. Wrapped as extractAsync in index.js.
+NAN_METHOD(StartExtract) {
+  Encoding encoding;
+  if (!EncodingArgument(info[1], &encoding) || !CallbackArgument(info)) return;
+  Local<Object> task = AsyncTask::NewInstance();
+  ExtractWorker *worker = new ExtractWorker(new Nan::Callback(info[2].As<Function>()), task, encoding);
+  if (!worker->SetCatalog(info[0])) {
+    delete worker;
+    Nan::ThrowTypeError("catalog must be a string or a Buffer");
+    return;
+  }
+  Nan::AsyncQueueWorker(worker);
+  info.GetReturnValue().Set(task);
+}
+
+// new SymbolTable(): property-name interning (src/symbols.h).
+class SymbolTable : public Nan::ObjectWrap {
+ public:
+  static Local<Function> Constructor() {
+    Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
+    tpl->SetClassName(Nan::New("SymbolTable").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "intern", Intern);
+    Nan::SetPrototypeMethod(tpl, "find", Find);
+    Nan::SetPrototypeMethod(tpl, "name", Name);
+    Nan::SetPrototypeMethod(tpl, "segments", Segments);
+    Nan::SetPrototypeMethod(tpl, "properties", Properties);
+    Nan::SetAccessor(tpl->InstanceTemplate(), Nan::New("size").ToLocalChecked(), Size);
+    Nan::SetAccessor(tpl->InstanceTemplate(), Nan::New("memory").ToLocalChecked(), Memory);
+    return Nan::GetFunction(tpl).ToLocalChecked();
+  }
+
+ private:
+  SymbolTable() : symbols_(mtlog_symbols_new()) {}
+  ~SymbolTable() { mtlog_symbols_delete(symbols_); }
+
+  static MtlogSymbols *Unwrap(const Nan::FunctionCallbackInfo<Value> &info) {
+    return Nan::ObjectWrap::Unwrap<SymbolTable>(info.Holder())->symbols_;
+  }
+
+  static bool Id(const Nan::FunctionCallbackInfo<Value> &info, uint32_t *id) {
+    if (info.Length() < 1 || !info[0]->IsUint32()) {
+      Nan::ThrowTypeError("id must be a non-negative integer");
+      return false;
+    }
+    *id = Nan::To<uint32_t>(info[0]).FromJust();
+    return true;
+  }
+
+  static NAN_METHOD(New) {
+    if (!info.IsConstructCall()) {
+      Nan::ThrowTypeError("SymbolTable must be called with new");
+      return;
+    }
+    SymbolTable *table = new SymbolTable();
+    if (!table->symbols_) {
+      delete table;
+      Nan::ThrowError("out of memory");
+      return;
+    }
+    table->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  // intern(name: string | Buffer): number
+  static NAN_METHOD(Intern) {
+    TextArgument name(info[0]);
+    if (!name.valid()) {
+      Nan::ThrowTypeError("name must be a string or a Buffer");
+      return;
+    }
+    uint32_t id = mtlog_symbols_intern(Unwrap(info), name.data(), name.length());
+    if (id == MTLOG_SYMBOL_NONE) {
+      Nan::ThrowError("out of memory");
+      return;
+    }
+    info.GetReturnValue().Set(id);
+  }
+
+  // find(name: string | Buffer): number, -1 if not interned
+  static NAN_METHOD(Find) {
+    TextArgument name(info[0]);
+    if (!name.valid()) {
+      Nan::ThrowTypeError("name must be a string or a Buffer");
+      return;
+    }
+    uint32_t id = mtlog_symbols_find(Unwrap(info), name.data(), name.length());
+    info.GetReturnValue().Set(id == MTLOG_SYMBOL_NONE ? -1.0 : (double)id);
+  }
+
+  // name(id: number): string | undefined
+  static NAN_METHOD(Name) {
+    uint32_t id, length;
+    if (!Id(info, &id)) return;
+    const char *name = mtlog_symbols_name(Unwrap(info), id, &length);
+    if (name) info.GetReturnValue().Set(Nan::New(name, (int)length).ToLocalChecked());
+  }
+
+  // segments(id: number): Uint32Array | undefined
+  static NAN_METHOD(Segments) {
+    uint32_t id, count;
+    if (!Id(info, &id)) return;
+    const uint32_t *segments = mtlog_symbols_segments(Unwrap(info), id, &count);
+    if (segments) info.GetReturnValue().Set(ToUint32Array(segments, count));
+  }
+
+  // properties(template: string | Buffer): Uint32Array of property-name symbols
+  static NAN_METHOD(Properties) {
+    TextArgument text(info[0]);
+    if (!text.valid()) {
+      Nan::ThrowTypeError("template must be a string or a Buffer");
+      return;
+    }
+    MtlogSymbols *symbols = Unwrap(info);
+    uint32_t stack[32];
+    uint32_t count = mtlog_symbols_intern_properties(symbols, text.data(), text.length(), stack, 32);
+    if (count == MTLOG_SYMBOL_NONE) {
+      Nan::ThrowError("out of memory");
+      return;
+    }
+    if (count <= 32) {
+      info.GetReturnValue().Set(ToUint32Array(stack, count));
+      return;
+    }
+    std::vector<uint32_t> ids(count);
+    mtlog_symbols_intern_properties(symbols, text.data(), text.length(), ids.data(), count);
+    info.GetReturnValue().Set(ToUint32Array(ids.data(), count));
+  }
+
+  static NAN_GETTER(Size) {
+    info.GetReturnValue().Set(mtlog_symbols_count(Nan::ObjectWrap::Unwrap<SymbolTable>(info.Holder())->symbols_));
+  }
+
+  static NAN_GETTER(Memory) {
+    MtlogSymbols *symbols = Nan::ObjectWrap::Unwrap<SymbolTable>(info.Holder())->symbols_;
+    info.GetReturnValue().Set((double)mtlog_symbols_memory(symbols));
+  }
+
+  MtlogSymbols *symbols_;
+};
+
 void Init(Local<Object> exports, Local<Object> module) {
   Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
   tpl->SetClassName(Nan::New("Language").ToLocalChecked());
@@ -19,9 +551,34 @@ void Init(Local<Object> exports, Local<Object> module) {
   Local<Object> instance = constructor->NewInstance(Nan::GetCurrentContext()).ToLocalChecked();
   Nan::SetInternalFieldPointer(instance, 0, tree_sitter_mtlog());
   Nan::Set(instance, Nan::New("name").ToLocalChecked(), Nan::New("mtlog").ToLocalChecked());
+
+  Nan::SetMethod(instance, "fingerprint", Fingerprint);
+  Local<Object> flags = Nan::New<Object>();
+  Nan::Set(flags, Nan::New("LITERALS").ToLocalChecked(), Nan::New<Uint32>(MTLOG_FINGERPRINT_LITERALS));
+  Nan::Set(flags, Nan::New("NAMES").ToLocalChecked(), Nan::New<Uint32>(MTLOG_FINGERPRINT_NAMES));
+  Nan::Set(flags, Nan::New("HINTS").ToLocalChecked(), Nan::New<Uint32>(MTLOG_FINGERPRINT_HINTS));
+  Nan::Set(flags, Nan::New("FORMATS").ToLocalChecked(), Nan::New<Uint32>(MTLOG_FINGERPRINT_FORMATS));
+  Nan::Set(flags, Nan::New("DEFAULT").ToLocalChecked(), Nan::New<Uint32>(MTLOG_FINGERPRINT_DEFAULT));
+  Nan::Set(flags, Nan::New("ALL").ToLocalChecked(), Nan::New<Uint32>(MTLOG_FINGERPRINT_ALL));
+  Nan::Set(instance, Nan::New("FINGERPRINT").ToLocalChecked(), flags);
+
+  Nan::Set(instance, Nan::New("SymbolTable").ToLocalChecked(), SymbolTable::Constructor());
+
+  Nan::SetMethod(instance, "parseMany", ParseMany);
+  Local<Object> kinds = Nan::New<Object>();
+  Nan::Set(kinds, Nan::New("LITERAL").ToLocalChecked(), Nan::New<Uint32>(MTLOG_SEGMENT_LITERAL));
+  Nan::Set(kinds, Nan::New("PROPERTY").ToLocalChecked(), Nan::New<Uint32>(MTLOG_SEGMENT_PROPERTY));
+  Nan::Set(kinds, Nan::New("GO_PROPERTY").ToLocalChecked(), Nan::New<Uint32>(MTLOG_SEGMENT_GO_PROPERTY));
+  Nan::Set(kinds, Nan::New("BUILTIN_PROPERTY").ToLocalChecked(), Nan::New<Uint32>(MTLOG_SEGMENT_BUILTIN_PROPERTY));
+  Nan::Set(instance, Nan::New("SEGMENT").ToLocalChecked(), kinds);
+
+  AsyncTask::Init();
+  Nan::SetMethod(instance, "startParseMany", StartParseMany);
+  Nan::SetMethod(instance, "startExtract", StartExtract);
+
   Nan::Set(module, Nan::New("exports").ToLocalChecked(), instance);
 }
 
 NODE_MODULE(tree_sitter_mtlog_binding, Init)
 
-}  // namespace
\ No newline at end of file
+}  // namespace
@@ -1,8 +1,39 @@
+let binding;
 try {
-  module.exports = require('../../build/Release/tree_sitter_mtlog_binding');
+  binding = require('../../build/Release/tree_sitter_mtlog_binding');
 } catch (error) {
   if (error.code !== 'MODULE_NOT_FOUND') {
     throw error;
   }
-  module.exports = require('../../build/Debug/tree_sitter_mtlog_binding');
-}
\ No newline at end of file
+  binding = require('../../build/Debug/tree_sitter_mtlog_binding');
+}
+
+// Runs a native start* method on the libuv threadpool as a Promise. Aborting
+// `options.signal` cancels the task before its next template and rejects
+// with the signal's reason; `options.encoding` is passed through.
+function runAsync(start, input, options = {}) {
+  const { signal } = options;
+  return new Promise((resolve, reject) => {
+    if (signal && signal.aborted) {
+      reject(signal.reason);
+      return;
+    }
+    const onAbort = () => task.cancel();
+    const task = start(input, options, (error, result) => {
+      if (signal) signal.removeEventListener('abort', onAbort);
+      if (signal && signal.aborted) reject(signal.reason);
+      else if (error) reject(error);
+      else resolve(result);
+    });
+    if (signal) signal.addEventListener('abort', onAbort, { once: true });
+  });
+}
+
+// parseManyAsync(templates, { encoding, signal }?): Promise of the parseMany result
+binding.parseManyAsync = (templates, options) => runAsync(binding.startParseMany, templates, options);
+
+// extractAsync(catalog, { encoding, signal }?): Promise of the segments of every
+// template in a catalog, with `templates` giving each one's byte range
+binding.extractAsync = (catalog, options) => runAsync(binding.startExtract, catalog, options);
+
+module.exports = binding;
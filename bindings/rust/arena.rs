@@ -0,0 +1,135 @@
+//! Bump arena for parse-extract-discard cycles, backed by `src/arena.c`.
+//!
+//! Call [`install`] once, before any [`tree_sitter::Parser`] is created, to
+//! route the tree-sitter runtime's allocations through the arena hooks. Then
+//! run each cycle inside [`Arena::cycle`]: everything the runtime allocates in
+//! the closure comes from the arena and is released by a single reset.
+//!
+//! ```ignore
+//! unsafe { tree_sitter_mtlog::arena::install() };
+//! let mut arena = tree_sitter_mtlog::arena::Arena::new(0);
+//! let names = unsafe {
+//!     arena.cycle(|| {
+//!         let mut parser = tree_sitter::Parser::new();
+//!         parser.set_language(tree_sitter_mtlog::language()).unwrap();
+//!         let tree = parser.parse(template, None).unwrap();
+//!         let names = extract(&tree, template); // owned, heap-allocated by Rust
+//!         drop(tree);
+//!         drop(parser);
+//!         names
+//!     })
+//! };
+//! ```
+
+use std::os::raw::c_void;
+use std::ptr::NonNull;
+
+#[repr(C)]
+struct MtlogArena {
+    _private: [u8; 0],
+}
+
+/// Allocation statistics; see `MtlogArenaStats` in `src/arena.h`.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct Stats {
+    /// Blocks served since the last reset.
+    pub allocations: usize,
+    /// Bytes served since the last reset, including block headers.
+    pub bytes_used: usize,
+    /// Capacity of all chunks currently held.
+    pub bytes_reserved: usize,
+    /// Chunks obtained from `malloc` over the arena's lifetime.
+    pub chunk_allocations: usize,
+}
+
+extern "C" {
+    fn mtlog_arena_new(chunk_size: usize) -> *mut MtlogArena;
+    fn mtlog_arena_delete(arena: *mut MtlogArena);
+    fn mtlog_arena_reset(arena: *mut MtlogArena);
+    fn mtlog_arena_stats(arena: *const MtlogArena, stats: *mut Stats);
+    fn mtlog_arena_activate(arena: *mut MtlogArena) -> *mut MtlogArena;
+    fn mtlog_arena_malloc(size: usize) -> *mut c_void;
+    fn mtlog_arena_calloc(count: usize, size: usize) -> *mut c_void;
+    fn mtlog_arena_realloc(ptr: *mut c_void, size: usize) -> *mut c_void;
+    fn mtlog_arena_free(ptr: *mut c_void);
+}
+
+/// Install the arena allocator hooks into the tree-sitter runtime.
+///
+/// Outside an [`Arena::cycle`] the hooks behave like `malloc`/`free`, but
+/// every block they return sits behind a header, so it must be freed by
+/// `mtlog_arena_free` and never by libc `free`. They are installed with
+/// [`tree_sitter::set_allocator`], which also makes the `tree_sitter` crate
+/// free the buffers the runtime hands it (such as the string behind
+/// [`tree_sitter::Node::to_sexp`]) through them.
+///
+/// # Safety
+///
+/// Must be called before the runtime allocates anything (before the first
+/// parser is created), and no other allocator may be installed afterwards.
+/// Any other code that takes a buffer from the runtime (`ts_node_string`,
+/// `ts_tree_get_changed_ranges`, ...) through FFI must free it with
+/// `mtlog_arena_free`, not `free`.
+pub unsafe fn install() {
+    tree_sitter::set_allocator(
+        Some(mtlog_arena_malloc),
+        Some(mtlog_arena_calloc),
+        Some(mtlog_arena_realloc),
+        Some(mtlog_arena_free),
+    );
+}
+
+/// A bump arena serving tree-sitter allocations for one cycle at a time.
+pub struct Arena {
+    ptr: NonNull<MtlogArena>,
+}
+
+impl Arena {
+    /// Create an arena whose chunks hold at least `chunk_size` bytes
+    /// (0 picks the default of 64 KiB).
+    pub fn new(chunk_size: usize) -> Self {
+        let ptr = unsafe { mtlog_arena_new(chunk_size) };
+        Arena {
+            ptr: NonNull::new(ptr).expect("failed to allocate mtlog arena"),
+        }
+    }
+
+    /// Run `f` with this arena active on the current thread, then release
+    /// everything allocated by the runtime during `f` with one reset.
+    ///
+    /// # Safety
+    ///
+    /// [`install`] must have been called. Every tree-sitter object used in
+    /// `f` (parsers, trees, cursors, queries) must be created in `f` and must
+    /// not escape it: nothing allocated during the cycle may be used or
+    /// dropped after it returns.
+    pub unsafe fn cycle<R>(&mut self, f: impl FnOnce() -> R) -> R {
+        struct Deactivate(*mut MtlogArena, *mut MtlogArena);
+        impl Drop for Deactivate {
+            fn drop(&mut self) {
+                unsafe {
+                    mtlog_arena_activate(self.1);
+                    mtlog_arena_reset(self.0);
+                }
+            }
+        }
+
+        let previous = mtlog_arena_activate(self.ptr.as_ptr());
+        let _guard = Deactivate(self.ptr.as_ptr(), previous);
+        f()
+    }
+
+    /// Current allocation statistics.
+    pub fn stats(&self) -> Stats {
+        let mut stats = Stats::default();
+        unsafe { mtlog_arena_stats(self.ptr.as_ptr(), &mut stats) };
+        stats
+    }
+}
+
+impl Drop for Arena {
+    fn drop(&mut self) {
+        unsafe { mtlog_arena_delete(self.ptr.as_ptr()) }
+    }
+}
@@ -0,0 +1,81 @@
+//! Extraction throughput: a batch of templates through one parser and
+//! `PropertyIter` in a loop, through `par_extract` on a one-thread rayon pool,
+//! and through `par_extract` on a pool with one thread per core.
+//!
+//!   cargo bench --features rayon
+//!
+//! Throughput is in bytes of template text, so the rows compare directly.
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use rayon::ThreadPoolBuilder;
+use tree_sitter::Parser;
+use tree_sitter_mtlog::properties::{par_extract, PropertyIter};
+
+const LITERALS: &[&str] = &[
+    "User ", " logged in from ", " at ", "Processing ", " items for ", "Order ",
+    " created with total ", " failed: ", "Request to ", " returned ", " in ", " ms",
+];
+
+const PROPERTIES: &[&str] = &[
+    "{UserId}", "{@Order}", "{$Error}", "{Amount:F2}", "{Timestamp:yyyy-MM-dd HH:mm:ss}",
+    "{http.method}", "{service.name}", "{0}", "{{.UserId}}", "${Level:u3}", "{Elapsed:0.000}",
+];
+
+const BATCH: usize = 10_000;
+
+// xorshift32, so runs on different revisions see the same batch.
+fn batch(mut state: u32) -> Vec<String> {
+    let mut next = move || {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        state as usize
+    };
+    (0..BATCH)
+        .map(|i| {
+            let mut text = format!("[{}] ", i);
+            for _ in 0..1 + next() % 5 {
+                text.push_str(LITERALS[next() % LITERALS.len()]);
+                text.push_str(PROPERTIES[next() % PROPERTIES.len()]);
+            }
+            text
+        })
+        .collect()
+}
+
+fn extract(c: &mut Criterion) {
+    let templates = batch(2024);
+    let bytes: usize = templates.iter().map(String::len).sum();
+    let cores = std::thread::available_parallelism().map_or(1, |n| n.get());
+
+    let mut group = c.benchmark_group("extract");
+    group.throughput(Throughput::Bytes(bytes as u64));
+
+    group.bench_function("sequential", |b| {
+        let mut parser = Parser::new();
+        parser.set_language(tree_sitter_mtlog::language()).unwrap();
+        b.iter(|| {
+            let mut count = 0;
+            for template in &templates {
+                let tree = parser.parse(template, None).unwrap();
+                count += PropertyIter::new(&tree, template.as_bytes()).count();
+            }
+            black_box(count)
+        })
+    });
+
+    let mut pools = vec![1];
+    if cores > 1 {
+        pools.push(cores);
+    }
+    for threads in pools {
+        let pool = ThreadPoolBuilder::new().num_threads(threads).build().unwrap();
+        group.bench_with_input(BenchmarkId::new("par_extract", threads), &templates, |b, templates| {
+            b.iter(|| pool.install(|| black_box(par_extract(templates))))
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, extract);
+criterion_main!(benches);
@@ -10,17 +10,64 @@ fn main() {
     let parser_path = src_dir.join("parser.c");
     c_config.file(&parser_path);
 
-    // If your language uses an external scanner written in C,
-    // then include this block of code:
+    let properties_path = src_dir.join("properties.c");
+    c_config.file(&properties_path);
+
+    let structural_path = src_dir.join("structural.c");
+    c_config.file(&structural_path);
+
+    let template_cache_path = src_dir.join("template_cache.c");
+    c_config.file(&template_cache_path);
+
+    let template_ir_path = src_dir.join("template_ir.c");
+    c_config.file(&template_ir_path);
+
+    let fingerprint_path = src_dir.join("fingerprint.c");
+    c_config.file(&fingerprint_path);
+
+    let format_spec_path = src_dir.join("format_spec.c");
+    c_config.file(&format_spec_path);
+
+    let render_path = src_dir.join("render.c");
+    c_config.file(&render_path);
+
+    let matcher_path = src_dir.join("matcher.c");
+    c_config.file(&matcher_path);
+
+    let registry_path = src_dir.join("registry.c");
+    c_config.file(&registry_path);
+
+    let symbols_path = src_dir.join("symbols.c");
+    c_config.file(&symbols_path);
+
+    let parallel_path = src_dir.join("parallel.c");
+    c_config.file(&parallel_path);
+
+    let arena_path = src_dir.join("arena.c");
+    c_config.file(&arena_path);
+
+    let alloc_stats_path = src_dir.join("alloc_stats.c");
+    c_config.file(&alloc_stats_path);
 
-    /*
     let scanner_path = src_dir.join("scanner.c");
     c_config.file(&scanner_path);
     println!("cargo:rerun-if-changed={}", scanner_path.to_str().unwrap());
-    */
 
     c_config.compile("parser");
     println!("cargo:rerun-if-changed={}", parser_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", properties_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", structural_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", template_cache_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", template_ir_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", fingerprint_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", format_spec_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", render_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", matcher_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", registry_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", symbols_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", parallel_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", arena_path.to_str().unwrap());
+    println!("cargo:rerun-if-changed={}", alloc_stats_path.to_str().unwrap());
 
     // If your language uses an external scanner written in C++,
     // then include this block of code:
@@ -0,0 +1,69 @@
+//! Structural template fingerprints, backed by `src/fingerprint.c`.
+//!
+//! A fingerprint hashes a template's sequence of property kinds plus whichever
+//! parts the [`Flags`] select, so templates that differ only in the ignored
+//! parts group together. It is computed in a single extraction pass without a
+//! parser.
+//!
+//! ```
+//! use tree_sitter_mtlog::fingerprint::{fingerprint, Flags};
+//!
+//! let a = fingerprint("Total {Amount:F2}", Flags::DEFAULT);
+//! let b = fingerprint("Total  {Amount:F4}", Flags::DEFAULT);
+//! assert_eq!(a, b);
+//! assert_ne!(a, fingerprint("Total {Amount:F4}", Flags::ALL));
+//! ```
+
+use std::convert::TryFrom;
+use std::ops::BitOr;
+use std::os::raw::c_char;
+
+/// The parts of a template a fingerprint is sensitive to; see
+/// `MtlogFingerprintFlags` in `src/fingerprint.h`.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub struct Flags(u32);
+
+impl Flags {
+    /// Property kinds only.
+    pub const NONE: Flags = Flags(0);
+    /// Literal text, with whitespace canonicalized.
+    pub const LITERALS: Flags = Flags(1 << 0);
+    /// Property names.
+    pub const NAMES: Flags = Flags(1 << 1);
+    /// `@` and `$` capture hints.
+    pub const HINTS: Flags = Flags(1 << 2);
+    /// Format strings.
+    pub const FORMATS: Flags = Flags(1 << 3);
+    /// Everything but format strings.
+    pub const DEFAULT: Flags = Flags(Self::LITERALS.0 | Self::NAMES.0 | Self::HINTS.0);
+    /// Every part.
+    pub const ALL: Flags = Flags(Self::DEFAULT.0 | Self::FORMATS.0);
+
+    /// The raw bit set passed to the C API.
+    pub const fn bits(self) -> u32 {
+        self.0
+    }
+}
+
+impl BitOr for Flags {
+    type Output = Flags;
+
+    fn bitor(self, other: Flags) -> Flags {
+        Flags(self.0 | other.0)
+    }
+}
+
+extern "C" {
+    fn mtlog_fingerprint(text: *const c_char, length: u32, flags: u32) -> u64;
+}
+
+/// Fingerprint of `template` under `flags`.
+///
+/// # Panics
+///
+/// Panics if `template` is 4 GiB or longer.
+pub fn fingerprint(template: impl AsRef<[u8]>, flags: Flags) -> u64 {
+    let bytes = template.as_ref();
+    let length = u32::try_from(bytes.len()).expect("template longer than u32::MAX bytes");
+    unsafe { mtlog_fingerprint(bytes.as_ptr() as *const c_char, length, flags.0) }
+}
@@ -17,6 +17,11 @@
 
 use tree_sitter::Language;
 
+pub mod arena;
+pub mod fingerprint;
+pub mod properties;
+pub mod symbols;
+
 extern "C" {
     fn tree_sitter_mtlog() -> Language;
 }
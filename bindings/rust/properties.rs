@@ -0,0 +1,273 @@
+//! Properties of parsed templates, without per-property allocation.
+//!
+//! [`PropertyIter`] walks the top level of a [`Tree`] with a [`TreeCursor`]
+//! and yields each property, Go-template property and builtin property as a
+//! [`Property`]: plain byte spans into the source, the same layout as
+//! `MtlogSegment` in `src/properties.h`. Node kind and field ids are looked up
+//! once per process, so the walk compares integers and allocates nothing
+//! beyond the cursor.
+//!
+//! ```
+//! use tree_sitter_mtlog::properties::{Kind, NameKind, PropertyIter};
+//!
+//! let source = "User {@User} logged in after {Elapsed:0.000} ms";
+//! let mut parser = tree_sitter::Parser::new();
+//! parser.set_language(tree_sitter_mtlog::language()).unwrap();
+//! let tree = parser.parse(source, None).unwrap();
+//!
+//! let properties: Vec<_> = PropertyIter::new(&tree, source.as_bytes()).collect();
+//! assert_eq!(properties.len(), 2);
+//! assert_eq!(properties[0].kind, Kind::Property);
+//! assert_eq!(properties[0].hint, Some(b'@'));
+//! assert_eq!(properties[0].name.text(source.as_bytes()), b"User");
+//! assert_eq!(properties[1].name_kind, NameKind::Identifier);
+//! assert_eq!(properties[1].format.text(source.as_bytes()), b"0.000");
+//! ```
+//!
+//! With the `rayon` feature, [`par_extract`] parses a batch of templates on
+//! the rayon pool, each worker with its own parser.
+
+use std::ops::Range;
+use std::sync::OnceLock;
+
+use tree_sitter::{Node, Tree, TreeCursor};
+
+/// The kind of a property; see `MtlogSegmentKind` in `src/properties.h`.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub enum Kind {
+    /// `{Name}`, `{@Name:format}`
+    Property,
+    /// `{{.Name}}`
+    GoProperty,
+    /// `${Name:format}`
+    BuiltinProperty,
+}
+
+/// The shape of a property name; see `MtlogNameKind` in `src/properties.h`.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub enum NameKind {
+    /// No name, as in `{:F2}`.
+    None,
+    /// `UserId`
+    Identifier,
+    /// `http.method`
+    Dotted,
+    /// `0`
+    Numeric,
+}
+
+/// Half-open byte range; empty when the part is absent.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq, Hash)]
+pub struct Span {
+    pub start: usize,
+    pub end: usize,
+}
+
+impl Span {
+    fn of(node: Node) -> Span {
+        Span {
+            start: node.start_byte(),
+            end: node.end_byte(),
+        }
+    }
+
+    /// The span as a range.
+    pub fn range(self) -> Range<usize> {
+        self.start..self.end
+    }
+
+    /// The bytes of `source` the span covers.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `source` is not the text the span was found in.
+    pub fn text(self, source: &[u8]) -> &[u8] {
+        &source[self.range()]
+    }
+}
+
+/// One property of a template.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub struct Property {
+    pub kind: Kind,
+    /// The whole property, delimiters included.
+    pub span: Span,
+    pub name: Span,
+    /// The format string after ':', without the ':'.
+    pub format: Span,
+    pub name_kind: NameKind,
+    /// `@` or `$` (properties only).
+    pub hint: Option<u8>,
+}
+
+struct Ids {
+    property: u16,
+    go_property: u16,
+    builtin_property: u16,
+    dotted_name: u16,
+    numeric_index: u16,
+    hint: u16,
+    name: u16,
+    format: u16,
+    format_string: u16,
+}
+
+fn ids() -> &'static Ids {
+    static IDS: OnceLock<Ids> = OnceLock::new();
+    IDS.get_or_init(|| {
+        let language = crate::language();
+        let kind = |name: &str| language.id_for_node_kind(name, true);
+        let field = |name: &str| {
+            language
+                .field_id_for_name(name)
+                .expect("mtlog grammar is missing a field")
+        };
+        Ids {
+            property: kind("property"),
+            go_property: kind("go_property"),
+            builtin_property: kind("builtin_property"),
+            dotted_name: kind("dotted_name"),
+            numeric_index: kind("numeric_index"),
+            hint: field("hint"),
+            name: field("name"),
+            format: field("format"),
+            format_string: field("format_string"),
+        }
+    })
+}
+
+/// Iterator over the properties of a parsed template, in source order.
+///
+/// Properties inside `ERROR` nodes are skipped, as error recovery may have
+/// split them.
+pub struct PropertyIter<'a> {
+    cursor: TreeCursor<'a>,
+    source: &'a [u8],
+    ids: &'static Ids,
+    started: bool,
+    done: bool,
+}
+
+impl<'a> PropertyIter<'a> {
+    /// Iterate over the properties of `tree`, which was parsed from `source`.
+    pub fn new(tree: &'a Tree, source: &'a [u8]) -> Self {
+        Self::with_cursor(tree.walk(), tree, source)
+    }
+
+    /// Like [`new`](Self::new), but reusing `cursor` and the stack it has
+    /// already allocated.
+    pub fn with_cursor(mut cursor: TreeCursor<'a>, tree: &'a Tree, source: &'a [u8]) -> Self {
+        cursor.reset(tree.root_node());
+        PropertyIter {
+            cursor,
+            source,
+            ids: ids(),
+            started: false,
+            done: false,
+        }
+    }
+
+    /// The cursor, for reuse with another iterator over the same tree.
+    pub fn into_cursor(self) -> TreeCursor<'a> {
+        self.cursor
+    }
+
+    fn property(&self, node: Node, kind: Kind) -> Property {
+        let ids = self.ids;
+        let mut property = Property {
+            kind,
+            span: Span::of(node),
+            name: Span::default(),
+            format: Span::default(),
+            name_kind: NameKind::None,
+            hint: None,
+        };
+        if let Some(name) = node.child_by_field_id(ids.name) {
+            property.name = Span::of(name);
+            property.name_kind = match name.kind_id() {
+                id if id == ids.dotted_name => NameKind::Dotted,
+                id if id == ids.numeric_index => NameKind::Numeric,
+                _ => NameKind::Identifier,
+            };
+        }
+        if let Some(format) = node.child_by_field_id(ids.format) {
+            if let Some(string) = format.child_by_field_id(ids.format_string) {
+                property.format = Span::of(string);
+            }
+        }
+        if let Some(hint) = node.child_by_field_id(ids.hint) {
+            property.hint = self.source.get(hint.start_byte()).copied();
+        }
+        property
+    }
+}
+
+impl<'a> Iterator for PropertyIter<'a> {
+    type Item = Property;
+
+    fn next(&mut self) -> Option<Property> {
+        while !self.done {
+            let moved = if self.started {
+                self.cursor.goto_next_sibling()
+            } else {
+                self.started = true;
+                self.cursor.goto_first_child()
+            };
+            if !moved {
+                self.done = true;
+                break;
+            }
+            let node = self.cursor.node();
+            let kind = match node.kind_id() {
+                id if id == self.ids.property => Kind::Property,
+                id if id == self.ids.go_property => Kind::GoProperty,
+                id if id == self.ids.builtin_property => Kind::BuiltinProperty,
+                _ => continue,
+            };
+            return Some(self.property(node, kind));
+        }
+        None
+    }
+}
+
+#[cfg(feature = "rayon")]
+pub use self::parallel::par_extract;
+
+#[cfg(feature = "rayon")]
+mod parallel {
+    use std::cell::RefCell;
+
+    use rayon::prelude::*;
+    use tree_sitter::Parser;
+
+    use super::{Property, PropertyIter};
+
+    thread_local! {
+        // One parser per rayon worker, created on its first template.
+        static PARSER: RefCell<Parser> = RefCell::new({
+            let mut parser = Parser::new();
+            parser
+                .set_language(crate::language())
+                .expect("Error loading mtlog language");
+            parser
+        });
+    }
+
+    /// The properties of each of `templates`, parsed in parallel on the
+    /// current rayon pool.
+    ///
+    /// Call it inside [`rayon::ThreadPool::install`] to choose the pool, e.g.
+    /// a one-thread pool to keep extraction off other cores.
+    pub fn par_extract<S: AsRef<[u8]> + Sync>(templates: &[S]) -> Vec<Vec<Property>> {
+        templates
+            .par_iter()
+            .map(|template| {
+                let source = template.as_ref();
+                let tree = PARSER
+                    .with(|parser| parser.borrow_mut().parse(source, None))
+                    .expect("mtlog parse failed");
+                PropertyIter::new(&tree, source).collect()
+            })
+            .collect()
+    }
+}
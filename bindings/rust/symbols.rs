@@ -0,0 +1,185 @@
+//! Property-name interning, backed by `src/symbols.c`.
+//!
+//! A [`SymbolTable`] gives each distinct property name a dense `u32` symbol,
+//! counting from 0 in the order first seen. Dotted names are also split into
+//! segments, each interned in the same table, so columnar stores can key
+//! both whole names and their parts by integer.
+//!
+//! ```
+//! use tree_sitter_mtlog::symbols::SymbolTable;
+//!
+//! let mut symbols = SymbolTable::new();
+//! let ids = symbols.intern_properties("{http.method} {Path} took {Elapsed}");
+//! assert_eq!(symbols.name(ids[0]), Some(&b"http.method"[..]));
+//! let http = symbols.find("http").unwrap();
+//! assert_eq!(symbols.segments(ids[0])[0], http);
+//! assert_eq!(symbols.intern("Path"), ids[1]);
+//! ```
+
+use std::convert::TryFrom;
+use std::os::raw::c_char;
+use std::ptr::NonNull;
+use std::slice;
+
+#[repr(C)]
+struct MtlogSymbols {
+    _private: [u8; 0],
+}
+
+const NONE: u32 = u32::MAX;
+
+extern "C" {
+    fn mtlog_symbols_new() -> *mut MtlogSymbols;
+    fn mtlog_symbols_delete(symbols: *mut MtlogSymbols);
+    fn mtlog_symbols_intern(symbols: *mut MtlogSymbols, name: *const c_char, length: u32) -> u32;
+    fn mtlog_symbols_find(symbols: *const MtlogSymbols, name: *const c_char, length: u32) -> u32;
+    fn mtlog_symbols_intern_properties(
+        symbols: *mut MtlogSymbols,
+        text: *const c_char,
+        length: u32,
+        ids: *mut u32,
+        capacity: u32,
+    ) -> u32;
+    fn mtlog_symbols_count(symbols: *const MtlogSymbols) -> u32;
+    fn mtlog_symbols_name(symbols: *const MtlogSymbols, id: u32, length: *mut u32)
+        -> *const c_char;
+    fn mtlog_symbols_segments(symbols: *const MtlogSymbols, id: u32, count: *mut u32)
+        -> *const u32;
+    fn mtlog_symbols_memory(symbols: *const MtlogSymbols) -> usize;
+}
+
+fn length_of(bytes: &[u8]) -> u32 {
+    u32::try_from(bytes.len()).expect("text longer than u32::MAX bytes")
+}
+
+/// A table of interned property names.
+pub struct SymbolTable {
+    ptr: NonNull<MtlogSymbols>,
+}
+
+// Interning takes `&mut self`; everything else only reads the table.
+unsafe impl Send for SymbolTable {}
+unsafe impl Sync for SymbolTable {}
+
+impl SymbolTable {
+    /// Create an empty table.
+    pub fn new() -> Self {
+        let ptr = unsafe { mtlog_symbols_new() };
+        SymbolTable {
+            ptr: NonNull::new(ptr).expect("failed to allocate mtlog symbol table"),
+        }
+    }
+
+    /// The symbol of `name`, interning it and its segments if new.
+    ///
+    /// # Panics
+    ///
+    /// Panics if allocation fails or `name` is 4 GiB or longer.
+    pub fn intern(&mut self, name: impl AsRef<[u8]>) -> u32 {
+        let bytes = name.as_ref();
+        let id = unsafe {
+            mtlog_symbols_intern(
+                self.ptr.as_ptr(),
+                bytes.as_ptr() as *const c_char,
+                length_of(bytes),
+            )
+        };
+        assert_ne!(id, NONE, "failed to intern property name");
+        id
+    }
+
+    /// The symbol of `name`, if it has been interned.
+    pub fn find(&self, name: impl AsRef<[u8]>) -> Option<u32> {
+        let bytes = name.as_ref();
+        let id = unsafe {
+            mtlog_symbols_find(
+                self.ptr.as_ptr(),
+                bytes.as_ptr() as *const c_char,
+                length_of(bytes),
+            )
+        };
+        if id == NONE {
+            None
+        } else {
+            Some(id)
+        }
+    }
+
+    /// Extract the properties of `template` and intern their names in the
+    /// same pass, returning one symbol per property in template order.
+    ///
+    /// # Panics
+    ///
+    /// Panics if allocation fails or `template` is 4 GiB or longer.
+    pub fn intern_properties(&mut self, template: impl AsRef<[u8]>) -> Vec<u32> {
+        let bytes = template.as_ref();
+        let mut ids = vec![0u32; 16];
+        loop {
+            let count = unsafe {
+                mtlog_symbols_intern_properties(
+                    self.ptr.as_ptr(),
+                    bytes.as_ptr() as *const c_char,
+                    length_of(bytes),
+                    ids.as_mut_ptr(),
+                    ids.len() as u32,
+                )
+            };
+            assert_ne!(count, NONE, "failed to intern property names");
+            if count as usize <= ids.len() {
+                ids.truncate(count as usize);
+                return ids;
+            }
+            ids.resize(count as usize, 0);
+        }
+    }
+
+    /// The number of symbols, segments included.
+    pub fn len(&self) -> usize {
+        unsafe { mtlog_symbols_count(self.ptr.as_ptr()) as usize }
+    }
+
+    /// Whether nothing has been interned.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// The name of symbol `id`.
+    pub fn name(&self, id: u32) -> Option<&[u8]> {
+        let mut length = 0u32;
+        let name = unsafe { mtlog_symbols_name(self.ptr.as_ptr(), id, &mut length) };
+        if name.is_null() {
+            None
+        } else {
+            Some(unsafe { slice::from_raw_parts(name as *const u8, length as usize) })
+        }
+    }
+
+    /// The segment symbols of `id`, one per `.`-separated part; just `id`
+    /// for a name without dots, and empty if there is no such symbol.
+    pub fn segments(&self, id: u32) -> &[u32] {
+        let mut count = 0u32;
+        let segments = unsafe { mtlog_symbols_segments(self.ptr.as_ptr(), id, &mut count) };
+        if segments.is_null() {
+            &[]
+        } else {
+            unsafe { slice::from_raw_parts(segments, count as usize) }
+        }
+    }
+
+    /// Bytes of memory held by the table.
+    pub fn memory(&self) -> usize {
+        unsafe { mtlog_symbols_memory(self.ptr.as_ptr()) }
+    }
+}
+
+impl Default for SymbolTable {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Drop for SymbolTable {
+    fn drop(&mut self) {
+        unsafe { mtlog_symbols_delete(self.ptr.as_ptr()) }
+    }
+}
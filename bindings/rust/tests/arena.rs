@@ -0,0 +1,27 @@
+//! Buffers the runtime hands to the `tree_sitter` crate must be freed through
+//! the installed hooks, whose blocks sit behind a header. A binary of its own,
+//! as the hooks must be installed before any parser exists.
+
+use tree_sitter_mtlog::arena::{self, Arena};
+
+fn sexp(text: &str) -> String {
+    let mut parser = tree_sitter::Parser::new();
+    parser.set_language(tree_sitter_mtlog::language()).unwrap();
+    let tree = parser.parse(text, None).unwrap();
+    tree.root_node().to_sexp()
+}
+
+#[test]
+fn to_sexp_with_hooks_installed() {
+    unsafe { arena::install() };
+    let text = "User {UserId} logged in from {{.Location}}";
+
+    let outside = sexp(text);
+    assert!(outside.starts_with("(template"), "{}", outside);
+    assert!(outside.contains("(property") && outside.contains("(go_property"), "{}", outside);
+
+    let mut arena = Arena::new(0);
+    let inside = unsafe { arena.cycle(|| sexp(text)) };
+    assert_eq!(inside, outside);
+    assert!(arena.stats().chunk_allocations > 0);
+}
@@ -0,0 +1,215 @@
+#!/usr/bin/env node
+// Generate src/highlight_table.h from the symbol and field enums in
+// src/parser.c and the patterns in queries/highlights.scm, with
+// src/node-types.json narrowing `_` to the nodes a field can hold. Run it
+// after `tree-sitter generate` or any change to the query (`npm run generate`
+// does both); `--check` exits 1 if the committed table is stale.
+//
+// Usage: node script/highlight_table.js [--check]
+//
+// Only the pattern shapes the query uses are supported, each with one
+// capture: `(node) @c`, `(parent (node) @c)`, `(parent "token" @c)` and
+// `(parent field: (node) @c)`, where `node` may be `_` for any named node.
+// Anything else (predicates, anchors, deeper nesting, several captures) is
+// an error, so the table can never silently disagree with the query.
+
+const fs = require('fs');
+const path = require('path');
+
+const ROOT = path.join(__dirname, '..');
+const PARSER = path.join(ROOT, 'src', 'parser.c');
+const NODE_TYPES = path.join(ROOT, 'src', 'node-types.json');
+const QUERY = path.join(ROOT, 'queries', 'highlights.scm');
+const OUTPUT = path.join(ROOT, 'src', 'highlight_table.h');
+
+function block(source, start) {
+  const from = source.indexOf(start);
+  if (from < 0) throw new Error(`parser.c: missing ${start}`);
+  return source.slice(from, source.indexOf('\n};', from));
+}
+
+function readGrammar(source) {
+  const ids = new Map([['ts_builtin_sym_end', 0]]);
+  for (const [, name, id] of block(source, 'enum {\n  sym_').matchAll(/^\s*(\w+) = (\d+),$/gm)) {
+    ids.set(name, Number(id));
+  }
+  const symbols = [];
+  for (const [, name, text] of block(source, 'ts_symbol_names[]').matchAll(/^\s*\[(\w+)\] = (".*"),$/gm)) {
+    symbols[ids.get(name)] = { id: ids.get(name), name: JSON.parse(text) };
+  }
+  for (const [, name, target] of block(source, 'ts_symbol_map[]').matchAll(/^\s*\[(\w+)\] = (\w+),$/gm)) {
+    symbols[ids.get(name)].public = ids.get(target);
+  }
+  const metadata = /^\s*\[(\w+)\] = \{\s*\.visible = (true|false),\s*\.named = (true|false),/gm;
+  for (const [, name, visible, named] of block(source, 'ts_symbol_metadata[]').matchAll(metadata)) {
+    Object.assign(symbols[ids.get(name)], { visible: visible === 'true', named: named === 'true' });
+  }
+
+  const fieldIds = new Map();
+  for (const [, name, id] of block(source, 'enum {\n  field_').matchAll(/^\s*(\w+) = (\d+),$/gm)) {
+    fieldIds.set(name, Number(id));
+  }
+  const fields = new Map();
+  for (const [, name, text] of block(source, 'ts_field_names[]').matchAll(/^\s*\[(\w+)\] = (".*"),$/gm)) {
+    fields.set(JSON.parse(text), fieldIds.get(name));
+  }
+
+  // The symbols a node can report: visible, and their own public symbol.
+  const visible = symbols.filter((symbol) => symbol.visible && symbol.public === symbol.id);
+  return { count: symbols.length, visible, fields };
+}
+
+function tokenize(query) {
+  const tokens = [];
+  const pattern = /\s+|;[^\n]*|("(?:[^"\\]|\\.)*")|([()])|(@[\w.-]+)|([\w.-]+:)|([\w.-]+)|(\S)/g;
+  for (const [, string, paren, capture, field, word, other] of query.matchAll(pattern)) {
+    if (other) throw new Error(`highlights.scm: unsupported syntax '${other}'`);
+    if (string) tokens.push({ type: 'string', value: JSON.parse(string) });
+    else if (paren) tokens.push({ type: paren });
+    else if (capture) tokens.push({ type: 'capture', value: capture.slice(1) });
+    else if (field) tokens.push({ type: 'field', value: field.slice(0, -1) });
+    else if (word) tokens.push({ type: 'word', value: word });
+  }
+  return tokens;
+}
+
+// Patterns as { parent, field, node: { name, named }, capture }, in order.
+function readPatterns(query) {
+  const tokens = tokenize(query);
+  let i = 0;
+  const expect = (type) => {
+    const token = tokens[i++];
+    if (!token || token.type !== type) throw new Error(`highlights.scm: expected ${type} at token ${i}`);
+    return token;
+  };
+  const capture = () => (tokens[i] && tokens[i].type === 'capture' ? tokens[i++].value : null);
+  const node = () => {
+    if (tokens[i] && tokens[i].type === 'string') return { name: tokens[i++].value, named: false };
+    expect('(');
+    const name = expect('word').value;
+    if (tokens[i].type !== ')') throw new Error(`highlights.scm: (${name} ...) nested below a parent`);
+    expect(')');
+    return { name, named: true };
+  };
+
+  const patterns = [];
+  while (i < tokens.length) {
+    expect('(');
+    const outer = expect('word').value;
+    const children = [];
+    while (tokens[i] && tokens[i].type !== ')') {
+      const field = tokens[i].type === 'field' ? tokens[i++].value : null;
+      children.push({ field, node: node(), capture: capture() });
+    }
+    expect(')');
+    const outerCapture = capture();
+
+    const captured = children.filter((child) => child.capture);
+    if (children.length === 0 && outerCapture) {
+      patterns.push({ parent: null, field: null, node: { name: outer, named: true }, capture: outerCapture });
+    } else if (children.length === 1 && captured.length === 1 && !outerCapture) {
+      patterns.push({ parent: outer, ...captured[0] });
+    } else {
+      throw new Error(`highlights.scm: unsupported pattern (${outer} ...): needs exactly one capture`);
+    }
+  }
+  return patterns;
+}
+
+// The named types `parent` can hold in `field`, or null if unconstrained.
+function fieldTypes(nodeTypes, parent, field) {
+  if (!parent || !field) return null;
+  const type = nodeTypes.find((t) => t.type === parent && t.named);
+  const types = type && type.fields && type.fields[field] && type.fields[field].types;
+  if (!types) throw new Error(`highlights.scm: (${parent}) has no field ${field}`);
+  return types.filter((t) => t.named).map((t) => t.type);
+}
+
+function buildTable(grammar, nodeTypes, patterns) {
+  const lookup = (name, named, within = null) => {
+    const matches = (s) => (name === '_' ? s.named && (!within || within.includes(s.name)) : s.name === name);
+    const symbols = grammar.visible.filter((s) => s.named === named && matches(s));
+    if (symbols.length === 0) throw new Error(`highlights.scm: no node ${named ? `(${name})` : `"${name}"`}`);
+    return symbols;
+  };
+  const captures = [];
+  const rules = new Map(); // symbol id -> [{ parent, field, capture }] in pattern order
+  for (const pattern of patterns) {
+    const parent = pattern.parent ? lookup(pattern.parent, true) : [{ id: 0 }];
+    if (parent.length !== 1) throw new Error(`highlights.scm: ambiguous parent (${pattern.parent})`);
+    let field = 0;
+    if (pattern.field) {
+      field = grammar.fields.get(pattern.field);
+      if (!field) throw new Error(`highlights.scm: no field ${pattern.field}`);
+    }
+    if (!captures.includes(pattern.capture)) captures.push(pattern.capture);
+    const within = fieldTypes(nodeTypes, pattern.parent, pattern.field);
+    for (const symbol of lookup(pattern.node.name, pattern.node.named, within)) {
+      if (!rules.has(symbol.id)) rules.set(symbol.id, []);
+      rules.get(symbol.id).push({ parent: parent[0].id, field, capture: captures.indexOf(pattern.capture) });
+    }
+  }
+  return { captures, rules };
+}
+
+function render(grammar, table) {
+  const name = (id) => grammar.visible.find((symbol) => symbol.id === id).name;
+  const lines = [
+    '// Generated by script/highlight_table.js from src/parser.c and',
+    '// queries/highlights.scm. Do not edit.',
+    '',
+    '#ifndef TREE_SITTER_MTLOG_HIGHLIGHT_TABLE_H_',
+    '#define TREE_SITTER_MTLOG_HIGHLIGHT_TABLE_H_',
+    '',
+    `#define HIGHLIGHT_SYMBOL_COUNT ${grammar.count}`,
+    `#define HIGHLIGHT_CAPTURE_COUNT ${table.captures.length}`,
+    '',
+    'static const char *const HIGHLIGHT_NAMES[HIGHLIGHT_CAPTURE_COUNT] = {',
+    ...table.captures.map((capture) => `  ${JSON.stringify(capture)},`),
+    '};',
+    '',
+    '// Per symbol, in query order: {parent symbol or 0, field or 0, capture}.',
+    'static const HighlightRule HIGHLIGHT_RULES[] = {',
+  ];
+  const slices = [];
+  let index = 0;
+  for (const id of [...table.rules.keys()].sort((a, b) => a - b)) {
+    const rules = table.rules.get(id);
+    for (const rule of rules) {
+      const comment = rule.parent ? ` in ${name(rule.parent)}` : '';
+      lines.push(`  {${rule.parent}, ${rule.field}, ${rule.capture}}, // ${JSON.stringify(name(id))}${comment}`);
+    }
+    slices.push(`  [${id}] = {${index}, ${rules.length}},`);
+    index += rules.length;
+  }
+  lines.push(
+    '};',
+    '',
+    'static const HighlightSlice HIGHLIGHT_SLICES[HIGHLIGHT_SYMBOL_COUNT] = {',
+    ...slices,
+    '};',
+    '',
+    '#endif // TREE_SITTER_MTLOG_HIGHLIGHT_TABLE_H_',
+    '',
+  );
+  return lines.join('\n');
+}
+
+function main() {
+  const check = process.argv.includes('--check');
+  const grammar = readGrammar(fs.readFileSync(PARSER, 'utf8'));
+  const nodeTypes = JSON.parse(fs.readFileSync(NODE_TYPES, 'utf8'));
+  const table = buildTable(grammar, nodeTypes, readPatterns(fs.readFileSync(QUERY, 'utf8')));
+  const output = render(grammar, table);
+  if (check) {
+    const current = fs.existsSync(OUTPUT) ? fs.readFileSync(OUTPUT, 'utf8') : '';
+    if (current !== output) {
+      console.error('src/highlight_table.h is stale; run node script/highlight_table.js');
+      process.exitCode = 1;
+    }
+    return;
+  }
+  fs.writeFileSync(OUTPUT, output);
+}
+
+main();
@@ -0,0 +1,99 @@
+#include "alloc_stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define MTLOG_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#define MTLOG_THREAD_LOCAL __thread
+#else
+#define MTLOG_THREAD_LOCAL _Thread_local
+#endif
+
+// Each block is prefixed with its requested size so frees and reallocs can
+// keep live_bytes exact. 16 bytes keeps the backend's alignment.
+#define HEADER_SIZE 16
+
+static void *(*backend_malloc)(size_t) = malloc;
+static void *(*backend_calloc)(size_t, size_t) = calloc;
+static void *(*backend_realloc)(void *, size_t) = realloc;
+static void (*backend_free)(void *) = free;
+
+static MTLOG_THREAD_LOCAL MtlogAllocStats stats;
+
+void mtlog_alloc_stats_set_backend(
+  void *(*new_malloc)(size_t),
+  void *(*new_calloc)(size_t, size_t),
+  void *(*new_realloc)(void *, size_t),
+  void (*new_free)(void *)
+) {
+  backend_malloc = new_malloc ? new_malloc : malloc;
+  backend_calloc = new_calloc ? new_calloc : calloc;
+  backend_realloc = new_realloc ? new_realloc : realloc;
+  backend_free = new_free ? new_free : free;
+}
+
+void mtlog_alloc_stats_reset(void) {
+  int64_t live = stats.live_bytes;
+  memset(&stats, 0, sizeof stats);
+  stats.live_bytes = live;
+  stats.peak_bytes = live;
+}
+
+void mtlog_alloc_stats_get(MtlogAllocStats *out) { *out = stats; }
+
+static inline void grow(int64_t delta) {
+  stats.live_bytes += delta;
+  if (stats.live_bytes > stats.peak_bytes) stats.peak_bytes = stats.live_bytes;
+}
+
+static inline void *finish(unsigned char *block, size_t size) {
+  if (!block) return NULL;
+  memcpy(block, &size, sizeof size);
+  return block + HEADER_SIZE;
+}
+
+static inline size_t size_of_block(void *ptr) {
+  size_t size;
+  memcpy(&size, (unsigned char *)ptr - HEADER_SIZE, sizeof size);
+  return size;
+}
+
+void *mtlog_alloc_stats_malloc(size_t size) {
+  stats.malloc_calls++;
+  stats.bytes_allocated += size;
+  grow((int64_t)size);
+  return finish((unsigned char *)backend_malloc(HEADER_SIZE + size), size);
+}
+
+void *mtlog_alloc_stats_calloc(size_t count, size_t size) {
+  stats.calloc_calls++;
+  if (size && count > (SIZE_MAX - HEADER_SIZE) / size) return NULL;
+  size_t total = count * size;
+  stats.bytes_allocated += total;
+  grow((int64_t)total);
+  // The header does not fit calloc's count * size shape; ask for raw bytes.
+  return finish((unsigned char *)backend_calloc(1, HEADER_SIZE + total), total);
+}
+
+void *mtlog_alloc_stats_realloc(void *ptr, size_t size) {
+  stats.realloc_calls++;
+  stats.bytes_allocated += size;
+  if (!ptr) {
+    grow((int64_t)size);
+    return finish((unsigned char *)backend_realloc(NULL, HEADER_SIZE + size), size);
+  }
+  size_t old_size = size_of_block(ptr);
+  unsigned char *block = (unsigned char *)backend_realloc((unsigned char *)ptr - HEADER_SIZE, HEADER_SIZE + size);
+  if (!block) return NULL;
+  grow((int64_t)size - (int64_t)old_size);
+  return finish(block, size);
+}
+
+void mtlog_alloc_stats_free(void *ptr) {
+  if (!ptr) return;
+  stats.free_calls++;
+  stats.live_bytes -= (int64_t)size_of_block(ptr);
+  backend_free((unsigned char *)ptr - HEADER_SIZE);
+}
@@ -0,0 +1,77 @@
+#ifndef TREE_SITTER_MTLOG_ALLOC_STATS_H_
+#define TREE_SITTER_MTLOG_ALLOC_STATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocation profiling for the tree-sitter runtime.
+//
+// Instrumented mode is enabled by installing the hooks below with
+// ts_set_allocator() before any parser is created. They forward to a backend
+// allocator (malloc/free by default, or e.g. the arena hooks from arena.h)
+// and count calls and bytes for the calling thread:
+//
+//   ts_set_allocator(mtlog_alloc_stats_malloc, mtlog_alloc_stats_calloc,
+//                    mtlog_alloc_stats_realloc, mtlog_alloc_stats_free);
+//
+//   mtlog_alloc_stats_reset();
+//   TSTree *tree = ts_parser_parse_string(parser, NULL, text, length);
+//   MtlogAllocStats parse;
+//   mtlog_alloc_stats_get(&parse);      // calls and peak for this parse
+//   ts_tree_delete(tree);
+//   MtlogAllocStats after;
+//   mtlog_alloc_stats_get(&after);      // parse.live_bytes - after.live_bytes
+//                                       // is what the tree retained
+//
+// Counters are per thread; a block freed on another thread than the one that
+// allocated it is credited to the freeing thread.
+//
+// Blocks carry a size header, so once the hooks are installed a buffer the
+// runtime returns to its caller (ts_node_string, ts_tree_get_changed_ranges,
+// ...) must be freed with mtlog_alloc_stats_free, never free(). From Rust,
+// install them with tree_sitter::set_allocator so the crate does the same.
+
+typedef struct {
+  uint64_t malloc_calls;
+  uint64_t calloc_calls;
+  uint64_t realloc_calls;
+  uint64_t free_calls;
+  uint64_t bytes_allocated; // requested by malloc/calloc/realloc since reset
+  int64_t live_bytes;       // outstanding on this thread, not cleared by reset
+  int64_t peak_bytes;       // high-water mark of live_bytes since reset
+} MtlogAllocStats;
+
+// Allocator that the hooks forward to. Must be set before the hooks are
+// installed; NULL arguments restore malloc/calloc/realloc/free.
+void mtlog_alloc_stats_set_backend(
+  void *(*backend_malloc)(size_t),
+  void *(*backend_calloc)(size_t, size_t),
+  void *(*backend_realloc)(void *, size_t),
+  void (*backend_free)(void *)
+);
+
+// Zero the calling thread's counters; the peak restarts at the live size.
+void mtlog_alloc_stats_reset(void);
+
+void mtlog_alloc_stats_get(MtlogAllocStats *stats);
+
+// Total malloc + calloc + realloc calls in `stats`.
+static inline uint64_t mtlog_alloc_stats_calls(const MtlogAllocStats *stats) {
+  return stats->malloc_calls + stats->calloc_calls + stats->realloc_calls;
+}
+
+// Allocator hooks for ts_set_allocator().
+void *mtlog_alloc_stats_malloc(size_t size);
+void *mtlog_alloc_stats_calloc(size_t count, size_t size);
+void *mtlog_alloc_stats_realloc(void *ptr, size_t size);
+void mtlog_alloc_stats_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_ALLOC_STATS_H_
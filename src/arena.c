@@ -0,0 +1,208 @@
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define MTLOG_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#define MTLOG_THREAD_LOCAL __thread
+#else
+#define MTLOG_THREAD_LOCAL _Thread_local
+#endif
+
+#define DEFAULT_CHUNK_SIZE (64 * 1024)
+
+// Every block handed out by the hooks is preceded by a header recording where
+// it came from, so frees and reallocs route correctly no matter which arena
+// (if any) is active when they happen. 16 bytes keeps malloc's alignment.
+typedef struct {
+  size_t size;
+  size_t owner; // BLOCK_HEAP or BLOCK_ARENA
+} BlockHeader;
+
+enum { BLOCK_HEAP = 0x68656170, BLOCK_ARENA = 0x6172656e };
+
+#define HEADER_SIZE ((sizeof(BlockHeader) + 15) & ~(size_t)15)
+#define ALIGN(n) (((n) + 15) & ~(size_t)15)
+
+typedef struct Chunk {
+  struct Chunk *next;
+  size_t capacity;
+  size_t used;
+  size_t padding;
+  unsigned char data[];
+} Chunk;
+
+struct MtlogArena {
+  Chunk *first;
+  Chunk *current;
+  unsigned char *last_block; // most recent block, may grow or shrink in place
+  size_t chunk_size;
+  size_t allocations;
+  size_t bytes_used;
+  size_t bytes_reserved;
+  size_t chunk_allocations;
+};
+
+static MTLOG_THREAD_LOCAL MtlogArena *active_arena;
+
+static Chunk *chunk_new(MtlogArena *self, size_t min_capacity) {
+  size_t capacity = min_capacity > self->chunk_size ? ALIGN(min_capacity) : self->chunk_size;
+  Chunk *chunk = (Chunk *)malloc(sizeof(Chunk) + capacity);
+  if (!chunk) return NULL;
+  chunk->next = NULL;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+  self->bytes_reserved += capacity;
+  self->chunk_allocations++;
+  return chunk;
+}
+
+MtlogArena *mtlog_arena_new(size_t chunk_size) {
+  MtlogArena *self = (MtlogArena *)calloc(1, sizeof(MtlogArena));
+  if (!self) return NULL;
+  self->chunk_size = ALIGN(chunk_size ? chunk_size : DEFAULT_CHUNK_SIZE);
+  self->first = self->current = chunk_new(self, 0);
+  if (!self->first) {
+    free(self);
+    return NULL;
+  }
+  return self;
+}
+
+void mtlog_arena_delete(MtlogArena *self) {
+  if (!self) return;
+  if (active_arena == self) active_arena = NULL;
+  Chunk *chunk = self->first;
+  while (chunk) {
+    Chunk *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  free(self);
+}
+
+void mtlog_arena_reset(MtlogArena *self) {
+  for (Chunk *chunk = self->first; chunk; chunk = chunk->next) chunk->used = 0;
+  self->current = self->first;
+  self->last_block = NULL;
+  self->allocations = 0;
+  self->bytes_used = 0;
+}
+
+void mtlog_arena_stats(const MtlogArena *self, MtlogArenaStats *stats) {
+  stats->allocations = self->allocations;
+  stats->bytes_used = self->bytes_used;
+  stats->bytes_reserved = self->bytes_reserved;
+  stats->chunk_allocations = self->chunk_allocations;
+}
+
+MtlogArena *mtlog_arena_activate(MtlogArena *arena) {
+  MtlogArena *previous = active_arena;
+  active_arena = arena;
+  return previous;
+}
+
+// Bump-allocate a block (header included) of at least `size` usable bytes.
+static void *arena_alloc(MtlogArena *self, size_t size) {
+  size_t needed = HEADER_SIZE + ALIGN(size);
+  Chunk *chunk = self->current;
+  while (chunk->capacity - chunk->used < needed) {
+    // Reuse chunks kept from before the last reset before asking for more.
+    if (!chunk->next) {
+      chunk->next = chunk_new(self, needed);
+      if (!chunk->next) return NULL;
+    }
+    chunk = chunk->next;
+    self->current = chunk;
+  }
+
+  unsigned char *block = chunk->data + chunk->used;
+  chunk->used += needed;
+  self->last_block = block;
+  self->allocations++;
+  self->bytes_used += needed;
+
+  BlockHeader *header = (BlockHeader *)block;
+  header->size = size;
+  header->owner = BLOCK_ARENA;
+  return block + HEADER_SIZE;
+}
+
+static void *heap_alloc(size_t size) {
+  unsigned char *block = (unsigned char *)malloc(HEADER_SIZE + size);
+  if (!block) return NULL;
+  BlockHeader *header = (BlockHeader *)block;
+  header->size = size;
+  header->owner = BLOCK_HEAP;
+  return block + HEADER_SIZE;
+}
+
+static inline BlockHeader *header_of(void *ptr) {
+  return (BlockHeader *)((unsigned char *)ptr - HEADER_SIZE);
+}
+
+void *mtlog_arena_malloc(size_t size) {
+  MtlogArena *arena = active_arena;
+  return arena ? arena_alloc(arena, size) : heap_alloc(size);
+}
+
+void *mtlog_arena_calloc(size_t count, size_t size) {
+  if (size && count > SIZE_MAX / size) return NULL;
+  void *ptr = mtlog_arena_malloc(count * size);
+  if (ptr) memset(ptr, 0, count * size);
+  return ptr;
+}
+
+void *mtlog_arena_realloc(void *ptr, size_t size) {
+  if (!ptr) return mtlog_arena_malloc(size);
+
+  BlockHeader *header = header_of(ptr);
+  if (header->owner == BLOCK_HEAP) {
+    unsigned char *block = (unsigned char *)realloc(header, HEADER_SIZE + size);
+    if (!block) return NULL;
+    ((BlockHeader *)block)->size = size;
+    return block + HEADER_SIZE;
+  }
+
+  // Arena block. tree-sitter grows its arrays by repeated reallocs, so the
+  // most recent block is extended in place when its chunk has room.
+  MtlogArena *arena = active_arena;
+  if (arena && (unsigned char *)header == arena->last_block) {
+    Chunk *chunk = arena->current;
+    size_t old_size = HEADER_SIZE + ALIGN(header->size);
+    size_t new_size = HEADER_SIZE + ALIGN(size);
+    if (chunk->used - old_size + new_size <= chunk->capacity) {
+      chunk->used = chunk->used - old_size + new_size;
+      arena->bytes_used = arena->bytes_used - old_size + new_size;
+      header->size = size;
+      return ptr;
+    }
+  }
+
+  void *moved = mtlog_arena_malloc(size);
+  if (!moved) return NULL;
+  memcpy(moved, ptr, header->size < size ? header->size : size);
+  return moved;
+}
+
+void mtlog_arena_free(void *ptr) {
+  if (!ptr) return;
+  BlockHeader *header = header_of(ptr);
+  if (header->owner == BLOCK_HEAP) {
+    free(header);
+    return;
+  }
+
+  // Arena blocks are released by mtlog_arena_reset; only the most recent one
+  // is handed back so that short-lived scratch allocations do not pile up.
+  MtlogArena *arena = active_arena;
+  if (arena && (unsigned char *)header == arena->last_block) {
+    size_t size = HEADER_SIZE + ALIGN(header->size);
+    arena->current->used -= size;
+    arena->bytes_used -= size;
+    arena->last_block = NULL;
+  }
+}
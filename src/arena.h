@@ -0,0 +1,77 @@
+#ifndef TREE_SITTER_MTLOG_ARENA_H_
+#define TREE_SITTER_MTLOG_ARENA_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Bump allocator for parse-extract-discard cycles.
+//
+// Install the hooks below with ts_set_allocator() once, before any parser is
+// created. While an arena is active on a thread, every tree-sitter allocation
+// made on that thread is carved out of the arena and frees are no-ops; a
+// single mtlog_arena_reset() then releases the parser, trees and everything
+// else allocated during the cycle. With no arena active the hooks fall back to
+// malloc/free.
+//
+//   ts_set_allocator(mtlog_arena_malloc, mtlog_arena_calloc,
+//                    mtlog_arena_realloc, mtlog_arena_free);
+//   MtlogArena *arena = mtlog_arena_new(0);
+//   for (each template) {
+//     mtlog_arena_activate(arena);
+//     TSParser *parser = ts_parser_new();
+//     ts_parser_set_language(parser, tree_sitter_mtlog());
+//     TSTree *tree = ts_parser_parse_string(parser, NULL, text, length);
+//     ... extract ...
+//     mtlog_arena_activate(NULL);
+//     mtlog_arena_reset(arena); // no ts_tree_delete / ts_parser_delete
+//   }
+//
+// Every tree-sitter object used while an arena is active must be created
+// while it is active (a parser keeps freed subtrees in a pool for reuse), and
+// none of them may be used or deleted after the reset.
+//
+// Blocks carry a header, so once the hooks are installed a buffer the runtime
+// returns to its caller (ts_node_string, ts_tree_get_changed_ranges, ...)
+// must be freed with mtlog_arena_free, never free(). From Rust, install them
+// with tree_sitter::set_allocator so the crate does the same.
+
+typedef struct MtlogArena MtlogArena;
+
+typedef struct {
+  size_t allocations;       // blocks served since the last reset
+  size_t bytes_used;        // bytes served since the last reset, with headers
+  size_t bytes_reserved;    // capacity of all chunks currently held
+  size_t chunk_allocations; // chunks obtained from malloc over the lifetime
+} MtlogArenaStats;
+
+// Create an arena whose chunks hold at least `chunk_size` bytes (0 picks a
+// default of 64 KiB). Returns NULL if allocation fails.
+MtlogArena *mtlog_arena_new(size_t chunk_size);
+
+// Free the arena and all of its chunks.
+void mtlog_arena_delete(MtlogArena *self);
+
+// Release every block at once; chunks are kept for the next cycle.
+void mtlog_arena_reset(MtlogArena *self);
+
+void mtlog_arena_stats(const MtlogArena *self, MtlogArenaStats *stats);
+
+// Route the calling thread's allocations to `arena` (NULL restores
+// malloc/free). Returns the previously active arena.
+MtlogArena *mtlog_arena_activate(MtlogArena *arena);
+
+// Allocator hooks for ts_set_allocator().
+void *mtlog_arena_malloc(size_t size);
+void *mtlog_arena_calloc(size_t count, size_t size);
+void *mtlog_arena_realloc(void *ptr, size_t size);
+void mtlog_arena_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_ARENA_H_
@@ -0,0 +1,43 @@
+#ifndef TREE_SITTER_MTLOG_CHAR_CLASS_H_
+#define TREE_SITTER_MTLOG_CHAR_CLASS_H_
+
+// Shared by the external scanner and the tree-free extractor so both apply
+// the same character rules.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Character classes for the first 256 code points; everything above is plain
+// literal text. CC_SPECIAL marks the characters that end a literal run.
+//
+// The scanner sees code points, never code units: with UTF-16 input the
+// runtime joins surrogate pairs before setting the lookahead, and passes an
+// unpaired surrogate through as itself. Invalid UTF-8 arrives as -1. All of
+// these are plain text, so no encoding can make the scanner split a
+// character or take part of one for a delimiter.
+enum {
+  CC_IDENT = 1 << 0,   // [A-Za-z_]
+  CC_DIGIT = 1 << 1,   // [0-9]
+  CC_SPECIAL = 1 << 2, // NUL/EOF, '\n', '\r', '{', '$'
+};
+
+static const uint8_t char_class[256] = {
+  [0] = CC_SPECIAL, ['\n'] = CC_SPECIAL, ['\r'] = CC_SPECIAL, ['{'] = CC_SPECIAL, ['$'] = CC_SPECIAL,
+  ['A'] = CC_IDENT, ['B'] = CC_IDENT, ['C'] = CC_IDENT, ['D'] = CC_IDENT, ['E'] = CC_IDENT, ['F'] = CC_IDENT, ['G'] = CC_IDENT, ['H'] = CC_IDENT, ['I'] = CC_IDENT, ['J'] = CC_IDENT, ['K'] = CC_IDENT, ['L'] = CC_IDENT, ['M'] = CC_IDENT,
+  ['N'] = CC_IDENT, ['O'] = CC_IDENT, ['P'] = CC_IDENT, ['Q'] = CC_IDENT, ['R'] = CC_IDENT, ['S'] = CC_IDENT, ['T'] = CC_IDENT, ['U'] = CC_IDENT, ['V'] = CC_IDENT, ['W'] = CC_IDENT, ['X'] = CC_IDENT, ['Y'] = CC_IDENT, ['Z'] = CC_IDENT,
+  ['a'] = CC_IDENT, ['b'] = CC_IDENT, ['c'] = CC_IDENT, ['d'] = CC_IDENT, ['e'] = CC_IDENT, ['f'] = CC_IDENT, ['g'] = CC_IDENT, ['h'] = CC_IDENT, ['i'] = CC_IDENT, ['j'] = CC_IDENT, ['k'] = CC_IDENT, ['l'] = CC_IDENT, ['m'] = CC_IDENT,
+  ['n'] = CC_IDENT, ['o'] = CC_IDENT, ['p'] = CC_IDENT, ['q'] = CC_IDENT, ['r'] = CC_IDENT, ['s'] = CC_IDENT, ['t'] = CC_IDENT, ['u'] = CC_IDENT, ['v'] = CC_IDENT, ['w'] = CC_IDENT, ['x'] = CC_IDENT, ['y'] = CC_IDENT, ['z'] = CC_IDENT,
+  ['0'] = CC_DIGIT, ['1'] = CC_DIGIT, ['2'] = CC_DIGIT, ['3'] = CC_DIGIT, ['4'] = CC_DIGIT,
+  ['5'] = CC_DIGIT, ['6'] = CC_DIGIT, ['7'] = CC_DIGIT, ['8'] = CC_DIGIT, ['9'] = CC_DIGIT,
+  ['_'] = CC_IDENT,
+};
+
+static inline uint8_t class_of(int32_t c) { return (c >= 0 && c < 256) ? char_class[c] : 0; }
+
+static inline bool is_ident_start(int32_t c) { return class_of(c) & CC_IDENT; }
+static inline bool is_digit(int32_t c) { return class_of(c) & CC_DIGIT; }
+static inline bool is_plain(int32_t c) { return !(class_of(c) & CC_SPECIAL); }
+static inline bool is_ident_char(int32_t c) { return class_of(c) & (CC_IDENT | CC_DIGIT); }
+static inline bool is_newline(int32_t c) { return c == '\n' || c == '\r'; }
+
+#endif // TREE_SITTER_MTLOG_CHAR_CLASS_H_
@@ -0,0 +1,163 @@
+#include "fingerprint.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// Streaming 64-bit hash: eight bytes per multiply, with every field
+// length-prefixed and tagged so that field boundaries cannot collide.
+
+typedef struct {
+  uint64_t state;
+  uint32_t flags;
+  bool pending_space; // a whitespace run is waiting to be fed as one ' '
+  bool in_literal;    // inside a canonical literal (adjacent literals merge)
+  uint64_t literal_length;
+} Hasher;
+
+enum {
+  TAG_LITERAL = 0x4c,
+  TAG_PROPERTY = 0x50,
+  TAG_NAME = 0x4e,
+  TAG_HINT = 0x48,
+  TAG_FORMAT = 0x46,
+  TAG_END = 0x45,
+};
+
+static inline void feed_u64(Hasher *hasher, uint64_t value) {
+  hasher->state = (hasher->state ^ value) * 0xff51afd7ed558ccdull;
+  hasher->state ^= hasher->state >> 29;
+}
+
+static void feed_bytes(Hasher *hasher, const unsigned char *p, uint32_t length) {
+  while (length >= 8) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    feed_u64(hasher, word);
+    p += 8;
+    length -= 8;
+  }
+  uint64_t tail = 0;
+  for (uint32_t i = 0; i < length; i++) tail |= (uint64_t)p[i] << (8 * i);
+  feed_u64(hasher, tail ^ ((uint64_t)length << 56));
+}
+
+static inline bool is_space(unsigned char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+// Literal text with whitespace runs collapsed and leading and trailing
+// whitespace dropped; runs of other bytes are fed in bulk.
+static void feed_literal(Hasher *hasher, const unsigned char *p, uint32_t length) {
+  if (!hasher->in_literal) {
+    feed_u64(hasher, TAG_LITERAL);
+    hasher->in_literal = true;
+    hasher->pending_space = false;
+    hasher->literal_length = 0;
+  }
+  uint32_t i = 0;
+  while (i < length) {
+    if (is_space(p[i])) {
+      do i++; while (i < length && is_space(p[i]));
+      if (hasher->literal_length) hasher->pending_space = true;
+      continue;
+    }
+    uint32_t start = i;
+    do i++; while (i < length && !is_space(p[i]));
+    if (hasher->pending_space) {
+      feed_u64(hasher, ' ');
+      hasher->pending_space = false;
+    }
+    feed_bytes(hasher, p + start, i - start);
+    hasher->literal_length += i - start;
+  }
+}
+
+static void end_literal(Hasher *hasher) {
+  if (!hasher->in_literal) return;
+  feed_u64(hasher, hasher->literal_length);
+  hasher->in_literal = false;
+}
+
+static void feed_property(Hasher *hasher, const char *text, uint8_t kind, MtlogSpan name, MtlogSpan format,
+                          uint8_t hint) {
+  end_literal(hasher);
+  feed_u64(hasher, TAG_PROPERTY | (uint64_t)kind << 8);
+  if (hasher->flags & MTLOG_FINGERPRINT_NAMES) {
+    feed_u64(hasher, TAG_NAME);
+    feed_bytes(hasher, (const unsigned char *)text + name.start, name.end - name.start);
+  }
+  if (hasher->flags & MTLOG_FINGERPRINT_HINTS) feed_u64(hasher, TAG_HINT | (uint64_t)hint << 8);
+  if (hasher->flags & MTLOG_FINGERPRINT_FORMATS) {
+    feed_u64(hasher, TAG_FORMAT);
+    feed_bytes(hasher, (const unsigned char *)text + format.start, format.end - format.start);
+  }
+}
+
+static void hasher_init(Hasher *hasher, uint32_t flags) {
+  hasher->state = 0x9e3779b97f4a7c15ull ^ flags;
+  hasher->flags = flags;
+  hasher->pending_space = false;
+  hasher->in_literal = false;
+  hasher->literal_length = 0;
+}
+
+static uint64_t hasher_finish(Hasher *hasher) {
+  end_literal(hasher);
+  feed_u64(hasher, TAG_END);
+  uint64_t x = hasher->state;
+  x ^= x >> 32;
+  x *= 0xd6e8feb86659fd93ull;
+  x ^= x >> 32;
+  x *= 0xd6e8feb86659fd93ull;
+  x ^= x >> 32;
+  return x;
+}
+
+typedef struct {
+  Hasher hasher;
+  const char *text;
+} ScanContext;
+
+static bool on_segment(const MtlogSegment *segment, void *context) {
+  ScanContext *scan = (ScanContext *)context;
+  if (segment->kind == MTLOG_SEGMENT_LITERAL) {
+    if (scan->hasher.flags & MTLOG_FINGERPRINT_LITERALS) {
+      feed_literal(&scan->hasher, (const unsigned char *)scan->text + segment->span.start,
+                   segment->span.end - segment->span.start);
+    }
+  } else {
+    feed_property(&scan->hasher, scan->text, (uint8_t)segment->kind, segment->name, segment->format,
+                  (uint8_t)segment->hint);
+  }
+  return true;
+}
+
+uint64_t mtlog_fingerprint(const char *text, uint32_t length, uint32_t flags) {
+  ScanContext scan;
+  hasher_init(&scan.hasher, flags);
+  scan.text = text;
+  if (flags & MTLOG_FINGERPRINT_LITERALS) {
+    mtlog_scan_segments(text, length, on_segment, &scan);
+  } else {
+    mtlog_scan_properties(text, length, on_segment, &scan);
+  }
+  return hasher_finish(&scan.hasher);
+}
+
+uint64_t mtlog_fingerprint_ir(const MtlogTemplateIR *ir, const char *text, uint32_t flags) {
+  Hasher hasher;
+  hasher_init(&hasher, flags);
+  const MtlogSpan *spans = mtlog_ir_spans(ir);
+  const MtlogSpan *names = mtlog_ir_names(ir);
+  const MtlogSpan *formats = mtlog_ir_formats(ir);
+  const uint8_t *kinds = mtlog_ir_kinds(ir);
+  const uint8_t *hints = mtlog_ir_hints(ir);
+  for (uint32_t i = 0; i < ir->segment_count; i++) {
+    if (kinds[i] == MTLOG_SEGMENT_LITERAL) {
+      if (flags & MTLOG_FINGERPRINT_LITERALS) {
+        feed_literal(&hasher, (const unsigned char *)text + spans[i].start, spans[i].end - spans[i].start);
+      }
+    } else {
+      feed_property(&hasher, text, kinds[i], names[i], formats[i], hints[i]);
+    }
+  }
+  return hasher_finish(&hasher);
+}
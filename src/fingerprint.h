@@ -0,0 +1,49 @@
+#ifndef TREE_SITTER_MTLOG_FINGERPRINT_H_
+#define TREE_SITTER_MTLOG_FINGERPRINT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "template_ir.h"
+
+// Structural template fingerprints for grouping events by template.
+//
+// Hashing the raw template string separates templates that differ only in
+// parts a consumer may not care about. The fingerprint hashes the template's
+// structure instead, the sequence of property kinds, plus whichever parts the
+// flags select. Literal text is canonicalized first: whitespace at either end
+// of a literal is dropped and each inner whitespace run (spaces, tabs,
+// newlines) counts as one space, so "User  {Id}" and "User{Id}" agree. It is computed in the same single pass that extracts
+// the properties.
+//
+// Fingerprints are stable across releases for a given set of flags.
+
+typedef enum {
+  MTLOG_FINGERPRINT_LITERALS = 1 << 0, // literal text, canonicalized
+  MTLOG_FINGERPRINT_NAMES = 1 << 1,    // property names
+  MTLOG_FINGERPRINT_HINTS = 1 << 2,    // '@' and '$' capture hints
+  MTLOG_FINGERPRINT_FORMATS = 1 << 3,  // format strings
+} MtlogFingerprintFlags;
+
+// Literals, names and hints: groups templates that differ only in
+// formatting (format strings and whitespace).
+#define MTLOG_FINGERPRINT_DEFAULT \
+  (MTLOG_FINGERPRINT_LITERALS | MTLOG_FINGERPRINT_NAMES | MTLOG_FINGERPRINT_HINTS)
+
+#define MTLOG_FINGERPRINT_ALL \
+  (MTLOG_FINGERPRINT_LITERALS | MTLOG_FINGERPRINT_NAMES | MTLOG_FINGERPRINT_HINTS | MTLOG_FINGERPRINT_FORMATS)
+
+uint64_t mtlog_fingerprint(const char *text, uint32_t length, uint32_t flags);
+
+// Same value from an IR already built for `text` (for example from a parse
+// tree with mtlog_ir_from_tree).
+uint64_t mtlog_fingerprint_ir(const MtlogTemplateIR *ir, const char *text, uint32_t flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_FINGERPRINT_H_
@@ -0,0 +1,665 @@
+#include "format_spec.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Date ops; the argument is a digit count unless noted.
+enum {
+  DATE_LITERAL,     // argument: bytes of `literal`
+  DATE_YEAR,        // 4: full year, 2: two digits, 1: two digits unpadded
+  DATE_MONTH,
+  DATE_MONTH_NAME,  // 0: Jan, 1: January
+  DATE_DAY,         // 0: space-padded to two (Go '_2')
+  DATE_WEEKDAY,     // 0: Mon, 1: Monday
+  DATE_HOUR24,
+  DATE_HOUR12,
+  DATE_MINUTE,
+  DATE_SECOND,
+  DATE_FRACTION,    // exactly n digits
+  DATE_FRACTION_TRIM,     // up to n digits, trailing zeros dropped (.NET 'F')
+  DATE_DOT_FRACTION_TRIM, // same, with the '.' dropped too when empty (Go '.999')
+  DATE_AMPM,        // 0: AM, 1: am, 2: A
+  DATE_ZONE,        // UTC as 0: Z, 1: +00:00, 2: +0000, 3: UTC
+};
+
+static const char *const MONTHS[] = {"January", "February", "March",     "April",   "May",      "June",
+                                     "July",    "August",   "September", "October", "November", "December"};
+static const char *const WEEKDAYS[] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
+
+static inline bool is_digit(unsigned char c) { return c >= '0' && c <= '9'; }
+
+// A bare width: "15" or "-15". A leading zero makes it a custom number.
+static bool compile_padding(const unsigned char *p, uint32_t length, MtlogFormatSpec *spec) {
+  uint32_t i = 0;
+  bool left = length > 1 && p[0] == '-';
+  if (left) i++;
+  if (i >= length || p[i] == '0') return false;
+  uint32_t width = 0;
+  for (; i < length; i++) {
+    if (!is_digit(p[i])) return false;
+    width = width * 10 + (p[i] - '0');
+    if (width > 255) return false;
+  }
+  spec->kind = MTLOG_FORMAT_PADDING;
+  spec->width = (uint8_t)width;
+  spec->flags = left ? MTLOG_FORMAT_LEFT : 0;
+  return true;
+}
+
+// A standard numeric format: one letter and an optional 0-99.
+static bool compile_standard_number(const unsigned char *p, uint32_t length, MtlogFormatSpec *spec) {
+  if (length > 3) return false;
+  int precision = -1;
+  if (length > 1) {
+    if (!is_digit(p[1]) || (length == 3 && !is_digit(p[2]))) return false;
+    precision = p[1] - '0';
+    if (length == 3) precision = precision * 10 + (p[2] - '0');
+  }
+
+  uint8_t style, flags = (p[0] >= 'A' && p[0] <= 'Z') ? MTLOG_FORMAT_UPPER : 0;
+  int fallback;
+  switch (p[0] | 0x20) {
+    case 'f': style = MTLOG_NUMBER_FIXED, fallback = 2; break;
+    case 'n': style = MTLOG_NUMBER_FIXED, fallback = 2, flags |= MTLOG_FORMAT_GROUPED; break;
+    case 'd': style = MTLOG_NUMBER_DECIMAL, fallback = 0; break;
+    case 'x': style = MTLOG_NUMBER_HEX, fallback = 0; break;
+    case 'e': style = MTLOG_NUMBER_EXPONENT, fallback = 6; break;
+    case 'p': style = MTLOG_NUMBER_PERCENT, fallback = 2; break;
+    case 'g': style = MTLOG_NUMBER_GENERAL, fallback = 0; break;
+    default: return false;
+  }
+  if (precision < 0) precision = fallback;
+
+  spec->kind = MTLOG_FORMAT_NUMBER;
+  spec->style = style;
+  spec->flags = flags;
+  if (style == MTLOG_NUMBER_DECIMAL || style == MTLOG_NUMBER_HEX) {
+    spec->width = (uint8_t)(precision ? precision : 1);
+  } else {
+    spec->precision = spec->min_fraction = (uint8_t)precision;
+    spec->width = 1;
+  }
+  return true;
+}
+
+// "u3", "w3", "U": level name in upper or lower case, optional length.
+static bool compile_level(const unsigned char *p, uint32_t length, MtlogFormatSpec *spec) {
+  if (length > 3 || ((p[0] | 0x20) != 'u' && (p[0] | 0x20) != 'w')) return false;
+  uint32_t width = 0;
+  for (uint32_t i = 1; i < length; i++) {
+    if (!is_digit(p[i])) return false;
+    width = width * 10 + (p[i] - '0');
+  }
+  spec->kind = MTLOG_FORMAT_LEVEL;
+  spec->flags = (p[0] | 0x20) == 'u' ? MTLOG_FORMAT_UPPER : 0;
+  spec->width = (uint8_t)width;
+  return true;
+}
+
+// Custom numeric: only '0', '#', ',', '.' and '%'. Zeros before the point set
+// the minimum integer digits; '0's and '#'s after it set the kept and
+// optional fraction digits.
+static bool compile_custom_number(const unsigned char *p, uint32_t length, MtlogFormatSpec *spec) {
+  uint32_t integer_zeros = 0, fraction_digits = 0, fraction_zeros = 0;
+  bool point = false, grouped = false, percent = false, placeholder = false;
+  for (uint32_t i = 0; i < length; i++) {
+    switch (p[i]) {
+      case '0':
+        placeholder = true;
+        if (point) fraction_zeros = ++fraction_digits;
+        else integer_zeros++;
+        break;
+      case '#':
+        placeholder = true;
+        if (point) fraction_digits++;
+        break;
+      case ',':
+        if (point) return false;
+        grouped = true;
+        break;
+      case '.':
+        if (point) return false;
+        point = true;
+        break;
+      case '%':
+        percent = true;
+        break;
+      default:
+        return false;
+    }
+  }
+  if (!placeholder || integer_zeros > 99 || fraction_digits > 99) return false;
+
+  spec->kind = MTLOG_FORMAT_NUMBER;
+  spec->style = percent ? MTLOG_NUMBER_PERCENT : MTLOG_NUMBER_FIXED;
+  spec->flags = grouped ? MTLOG_FORMAT_GROUPED : 0;
+  spec->precision = (uint8_t)fraction_digits;
+  spec->min_fraction = (uint8_t)fraction_zeros;
+  spec->width = (uint8_t)integer_zeros;
+  return true;
+}
+
+typedef struct {
+  MtlogFormatSpec *spec;
+  bool overflow;
+  bool invalid;  // a letter the pattern language does not define
+  bool anchored; // a field only a date format would have
+} DateBuilder;
+
+static void add_op(DateBuilder *builder, uint8_t op, uint8_t argument) {
+  MtlogFormatSpec *spec = builder->spec;
+  if (spec->op_count == MTLOG_FORMAT_MAX_OPS) {
+    builder->overflow = true;
+    return;
+  }
+  spec->ops[spec->op_count][0] = op;
+  spec->ops[spec->op_count][1] = argument;
+  spec->op_count++;
+}
+
+static void add_literal(DateBuilder *builder, const unsigned char *text, uint32_t length) {
+  MtlogFormatSpec *spec = builder->spec;
+  if (length == 0) return;
+  if (spec->literal_length + length > MTLOG_FORMAT_MAX_LITERAL) {
+    builder->overflow = true;
+    return;
+  }
+  memcpy(spec->literal + spec->literal_length, text, length);
+  spec->literal_length += (uint8_t)length;
+  if (spec->op_count && spec->ops[spec->op_count - 1][0] == DATE_LITERAL) {
+    spec->ops[spec->op_count - 1][1] += (uint8_t)length;
+    return;
+  }
+  add_op(builder, DATE_LITERAL, (uint8_t)length);
+}
+
+static uint32_t run_length(const unsigned char *p, uint32_t length, uint32_t i) {
+  uint32_t n = 1;
+  while (i + n < length && p[i + n] == p[i]) n++;
+  return n;
+}
+
+// .NET custom pattern. Letters it does not define must be quoted, and one of
+// y, M, d, H, h, m or s must be doubled (yyyy, MM, HH, ...): single letters
+// such as "ms" are too easily something else.
+static void compile_dotnet_date(const unsigned char *p, uint32_t length, DateBuilder *builder) {
+  for (uint32_t i = 0; i < length && !builder->overflow && !builder->invalid;) {
+    unsigned char c = p[i];
+    uint32_t n = run_length(p, length, i);
+    uint8_t two = n > 1 ? 2 : 1;
+    if (n > 1 && strchr("yMdHhms", c)) builder->anchored = true;
+    switch (c) {
+      case 'y': add_op(builder, DATE_YEAR, n >= 3 ? 4 : (uint8_t)n); break;
+      case 'M': add_op(builder, n >= 3 ? DATE_MONTH_NAME : DATE_MONTH, n >= 3 ? (n > 3) : two); break;
+      case 'd': add_op(builder, n >= 3 ? DATE_WEEKDAY : DATE_DAY, n >= 3 ? (n > 3) : two); break;
+      case 'H': add_op(builder, DATE_HOUR24, two); break;
+      case 'h': add_op(builder, DATE_HOUR12, two); break;
+      case 'm': add_op(builder, DATE_MINUTE, two); break;
+      case 's': add_op(builder, DATE_SECOND, two); break;
+      case 'f': add_op(builder, DATE_FRACTION, (uint8_t)(n > 9 ? 9 : n)); break;
+      case 'F': {
+        // Like Go's '.999', an empty fraction takes the '.' before it along.
+        MtlogFormatSpec *spec = builder->spec;
+        uint8_t *last = spec->op_count ? spec->ops[spec->op_count - 1] : NULL;
+        bool dot = last && last[0] == DATE_LITERAL && spec->literal[spec->literal_length - 1] == '.';
+        if (dot) {
+          spec->literal_length--;
+          if (--last[1] == 0) spec->op_count--;
+        }
+        add_op(builder, dot ? DATE_DOT_FRACTION_TRIM : DATE_FRACTION_TRIM, (uint8_t)(n > 9 ? 9 : n));
+        break;
+      }
+      case 't': add_op(builder, DATE_AMPM, n == 1 ? 2 : 0); break;
+      case 'z': add_op(builder, DATE_ZONE, 1); break;
+      case 'K':
+        add_op(builder, DATE_ZONE, 0);
+        n = 1;
+        break;
+      case '\'':
+      case '"': {
+        uint32_t end = i + 1;
+        while (end < length && p[end] != c) end++;
+        add_literal(builder, p + i + 1, end - i - 1);
+        n = end < length ? end - i + 1 : end - i;
+        break;
+      }
+      case '\\':
+        add_literal(builder, p + i + 1, i + 1 < length ? 1 : 0);
+        n = i + 1 < length ? 2 : 1;
+        break;
+      default:
+        if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') builder->invalid = true;
+        add_literal(builder, p + i, 1);
+        n = 1;
+        break;
+    }
+    i += n;
+  }
+}
+
+static bool starts_with(const unsigned char *p, uint32_t length, uint32_t i, const char *prefix) {
+  uint32_t n = (uint32_t)strlen(prefix);
+  return i + n <= length && memcmp(p + i, prefix, n) == 0;
+}
+
+// Go reference layout (Mon Jan 2 15:04:05 MST 2006), following the chunk
+// rules of Go's time package for the tokens below. It must have a token
+// longer than one character other than PM: a lone digit ("F2 ", "N200") is
+// far more likely a mistyped number than a layout.
+static void compile_go_date(const unsigned char *p, uint32_t length, DateBuilder *builder) {
+  static const struct {
+    const char *token;
+    uint8_t op;
+    uint8_t argument;
+  } TOKENS[] = {
+    {"January", DATE_MONTH_NAME, 1}, {"Jan", DATE_MONTH_NAME, 0}, {"Monday", DATE_WEEKDAY, 1},
+    {"Mon", DATE_WEEKDAY, 0},        {"MST", DATE_ZONE, 3},       {"2006", DATE_YEAR, 4},
+    {"01", DATE_MONTH, 2},           {"02", DATE_DAY, 2},         {"03", DATE_HOUR12, 2},
+    {"04", DATE_MINUTE, 2},          {"05", DATE_SECOND, 2},      {"06", DATE_YEAR, 2},
+    {"15", DATE_HOUR24, 2},          {"1", DATE_MONTH, 1},        {"2", DATE_DAY, 1},
+    {"_2", DATE_DAY, 0},
+    {"3", DATE_HOUR12, 1},           {"4", DATE_MINUTE, 1},       {"5", DATE_SECOND, 1},
+    {"PM", DATE_AMPM, 0},            {"pm", DATE_AMPM, 1},        {"Z07:00", DATE_ZONE, 0},
+    {"Z0700", DATE_ZONE, 0},         {"-07:00", DATE_ZONE, 1},    {"-0700", DATE_ZONE, 2},
+  };
+
+  for (uint32_t i = 0; i < length && !builder->overflow;) {
+    // Fractional seconds: '.' or ',' then a run of '0' or '9' not followed by
+    // another digit.
+    if ((p[i] == '.' || p[i] == ',') && i + 1 < length && (p[i + 1] == '0' || p[i + 1] == '9')) {
+      uint32_t n = run_length(p, length, i + 1);
+      if (i + 1 + n >= length || !is_digit(p[i + 1 + n])) {
+        uint8_t digits = (uint8_t)(n > 9 ? 9 : n);
+        if (p[i + 1] == '0') {
+          add_literal(builder, p + i, 1);
+          add_op(builder, DATE_FRACTION, digits);
+        } else {
+          add_op(builder, DATE_DOT_FRACTION_TRIM, digits);
+        }
+        i += 1 + n;
+        continue;
+      }
+    }
+
+    size_t t = 0;
+    for (; t < sizeof(TOKENS) / sizeof(TOKENS[0]); t++) {
+      if (starts_with(p, length, i, TOKENS[t].token)) break;
+    }
+    if (t < sizeof(TOKENS) / sizeof(TOKENS[0])) {
+      uint32_t n = (uint32_t)strlen(TOKENS[t].token);
+      if (n > 1 && TOKENS[t].op != DATE_AMPM) builder->anchored = true;
+      add_op(builder, TOKENS[t].op, TOKENS[t].argument);
+      i += n;
+    } else {
+      add_literal(builder, p + i, 1);
+      i++;
+    }
+  }
+}
+
+static bool compile_date(const unsigned char *p, uint32_t length, MtlogFormatSpec *spec) {
+  bool go = false;
+  for (uint32_t i = 0; i < length; i++) go |= is_digit(p[i]);
+
+  DateBuilder builder = {spec, false, false, false};
+  if (go) compile_go_date(p, length, &builder);
+  else compile_dotnet_date(p, length, &builder);
+  if (builder.overflow || builder.invalid || !builder.anchored) return false;
+  spec->kind = MTLOG_FORMAT_DATE;
+  return true;
+}
+
+void mtlog_format_spec_compile(const char *format, uint32_t length, MtlogFormatSpec *spec) {
+  const unsigned char *p = (const unsigned char *)format;
+  memset(spec, 0, sizeof(*spec));
+  if (length == 0) return;
+  if (compile_padding(p, length, spec) || compile_standard_number(p, length, spec) ||
+      compile_level(p, length, spec) || compile_custom_number(p, length, spec)) {
+    return;
+  }
+  if (compile_date(p, length, spec)) return;
+  memset(spec, 0, sizeof(*spec));
+  spec->kind = MTLOG_FORMAT_UNKNOWN;
+}
+
+// Output
+
+typedef struct {
+  char *data;
+  uint32_t length;
+} Writer;
+
+static inline void put_char(Writer *w, char c) { w->data[w->length++] = c; }
+
+static inline void put_text(Writer *w, const char *text, uint32_t length) {
+  memcpy(w->data + w->length, text, length);
+  w->length += length;
+}
+
+static void put_unsigned(Writer *w, uint64_t value, uint32_t min_digits) {
+  char digits[20];
+  uint32_t n = 0;
+  do {
+    digits[n++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value);
+  for (uint32_t i = n; i < min_digits; i++) put_char(w, '0');
+  while (n) put_char(w, digits[--n]);
+}
+
+static void put_hex(Writer *w, uint64_t value, uint32_t min_digits, bool upper) {
+  const char *alphabet = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  char digits[16];
+  uint32_t n = 0;
+  do {
+    digits[n++] = alphabet[value & 15];
+    value >>= 4;
+  } while (value);
+  for (uint32_t i = n; i < min_digits; i++) put_char(w, '0');
+  while (n) put_char(w, digits[--n]);
+}
+
+// Lay out a fixed-point number from its digits: minimum integer digits,
+// grouping, fraction trimmed to min_fraction and the percent sign.
+static void put_fixed(Writer *w, const MtlogFormatSpec *spec, bool negative, const char *integer,
+                      uint32_t integer_length, const char *fraction, uint32_t fraction_length) {
+  while (fraction_length > spec->min_fraction && fraction[fraction_length - 1] == '0') fraction_length--;
+  while (integer_length > 1 && integer[0] == '0') integer++, integer_length--;
+  if (integer_length == 1 && integer[0] == '0' && spec->width == 0) integer_length = 0;
+
+  if (negative) put_char(w, '-');
+  uint32_t digits = integer_length > spec->width ? integer_length : spec->width;
+  for (uint32_t i = 0; i < digits; i++) {
+    put_char(w, i < digits - integer_length ? '0' : integer[i - (digits - integer_length)]);
+    if ((spec->flags & MTLOG_FORMAT_GROUPED) && i + 1 < digits && (digits - i - 1) % 3 == 0) put_char(w, ',');
+  }
+  if (fraction_length) {
+    put_char(w, '.');
+    put_text(w, fraction, fraction_length);
+  }
+  if (spec->style == MTLOG_NUMBER_PERCENT) put_char(w, '%');
+}
+
+static uint32_t put_special(Writer *w, double value) {
+  if (isnan(value)) put_text(w, "NaN", 3);
+  else put_text(w, value > 0 ? "+Inf" : "-Inf", 4);
+  return w->length;
+}
+
+// Shortest of %.15g and %.17g that reads back exactly.
+static uint32_t put_shortest(Writer *w, double value, bool upper) {
+  char digits[32];
+  int length = snprintf(digits, sizeof(digits), upper ? "%.15G" : "%.15g", value);
+  if (strtod(digits, NULL) != value) length = snprintf(digits, sizeof(digits), upper ? "%.17G" : "%.17g", value);
+  put_text(w, digits, (uint32_t)length);
+  return w->length;
+}
+
+// Digits of `magnitude` rounded to `precision` fraction digits, as "%.*f"
+// would write them, without stdio. Gives up (returns 0) on large values and on
+// products too close to a rounding tie to decide from the scaled double alone.
+static uint32_t fixed_digits(double magnitude, int precision, char *digits) {
+  static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12};
+  if (precision >= (int)(sizeof(POW10) / sizeof(POW10[0]))) return 0;
+  double scaled = magnitude * POW10[precision];
+  if (!(scaled < 4398046511104.0)) return 0; // 2^42: keeps the product's error under 2^-10
+  uint64_t whole = (uint64_t)scaled;
+  double rest = scaled - (double)whole;
+  if (rest > 0.5 - 0x1p-9 && rest < 0.5 + 0x1p-9) return 0;
+  if (rest > 0.5) whole++;
+
+  char reversed[32];
+  uint32_t count = 0;
+  do {
+    reversed[count++] = (char)('0' + whole % 10);
+    whole /= 10;
+  } while (whole || count <= (uint32_t)precision);
+  uint32_t length = 0;
+  while (count) {
+    if (count == (uint32_t)precision) digits[length++] = '.';
+    digits[length++] = reversed[--count];
+  }
+  return length;
+}
+
+static bool is_number(const MtlogFormatSpec *spec) { return spec && spec->kind == MTLOG_FORMAT_NUMBER; }
+
+uint32_t mtlog_format_uint(const MtlogFormatSpec *spec, uint64_t value, char *out) {
+  Writer w = {out, 0};
+  if (!is_number(spec)) {
+    put_unsigned(&w, value, 1);
+    return w.length;
+  }
+  switch (spec->style) {
+    case MTLOG_NUMBER_DECIMAL:
+      put_unsigned(&w, value, spec->width);
+      return w.length;
+    case MTLOG_NUMBER_HEX:
+      put_hex(&w, value, spec->width, spec->flags & MTLOG_FORMAT_UPPER);
+      return w.length;
+    case MTLOG_NUMBER_FIXED: {
+      // Exact, without a detour through double.
+      char integer[20];
+      Writer digits = {integer, 0};
+      put_unsigned(&digits, value, 1);
+      char fraction[99];
+      memset(fraction, '0', spec->precision);
+      put_fixed(&w, spec, false, integer, digits.length, fraction, spec->precision);
+      return w.length;
+    }
+    default:
+      return mtlog_format_double(spec, (double)value, out);
+  }
+}
+
+uint32_t mtlog_format_int(const MtlogFormatSpec *spec, int64_t value, char *out) {
+  if (value >= 0) return mtlog_format_uint(spec, (uint64_t)value, out);
+  if (is_number(spec)) {
+    // Hex shows the two's complement, as .NET does.
+    if (spec->style == MTLOG_NUMBER_HEX) return mtlog_format_uint(spec, (uint64_t)value, out);
+    if (spec->style != MTLOG_NUMBER_DECIMAL && spec->style != MTLOG_NUMBER_FIXED) {
+      return mtlog_format_double(spec, (double)value, out);
+    }
+  }
+  out[0] = '-';
+  return 1 + mtlog_format_uint(spec, 0 - (uint64_t)value, out + 1);
+}
+
+uint32_t mtlog_format_double(const MtlogFormatSpec *spec, double value, char *out) {
+  Writer w = {out, 0};
+  if (!isfinite(value)) return put_special(&w, value);
+  if (!is_number(spec)) return put_shortest(&w, value, false);
+
+  bool upper = spec->flags & MTLOG_FORMAT_UPPER;
+  switch (spec->style) {
+    case MTLOG_NUMBER_DECIMAL:
+    case MTLOG_NUMBER_HEX:
+      // Integral styles round (D) or truncate (X) to an integer when it fits.
+      if (value > -9.2e18 && value < 9.2e18) {
+        double rounded = value < 0 ? value - 0.5 : value + 0.5;
+        int64_t integer = (int64_t)(spec->style == MTLOG_NUMBER_DECIMAL ? rounded : value);
+        return mtlog_format_int(spec, integer, out);
+      }
+      // fallthrough
+    case MTLOG_NUMBER_FIXED:
+    case MTLOG_NUMBER_PERCENT: {
+      // Up to 309 integer digits and 99 fraction digits.
+      char digits[420];
+      double scaled = spec->style == MTLOG_NUMBER_PERCENT ? value * 100 : value;
+      int precision = spec->style == MTLOG_NUMBER_FIXED || spec->style == MTLOG_NUMBER_PERCENT ? spec->precision : 0;
+      if (!isfinite(scaled)) return put_special(&w, scaled);
+      double magnitude = scaled < 0 ? -scaled : scaled;
+      int length = (int)fixed_digits(magnitude, precision, digits);
+      if (!length) length = snprintf(digits, sizeof(digits), "%.*f", precision, magnitude);
+      const char *point = memchr(digits, '.', (size_t)length);
+      uint32_t integer_length = point ? (uint32_t)(point - digits) : (uint32_t)length;
+      const char *fraction = point ? point + 1 : digits + length;
+      put_fixed(&w, spec, signbit(value) && scaled != 0, digits, integer_length, fraction,
+                (uint32_t)(digits + length - fraction));
+      return w.length;
+    }
+    case MTLOG_NUMBER_EXPONENT: {
+      char digits[128];
+      int length = snprintf(digits, sizeof(digits), upper ? "%.*E" : "%.*e", spec->precision, value);
+      put_text(&w, digits, (uint32_t)length);
+      return w.length;
+    }
+    default: {
+      if (spec->precision == 0) return put_shortest(&w, value, upper);
+      char digits[128];
+      int length = snprintf(digits, sizeof(digits), upper ? "%.*G" : "%.*g", spec->precision, value);
+      put_text(&w, digits, (uint32_t)length);
+      return w.length;
+    }
+  }
+}
+
+static int64_t floor_div(int64_t a, int64_t b) { return a / b - (a % b != 0 && (a < 0) != (b < 0)); }
+
+// Days since 1970-01-01 to a proleptic Gregorian date (H. Hinnant's algorithm).
+static void civil_from_days(int64_t days, int64_t *year, uint32_t *month, uint32_t *day) {
+  days += 719468;
+  int64_t era = floor_div(days, 146097);
+  uint32_t doe = (uint32_t)(days - era * 146097);
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+  *day = doy - (153 * mp + 2) / 5 + 1;
+  *month = mp < 10 ? mp + 3 : mp - 9;
+  *year = (int64_t)yoe + era * 400 + (*month <= 2);
+}
+
+// RFC 3339 with nanoseconds, trailing zeros dropped, as Go's RFC3339Nano.
+static const MtlogFormatSpec RFC3339_NANO = {
+  .kind = MTLOG_FORMAT_DATE,
+  .op_count = 13,
+  .literal_length = 5,
+  .ops = {{DATE_YEAR, 4}, {DATE_LITERAL, 1}, {DATE_MONTH, 2}, {DATE_LITERAL, 1}, {DATE_DAY, 2},
+          {DATE_LITERAL, 1}, {DATE_HOUR24, 2}, {DATE_LITERAL, 1}, {DATE_MINUTE, 2}, {DATE_LITERAL, 1},
+          {DATE_SECOND, 2}, {DATE_DOT_FRACTION_TRIM, 9}, {DATE_ZONE, 0}},
+  .literal = "--T::",
+};
+
+static void put_fraction(Writer *w, uint32_t nanos, uint32_t digits, bool trim, bool dot) {
+  char text[9];
+  for (int i = 8; i >= 0; i--) {
+    text[i] = (char)('0' + nanos % 10);
+    nanos /= 10;
+  }
+  if (trim) {
+    while (digits && text[digits - 1] == '0') digits--;
+    if (dot && digits) put_char(w, '.');
+  }
+  put_text(w, text, digits);
+}
+
+uint32_t mtlog_format_time(const MtlogFormatSpec *spec, int64_t unix_nanos, char *out) {
+  if (!spec || spec->kind != MTLOG_FORMAT_DATE) spec = &RFC3339_NANO;
+
+  int64_t seconds = floor_div(unix_nanos, 1000000000);
+  uint32_t nanos = (uint32_t)(unix_nanos - seconds * 1000000000);
+  int64_t days = floor_div(seconds, 86400);
+  uint32_t second_of_day = (uint32_t)(seconds - days * 86400);
+  uint32_t hour = second_of_day / 3600, minute = second_of_day / 60 % 60, second = second_of_day % 60;
+  uint32_t weekday = (uint32_t)(days + 4 - floor_div(days + 4, 7) * 7); // 1970-01-01 was a Thursday
+  int64_t year;
+  uint32_t month, day;
+  civil_from_days(days, &year, &month, &day);
+
+  Writer w = {out, 0};
+  const char *literal = spec->literal;
+  for (uint32_t i = 0; i < spec->op_count; i++) {
+    uint8_t argument = spec->ops[i][1];
+    switch (spec->ops[i][0]) {
+      case DATE_LITERAL:
+        put_text(&w, literal, argument);
+        literal += argument;
+        break;
+      case DATE_YEAR:
+        if (argument == 4) {
+          if (year < 0) put_char(&w, '-');
+          put_unsigned(&w, (uint64_t)(year < 0 ? -year : year), 4);
+        } else {
+          put_unsigned(&w, (uint64_t)((year % 100 + 100) % 100), argument);
+        }
+        break;
+      case DATE_MONTH: put_unsigned(&w, month, argument); break;
+      case DATE_MONTH_NAME: {
+        const char *name = MONTHS[month - 1];
+        put_text(&w, name, argument ? (uint32_t)strlen(name) : 3);
+        break;
+      }
+      case DATE_DAY:
+        if (argument == 0 && day < 10) put_char(&w, ' ');
+        put_unsigned(&w, day, argument ? argument : 1);
+        break;
+      case DATE_WEEKDAY: {
+        const char *name = WEEKDAYS[weekday];
+        put_text(&w, name, argument ? (uint32_t)strlen(name) : 3);
+        break;
+      }
+      case DATE_HOUR24: put_unsigned(&w, hour, argument); break;
+      case DATE_HOUR12: put_unsigned(&w, hour % 12 ? hour % 12 : 12, argument); break;
+      case DATE_MINUTE: put_unsigned(&w, minute, argument); break;
+      case DATE_SECOND: put_unsigned(&w, second, argument); break;
+      case DATE_FRACTION: put_fraction(&w, nanos, argument, false, false); break;
+      case DATE_FRACTION_TRIM: put_fraction(&w, nanos, argument, true, false); break;
+      case DATE_DOT_FRACTION_TRIM: put_fraction(&w, nanos, argument, true, true); break;
+      case DATE_AMPM:
+        if (argument == 2) put_char(&w, hour < 12 ? 'A' : 'P');
+        else put_text(&w, hour < 12 ? (argument ? "am" : "AM") : (argument ? "pm" : "PM"), 2);
+        break;
+      case DATE_ZONE:
+        switch (argument) {
+          case 0: put_char(&w, 'Z'); break;
+          case 1: put_text(&w, "+00:00", 6); break;
+          case 2: put_text(&w, "+0000", 5); break;
+          default: put_text(&w, "UTC", 3); break;
+        }
+        break;
+    }
+  }
+  return w.length;
+}
+
+uint32_t mtlog_format_level(const MtlogFormatSpec *spec, const char *level, uint32_t length, char *out) {
+  static const struct {
+    const char *name;
+    const char *abbreviation;
+  } LEVELS[] = {
+    {"verbose", "VRB"}, {"trace", "TRC"}, {"debug", "DBG"}, {"information", "INF"}, {"info", "INF"},
+    {"warning", "WRN"}, {"warn", "WRN"},  {"error", "ERR"}, {"fatal", "FTL"},       {"panic", "PNC"},
+  };
+
+  if (length > MTLOG_FORMAT_MAX_OUTPUT) length = MTLOG_FORMAT_MAX_OUTPUT;
+  if (!spec || spec->kind != MTLOG_FORMAT_LEVEL) {
+    memcpy(out, level, length);
+    return length;
+  }
+
+  const char *text = level;
+  if (spec->width == 3) {
+    for (size_t i = 0; i < sizeof(LEVELS) / sizeof(LEVELS[0]); i++) {
+      size_t n = strlen(LEVELS[i].name);
+      bool match = n == length;
+      for (size_t k = 0; match && k < n; k++) match = (level[k] | 0x20) == LEVELS[i].name[k];
+      if (match) {
+        text = LEVELS[i].abbreviation;
+        length = 3;
+        break;
+      }
+    }
+  }
+  if (spec->width && length > spec->width) length = spec->width;
+
+  bool upper = spec->flags & MTLOG_FORMAT_UPPER;
+  for (uint32_t i = 0; i < length; i++) {
+    char c = text[i];
+    if (upper && c >= 'a' && c <= 'z') c = (char)(c - 32);
+    if (!upper && c >= 'A' && c <= 'Z') c = (char)(c + 32);
+    out[i] = c;
+  }
+  return length;
+}
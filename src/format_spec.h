@@ -0,0 +1,108 @@
+#ifndef TREE_SITTER_MTLOG_FORMAT_SPEC_H_
+#define TREE_SITTER_MTLOG_FORMAT_SPEC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Compiled format specifiers.
+//
+// The grammar keeps a property's format (`F2` in `{Amount:F2}`) as one opaque
+// token. mtlog_format_spec_compile interprets it once into a fixed-size,
+// pointer-free descriptor, and the mtlog_format_* writers below format values
+// from the descriptor alone, so per-event code never re-reads the string.
+//
+//   Kind      Examples                        Meaning
+//   NUMBER    F2 N0 D8 X4 x E3 P1 G           standard numeric, optional precision
+//             0.00  #,##0.0#  000  0%         custom numeric
+//   DATE      yyyy-MM-dd HH:mm:ss.fff         .NET custom date and time
+//             2006-01-02T15:04:05.000Z07:00   Go reference layout
+//   LEVEL     u3 w3 U                         level name, upper or lower case,
+//                                             abbreviated to the given length
+//   PADDING   15 -15                          right- or left-align to a width
+//   UNKNOWN   anything else                   left to the caller
+//
+// A format with digits is read as a Go layout and one without as a .NET
+// pattern, and is a date only if it has a field no other format would use: a
+// Go reference token (2006, 01, 02, 15, 04, 05, Jan, MST, ...) or a doubled
+// .NET letter (yyyy, MM, dd, HH, mm, ss). A number is a padding width unless
+// it starts with a zero, which makes it custom numeric ("0", "000").
+//
+//   MtlogFormatSpec spec;
+//   mtlog_format_spec_compile("F2", 2, &spec);        // once per template
+//   char out[MTLOG_FORMAT_MAX_OUTPUT];
+//   uint32_t n = mtlog_format_double(&spec, 3.14159, out); // "3.14"
+
+typedef enum {
+  MTLOG_FORMAT_NONE,
+  MTLOG_FORMAT_NUMBER,
+  MTLOG_FORMAT_DATE,
+  MTLOG_FORMAT_LEVEL,
+  MTLOG_FORMAT_PADDING,
+  MTLOG_FORMAT_UNKNOWN,
+} MtlogFormatKind;
+
+typedef enum {
+  MTLOG_NUMBER_FIXED,    // F, custom 0.00
+  MTLOG_NUMBER_DECIMAL,  // D, custom 000
+  MTLOG_NUMBER_HEX,      // X
+  MTLOG_NUMBER_EXPONENT, // E
+  MTLOG_NUMBER_PERCENT,  // P, custom 0%
+  MTLOG_NUMBER_GENERAL,  // G
+} MtlogNumberStyle;
+
+enum {
+  MTLOG_FORMAT_UPPER = 1 << 0,   // X, E, u: upper-case letters
+  MTLOG_FORMAT_GROUPED = 1 << 1, // N, custom #,##0: thousands separators
+  MTLOG_FORMAT_LEFT = 1 << 2,    // padding: align left
+};
+
+#define MTLOG_FORMAT_MAX_OPS 24
+#define MTLOG_FORMAT_MAX_LITERAL 32
+
+// Enough for any value written by the functions below.
+#define MTLOG_FORMAT_MAX_OUTPUT 640
+
+typedef struct {
+  uint8_t kind;         // MtlogFormatKind
+  uint8_t style;        // MtlogNumberStyle
+  uint8_t flags;
+  uint8_t precision;    // number: fraction digits (significant digits for G)
+  uint8_t min_fraction; // number: trailing zeros kept down to this many (custom '#')
+  uint8_t width;        // number: minimum integer digits; level: length; padding: width
+  uint8_t op_count;     // date
+  uint8_t literal_length;
+  uint8_t ops[MTLOG_FORMAT_MAX_OPS][2]; // date: {op, argument}
+  char literal[MTLOG_FORMAT_MAX_LITERAL]; // date: literal text, consumed in op order
+} MtlogFormatSpec;
+
+// Compile `length` bytes of format text. Never fails: text that is not
+// understood, or a date pattern too long for the descriptor, compiles to
+// MTLOG_FORMAT_UNKNOWN.
+void mtlog_format_spec_compile(const char *format, uint32_t length, MtlogFormatSpec *spec);
+
+// Writers. Each fills `out` (MTLOG_FORMAT_MAX_OUTPUT bytes) and returns the
+// length written. A spec of a kind that does not apply to the value writes it
+// unformatted.
+uint32_t mtlog_format_int(const MtlogFormatSpec *spec, int64_t value, char *out);
+uint32_t mtlog_format_uint(const MtlogFormatSpec *spec, uint64_t value, char *out);
+uint32_t mtlog_format_double(const MtlogFormatSpec *spec, double value, char *out);
+
+// `unix_nanos` is nanoseconds since 1970-01-01T00:00:00Z, formatted in UTC.
+// With no DATE spec it is written as RFC 3339 with nanoseconds.
+uint32_t mtlog_format_time(const MtlogFormatSpec *spec, int64_t unix_nanos, char *out);
+
+// Level names (Verbose, Debug, Information, ...) abbreviate to the
+// conventional three letters (VRB, DBG, INF, WRN, ERR, FTL) for a width of 3;
+// other names and widths are truncated. Names longer than
+// MTLOG_FORMAT_MAX_OUTPUT are truncated to it.
+uint32_t mtlog_format_level(const MtlogFormatSpec *spec, const char *level, uint32_t length, char *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_FORMAT_SPEC_H_
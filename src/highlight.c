@@ -0,0 +1,71 @@
+#include "highlight.h"
+
+typedef struct {
+  uint16_t parent; // symbol of the parent node, or 0 for any
+  uint16_t field;  // field the node sits in, or 0 for any
+  uint16_t capture;
+} HighlightRule;
+
+typedef struct {
+  uint16_t index;
+  uint16_t count;
+} HighlightSlice;
+
+#include "highlight_table.h"
+
+// Parent symbols kept on the stack; deeper nodes ask the runtime.
+#define MAX_DEPTH 64
+
+#define NO_CAPTURE UINT32_MAX
+
+static uint32_t capture_of(TSSymbol symbol, TSSymbol parent, TSFieldId field) {
+  if (symbol >= HIGHLIGHT_SYMBOL_COUNT) return NO_CAPTURE; // ERROR
+  HighlightSlice slice = HIGHLIGHT_SLICES[symbol];
+  for (uint32_t i = slice.index; i < (uint32_t)slice.index + slice.count; i++) {
+    const HighlightRule *rule = &HIGHLIGHT_RULES[i];
+    if ((rule->parent == 0 || rule->parent == parent) && (rule->field == 0 || rule->field == field)) {
+      return rule->capture;
+    }
+  }
+  return NO_CAPTURE;
+}
+
+uint32_t mtlog_highlight(TSNode root, MtlogHighlightCallback callback, void *context) {
+  TSSymbol parents[MAX_DEPTH];
+  uint32_t depth = 0;
+  uint32_t delivered = 0;
+
+  TSTreeCursor cursor = ts_tree_cursor_new(root);
+  for (;;) {
+    TSNode node = ts_tree_cursor_current_node(&cursor);
+    TSSymbol symbol = ts_node_symbol(node);
+    if (depth > 0) {
+      TSSymbol parent = depth <= MAX_DEPTH ? parents[depth - 1] : ts_node_symbol(ts_node_parent(node));
+      uint32_t capture = capture_of(symbol, parent, ts_tree_cursor_current_field_id(&cursor));
+      MtlogHighlight highlight = {{ts_node_start_byte(node), ts_node_end_byte(node)}, capture};
+      if (capture != NO_CAPTURE && highlight.span.start < highlight.span.end) {
+        delivered++;
+        if (!callback(&highlight, context)) break;
+      }
+    }
+
+    if (ts_tree_cursor_goto_first_child(&cursor)) {
+      if (depth < MAX_DEPTH) parents[depth] = symbol;
+      depth++;
+      continue;
+    }
+    while (depth > 0 && !ts_tree_cursor_goto_next_sibling(&cursor)) {
+      ts_tree_cursor_goto_parent(&cursor);
+      depth--;
+    }
+    if (depth == 0) break;
+  }
+  ts_tree_cursor_delete(&cursor);
+  return delivered;
+}
+
+uint32_t mtlog_highlight_capture_count(void) { return HIGHLIGHT_CAPTURE_COUNT; }
+
+const char *mtlog_highlight_capture_name(uint32_t capture) {
+  return capture < HIGHLIGHT_CAPTURE_COUNT ? HIGHLIGHT_NAMES[capture] : NULL;
+}
@@ -0,0 +1,59 @@
+#ifndef TREE_SITTER_MTLOG_HIGHLIGHT_H_
+#define TREE_SITTER_MTLOG_HIGHLIGHT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#include "properties.h"
+
+// Syntax highlighting without TSQuery (needs the runtime).
+//
+// queries/highlights.scm only ever captures a node by its own symbol, its
+// parent's symbol and the field it sits in, so it compiles down to a table
+// from symbol to (parent, field, capture) rules: src/highlight_table.h,
+// generated from src/parser.c and the query by script/highlight_table.js.
+// Highlighting a tree is then one cursor walk with a table lookup per node,
+// with no query to compile at startup and no match state per node:
+//
+//   static bool on_highlight(const MtlogHighlight *highlight, void *context) {
+//     printf("%u-%u %s\n", highlight->span.start, highlight->span.end,
+//            mtlog_highlight_capture_name(highlight->capture));
+//     return true; // false stops the walk
+//   }
+//
+//   mtlog_highlight(ts_tree_root_node(tree), on_highlight, NULL);
+//
+// Each node gets the capture of the first pattern in the query that matches
+// it, as `tree-sitter highlight` does. Highlights arrive in document order
+// with an enclosing highlight before the ones nested in it (a dotted name
+// before its dots). Empty spans, such as MISSING nodes, are not reported.
+
+typedef struct {
+  MtlogSpan span;
+  uint32_t capture; // index of the capture name, below mtlog_highlight_capture_count()
+} MtlogHighlight;
+
+// Receives each highlight in order; return false to stop the walk.
+typedef bool (*MtlogHighlightCallback)(const MtlogHighlight *highlight, void *context);
+
+// Report the highlights of the tree under `root`. Returns the number of
+// highlights delivered.
+uint32_t mtlog_highlight(TSNode root, MtlogHighlightCallback callback, void *context);
+
+// The number of distinct capture names in highlights.scm.
+uint32_t mtlog_highlight_capture_count(void);
+
+// The name of a capture without the '@', e.g. "variable.parameter", or NULL
+// if `capture` is out of range.
+const char *mtlog_highlight_capture_name(uint32_t capture);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_HIGHLIGHT_H_
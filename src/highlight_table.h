@@ -0,0 +1,60 @@
+// Generated by script/highlight_table.js from src/parser.c and
+// queries/highlights.scm. Do not edit.
+
+#ifndef TREE_SITTER_MTLOG_HIGHLIGHT_TABLE_H_
+#define TREE_SITTER_MTLOG_HIGHLIGHT_TABLE_H_
+
+#define HIGHLIGHT_SYMBOL_COUNT 27
+#define HIGHLIGHT_CAPTURE_COUNT 9
+
+static const char *const HIGHLIGHT_NAMES[HIGHLIGHT_CAPTURE_COUNT] = {
+  "punctuation.bracket",
+  "punctuation.special",
+  "keyword.operator",
+  "variable.parameter",
+  "number",
+  "punctuation.delimiter",
+  "constant.builtin",
+  "variable.member",
+  "string.special",
+};
+
+// Per symbol, in query order: {parent symbol or 0, field or 0, capture}.
+static const HighlightRule HIGHLIGHT_RULES[] = {
+  {0, 0, 0}, // "open_brace"
+  {18, 0, 5}, // "." in go_property
+  {23, 0, 5}, // "." in dotted_name
+  {0, 0, 1}, // "open_go"
+  {0, 0, 1}, // "close_go"
+  {0, 0, 1}, // "open_builtin"
+  {16, 4, 3}, // "identifier" in property
+  {18, 4, 3}, // "identifier" in go_property
+  {19, 4, 6}, // "identifier" in builtin_property
+  {24, 2, 8}, // "identifier" in format_spec
+  {16, 4, 4}, // "numeric_index" in property
+  {18, 4, 4}, // "numeric_index" in go_property
+  {24, 0, 5}, // ":" in format_spec
+  {0, 0, 0}, // "close_brace"
+  {0, 0, 1}, // "close_builtin"
+  {16, 3, 2}, // "hint_symbol" in property
+  {16, 4, 7}, // "dotted_name" in property
+  {18, 4, 7}, // "dotted_name" in go_property
+  {19, 4, 7}, // "dotted_name" in builtin_property
+};
+
+static const HighlightSlice HIGHLIGHT_SLICES[HIGHLIGHT_SYMBOL_COUNT] = {
+  [1] = {0, 1},
+  [3] = {1, 2},
+  [4] = {3, 1},
+  [5] = {4, 1},
+  [6] = {5, 1},
+  [9] = {6, 4},
+  [10] = {10, 2},
+  [11] = {12, 1},
+  [17] = {13, 1},
+  [20] = {14, 1},
+  [21] = {15, 1},
+  [23] = {16, 3},
+};
+
+#endif // TREE_SITTER_MTLOG_HIGHLIGHT_TABLE_H_
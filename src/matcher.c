@@ -0,0 +1,492 @@
+#include "matcher.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NOT_FOUND UINT32_MAX
+#define GRAM 4
+
+// A template is property_count + 1 pieces: the literal text before each
+// property, then the text after the last one. Any piece can be empty.
+typedef struct {
+  uint32_t offset; // into bytes
+  uint32_t length;
+} Piece;
+
+typedef struct {
+  uint32_t piece; // first piece
+  uint32_t property_count;
+  uint32_t literal_bytes; // specificity: the sum of the piece lengths
+} Template;
+
+typedef enum {
+  PLACE_ANYWHERE,
+  PLACE_HEAD, // the anchor is in the head piece, which starts the line
+  PLACE_TAIL, // the anchor is in the tail piece, which ends the line
+} Placement;
+
+// A template as seen from its anchor, with enough of it inline to turn most
+// false candidates away without touching the template itself.
+typedef struct {
+  uint32_t id;
+  uint32_t literal_bytes;
+  uint32_t piece;     // the piece holding the anchor
+  uint32_t anchor;    // the anchor's offset within that piece
+  uint32_t placement; // Placement
+  uint32_t head;      // up to four leading bytes of the head piece
+  uint32_t head_mask;
+  uint32_t tail;      // up to four trailing bytes of the tail piece, as in edge_word
+  uint32_t tail_mask;
+} Candidate;
+
+// Hash table slot for one anchor; empty when count is 0.
+typedef struct {
+  uint32_t gram;
+  uint32_t first; // candidates[first .. first + count], best first
+  uint32_t count;
+} Slot;
+
+struct MtlogMatcher {
+  Template *templates;
+  uint32_t template_count;
+  uint32_t template_capacity;
+  Piece *pieces;
+  uint32_t piece_count;
+  uint32_t piece_capacity;
+  char *bytes;
+  uint32_t byte_count;
+  uint32_t byte_capacity;
+
+  // Set by mtlog_matcher_build.
+  bool built;
+  int32_t catch_all;     // first template without literal text, or -1
+  uint32_t filter_shift; // 32 - log2 of the bits in filter
+  uint32_t slot_shift;   // 32 - log2 of the slot count
+  uint64_t *filter;      // one bit per anchor hash
+  Slot *slots;
+  Candidate *candidates; // grouped by anchor, then the short templates
+  uint32_t short_first;  // templates without four consecutive literal bytes, best first
+  uint32_t short_count;
+};
+
+// Make room for `needed` elements of `size` bytes, doubling the capacity.
+static bool reserve(void **array, uint32_t *capacity, uint32_t needed, size_t size) {
+  if (needed <= *capacity) return true;
+  size_t grown = *capacity ? *capacity : 16;
+  while (grown < needed) grown *= 2;
+  if (grown > UINT32_MAX) grown = UINT32_MAX;
+  void *data = realloc(*array, grown * size);
+  if (!data) return false;
+  *array = data;
+  *capacity = (uint32_t)grown;
+  return true;
+}
+
+static void clear_index(MtlogMatcher *matcher) {
+  free(matcher->filter);
+  free(matcher->slots);
+  free(matcher->candidates);
+  matcher->filter = NULL;
+  matcher->slots = NULL;
+  matcher->candidates = NULL;
+  matcher->built = false;
+}
+
+MtlogMatcher *mtlog_matcher_new(void) {
+  MtlogMatcher *matcher = (MtlogMatcher *)calloc(1, sizeof(MtlogMatcher));
+  if (matcher) matcher->catch_all = -1;
+  return matcher;
+}
+
+void mtlog_matcher_delete(MtlogMatcher *matcher) {
+  if (!matcher) return;
+  clear_index(matcher);
+  free(matcher->templates);
+  free(matcher->pieces);
+  free(matcher->bytes);
+  free(matcher);
+}
+
+int32_t mtlog_matcher_add_ir(MtlogMatcher *matcher, const MtlogTemplateIR *ir, const char *text) {
+  if (matcher->template_count >= INT32_MAX || ir->property_count >= UINT32_MAX - matcher->piece_count ||
+      ir->source_length >= UINT32_MAX / 2 - matcher->byte_count) {
+    return -1;
+  }
+  // One spare byte keeps `bytes` allocated even if every template is empty.
+  if (!reserve((void **)&matcher->templates, &matcher->template_capacity, matcher->template_count + 1,
+               sizeof(Template)) ||
+      !reserve((void **)&matcher->pieces, &matcher->piece_capacity, matcher->piece_count + ir->property_count + 1,
+               sizeof(Piece)) ||
+      !reserve((void **)&matcher->bytes, &matcher->byte_capacity, matcher->byte_count + ir->source_length + 1, 1)) {
+    return -1;
+  }
+  clear_index(matcher);
+
+  const MtlogSpan *spans = mtlog_ir_spans(ir);
+  const uint8_t *kinds = mtlog_ir_kinds(ir);
+  Template *t = &matcher->templates[matcher->template_count];
+  *t = (Template){matcher->piece_count, ir->property_count, 0};
+  Piece *piece = &matcher->pieces[matcher->piece_count];
+  *piece = (Piece){matcher->byte_count, 0};
+  for (uint32_t i = 0; i < ir->segment_count; i++) {
+    if (kinds[i] != MTLOG_SEGMENT_LITERAL) {
+      *++piece = (Piece){matcher->byte_count, 0};
+      continue;
+    }
+    uint32_t length = spans[i].end - spans[i].start;
+    if (length) memcpy(matcher->bytes + matcher->byte_count, text + spans[i].start, length);
+    matcher->byte_count += length;
+    piece->length += length;
+    t->literal_bytes += length;
+  }
+  matcher->piece_count += ir->property_count + 1;
+  return (int32_t)matcher->template_count++;
+}
+
+int32_t mtlog_matcher_add(MtlogMatcher *matcher, const char *text, uint32_t length) {
+  MtlogTemplateIR *ir = mtlog_ir_from_text(text, length);
+  if (!ir) return -1;
+  int32_t id = mtlog_matcher_add_ir(matcher, ir, text);
+  mtlog_ir_delete(ir);
+  return id;
+}
+
+static inline uint32_t load_gram(const uint8_t *p) {
+  uint32_t gram;
+  memcpy(&gram, p, GRAM);
+  return gram;
+}
+
+// Fibonacci hashing; callers take the top bits.
+static inline uint32_t hash_gram(uint32_t gram) { return (uint32_t)((gram * 0x9e3779b97f4a7c15ull) >> 32); }
+
+static uint32_t log2_at_least(size_t n) {
+  uint32_t bits = 0;
+  while (((size_t)1 << bits) < n) bits++;
+  return bits;
+}
+
+// A gram of literal text while building: how many templates contain it, and
+// later its anchor number.
+typedef struct {
+  uint32_t gram;
+  uint32_t templates;
+  uint32_t last;   // the last template counted, plus one; 0 marks an empty entry
+  uint32_t anchor; // numbered from 1 if some template is anchored on it
+} GramCount;
+
+static GramCount *gram_entry(GramCount *table, uint32_t bits, uint32_t gram) {
+  uint32_t mask = ((uint32_t)1 << bits) - 1;
+  for (uint32_t i = hash_gram(gram) >> (32 - bits);; i = (i + 1) & mask) {
+    if (!table[i].last || table[i].gram == gram) return &table[i];
+  }
+}
+
+// Up to four bytes from the start of `bytes`, or from its end when `end`,
+// packed into a word with a mask of the bytes present.
+static uint32_t edge_word(const uint8_t *bytes, uint32_t length, bool end, uint32_t *mask) {
+  uint8_t word[4] = {0}, present[4] = {0};
+  uint32_t n = length < 4 ? length : 4;
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t at = end ? 4 - n + i : i;
+    word[at] = bytes[end ? length - n + i : i];
+    present[at] = 0xff;
+  }
+  uint32_t value;
+  memcpy(&value, word, 4);
+  memcpy(mask, present, 4);
+  return value;
+}
+
+static Candidate candidate(const MtlogMatcher *matcher, uint32_t id, uint32_t piece, uint32_t anchor) {
+  const Template *t = &matcher->templates[id];
+  const Piece *head = &matcher->pieces[t->piece], *tail = &matcher->pieces[t->piece + t->property_count];
+  const uint8_t *bytes = (const uint8_t *)matcher->bytes;
+  Candidate c = {id, t->literal_bytes, piece, anchor, PLACE_ANYWHERE, 0, 0, 0, 0};
+  if (piece == t->piece) c.placement = PLACE_HEAD;
+  else if (piece == t->piece + t->property_count) c.placement = PLACE_TAIL;
+  c.head = edge_word(bytes + head->offset, head->length, false, &c.head_mask);
+  c.tail = edge_word(bytes + tail->offset, tail->length, true, &c.tail_mask);
+  return c;
+}
+
+static int compare_keys(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+// Sort key: most literal bytes first, then the lowest id.
+static inline uint64_t rank(const Template *t, uint32_t id) {
+  return (uint64_t)(UINT32_MAX - t->literal_bytes) << 32 | id;
+}
+
+bool mtlog_matcher_build(MtlogMatcher *matcher) {
+  clear_index(matcher);
+  const Template *templates = matcher->templates;
+  const Piece *pieces = matcher->pieces;
+  const uint8_t *bytes = (const uint8_t *)matcher->bytes;
+  uint32_t count = matcher->template_count;
+  size_t per_template = (count ? count : 1) * sizeof(uint32_t);
+
+  uint32_t count_bits = log2_at_least(2 * (size_t)matcher->byte_count + 2);
+  GramCount *counts = (GramCount *)calloc((size_t)1 << count_bits, sizeof(GramCount));
+  uint32_t *anchor_piece = (uint32_t *)malloc(per_template);
+  uint32_t *anchor_offset = (uint32_t *)malloc(per_template);
+  uint64_t *keys = (uint64_t *)malloc(2 * per_template);
+  bool ok = counts && anchor_piece && anchor_offset && keys;
+
+  // How many templates contain each gram of literal text.
+  for (uint32_t i = 0; ok && i < count; i++) {
+    for (uint32_t p = templates[i].piece; p <= templates[i].piece + templates[i].property_count; p++) {
+      for (uint32_t at = 0; at + GRAM <= pieces[p].length; at++) {
+        uint32_t gram = load_gram(bytes + pieces[p].offset + at);
+        GramCount *entry = gram_entry(counts, count_bits, gram);
+        if (entry->last == i + 1) continue;
+        entry->gram = gram;
+        entry->templates++;
+        entry->last = i + 1;
+      }
+    }
+  }
+
+  // Anchor each template on its rarest gram, so that finding the anchor in a
+  // line nominates few templates. Among equals prefer the head, then the
+  // tail, whose places in the line are known.
+  uint32_t anchored_count = 0, short_count = 0, distinct = 0;
+  matcher->catch_all = -1;
+  for (uint32_t i = 0; ok && i < count; i++) {
+    const Template *t = &templates[i];
+    uint32_t tail = t->piece + t->property_count;
+    uint64_t best = UINT64_MAX;
+    anchor_piece[i] = NOT_FOUND;
+    for (uint32_t p = t->piece; p <= tail; p++) {
+      uint32_t preference = p == t->piece ? 0 : p == tail ? 1 : 2;
+      for (uint32_t at = 0; at + GRAM <= pieces[p].length; at++) {
+        uint32_t gram = load_gram(bytes + pieces[p].offset + at);
+        uint64_t score = (uint64_t)gram_entry(counts, count_bits, gram)->templates << 2 | preference;
+        if (score < best) {
+          best = score;
+          anchor_piece[i] = p;
+          anchor_offset[i] = at;
+        }
+      }
+    }
+    if (anchor_piece[i] != NOT_FOUND) {
+      uint32_t gram = load_gram(bytes + pieces[anchor_piece[i]].offset + anchor_offset[i]);
+      GramCount *entry = gram_entry(counts, count_bits, gram);
+      if (!entry->anchor) entry->anchor = ++distinct;
+      anchored_count++;
+    } else if (t->literal_bytes) {
+      short_count++;
+    } else if (matcher->catch_all < 0) {
+      matcher->catch_all = (int32_t)i;
+    }
+  }
+
+  // About 1.5% of the filter's bits are set, and slots are at most half full.
+  uint32_t filter_bits = log2_at_least(64 * (size_t)distinct);
+  if (filter_bits < 12) filter_bits = 12;
+  uint32_t slot_bits = log2_at_least(2 * (size_t)distinct + 2);
+  uint32_t slot_mask = ((uint32_t)1 << slot_bits) - 1;
+  uint64_t *filter = ok ? (uint64_t *)calloc(((size_t)1 << filter_bits) / 64, sizeof(uint64_t)) : NULL;
+  Slot *slots = ok ? (Slot *)calloc((size_t)slot_mask + 1, sizeof(Slot)) : NULL;
+  Candidate *candidates = ok ? (Candidate *)malloc((count ? count : 1) * sizeof(Candidate)) : NULL;
+  uint32_t *slot_of = ok ? (uint32_t *)malloc(((size_t)distinct + 1) * sizeof(uint32_t)) : NULL;
+  ok = ok && filter && slots && candidates && slot_of;
+
+  if (ok) {
+    // A filter bit and a slot per anchor, counting the templates on each.
+    for (uint32_t i = 0; i < count; i++) {
+      if (anchor_piece[i] == NOT_FOUND) continue;
+      uint32_t gram = load_gram(bytes + pieces[anchor_piece[i]].offset + anchor_offset[i]);
+      uint32_t hash = hash_gram(gram), bit = hash >> (32 - filter_bits);
+      filter[bit / 64] |= (uint64_t)1 << (bit % 64);
+      uint32_t s = hash >> (32 - slot_bits);
+      while (slots[s].count && slots[s].gram != gram) s = (s + 1) & slot_mask;
+      slots[s].gram = gram;
+      slots[s].count++;
+      slot_of[gram_entry(counts, count_bits, gram)->anchor] = s;
+    }
+    uint32_t offset = 0;
+    for (uint32_t s = 0; s <= slot_mask; s++) {
+      slots[s].first = offset;
+      offset += slots[s].count;
+      slots[s].count = 0;
+    }
+
+    // Group candidates by anchor, best first, with the short templates last.
+    uint32_t shorts = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      if (anchor_piece[i] != NOT_FOUND) {
+        uint32_t gram = load_gram(bytes + pieces[anchor_piece[i]].offset + anchor_offset[i]);
+        Slot *slot = &slots[slot_of[gram_entry(counts, count_bits, gram)->anchor]];
+        keys[slot->first + slot->count++] = rank(&templates[i], i);
+      } else if (templates[i].literal_bytes) {
+        keys[anchored_count + shorts++] = rank(&templates[i], i);
+      }
+    }
+    for (uint32_t s = 0; s <= slot_mask; s++) {
+      if (slots[s].count > 1) qsort(keys + slots[s].first, slots[s].count, sizeof(uint64_t), compare_keys);
+    }
+    qsort(keys + anchored_count, short_count, sizeof(uint64_t), compare_keys);
+    for (uint32_t k = 0; k < anchored_count + short_count; k++) {
+      uint32_t id = (uint32_t)keys[k];
+      candidates[k] = k < anchored_count ? candidate(matcher, id, anchor_piece[id], anchor_offset[id])
+                                         : candidate(matcher, id, NOT_FOUND, 0);
+    }
+
+    matcher->filter_shift = 32 - filter_bits;
+    matcher->slot_shift = 32 - slot_bits;
+    matcher->filter = filter;
+    matcher->slots = slots;
+    matcher->candidates = candidates;
+    matcher->short_first = anchored_count;
+    matcher->short_count = short_count;
+    matcher->built = true;
+  } else {
+    free(filter);
+    free(slots);
+    free(candidates);
+  }
+  free(counts);
+  free(anchor_piece);
+  free(anchor_offset);
+  free(keys);
+  free(slot_of);
+  return ok;
+}
+
+uint32_t mtlog_matcher_template_count(const MtlogMatcher *matcher) { return matcher->template_count; }
+
+uint32_t mtlog_matcher_property_count(const MtlogMatcher *matcher, uint32_t id) {
+  return matcher->templates[id].property_count;
+}
+
+static inline bool same(const uint8_t *a, const uint8_t *b, uint32_t length) {
+  return length == 0 || !memcmp(a, b, length);
+}
+
+// First occurrence of `piece` within line[from, to), or NOT_FOUND.
+static uint32_t find(const uint8_t *line, uint32_t from, uint32_t to, const uint8_t *piece, uint32_t length) {
+  if (length == 0) return from;
+  if (to - from < length) return NOT_FOUND;
+  const uint8_t *p = line + from, *last = line + to - length;
+  while ((p = (const uint8_t *)memchr(p, piece[0], (size_t)(last - p) + 1))) {
+    if (same(p + 1, piece + 1, length - 1)) return (uint32_t)(p - line);
+    if (p++ == last) break;
+  }
+  return NOT_FOUND;
+}
+
+// Whether `line` is the template's pieces with text in each gap, giving each
+// gap the shortest text that works from the left. Writes the gaps to
+// `captures`.
+static bool fits(const MtlogMatcher *matcher, const Template *t, const uint8_t *line, uint32_t length,
+                 MtlogSpan *captures, uint32_t capacity) {
+  const Piece *pieces = matcher->pieces + t->piece;
+  const uint8_t *bytes = (const uint8_t *)matcher->bytes;
+  const Piece *head = &pieces[0], *tail = &pieces[t->property_count];
+  if (length < t->literal_bytes || !same(line, bytes + head->offset, head->length)) return false;
+  if (t->property_count == 0) return length == head->length;
+
+  uint32_t end = length - tail->length;
+  if (!same(line + end, bytes + tail->offset, tail->length)) return false;
+  uint32_t position = head->length;
+  for (uint32_t i = 1; i <= t->property_count; i++) {
+    uint32_t gap_end = end;
+    if (i < t->property_count) {
+      gap_end = find(line, position, end, bytes + pieces[i].offset, pieces[i].length);
+      if (gap_end == NOT_FOUND) return false;
+    }
+    if (i - 1 < capacity) captures[i - 1] = (MtlogSpan){position, gap_end};
+    position = gap_end + pieces[i].length;
+  }
+  return true;
+}
+
+// Matching state for one line.
+typedef struct {
+  const uint8_t *text;
+  uint32_t length;
+  uint32_t head; // the line's edge words
+  uint32_t tail;
+  int32_t best;
+  uint32_t best_bytes;
+  // Templates anchored anywhere that did not fit. Fitting does not depend on
+  // where the anchor was found, so they need no second try; past the limit
+  // they are tried again, which costs time but not correctness.
+  uint32_t failed[32];
+  uint32_t failed_count;
+} Search;
+
+// Try candidates in order with their anchor found at `at`, or NOT_FOUND for
+// short templates, which have none.
+static void try_candidates(const MtlogMatcher *matcher, Search *search, const Candidate *candidates, uint32_t count,
+                           uint32_t at) {
+  const uint8_t *bytes = (const uint8_t *)matcher->bytes;
+  for (uint32_t j = 0; j < count; j++) {
+    const Candidate *c = &candidates[j];
+    // Neither this nor the rest of the group can beat the current match.
+    if (search->best >= 0 && (c->literal_bytes < search->best_bytes ||
+                              (c->literal_bytes == search->best_bytes && c->id > (uint32_t)search->best))) {
+      return;
+    }
+    if (search->length < c->literal_bytes || (search->head & c->head_mask) != c->head ||
+        (search->tail & c->tail_mask) != c->tail) {
+      continue;
+    }
+    if (at != NOT_FOUND) {
+      // The anchor's whole piece must surround it, in its place.
+      const Piece *piece = &matcher->pieces[c->piece];
+      if (at < c->anchor || piece->length > search->length - (at - c->anchor)) continue;
+      uint32_t start = at - c->anchor;
+      if ((c->placement == PLACE_HEAD && start != 0) ||
+          (c->placement == PLACE_TAIL && start + piece->length != search->length) ||
+          !same(search->text + start, bytes + piece->offset, piece->length)) {
+        continue;
+      }
+    }
+    bool failed = false;
+    if (c->placement == PLACE_ANYWHERE) {
+      for (uint32_t k = 0; k < search->failed_count && !failed; k++) failed = search->failed[k] == c->id;
+      if (failed) continue;
+    }
+    if (fits(matcher, &matcher->templates[c->id], search->text, search->length, NULL, 0)) {
+      search->best = (int32_t)c->id;
+      search->best_bytes = c->literal_bytes;
+      return;
+    }
+    if (c->placement == PLACE_ANYWHERE && search->failed_count < sizeof(search->failed) / sizeof(search->failed[0])) {
+      search->failed[search->failed_count++] = c->id;
+    }
+  }
+}
+
+int32_t mtlog_matcher_match(const MtlogMatcher *matcher, const char *line, uint32_t length, MtlogSpan *captures,
+                            uint32_t capacity) {
+  if (!matcher->built) return -1;
+  Search search = {(const uint8_t *)line, length, 0, 0, -1, 0, {0}, 0};
+  uint32_t unused;
+  search.head = edge_word(search.text, length, false, &unused);
+  search.tail = edge_word(search.text, length, true, &unused);
+
+  // Every gram of the line goes through the filter. A set bit is an anchor
+  // or one of the ~1.5% of hashes that collide with one.
+  uint32_t slot_mask = (uint32_t)(((uint64_t)1 << (32 - matcher->slot_shift)) - 1);
+  for (uint32_t i = 0; i + GRAM <= length; i++) {
+    uint32_t gram = load_gram(search.text + i);
+    uint32_t hash = hash_gram(gram), bit = hash >> matcher->filter_shift;
+    if (!(matcher->filter[bit / 64] >> (bit % 64) & 1)) continue;
+    for (uint32_t s = hash >> matcher->slot_shift; matcher->slots[s].count; s = (s + 1) & slot_mask) {
+      const Slot *slot = &matcher->slots[s];
+      if (slot->gram != gram) continue;
+      try_candidates(matcher, &search, matcher->candidates + slot->first, slot->count, i);
+      break;
+    }
+  }
+  try_candidates(matcher, &search, matcher->candidates + matcher->short_first, matcher->short_count, NOT_FOUND);
+
+  int32_t best = search.best >= 0 ? search.best : matcher->catch_all;
+  if (best >= 0 && capacity) fits(matcher, &matcher->templates[best], search.text, length, captures, capacity);
+  return best;
+}
@@ -0,0 +1,70 @@
+#ifndef TREE_SITTER_MTLOG_MATCHER_H_
+#define TREE_SITTER_MTLOG_MATCHER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "template_ir.h"
+
+// Reverse extraction: from a rendered log line back to its template.
+//
+// Each template is reduced to its literal pieces with a capture gap for every
+// property. Its anchor is the four-byte substring of those pieces that the
+// fewest templates share. A line is scanned once, hashing every four-byte
+// window against a cache-sized bitmap of the anchors (a multi-pattern
+// Rabin-Karp filter); each anchor found nominates the templates it belongs
+// to, and those are checked piece by piece, most specific first. Templates
+// with no four consecutive literal bytes are checked against every line.
+// Matching reads only the matcher, so one built matcher serves any number of
+// threads.
+//
+//   MtlogMatcher *matcher = mtlog_matcher_new();
+//   for (each template) ids[i] = mtlog_matcher_add(matcher, text, length);
+//   mtlog_matcher_build(matcher);
+//
+//   MtlogSpan values[16];
+//   int32_t id = mtlog_matcher_match(matcher, line, line_length, values, 16);
+//   // values[i] is the text of the id's i-th property within the line
+//
+// Literal text must match byte for byte. A gap matches any text, including
+// none, and ends at the first occurrence of the piece after it, so a value
+// that contains that piece splits early, and of two properties with nothing
+// between them the first is always empty. When several templates match, the
+// one with the most literal bytes wins, then the one added first; a template
+// made only of properties, such as `{Message}`, matches every line that
+// nothing else does.
+
+typedef struct MtlogMatcher MtlogMatcher;
+
+MtlogMatcher *mtlog_matcher_new(void);
+void mtlog_matcher_delete(MtlogMatcher *matcher);
+
+// Add the template `text` described by `ir`, or extracted from `text` without
+// a parser. Returns its id, counting from 0 in the order added, or -1 if
+// allocation fails. Adding discards the index until the next build.
+int32_t mtlog_matcher_add_ir(MtlogMatcher *matcher, const MtlogTemplateIR *ir, const char *text);
+int32_t mtlog_matcher_add(MtlogMatcher *matcher, const char *text, uint32_t length);
+
+// Build the anchor index over the templates added so far. Returns false if
+// allocation fails, leaving the matcher unbuilt.
+bool mtlog_matcher_build(MtlogMatcher *matcher);
+
+uint32_t mtlog_matcher_template_count(const MtlogMatcher *matcher);
+uint32_t mtlog_matcher_property_count(const MtlogMatcher *matcher, uint32_t id);
+
+// Find the template that produced `line` (without its line terminator).
+// Returns its id, or -1 if none matches or the matcher is not built. The
+// matching template's property values are written to `captures` in template
+// order, up to `capacity` of them.
+int32_t mtlog_matcher_match(const MtlogMatcher *matcher, const char *line, uint32_t length, MtlogSpan *captures,
+                            uint32_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_MATCHER_H_
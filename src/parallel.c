@@ -0,0 +1,375 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "parallel.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "char_class.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef HANDLE Thread;
+#define thread_join(t) (WaitForSingleObject((t), INFINITE), CloseHandle(t))
+#else
+#include <pthread.h>
+#include <unistd.h>
+typedef pthread_t Thread;
+#define thread_join(t) pthread_join((t), NULL)
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define range_load(r) ((uint64_t)_InterlockedOr64((volatile long long *)(r), 0))
+#define range_store(r, v) _InterlockedExchange64((volatile long long *)(r), (long long)(v))
+#define range_cas(r, expected, desired)                                                         \
+  ((uint64_t)_InterlockedCompareExchange64((volatile long long *)(r), (long long)(desired),      \
+                                           (long long)(expected)) == (expected))
+#else
+#define range_load(r) __atomic_load_n((r), __ATOMIC_ACQUIRE)
+#define range_store(r, v) __atomic_store_n((r), (v), __ATOMIC_RELEASE)
+#define range_cas(r, expected, desired) range_cas_gcc((r), (expected), (desired))
+
+static inline bool range_cas_gcc(uint64_t *range, uint64_t expected, uint64_t desired) {
+  return __atomic_compare_exchange_n(range, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#endif
+
+#define DEFAULT_CHUNK_SIZE (1u << 20)
+#define CACHE_LINE 64
+#define PER_SEGMENT_BYTES (3 * sizeof(MtlogSpan) + 3)
+
+// ---------------------------------------------------------------------------
+// Cutting
+
+// Inside `{{ ... }}` only names, digits, dots and line ends can sit between
+// the opener and the closer (scan_go_property in properties.c).
+static inline bool go_property_char(int32_t c) { return is_ident_char(c) || c == '.' || is_newline(c); }
+
+// If the line end before `cut` lies in something shaped like a Go-template
+// property, '{{', then only the characters above, then '}}', the offset past
+// its '}}'; otherwise 0. Every property the extractor accepts has that
+// shape, so a cut outside all of them is safe. No such span crosses `floor`,
+// so the walk back for the '{{' stops there, however long the run.
+static uint32_t go_property_end(const unsigned char *text, uint32_t length, uint32_t floor, uint32_t cut) {
+  uint32_t i = cut;
+  while (i > floor && go_property_char(text[i - 1])) i--;
+  if (i < floor + 2 || text[i - 1] != '{' || text[i - 2] != '{') return 0;
+  uint32_t j = cut;
+  while (j < length && go_property_char(text[j])) j++;
+  return j + 1 < length && text[j] == '}' && text[j + 1] == '}' ? j + 2 : 0;
+}
+
+uint32_t mtlog_line_boundary_after(const char *text, uint32_t length, uint32_t floor, uint32_t from) {
+  const unsigned char *data = (const unsigned char *)text;
+  while (from < length) {
+    const unsigned char *newline = (const unsigned char *)memchr(data + from, '\n', length - from);
+    if (!newline) return length;
+    uint32_t cut = (uint32_t)(newline - data) + 1;
+    uint32_t end = go_property_end(data, length, floor, cut);
+    if (!end) return cut;
+    floor = from = end;
+  }
+  return length;
+}
+
+uint32_t mtlog_line_boundary(const char *text, uint32_t length, uint32_t from) {
+  return mtlog_line_boundary_after(text, length, 0, from);
+}
+
+// ---------------------------------------------------------------------------
+// Chunks
+
+typedef struct {
+  uint32_t start;
+  uint32_t end;
+  uint32_t segment_count;  // as extracted on its own
+  uint32_t property_count;
+  uint32_t first_end;      // end of the first segment, chunk-relative
+  bool starts_literal;
+  bool ends_literal;
+  bool joins_previous;     // its first literal continues the previous chunk's last
+  uint64_t base;           // index of its first segment in the IR
+  uint32_t last_end;       // where its last segment ends once literals are joined
+} Chunk;
+
+typedef struct {
+  Chunk *chunk;
+  uint32_t count;
+  bool first;
+  MtlogSegmentKind last_kind;
+} Counter;
+
+static bool count_segment(const MtlogSegment *segment, void *context) {
+  Counter *counter = (Counter *)context;
+  if (counter->first) {
+    counter->chunk->starts_literal = segment->kind == MTLOG_SEGMENT_LITERAL;
+    counter->chunk->first_end = segment->span.end;
+    counter->first = false;
+  }
+  if (segment->kind != MTLOG_SEGMENT_LITERAL) counter->chunk->property_count++;
+  counter->last_kind = segment->kind;
+  counter->count++;
+  return true;
+}
+
+typedef struct {
+  MtlogSpan *spans;
+  MtlogSpan *names;
+  MtlogSpan *formats;
+  uint8_t *kinds;
+  uint8_t *name_kinds;
+  uint8_t *hints;
+} Columns;
+
+typedef struct {
+  const Columns *columns;
+  const Chunk *chunk;
+  uint32_t index; // segments seen
+} Writer;
+
+static inline MtlogSpan shift(MtlogSpan span, uint32_t by) {
+  span.start += by;
+  span.end += by;
+  return span;
+}
+
+// Same packing as mtlog_ir_from_segments, at the segment's global index.
+static bool write_segment(const MtlogSegment *segment, void *context) {
+  Writer *writer = (Writer *)context;
+  const Chunk *chunk = writer->chunk;
+  uint32_t index = writer->index++;
+  if (index == 0 && chunk->joins_previous) return true;
+  size_t i = (size_t)(chunk->base + index - chunk->joins_previous);
+
+  const Columns *columns = writer->columns;
+  columns->spans[i] = shift(segment->span, chunk->start);
+  if (index + 1 == chunk->segment_count) columns->spans[i].end = chunk->last_end;
+  columns->kinds[i] = (uint8_t)segment->kind;
+  if (segment->kind == MTLOG_SEGMENT_LITERAL) return true;
+  if (segment->name.end > segment->name.start) columns->names[i] = shift(segment->name, chunk->start);
+  if (segment->format.end > segment->format.start) columns->formats[i] = shift(segment->format, chunk->start);
+  columns->name_kinds[i] = (uint8_t)segment->name_kind;
+  columns->hints[i] = (uint8_t)segment->hint;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Work stealing
+//
+// Each worker owns a range of chunk indices, packed as `next << 32 | end` in
+// one word. The owner claims from the front and thieves take the back half,
+// each with one compare-and-swap, so every chunk is claimed exactly once.
+// No work is added once a phase starts: a worker that finds every range
+// empty is done.
+
+typedef enum { PHASE_COUNT, PHASE_WRITE } Phase;
+
+typedef struct {
+  uint64_t range;
+  char padding[CACHE_LINE - sizeof(uint64_t)];
+} Queue;
+
+typedef struct {
+  const char *text;
+  Chunk *chunks;
+  uint32_t chunk_count;
+  Queue *queues;
+  uint32_t worker_count;
+  Phase phase;
+  Columns columns;
+} Job;
+
+typedef struct {
+  Job *job;
+  uint32_t index;
+  Thread thread;
+  bool started;
+} Worker;
+
+static inline uint64_t pack(uint32_t next, uint32_t end) { return (uint64_t)next << 32 | end; }
+
+static bool claim(Queue *queue, uint32_t *chunk) {
+  for (;;) {
+    uint64_t range = range_load(&queue->range);
+    uint32_t next = (uint32_t)(range >> 32), end = (uint32_t)range;
+    if (next >= end) return false;
+    if (range_cas(&queue->range, range, pack(next + 1, end))) {
+      *chunk = next;
+      return true;
+    }
+  }
+}
+
+// Move the back half of another worker's range into worker `self`'s, which
+// is empty.
+static bool steal(Job *job, uint32_t self) {
+  for (uint32_t n = 1; n < job->worker_count; n++) {
+    Queue *victim = &job->queues[(self + n) % job->worker_count];
+    for (;;) {
+      uint64_t range = range_load(&victim->range);
+      uint32_t next = (uint32_t)(range >> 32), end = (uint32_t)range;
+      if (next >= end) break;
+      uint32_t middle = end - (end - next + 1) / 2;
+      if (range_cas(&victim->range, range, pack(next, middle))) {
+        range_store(&job->queues[self].range, pack(middle, end));
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static void process(Job *job, uint32_t index) {
+  Chunk *chunk = &job->chunks[index];
+  const char *text = job->text + chunk->start;
+  uint32_t length = chunk->end - chunk->start;
+  if (job->phase == PHASE_COUNT) {
+    Counter counter = {chunk, 0, true, MTLOG_SEGMENT_LITERAL};
+    mtlog_scan_segments(text, length, count_segment, &counter);
+    chunk->segment_count = counter.count;
+    chunk->ends_literal = counter.last_kind == MTLOG_SEGMENT_LITERAL;
+  } else {
+    Writer writer = {&job->columns, chunk, 0};
+    mtlog_scan_segments(text, length, write_segment, &writer);
+  }
+}
+
+static void run_worker(Worker *worker) {
+  Job *job = worker->job;
+  uint32_t chunk;
+  for (;;) {
+    while (claim(&job->queues[worker->index], &chunk)) process(job, chunk);
+    if (!steal(job, worker->index)) return;
+  }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI thread_main(LPVOID argument) {
+  run_worker((Worker *)argument);
+  return 0;
+}
+
+static bool thread_start(Worker *worker) {
+  worker->thread = CreateThread(NULL, 0, thread_main, worker, 0, NULL);
+  return worker->thread != NULL;
+}
+
+static uint32_t processor_count(void) {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors;
+}
+#else
+static void *thread_main(void *argument) {
+  run_worker((Worker *)argument);
+  return NULL;
+}
+
+static bool thread_start(Worker *worker) { return pthread_create(&worker->thread, NULL, thread_main, worker) == 0; }
+
+static uint32_t processor_count(void) {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (uint32_t)count : 1;
+}
+#endif
+
+// Run one phase over every chunk. The calling thread is worker 0; if a
+// thread cannot be started, the others steal its range.
+static void run_phase(Job *job, Worker *workers, Phase phase) {
+  job->phase = phase;
+  for (uint32_t i = 0; i < job->worker_count; i++) {
+    uint32_t begin = (uint32_t)((uint64_t)job->chunk_count * i / job->worker_count);
+    uint32_t end = (uint32_t)((uint64_t)job->chunk_count * (i + 1) / job->worker_count);
+    job->queues[i].range = pack(begin, end);
+  }
+  for (uint32_t i = 1; i < job->worker_count; i++) workers[i].started = thread_start(&workers[i]);
+  run_worker(&workers[0]);
+  for (uint32_t i = 1; i < job->worker_count; i++) {
+    if (workers[i].started) thread_join(workers[i].thread);
+  }
+}
+
+MtlogTemplateIR *mtlog_ir_from_text_parallel(const char *text, uint32_t length, uint32_t threads, uint32_t chunk_size) {
+  if (chunk_size == 0) chunk_size = DEFAULT_CHUNK_SIZE;
+  if (threads == 0) threads = processor_count();
+
+  // Every chunk but the last ends at least chunk_size bytes in.
+  uint32_t capacity = length / chunk_size + 1;
+  Chunk *chunks = (Chunk *)calloc(capacity, sizeof(Chunk));
+  if (!chunks) return NULL;
+  uint32_t chunk_count = 0;
+  for (uint32_t start = 0; start < length;) {
+    uint32_t end = length - start <= chunk_size ? length : mtlog_line_boundary_after(text, length, start, start + chunk_size);
+    chunks[chunk_count].start = start;
+    chunks[chunk_count].end = end;
+    chunk_count++;
+    start = end;
+  }
+  if (chunk_count <= 1) {
+    free(chunks);
+    return mtlog_ir_from_text(text, length);
+  }
+
+  Job job;
+  memset(&job, 0, sizeof(job));
+  job.text = text;
+  job.chunks = chunks;
+  job.chunk_count = chunk_count;
+  job.worker_count = threads < chunk_count ? threads : chunk_count;
+  job.queues = (Queue *)calloc(job.worker_count, sizeof(Queue));
+  Worker *workers = (Worker *)calloc(job.worker_count, sizeof(Worker));
+  MtlogTemplateIR *ir = NULL;
+  if (!job.queues || !workers) goto done;
+  for (uint32_t i = 0; i < job.worker_count; i++) {
+    workers[i].job = &job;
+    workers[i].index = i;
+  }
+
+  run_phase(&job, workers, PHASE_COUNT);
+
+  // Prefix sum, joining literals cut in two at a boundary.
+  uint64_t segment_count = 0, property_count = 0;
+  for (uint32_t i = 0; i < chunk_count; i++) {
+    Chunk *chunk = &chunks[i];
+    chunk->joins_previous = i > 0 && chunk->starts_literal && chunks[i - 1].ends_literal;
+    chunk->base = segment_count;
+    segment_count += chunk->segment_count - chunk->joins_previous;
+    property_count += chunk->property_count;
+  }
+  // A chunk's last literal runs on into the next chunk when that one starts
+  // with a literal, and through it when the literal is all it holds.
+  for (uint32_t i = chunk_count; i-- > 0;) {
+    const Chunk *next = i + 1 < chunk_count ? &chunks[i + 1] : NULL;
+    chunks[i].last_end = !next || !next->joins_previous ? chunks[i].end
+                         : next->segment_count == 1    ? next->last_end
+                                                       : next->start + next->first_end;
+  }
+  uint64_t size = (sizeof(MtlogTemplateIR) + segment_count * PER_SEGMENT_BYTES + 3) & ~(uint64_t)3;
+  if (size > UINT32_MAX) goto done;
+
+  // calloc: padding and absent spans are zero, as in mtlog_ir_from_segments.
+  ir = (MtlogTemplateIR *)calloc(1, (size_t)size);
+  if (!ir) goto done;
+  uint32_t count = (uint32_t)segment_count;
+  ir->version = MTLOG_IR_VERSION;
+  ir->size = (uint32_t)size;
+  ir->segment_count = count;
+  ir->property_count = (uint32_t)property_count;
+  ir->source_length = length;
+  job.columns.spans = (MtlogSpan *)(ir + 1);
+  job.columns.names = job.columns.spans + count;
+  job.columns.formats = job.columns.names + count;
+  job.columns.kinds = (uint8_t *)(job.columns.formats + count);
+  job.columns.name_kinds = job.columns.kinds + count;
+  job.columns.hints = job.columns.name_kinds + count;
+
+  run_phase(&job, workers, PHASE_WRITE);
+
+done:
+  free(workers);
+  free(job.queues);
+  free(chunks);
+  return ir;
+}
@@ -0,0 +1,52 @@
+#ifndef TREE_SITTER_MTLOG_PARALLEL_H_
+#define TREE_SITTER_MTLOG_PARALLEL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "template_ir.h"
+
+// Multi-threaded extraction for large files.
+//
+// Only a Go-template property can run across a line end (the grammar allows
+// newlines between its tokens); every other construct is decided before the
+// next '\n', as the scanner's lookahead stops there. So a large catalog can
+// be cut at line ends that are not inside a `{{ ... }}` and the pieces
+// extracted independently:
+//
+//   MtlogTemplateIR *ir = mtlog_ir_from_text_parallel(text, length, 0, 0);
+//   // byte-identical to mtlog_ir_from_text(text, length)
+//
+// The text is cut into chunks of about `chunk_size` bytes, which worker
+// threads claim from per-thread ranges and steal from each other once their
+// own run out. One pass counts each chunk's segments; after a prefix sum a
+// second pass writes them straight into the final IR at their global
+// offsets, so nothing is buffered between passes. A literal cut in two at a
+// chunk boundary is joined again.
+
+// Build the IR of `text` on `threads` threads (0: one per online processor)
+// from chunks of about `chunk_size` bytes (0: 1 MiB). The result is the
+// same as mtlog_ir_from_text. Returns NULL if allocation fails or the IR
+// would exceed 4 GiB. Free with mtlog_ir_delete.
+MtlogTemplateIR *mtlog_ir_from_text_parallel(const char *text, uint32_t length, uint32_t threads, uint32_t chunk_size);
+
+// The offset just past the first '\n' at or after `from` where the text can
+// be cut without changing how either side is extracted, or `length` if
+// there is none. For callers that split files themselves, e.g. to parse the
+// pieces with the runtime. It may read back to the start of the text over a
+// run of names, dots and line ends.
+uint32_t mtlog_line_boundary(const char *text, uint32_t length, uint32_t from);
+
+// The same, reading back no further than `floor`: 0 or an offset an earlier
+// call returned, at or before `from`. Cutting a text at successive line ends
+// with the previous cut as `floor` reads it in linear time.
+uint32_t mtlog_line_boundary_after(const char *text, uint32_t length, uint32_t floor, uint32_t from);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_PARALLEL_H_
@@ -0,0 +1,151 @@
+#include "parser_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define slot_peek(s) (*(TSParser *volatile *)(s))
+#define slot_take(s) ((TSParser *)_InterlockedExchangePointer((void *volatile *)(s), NULL))
+#define slot_fill(s, p) (_InterlockedCompareExchangePointer((void *volatile *)(s), (p), NULL) == NULL)
+#define counter_add(c, n) _InterlockedExchangeAdd64((volatile long long *)(c), (long long)(n))
+#define counter_read(c) ((uint64_t)_InterlockedOr64((volatile long long *)(c), 0))
+#define aligned_free(p) _aligned_free(p)
+#else
+#define slot_peek(s) __atomic_load_n((s), __ATOMIC_RELAXED)
+#define slot_take(s) __atomic_exchange_n((s), (TSParser *)NULL, __ATOMIC_ACQUIRE)
+#define slot_fill(s, p) slot_fill_cas((s), (p))
+#define counter_add(c, n) __atomic_fetch_add((c), (n), __ATOMIC_RELAXED)
+#define counter_read(c) __atomic_load_n((c), __ATOMIC_RELAXED)
+#define aligned_free(p) free(p)
+
+static inline int slot_fill_cas(TSParser **slot, TSParser *parser) {
+  TSParser *empty = NULL;
+  return __atomic_compare_exchange_n(slot, &empty, parser, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+#endif
+
+#define DEFAULT_SIZE 64
+#define CACHE_LINE 64
+
+const TSLanguage *tree_sitter_mtlog(void);
+
+// One parser per cache line, so threads working different slots never write
+// the same line.
+typedef struct {
+  _Alignas(CACHE_LINE) TSParser *parser; // NULL while checked out
+} Slot;
+
+struct MtlogParserPool {
+  Slot *slots; // read by every checkout and return
+  uint32_t size;
+  // Written only when threads collide or the pool runs dry, and kept off the
+  // line above so those writes do not evict it from every other core.
+  _Alignas(CACHE_LINE) uint64_t probes;
+  uint64_t overflows;
+  uint64_t discards;
+};
+
+// Zeroed memory starting on a cache line, which calloc does not promise.
+// `size` must be a multiple of CACHE_LINE, as sizeof the pool and of Slot are.
+static void *aligned_calloc(size_t size) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  void *memory = _aligned_malloc(size, CACHE_LINE);
+#else
+  void *memory = aligned_alloc(CACHE_LINE, size);
+#endif
+  if (memory) memset(memory, 0, size);
+  return memory;
+}
+
+static TSParser *parser_new(void) {
+  TSParser *parser = ts_parser_new();
+  if (parser && !ts_parser_set_language(parser, tree_sitter_mtlog())) {
+    ts_parser_delete(parser);
+    return NULL;
+  }
+  return parser;
+}
+
+MtlogParserPool *mtlog_parser_pool_new(uint32_t size) {
+  if (size == 0) size = DEFAULT_SIZE;
+  MtlogParserPool *pool = (MtlogParserPool *)aligned_calloc(sizeof(MtlogParserPool));
+  if (!pool) return NULL;
+  pool->size = size;
+  pool->slots = (Slot *)aligned_calloc((size_t)size * sizeof(Slot));
+  if (!pool->slots) {
+    aligned_free(pool);
+    return NULL;
+  }
+  for (uint32_t i = 0; i < size; i++) {
+    if (!(pool->slots[i].parser = parser_new())) {
+      mtlog_parser_pool_delete(pool);
+      return NULL;
+    }
+  }
+  return pool;
+}
+
+void mtlog_parser_pool_delete(MtlogParserPool *pool) {
+  if (!pool) return;
+  for (uint32_t i = 0; i < pool->size; i++) {
+    if (pool->slots[i].parser) ts_parser_delete(pool->slots[i].parser);
+  }
+  aligned_free(pool->slots);
+  aligned_free(pool);
+}
+
+// Threads' stacks are megabytes apart, so the page of a local variable picks
+// a slot that stays the same for a thread and differs between threads.
+static inline uint32_t home_slot(const MtlogParserPool *pool, const void *stack) {
+  uint64_t page = (uint64_t)(uintptr_t)stack >> 12;
+  return (uint32_t)(((page * 0x9e3779b97f4a7c15ull) >> 32) % pool->size);
+}
+
+TSParser *mtlog_parser_pool_checkout(MtlogParserPool *pool) {
+  uint32_t i = home_slot(pool, &pool), probes = 0;
+  for (uint32_t n = 0; n < pool->size; n++) {
+    TSParser **slot = &pool->slots[i].parser;
+    // Look before swapping, so empty slots are read but not written.
+    if (slot_peek(slot)) {
+      TSParser *parser = slot_take(slot);
+      if (parser) {
+        if (probes) counter_add(&pool->probes, probes);
+        return parser;
+      }
+    }
+    probes++;
+    if (++i == pool->size) i = 0;
+  }
+  counter_add(&pool->probes, probes);
+  counter_add(&pool->overflows, 1);
+  return parser_new();
+}
+
+void mtlog_parser_pool_return(MtlogParserPool *pool, TSParser *parser) {
+  if (!parser) return;
+  // A parse that was cancelled or timed out leaves state for resuming it.
+  ts_parser_reset(parser);
+  uint32_t i = home_slot(pool, &pool), probes = 0;
+  for (uint32_t n = 0; n < pool->size; n++) {
+    TSParser **slot = &pool->slots[i].parser;
+    if (!slot_peek(slot) && slot_fill(slot, parser)) {
+      if (probes) counter_add(&pool->probes, probes);
+      return;
+    }
+    probes++;
+    if (++i == pool->size) i = 0;
+  }
+  counter_add(&pool->probes, probes);
+  counter_add(&pool->discards, 1);
+  ts_parser_delete(parser);
+}
+
+void mtlog_parser_pool_stats(MtlogParserPool *pool, MtlogParserPoolStats *stats) {
+  stats->size = pool->size;
+  stats->idle = 0;
+  for (uint32_t i = 0; i < pool->size; i++) stats->idle += slot_peek(&pool->slots[i].parser) != NULL;
+  stats->probes = counter_read(&pool->probes);
+  stats->overflows = counter_read(&pool->overflows);
+  stats->discards = counter_read(&pool->discards);
+}
@@ -0,0 +1,70 @@
+#ifndef TREE_SITTER_MTLOG_PARSER_POOL_H_
+#define TREE_SITTER_MTLOG_PARSER_POOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+// Thread-safe pool of ready parsers (needs the runtime).
+//
+// A TSParser may only be used by one thread at a time, and creating one per
+// parse costs more than parsing a short template. The pool creates `size`
+// parsers up front, each already set to tree_sitter_mtlog() so its scanner
+// payload exists, and hands them out to any number of threads:
+//
+//   MtlogParserPool *pool = mtlog_parser_pool_new(64);
+//   TSParser *parser = mtlog_parser_pool_checkout(pool);
+//   TSTree *tree = ts_parser_parse_string(parser, NULL, text, length);
+//   mtlog_parser_pool_return(pool, parser);
+//
+// Checkout and return take no lock. Each parser sits in its own cache line;
+// checkout swaps one out of its slot and return swaps it back into an empty
+// one. Each thread starts probing at a slot picked from its stack address,
+// so with at least as many parsers as threads, a thread usually gets back
+// the parser it returned last and touches no line another thread writes.
+// The scanner keeps no state outside its payload, which for this grammar is
+// empty, so parsers share nothing mutable.
+//
+// C only: parser_pool.c calls the runtime's ts_parser_new, which the Node
+// addon does not link, so binding.gyp leaves it out. Rust code should keep a
+// tree_sitter::Parser per thread instead, so bindings/rust/build.rs leaves it
+// out too. Compile it next to the runtime, as test/api and bench do.
+
+typedef struct MtlogParserPool MtlogParserPool;
+
+typedef struct {
+  uint32_t size;      // parsers created with the pool
+  uint32_t idle;      // parsers in the pool now
+  uint64_t probes;    // slots passed over because another thread got there first
+  uint64_t overflows; // checkouts that found the pool empty and created a parser
+  uint64_t discards;  // returns that found the pool full and deleted the parser
+} MtlogParserPoolStats;
+
+// Create a pool of `size` parsers; 0 picks 64. Returns NULL if allocation
+// fails or the runtime cannot load the language.
+MtlogParserPool *mtlog_parser_pool_new(uint32_t size);
+
+// Delete the pool and the parsers in it. Parsers still checked out are not
+// freed; return them first.
+void mtlog_parser_pool_delete(MtlogParserPool *pool);
+
+// A parser for this thread's exclusive use until it is returned. When every
+// parser is checked out a new one is created, so this only fails (NULL) if
+// allocation does.
+TSParser *mtlog_parser_pool_checkout(MtlogParserPool *pool);
+
+// Reset `parser` and put it back, or delete it if the pool is full. Trees
+// it produced stay valid. Settings the caller changed, such as included
+// ranges, a timeout or a logger, are kept; restore them before returning.
+void mtlog_parser_pool_return(MtlogParserPool *pool, TSParser *parser);
+
+void mtlog_parser_pool_stats(MtlogParserPool *pool, MtlogParserPoolStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_PARSER_POOL_H_
@@ -0,0 +1,262 @@
+#include "properties.h"
+
+#include "char_class.h"
+#include "structural.h"
+
+// The recognition rules below mirror scanner.c: a '{' or '${' opens a
+// construct only when `[@$]? name? (':' format)? '}'` follows on the same
+// line, and '{{' opens a Go-template property only when the grammar would
+// accept `'{{' '.' name? '}}'`. Keep the two in step.
+//
+// Literal text and format strings are skipped with the structural index
+// (structural.h), built one window at a time so memory stays bounded for
+// large buffers; names and the short '{{' tails are checked byte by byte.
+
+#define WINDOW_BLOCKS 64
+#define WINDOW_SIZE (WINDOW_BLOCKS * MTLOG_STRUCTURAL_BLOCK)
+
+typedef struct {
+  const unsigned char *data;
+  uint32_t length;
+  uint32_t position;
+  bool bytewise;         // scalar kernel: skip the index
+  uint32_t window_start; // UINT32_MAX until the first window is indexed
+  MtlogStructuralBlock window[WINDOW_BLOCKS];
+} Cursor;
+
+typedef enum {
+  FIND_OPENER,     // '{' or '$'
+  FIND_FORMAT_END, // '}' or a line end
+} FindTarget;
+
+static inline uint64_t target_mask(const MtlogStructuralBlock *block, FindTarget target) {
+  return target == FIND_OPENER ? block->open_brace | block->dollar : block->close_brace | block->line_end;
+}
+
+// Position of the first `target` byte at or after `from`, or the buffer length.
+static uint32_t find_next(Cursor *cursor, uint32_t from, FindTarget target) {
+  // Without a SIMD kernel, building the masks costs more than testing each
+  // byte once, so walk the bytes instead.
+  if (cursor->bytewise) {
+    const unsigned char *data = cursor->data;
+    if (target == FIND_OPENER) {
+      while (from < cursor->length && data[from] != '{' && data[from] != '$') from++;
+    } else {
+      while (from < cursor->length && data[from] != '}' && data[from] && !is_newline(data[from])) from++;
+    }
+    return from;
+  }
+
+  while (from < cursor->length) {
+    uint32_t start = from - from % WINDOW_SIZE;
+    uint32_t size = cursor->length - start < WINDOW_SIZE ? cursor->length - start : WINDOW_SIZE;
+    if (start != cursor->window_start) {
+      mtlog_structural_index((const char *)cursor->data + start, size, cursor->window);
+      cursor->window_start = start;
+    }
+
+    uint32_t block = (from - start) / MTLOG_STRUCTURAL_BLOCK;
+    uint32_t blocks = mtlog_structural_block_count(size);
+    uint64_t mask = target_mask(&cursor->window[block], target) & (~(uint64_t)0 << (from % MTLOG_STRUCTURAL_BLOCK));
+    for (;;) {
+      if (mask) return start + block * MTLOG_STRUCTURAL_BLOCK + mtlog_lowest_bit(mask);
+      if (++block == blocks) break;
+      mask = target_mask(&cursor->window[block], target);
+    }
+    from = start + WINDOW_SIZE;
+  }
+  return cursor->length;
+}
+
+static inline int32_t peek(const Cursor *cursor) {
+  return cursor->position < cursor->length ? cursor->data[cursor->position] : -1;
+}
+
+static inline int32_t peek_at(const Cursor *cursor, uint32_t offset) {
+  uint32_t index = cursor->position + offset;
+  return index < cursor->length ? cursor->data[index] : -1;
+}
+
+static void skip_extras(Cursor *cursor);
+
+// Consume an optional property name and classify it. Returns false if a '.'
+// is not followed by an identifier, which no rule accepts. `extras` allows
+// newlines around the dots of a dotted name, as the grammar does between the
+// tokens of a Go property.
+static bool scan_name(Cursor *cursor, MtlogSpan *span, MtlogNameKind *kind, bool extras) {
+  span->start = span->end = cursor->position;
+  *kind = MTLOG_NAME_NONE;
+
+  if (is_ident_start(peek(cursor))) {
+    *kind = MTLOG_NAME_IDENTIFIER;
+    for (;;) {
+      do cursor->position++; while (is_ident_char(peek(cursor)));
+      span->end = cursor->position;
+      uint32_t before_dot = cursor->position;
+      if (extras) skip_extras(cursor);
+      if (peek(cursor) != '.') {
+        cursor->position = before_dot;
+        break;
+      }
+      cursor->position++;
+      if (extras) skip_extras(cursor);
+      if (!is_ident_start(peek(cursor))) return false;
+      *kind = MTLOG_NAME_DOTTED;
+    }
+  } else if (is_digit(peek(cursor))) {
+    *kind = MTLOG_NAME_NUMERIC;
+    do cursor->position++; while (is_digit(peek(cursor)));
+    span->end = cursor->position;
+  }
+  return true;
+}
+
+// Skip the grammar's extras (`\r?\n`) between tokens.
+static void skip_extras(Cursor *cursor) {
+  for (;;) {
+    if (peek(cursor) == '\n') {
+      cursor->position++;
+    } else if (peek(cursor) == '\r' && peek_at(cursor, 1) == '\n') {
+      cursor->position += 2;
+    } else {
+      return;
+    }
+  }
+}
+
+// Called with the cursor after '{' or '${': `name? (':' format)? '}'` on this
+// line. On failure the cursor is left where the lookahead stopped, matching
+// the characters the scanner folds into the literal.
+static bool scan_name_and_format(Cursor *cursor, MtlogSegment *segment) {
+  if (!scan_name(cursor, &segment->name, &segment->name_kind, false)) return false;
+
+  segment->format.start = segment->format.end = cursor->position;
+  if (peek(cursor) == ':') {
+    cursor->position++;
+    if (peek(cursor) == '}') return false; // format_spec is never empty
+    segment->format.start = cursor->position;
+    cursor->position = find_next(cursor, cursor->position, FIND_FORMAT_END);
+    segment->format.end = cursor->position;
+  }
+
+  if (peek(cursor) != '}') return false;
+  cursor->position++;
+  return true;
+}
+
+// Called with the cursor on '{{': `'{{' '.' name? '}}'` with extras allowed
+// between tokens. The grammar turns anything else into an ERROR node.
+static bool scan_go_property(Cursor *cursor, MtlogSegment *segment) {
+  cursor->position += 2;
+  skip_extras(cursor);
+  if (peek(cursor) != '.') return false;
+  cursor->position++;
+  skip_extras(cursor);
+  if (!scan_name(cursor, &segment->name, &segment->name_kind, true)) return false;
+  skip_extras(cursor);
+  if (peek(cursor) != '}' || peek_at(cursor, 1) != '}') return false;
+  cursor->position += 2;
+  segment->format.start = segment->format.end = cursor->position;
+  return true;
+}
+
+typedef struct {
+  MtlogSegmentCallback callback;
+  void *context;
+  bool literals;
+  bool stopped;
+  uint32_t count;
+} Sink;
+
+static void emit(Sink *sink, const MtlogSegment *segment) {
+  if (sink->stopped) return;
+  if (segment->kind == MTLOG_SEGMENT_LITERAL && !sink->literals) return;
+  sink->count++;
+  if (!sink->callback(segment, sink->context)) sink->stopped = true;
+}
+
+static void emit_literal(Sink *sink, uint32_t start, uint32_t end) {
+  if (start == end) return;
+  MtlogSegment segment = {
+    .kind = MTLOG_SEGMENT_LITERAL,
+    .span = {start, end},
+    .name = {end, end},
+    .format = {end, end},
+    .name_kind = MTLOG_NAME_NONE,
+    .hint = 0,
+  };
+  emit(sink, &segment);
+}
+
+static uint32_t scan(const char *buffer, uint32_t length, Sink *sink) {
+  Cursor cursor;
+  cursor.data = (const unsigned char *)buffer;
+  cursor.length = length;
+  cursor.position = 0;
+  cursor.bytewise = mtlog_structural_kernel() == MTLOG_KERNEL_SCALAR;
+  cursor.window_start = UINT32_MAX;
+  uint32_t literal_start = 0;
+
+  while (cursor.position < length && !sink->stopped) {
+    int32_t c = peek(&cursor);
+    uint32_t start = cursor.position;
+    MtlogSegment segment = {.span = {start, start}, .hint = 0};
+
+    if (c == '{' && peek_at(&cursor, 1) == '{') {
+      if (scan_go_property(&cursor, &segment)) {
+        segment.kind = MTLOG_SEGMENT_GO_PROPERTY;
+      } else {
+        // Not a Go property: the grammar recovers with an ERROR node; treat
+        // the opener as literal text.
+        cursor.position = start + 2;
+        continue;
+      }
+    } else if (c == '{') {
+      cursor.position++;
+      int32_t hint = peek(&cursor);
+      if (hint == '$' && peek_at(&cursor, 1) == '{') {
+        // '{' before a '${' opener is literal; the builtin starts at '$'.
+        continue;
+      }
+      if (hint == '@' || hint == '$') {
+        segment.hint = (char)hint;
+        cursor.position++;
+      }
+      if (!scan_name_and_format(&cursor, &segment)) continue;
+      segment.kind = MTLOG_SEGMENT_PROPERTY;
+    } else if (c == '$') {
+      cursor.position++;
+      if (peek(&cursor) != '{') continue;
+      cursor.position++;
+      if (!scan_name_and_format(&cursor, &segment)) continue;
+      segment.kind = MTLOG_SEGMENT_BUILTIN_PROPERTY;
+    } else {
+      // Plain text, newlines and NUL bytes alike: skip to the next opener.
+      cursor.position = find_next(&cursor, cursor.position + 1, FIND_OPENER);
+      continue;
+    }
+
+    segment.span.end = cursor.position;
+    emit_literal(sink, literal_start, start);
+    emit(sink, &segment);
+    literal_start = cursor.position;
+  }
+
+  emit_literal(sink, literal_start, length);
+  return sink->count;
+}
+
+uint32_t mtlog_scan_segments(const char *buffer, uint32_t length, MtlogSegmentCallback callback, void *context) {
+  Sink sink = {callback, context, true, false, 0};
+  return scan(buffer, length, &sink);
+}
+
+uint32_t mtlog_scan_properties(const char *buffer, uint32_t length, MtlogSegmentCallback callback, void *context) {
+  Sink sink = {callback, context, false, false, 0};
+  return scan(buffer, length, &sink);
+}
+
+void mtlog_narrow_utf16(const uint16_t *units, uint32_t length, char *out) {
+  // Branch-free so the loop vectorizes.
+  for (uint32_t i = 0; i < length; i++) out[i] = (char)(units[i] < 0x80 ? units[i] : 0x80);
+}
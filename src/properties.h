@@ -0,0 +1,79 @@
+#ifndef TREE_SITTER_MTLOG_PROPERTIES_H_
+#define TREE_SITTER_MTLOG_PROPERTIES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Tree-free extraction of template segments.
+//
+// Walks a UTF-8 buffer once and reports each property, Go-template property
+// and builtin property with the byte spans of its name, hint and format,
+// applying the same recognition rules as the grammar and external scanner
+// without building a TSTree. A '{{' that does not open a well-formed
+// Go-template property is an ERROR in the grammar; here it is reported as
+// literal text and scanning resumes after it, so the properties found near
+// malformed input can differ from what error recovery salvages.
+//
+// Literal segments cover all remaining bytes, including the newlines that the
+// grammar treats as extras, so the segments of a buffer tile it exactly.
+
+typedef enum {
+  MTLOG_SEGMENT_LITERAL,
+  MTLOG_SEGMENT_PROPERTY,         // {Name}, {@Name:format}
+  MTLOG_SEGMENT_GO_PROPERTY,      // {{.Name}}
+  MTLOG_SEGMENT_BUILTIN_PROPERTY, // ${Name:format}
+} MtlogSegmentKind;
+
+typedef enum {
+  MTLOG_NAME_NONE,
+  MTLOG_NAME_IDENTIFIER, // UserId
+  MTLOG_NAME_DOTTED,     // http.method
+  MTLOG_NAME_NUMERIC,    // 0
+} MtlogNameKind;
+
+// Half-open byte range; empty (start == end) when the part is absent.
+typedef struct {
+  uint32_t start;
+  uint32_t end;
+} MtlogSpan;
+
+typedef struct {
+  MtlogSegmentKind kind;
+  MtlogSpan span;          // the whole segment, delimiters included
+  MtlogSpan name;          // property name
+  MtlogSpan format;        // format string after ':', without the ':'
+  MtlogNameKind name_kind;
+  char hint;               // '@', '$' or 0 (properties only)
+} MtlogSegment;
+
+// Receives each segment in order; return false to stop the scan.
+typedef bool (*MtlogSegmentCallback)(const MtlogSegment *segment, void *context);
+
+// Report every segment of `buffer`, literals included. Returns the number of
+// segments delivered.
+uint32_t mtlog_scan_segments(const char *buffer, uint32_t length, MtlogSegmentCallback callback, void *context);
+
+// Report only property, Go-template and builtin segments. Returns the number
+// of properties delivered.
+uint32_t mtlog_scan_properties(const char *buffer, uint32_t length, MtlogSegmentCallback callback, void *context);
+
+// Map UTF-16 code units to one byte each for the scanners above: ASCII is
+// kept and every other unit becomes 0x80, which no rule treats specially.
+// Every character the grammar reacts to is ASCII, so scanning `out` finds the
+// same segments as scanning the UTF-8 text, with offsets in code units (JS
+// string indices) instead of bytes. `out` holds `length` bytes; it must not
+// overlap `units`.
+//
+//   mtlog_narrow_utf16(units, count, narrow);
+//   mtlog_scan_segments(narrow, count, on_segment, context);
+void mtlog_narrow_utf16(const uint16_t *units, uint32_t length, char *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_PROPERTIES_H_
@@ -0,0 +1,361 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "registry.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+
+MtlogRegistry *mtlog_registry_open(const char *path, uint32_t max_templates, uint64_t record_bytes) {
+  (void)path;
+  (void)max_templates;
+  (void)record_bytes;
+  return NULL;
+}
+
+void mtlog_registry_close(MtlogRegistry *registry) { (void)registry; }
+
+int32_t mtlog_registry_intern(MtlogRegistry *registry, const char *text, uint32_t length) {
+  (void)registry;
+  (void)text;
+  (void)length;
+  return -1;
+}
+
+int32_t mtlog_registry_intern_ir(MtlogRegistry *registry, const char *text, uint32_t length,
+                                 const MtlogTemplateIR *ir) {
+  (void)registry;
+  (void)text;
+  (void)length;
+  (void)ir;
+  return -1;
+}
+
+int32_t mtlog_registry_find(const MtlogRegistry *registry, const char *text, uint32_t length) {
+  (void)registry;
+  (void)text;
+  (void)length;
+  return -1;
+}
+
+const MtlogTemplateIR *mtlog_registry_ir(const MtlogRegistry *registry, uint32_t id) {
+  (void)registry;
+  (void)id;
+  return NULL;
+}
+
+const char *mtlog_registry_text(const MtlogRegistry *registry, uint32_t id, uint32_t *length) {
+  (void)registry;
+  (void)id;
+  if (length) *length = 0;
+  return NULL;
+}
+
+void mtlog_registry_stats(const MtlogRegistry *registry, MtlogRegistryStats *stats) {
+  (void)registry;
+  memset(stats, 0, sizeof(*stats));
+}
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEFAULT_MAX_TEMPLATES 65536
+#define DEFAULT_RECORD_BYTES (64u << 20)
+#define MAX_TEMPLATES (1u << 30)
+#define UNIT 8 // records are addressed in 8-byte units from the start of the file
+#define MAX_FILE_BYTES ((uint64_t)UINT32_MAX * UNIT)
+
+static const char MAGIC[8] = {'M', 'T', 'L', 'O', 'G', 'R', 'E', 'G'};
+
+// The first 256 bytes of the file. The two counters written by every insert
+// sit on cache lines of their own.
+typedef struct {
+  char magic[8];
+  uint32_t version;    // MTLOG_REGISTRY_VERSION
+  uint32_t ir_version; // MTLOG_IR_VERSION
+  uint32_t max_templates;
+  uint32_t slot_count; // a power of two, at least twice max_templates
+  uint64_t ids_offset;
+  uint64_t slots_offset;
+  uint64_t records_offset;
+  uint64_t record_bytes;
+  uint64_t file_bytes;
+  uint32_t next_id; // atomic
+  uint8_t padding1[60];
+  uint64_t used_bytes; // atomic; of the record area
+  uint8_t padding2[56];
+  uint8_t reserved[64];
+} Header;
+
+// A template in the record area, followed by its text, a NUL, padding to 8
+// bytes, then its IR block.
+typedef struct {
+  uint64_t hash;
+  uint32_t id;
+  uint32_t length;
+  uint32_t ir_offset; // from the start of the record
+  uint32_t ir_size;
+} Record;
+
+// Slots hold the top half of the text's hash above the record's unit offset;
+// 0 is empty. The ID table holds unit offsets, 0 for an unused ID.
+struct MtlogRegistry {
+  uint8_t *base;
+  size_t size;
+  Header *header;
+  uint32_t *ids;
+  uint64_t *slots;
+  uint32_t slot_mask;
+};
+
+// Slots and records hold mtlog_text_hash values, so the hash is part of the
+// file format: changing it needs a new MTLOG_REGISTRY_VERSION. C has no
+// constant evaluation of a function, so open checks this known vector
+// instead; with optimization the check folds away.
+#define HASH_VECTOR "User {UserId} logged in"
+#define HASH_VECTOR_VALUE 0x20151010b6ebcf8full
+
+static uint64_t align_up(uint64_t n, uint64_t alignment) { return (n + alignment - 1) & ~(alignment - 1); }
+
+// Fill in the layout for the given sizes; false if the file would be too big.
+static bool plan(Header *header, uint32_t max_templates, uint64_t record_bytes) {
+  uint32_t slots = 1;
+  while (slots < 2 * max_templates) slots <<= 1;
+  memcpy(header->magic, MAGIC, sizeof(MAGIC));
+  header->version = MTLOG_REGISTRY_VERSION;
+  header->ir_version = MTLOG_IR_VERSION;
+  header->max_templates = max_templates;
+  header->slot_count = slots;
+  header->ids_offset = sizeof(Header);
+  header->slots_offset = align_up(header->ids_offset + (uint64_t)max_templates * sizeof(uint32_t), 64);
+  header->records_offset = align_up(header->slots_offset + (uint64_t)slots * sizeof(uint64_t), 64);
+  header->record_bytes = align_up(record_bytes, UNIT);
+  header->file_bytes = header->records_offset + header->record_bytes;
+  return header->record_bytes >= record_bytes && header->file_bytes <= MAX_FILE_BYTES;
+}
+
+// Layouts are derived from the sizes alone, so a file is checked by planning
+// it again.
+static bool header_valid(const Header *header, size_t size) {
+  Header expected;
+  memset(&expected, 0, sizeof(expected));
+  if (size < sizeof(Header) || header->max_templates == 0 || header->max_templates > MAX_TEMPLATES ||
+      !plan(&expected, header->max_templates, header->record_bytes)) {
+    return false;
+  }
+  return !memcmp(header->magic, MAGIC, sizeof(MAGIC)) && header->version == expected.version &&
+         header->ir_version == expected.ir_version && header->slot_count == expected.slot_count &&
+         header->ids_offset == expected.ids_offset && header->slots_offset == expected.slots_offset &&
+         header->records_offset == expected.records_offset && header->file_bytes == expected.file_bytes &&
+         header->file_bytes <= size;
+}
+
+// Build the file under a private name and link it into place, so other
+// processes only ever see a complete header. Losing the race to another
+// creator is fine: its file is used instead.
+static bool create(const char *path, uint32_t max_templates, uint64_t record_bytes) {
+  Header header;
+  memset(&header, 0, sizeof(header));
+  if (!plan(&header, max_templates, record_bytes)) return false;
+
+  size_t path_length = strlen(path);
+  char *temporary = (char *)malloc(path_length + 32);
+  if (!temporary) return false;
+  snprintf(temporary, path_length + 32, "%s.%ld.tmp", path, (long)getpid());
+  unlink(temporary); // left by an earlier process with the same PID that died here
+  int fd = open(temporary, O_RDWR | O_CREAT | O_EXCL, 0666);
+  bool created = fd >= 0 && ftruncate(fd, (off_t)header.file_bytes) == 0 &&
+                 pwrite(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header);
+  if (fd >= 0) close(fd);
+  if (created && link(temporary, path) != 0 && errno != EEXIST) created = false;
+  if (fd >= 0) unlink(temporary);
+  free(temporary);
+  return created;
+}
+
+MtlogRegistry *mtlog_registry_open(const char *path, uint32_t max_templates, uint64_t record_bytes) {
+  if (mtlog_text_hash(HASH_VECTOR, sizeof(HASH_VECTOR) - 1) != HASH_VECTOR_VALUE) return NULL;
+  if (max_templates == 0) max_templates = DEFAULT_MAX_TEMPLATES;
+  if (max_templates > MAX_TEMPLATES) max_templates = MAX_TEMPLATES;
+  if (record_bytes == 0) record_bytes = DEFAULT_RECORD_BYTES;
+
+  int fd = open(path, O_RDWR);
+  if (fd < 0 && errno == ENOENT) {
+    if (!create(path, max_templates, record_bytes)) return NULL;
+    fd = open(path, O_RDWR);
+  }
+  if (fd < 0) return NULL;
+  struct stat st;
+  void *base = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= sizeof(Header) && (uint64_t)st.st_size <= MAX_FILE_BYTES) {
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (base == MAP_FAILED) return NULL;
+
+  MtlogRegistry *registry = (MtlogRegistry *)calloc(1, sizeof(MtlogRegistry));
+  if (!registry || !header_valid((const Header *)base, (size_t)st.st_size)) {
+    munmap(base, (size_t)st.st_size);
+    free(registry);
+    return NULL;
+  }
+  registry->base = (uint8_t *)base;
+  registry->size = (size_t)st.st_size;
+  registry->header = (Header *)base;
+  registry->ids = (uint32_t *)(registry->base + registry->header->ids_offset);
+  registry->slots = (uint64_t *)(registry->base + registry->header->slots_offset);
+  registry->slot_mask = registry->header->slot_count - 1;
+  return registry;
+}
+
+void mtlog_registry_close(MtlogRegistry *registry) {
+  if (!registry) return;
+  munmap(registry->base, registry->size);
+  free(registry);
+}
+
+// The record a slot or ID entry points at, or NULL if it is out of bounds.
+static const Record *record_at(const MtlogRegistry *registry, uint32_t units) {
+  uint64_t offset = (uint64_t)units * UNIT;
+  const Header *header = registry->header;
+  if (offset < header->records_offset || offset + sizeof(Record) > header->file_bytes) return NULL;
+  const Record *record = (const Record *)(registry->base + offset);
+  if ((uint64_t)record->ir_offset + record->ir_size > header->file_bytes - offset ||
+      (uint64_t)record->length >= record->ir_offset) {
+    return NULL;
+  }
+  return record;
+}
+
+static bool record_is(const Record *record, uint64_t hash, const char *text, uint32_t length) {
+  return record && record->hash == hash && record->length == length &&
+         !memcmp((const char *)(record + 1), text, length);
+}
+
+// Point the record's ID at it, if the insert that published its slot did not
+// get that far, and return the ID. Every writer stores the same value, so
+// racing ones agree.
+static int32_t id_publish(const MtlogRegistry *registry, const Record *record, uint32_t units) {
+  if (record->id >= registry->header->max_templates) return -1;
+  if (!__atomic_load_n(&registry->ids[record->id], __ATOMIC_ACQUIRE)) {
+    __atomic_store_n(&registry->ids[record->id], units, __ATOMIC_RELEASE);
+  }
+  return (int32_t)record->id;
+}
+
+int32_t mtlog_registry_find(const MtlogRegistry *registry, const char *text, uint32_t length) {
+  uint64_t hash = mtlog_text_hash(text, length);
+  uint32_t tag = (uint32_t)(hash >> 32);
+  for (uint32_t i = (uint32_t)hash & registry->slot_mask, probes = 0; probes <= registry->slot_mask;
+       i = (i + 1) & registry->slot_mask, probes++) {
+    uint64_t slot = __atomic_load_n(&registry->slots[i], __ATOMIC_ACQUIRE);
+    if (!slot) return -1;
+    if ((uint32_t)(slot >> 32) != tag) continue;
+    const Record *record = record_at(registry, (uint32_t)slot);
+    if (record_is(record, hash, text, length)) return id_publish(registry, record, (uint32_t)slot);
+  }
+  return -1;
+}
+
+// Claim an ID and record space and write the record, unpublished. NULL if
+// the registry is full. The caller publishes the slot, then the ID: a process
+// that dies before the slot only loses an ID, and one that dies between the
+// two leaves an ID entry that the next lookup of the template fills in.
+static Record *record_new(MtlogRegistry *registry, uint64_t hash, const char *text, uint32_t length,
+                          const MtlogTemplateIR *ir) {
+  Header *header = registry->header;
+  if (__atomic_load_n(&header->next_id, __ATOMIC_RELAXED) >= header->max_templates) return NULL;
+  uint32_t ir_offset = (uint32_t)align_up(sizeof(Record) + (uint64_t)length + 1, UNIT);
+  uint64_t size = align_up((uint64_t)ir_offset + ir->size, UNIT);
+  if (size > header->record_bytes) return NULL;
+  uint64_t at = __atomic_fetch_add(&header->used_bytes, size, __ATOMIC_RELAXED);
+  if (at > header->record_bytes - size) return NULL;
+  uint32_t id = __atomic_fetch_add(&header->next_id, 1, __ATOMIC_RELAXED);
+  if (id >= header->max_templates) return NULL;
+
+  Record *record = (Record *)(registry->base + header->records_offset + at);
+  *record = (Record){hash, id, length, ir_offset, ir->size};
+  memcpy((char *)(record + 1), text, length);
+  ((char *)(record + 1))[length] = 0;
+  memcpy((uint8_t *)record + ir_offset, ir, ir->size);
+  return record;
+}
+
+int32_t mtlog_registry_intern_ir(MtlogRegistry *registry, const char *text, uint32_t length,
+                                 const MtlogTemplateIR *ir) {
+  uint64_t hash = mtlog_text_hash(text, length);
+  uint32_t tag = (uint32_t)(hash >> 32);
+  Record *created = NULL;
+  int32_t id = -1;
+  for (uint32_t i = (uint32_t)hash & registry->slot_mask, probes = 0; probes <= registry->slot_mask;
+       i = (i + 1) & registry->slot_mask, probes++) {
+    uint64_t slot = __atomic_load_n(&registry->slots[i], __ATOMIC_ACQUIRE);
+    if (!slot) {
+      if (!created && !(ir && (created = record_new(registry, hash, text, length, ir)))) break;
+      uint32_t units = (uint32_t)(((uint8_t *)created - registry->base) / UNIT);
+      uint64_t desired = (uint64_t)tag << 32 | units;
+      if (__atomic_compare_exchange_n(&registry->slots[i], &slot, desired, false, __ATOMIC_RELEASE,
+                                      __ATOMIC_ACQUIRE)) {
+        return id_publish(registry, created, units);
+      }
+      // Another insert took the slot first; `slot` now holds it.
+    }
+    if ((uint32_t)(slot >> 32) != tag) continue;
+    const Record *record = record_at(registry, (uint32_t)slot);
+    if (record_is(record, hash, text, length)) {
+      id = id_publish(registry, record, (uint32_t)slot);
+      break;
+    }
+  }
+  // The template was inserted by someone else meanwhile, or there is no room:
+  // the claimed ID, never published, stays unused.
+  return id;
+}
+
+int32_t mtlog_registry_intern(MtlogRegistry *registry, const char *text, uint32_t length) {
+  int32_t id = mtlog_registry_find(registry, text, length);
+  if (id >= 0) return id;
+  MtlogTemplateIR *ir = mtlog_ir_from_text(text, length);
+  if (!ir) return -1;
+  id = mtlog_registry_intern_ir(registry, text, length, ir);
+  mtlog_ir_delete(ir);
+  return id;
+}
+
+static const Record *record_for(const MtlogRegistry *registry, uint32_t id) {
+  if (id >= registry->header->max_templates) return NULL;
+  uint32_t units = __atomic_load_n(&registry->ids[id], __ATOMIC_ACQUIRE);
+  const Record *record = units ? record_at(registry, units) : NULL;
+  return record && record->id == id ? record : NULL;
+}
+
+const MtlogTemplateIR *mtlog_registry_ir(const MtlogRegistry *registry, uint32_t id) {
+  const Record *record = record_for(registry, id);
+  return record ? (const MtlogTemplateIR *)((const uint8_t *)record + record->ir_offset) : NULL;
+}
+
+const char *mtlog_registry_text(const MtlogRegistry *registry, uint32_t id, uint32_t *length) {
+  const Record *record = record_for(registry, id);
+  if (length) *length = record ? record->length : 0;
+  return record ? (const char *)(record + 1) : NULL;
+}
+
+void mtlog_registry_stats(const MtlogRegistry *registry, MtlogRegistryStats *stats) {
+  const Header *header = registry->header;
+  uint32_t templates = __atomic_load_n(&header->next_id, __ATOMIC_RELAXED);
+  uint64_t used = __atomic_load_n(&header->used_bytes, __ATOMIC_RELAXED);
+  stats->max_templates = header->max_templates;
+  stats->templates = templates < header->max_templates ? templates : header->max_templates;
+  stats->record_bytes = header->record_bytes;
+  stats->used_bytes = used < header->record_bytes ? used : header->record_bytes;
+}
+
+#endif
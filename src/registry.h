@@ -0,0 +1,85 @@
+#ifndef TREE_SITTER_MTLOG_REGISTRY_H_
+#define TREE_SITTER_MTLOG_REGISTRY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "template_ir.h"
+
+// Template registry shared between processes through a memory-mapped file.
+//
+// Ingest workers on one host see the same templates. The registry gives each
+// distinct template text a stable integer ID and keeps its IR next to it, so
+// a template is parsed once per host rather than once per worker, and a
+// restarted worker finds every template its predecessor registered.
+//
+// The file holds a fixed-size open-addressing table of 64-bit slots, an ID
+// table, and an append-only record area (text, then IR). Nothing in it is
+// a pointer, and nothing is ever moved or removed. Inserting claims an ID and
+// record space with atomic adds, writes the record, publishes it with a
+// compare-and-swap on an empty slot, then fills in its ID entry; lookups are
+// acquire loads and never wait or retry. A worker that dies mid-insert leaves
+// either unreferenced space or a slot whose ID entry the next lookup fills
+// in, so there is no lock to recover.
+//
+//   MtlogRegistry *registry = mtlog_registry_open("/dev/shm/mtlog.templates", 0, 0);
+//   int32_t id = mtlog_registry_intern(registry, text, length);
+//   const MtlogTemplateIR *ir = mtlog_registry_ir(registry, id);
+//   ...
+//   mtlog_registry_close(registry);
+//
+// IDs count from 0. Two workers inserting the same new template at the same
+// moment each claim an ID and one of them goes unused, so IDs are stable and
+// unique but not always dense; an unused ID has no text or IR. Interning
+// fails once the table or the record area is full. POSIX only: on Windows
+// mtlog_registry_open returns NULL.
+
+#define MTLOG_REGISTRY_VERSION 1
+
+typedef struct MtlogRegistry MtlogRegistry;
+
+typedef struct {
+  uint32_t max_templates;
+  uint32_t templates;     // IDs claimed so far, unused ones included
+  uint64_t record_bytes;  // size of the record area
+  uint64_t used_bytes;
+} MtlogRegistryStats;
+
+// Map the registry at `path`, creating it sized for `max_templates` templates
+// and `record_bytes` of text and IR if it does not exist (0 picks 65536 and
+// 64 MiB; the file is sparse until used). An existing file keeps its own
+// sizes. Concurrent opens of a new path agree on one file. Returns NULL if the
+// file cannot be created or mapped, or is not a registry of this version.
+MtlogRegistry *mtlog_registry_open(const char *path, uint32_t max_templates, uint64_t record_bytes);
+
+// Unmap the registry. The file and everything in it stay.
+void mtlog_registry_close(MtlogRegistry *registry);
+
+// Return the ID of `text`, registering it with the IR from
+// mtlog_ir_from_text if it is new. Returns -1 if it is new and the registry
+// is full or allocation fails.
+int32_t mtlog_registry_intern(MtlogRegistry *registry, const char *text, uint32_t length);
+
+// Same, storing `ir` (for instance from mtlog_ir_from_tree) if the template
+// is new. `ir` must describe `text`.
+int32_t mtlog_registry_intern_ir(MtlogRegistry *registry, const char *text, uint32_t length,
+                                 const MtlogTemplateIR *ir);
+
+// The ID of `text`, or -1 if it is not registered. Never writes.
+int32_t mtlog_registry_find(const MtlogRegistry *registry, const char *text, uint32_t length);
+
+// The IR and text of template `id`, pointing into the mapping and valid
+// until close, or NULL if no template has that ID.
+const MtlogTemplateIR *mtlog_registry_ir(const MtlogRegistry *registry, uint32_t id);
+const char *mtlog_registry_text(const MtlogRegistry *registry, uint32_t id, uint32_t *length);
+
+void mtlog_registry_stats(const MtlogRegistry *registry, MtlogRegistryStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_REGISTRY_H_
@@ -0,0 +1,255 @@
+#include "render.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+  OP_LITERAL, // copy text
+  OP_VALUE,   // write values[slot]; text is the property's source for fallback
+} OpCode;
+
+#define NO_SPEC UINT32_MAX
+
+typedef struct {
+  uint8_t code;
+  uint8_t hint; // '@', '$' or 0
+  uint16_t reserved;
+  uint32_t slot;
+  uint32_t spec; // index into specs, or NO_SPEC
+  uint32_t text; // offsets into the program's copy of the source
+  uint32_t text_length;
+  uint32_t format;
+  uint32_t format_length;
+} Op;
+
+typedef struct {
+  uint32_t name;
+  uint32_t length;
+  bool builtin;
+} Slot;
+
+// One allocation: the header, then ops, slots, compiled formats and a copy
+// of the source.
+struct MtlogRenderProgram {
+  uint32_t op_count;
+  uint32_t slot_count;
+  const Op *ops;
+  const Slot *slots;
+  const MtlogFormatSpec *specs;
+  const char *source;
+};
+
+static uint32_t find_slot(const Slot *slots, uint32_t count, const char *text, MtlogSpan name, bool builtin) {
+  uint32_t length = name.end - name.start;
+  for (uint32_t i = 0; i < count; i++) {
+    if (slots[i].builtin == builtin && slots[i].length == length &&
+        !memcmp(text + slots[i].name, text + name.start, length)) {
+      return i;
+    }
+  }
+  return count;
+}
+
+MtlogRenderProgram *mtlog_render_compile(const MtlogTemplateIR *ir, const char *text) {
+  const MtlogSpan *spans = mtlog_ir_spans(ir);
+  const MtlogSpan *names = mtlog_ir_names(ir);
+  const MtlogSpan *formats = mtlog_ir_formats(ir);
+  const uint8_t *kinds = mtlog_ir_kinds(ir);
+  const uint8_t *hints = mtlog_ir_hints(ir);
+
+  // Upper bounds: adjacent literals merge and repeated names share a slot.
+  uint32_t max_ops = ir->segment_count;
+  uint32_t max_slots = ir->property_count;
+  uint32_t spec_count = 0;
+  for (uint32_t i = 0; i < ir->segment_count; i++) spec_count += formats[i].start != formats[i].end;
+  size_t size = sizeof(MtlogRenderProgram) + max_ops * sizeof(Op) + max_slots * sizeof(Slot) +
+                spec_count * sizeof(MtlogFormatSpec) + ir->source_length;
+  MtlogRenderProgram *program = (MtlogRenderProgram *)malloc(size);
+  if (!program) return NULL;
+
+  Op *ops = (Op *)(program + 1);
+  Slot *slots = (Slot *)(ops + max_ops);
+  MtlogFormatSpec *specs = (MtlogFormatSpec *)(slots + max_slots);
+  char *source = (char *)(specs + spec_count);
+  if (ir->source_length) memcpy(source, text, ir->source_length);
+
+  uint32_t op_count = 0, slot_count = 0;
+  spec_count = 0;
+  for (uint32_t i = 0; i < ir->segment_count; i++) {
+    if (kinds[i] == MTLOG_SEGMENT_LITERAL) {
+      if (spans[i].start == spans[i].end) continue;
+      Op *previous = op_count ? &ops[op_count - 1] : NULL;
+      if (previous && previous->code == OP_LITERAL && previous->text + previous->text_length == spans[i].start) {
+        previous->text_length += spans[i].end - spans[i].start;
+        continue;
+      }
+      ops[op_count++] = (Op){
+        .code = OP_LITERAL,
+        .spec = NO_SPEC,
+        .text = spans[i].start,
+        .text_length = spans[i].end - spans[i].start,
+      };
+      continue;
+    }
+
+    bool builtin = kinds[i] == MTLOG_SEGMENT_BUILTIN_PROPERTY;
+    uint32_t slot = find_slot(slots, slot_count, source, names[i], builtin);
+    if (slot == slot_count) {
+      slots[slot_count++] = (Slot){names[i].start, names[i].end - names[i].start, builtin};
+    }
+    uint32_t spec = NO_SPEC;
+    if (formats[i].start != formats[i].end) {
+      spec = spec_count++;
+      mtlog_format_spec_compile(source + formats[i].start, formats[i].end - formats[i].start, &specs[spec]);
+    }
+    ops[op_count++] = (Op){
+      .code = OP_VALUE,
+      .hint = hints[i],
+      .slot = slot,
+      .spec = spec,
+      .text = spans[i].start,
+      .text_length = spans[i].end - spans[i].start,
+      .format = formats[i].start,
+      .format_length = formats[i].end - formats[i].start,
+    };
+  }
+
+  program->op_count = op_count;
+  program->slot_count = slot_count;
+  program->ops = ops;
+  program->slots = slots;
+  program->specs = specs;
+  program->source = source;
+  return program;
+}
+
+MtlogRenderProgram *mtlog_render_compile_text(const char *text, uint32_t length) {
+  MtlogTemplateIR *ir = mtlog_ir_from_text(text, length);
+  if (!ir) return NULL;
+  MtlogRenderProgram *program = mtlog_render_compile(ir, text);
+  mtlog_ir_delete(ir);
+  return program;
+}
+
+void mtlog_render_delete(MtlogRenderProgram *program) { free(program); }
+
+uint32_t mtlog_render_op_count(const MtlogRenderProgram *program) { return program->op_count; }
+
+uint32_t mtlog_render_slot_count(const MtlogRenderProgram *program) { return program->slot_count; }
+
+MtlogRenderSlot mtlog_render_slot(const MtlogRenderProgram *program, uint32_t slot) {
+  const Slot *s = &program->slots[slot];
+  MtlogRenderSlot result = {program->source + s->name, s->length, s->builtin};
+  return result;
+}
+
+bool mtlog_render_append(MtlogRenderBuffer *buffer, const char *data, size_t length) {
+  if (length > buffer->capacity - buffer->length) {
+    size_t needed = buffer->length + length;
+    if (!buffer->grow || !buffer->grow(buffer, needed) || buffer->capacity < needed) return false;
+  }
+  if (length) memcpy(buffer->data + buffer->length, data, length);
+  buffer->length += length;
+  return true;
+}
+
+// Whether `spec` can be applied to a value of `kind` without a hook.
+static bool spec_applies(const MtlogFormatSpec *spec, MtlogValueKind kind) {
+  switch (spec->kind) {
+    case MTLOG_FORMAT_NONE:
+    case MTLOG_FORMAT_PADDING:
+      return true;
+    case MTLOG_FORMAT_NUMBER:
+      return kind == MTLOG_VALUE_INT || kind == MTLOG_VALUE_UINT || kind == MTLOG_VALUE_DOUBLE;
+    case MTLOG_FORMAT_DATE:
+      return kind == MTLOG_VALUE_TIME;
+    case MTLOG_FORMAT_LEVEL:
+      return kind == MTLOG_VALUE_STRING;
+    default:
+      return false;
+  }
+}
+
+static bool write_scalar(const MtlogFormatSpec *spec, const MtlogValue *value, MtlogRenderBuffer *out) {
+  char text[MTLOG_FORMAT_MAX_OUTPUT];
+  uint32_t length;
+  switch (value->kind) {
+    case MTLOG_VALUE_NULL:
+      return mtlog_render_append(out, "null", 4);
+    case MTLOG_VALUE_BOOL:
+      return value->as.boolean ? mtlog_render_append(out, "true", 4) : mtlog_render_append(out, "false", 5);
+    case MTLOG_VALUE_INT:
+      length = mtlog_format_int(spec, value->as.integer, text);
+      break;
+    case MTLOG_VALUE_UINT:
+      length = mtlog_format_uint(spec, value->as.uinteger, text);
+      break;
+    case MTLOG_VALUE_DOUBLE:
+      length = mtlog_format_double(spec, value->as.number, text);
+      break;
+    case MTLOG_VALUE_TIME:
+      length = mtlog_format_time(spec, value->as.integer, text);
+      break;
+    default:
+      if (spec && spec->kind == MTLOG_FORMAT_LEVEL) {
+        length = mtlog_format_level(spec, value->as.string, value->length, text);
+        break;
+      }
+      return mtlog_render_append(out, value->as.string, value->length);
+  }
+  return mtlog_render_append(out, text, length);
+}
+
+// Align the text written since `start` to the spec's width.
+static bool pad(MtlogRenderBuffer *out, size_t start, const MtlogFormatSpec *spec) {
+  static const char spaces[] = "                                ";
+  size_t length = out->length - start;
+  if (length >= spec->width) return true;
+  size_t missing = spec->width - length;
+  for (size_t n = missing; n;) {
+    size_t chunk = n < sizeof(spaces) - 1 ? n : sizeof(spaces) - 1;
+    if (!mtlog_render_append(out, spaces, chunk)) return false;
+    n -= chunk;
+  }
+  if (!(spec->flags & MTLOG_FORMAT_LEFT)) {
+    memmove(out->data + start + missing, out->data + start, length);
+    memset(out->data + start, ' ', missing);
+  }
+  return true;
+}
+
+static bool write_value(const MtlogRenderProgram *program, const Op *op, const MtlogValue *value,
+                        const MtlogRenderHooks *hooks, MtlogRenderBuffer *out) {
+  const MtlogFormatSpec *spec = op->spec == NO_SPEC ? NULL : &program->specs[op->spec];
+  MtlogRenderHook hook = NULL;
+  if (hooks && value->kind != MTLOG_VALUE_MISSING) {
+    if (op->hint == '@') hook = hooks->destructure;
+    else if (op->hint == '$') hook = hooks->stringify;
+    if (!hook && spec && !spec_applies(spec, value->kind)) hook = hooks->format;
+    if (!hook && value->kind == MTLOG_VALUE_OPAQUE) hook = hooks->stringify;
+  }
+
+  size_t start = out->length;
+  bool ok;
+  if (hook) {
+    ok = hook(out, value, program->source + op->format, op->format_length, hooks->context);
+  } else if (value->kind == MTLOG_VALUE_MISSING || value->kind == MTLOG_VALUE_OPAQUE) {
+    // Nothing to write it with: keep the property text.
+    ok = mtlog_render_append(out, program->source + op->text, op->text_length);
+  } else {
+    ok = write_scalar(spec, value, out);
+  }
+  if (ok && spec && spec->kind == MTLOG_FORMAT_PADDING) ok = pad(out, start, spec);
+  return ok;
+}
+
+bool mtlog_render(const MtlogRenderProgram *program, const MtlogValue *values, const MtlogRenderHooks *hooks,
+                  MtlogRenderBuffer *out) {
+  for (uint32_t i = 0; i < program->op_count; i++) {
+    const Op *op = &program->ops[i];
+    bool ok = op->code == OP_LITERAL ? mtlog_render_append(out, program->source + op->text, op->text_length)
+                                     : write_value(program, op, &values[op->slot], hooks, out);
+    if (!ok) return false;
+  }
+  return true;
+}
@@ -0,0 +1,134 @@
+#ifndef TREE_SITTER_MTLOG_RENDER_H_
+#define TREE_SITTER_MTLOG_RENDER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "format_spec.h"
+#include "template_ir.h"
+
+// Template rendering without per-event allocation.
+//
+// A template is compiled once into a short opcode list: literal runs, and one
+// value op per property, builtin property or Go property, carrying its capture
+// hint and its format compiled into an MtlogFormatSpec (format_spec.h), so
+// rendering never re-reads format strings. Each distinct property name
+// becomes a slot, and an event supplies one MtlogValue per slot. Rendering
+// appends to a buffer the caller owns and reuses across events; the renderer
+// itself never allocates.
+//
+//   MtlogTemplateIR *ir = mtlog_ir_from_tree(root, text, length);
+//   MtlogRenderProgram *program = mtlog_render_compile(ir, text);
+//   mtlog_ir_delete(ir);
+//
+//   MtlogRenderBuffer out = {buffer, 0, sizeof(buffer), NULL, NULL};
+//   for (each event) {
+//     MtlogValue values[MAX_SLOTS];
+//     for (uint32_t i = 0; i < mtlog_render_slot_count(program); i++)
+//       values[i] = lookup(event, mtlog_render_slot(program, i));
+//     out.length = 0;
+//     mtlog_render(program, values, &hooks, &out);
+//   }
+//
+// Values are written as follows:
+//
+//   '@' hint     hooks->destructure, if set
+//   '$' hint     hooks->stringify, if set
+//   format       natively when it fits the value: numeric formats for
+//                numbers, date formats for times, level formats for strings,
+//                and padding for anything; otherwise hooks->format, if set
+//   otherwise    scalars natively (a format that does not fit is ignored);
+//                strings as is; opaque values through hooks->stringify
+//
+// A missing value, or an opaque one with no hook to write it, renders the
+// property's original text, such as `{UserId}`.
+
+typedef enum {
+  MTLOG_VALUE_MISSING,
+  MTLOG_VALUE_NULL,
+  MTLOG_VALUE_BOOL,
+  MTLOG_VALUE_INT,
+  MTLOG_VALUE_UINT,
+  MTLOG_VALUE_DOUBLE,
+  MTLOG_VALUE_STRING,
+  MTLOG_VALUE_TIME,   // as.integer: nanoseconds since the Unix epoch, UTC
+  MTLOG_VALUE_OPAQUE, // caller-defined; rendered only through hooks
+} MtlogValueKind;
+
+typedef struct {
+  MtlogValueKind kind;
+  uint32_t length; // MTLOG_VALUE_STRING only
+  union {
+    bool boolean;
+    int64_t integer;
+    uint64_t uinteger;
+    double number;
+    const char *string;
+    const void *opaque;
+  } as;
+} MtlogValue;
+
+// Output buffer. When `length + n` would exceed `capacity`, `grow` is asked for
+// a buffer of at least `capacity` bytes holding the current contents; it
+// updates `data` and `capacity` and returns false on failure. With no `grow`,
+// rendering into a full buffer fails. Reusing one buffer across events means
+// growth stops once it fits the largest event.
+typedef struct MtlogRenderBuffer {
+  char *data;
+  size_t length;
+  size_t capacity;
+  bool (*grow)(struct MtlogRenderBuffer *buffer, size_t capacity);
+  void *context; // for `grow`
+} MtlogRenderBuffer;
+
+bool mtlog_render_append(MtlogRenderBuffer *buffer, const char *data, size_t length);
+
+// Hooks write a value with mtlog_render_append and return false to abort
+// rendering. `format` is empty (length 0) when the property has none.
+typedef bool (*MtlogRenderHook)(MtlogRenderBuffer *out, const MtlogValue *value, const char *format,
+                                uint32_t format_length, void *context);
+
+typedef struct {
+  MtlogRenderHook destructure; // '@'
+  MtlogRenderHook stringify;   // '$'
+  MtlogRenderHook format;      // values with a format string
+  void *context;
+} MtlogRenderHooks;
+
+typedef struct MtlogRenderProgram MtlogRenderProgram;
+
+typedef struct {
+  const char *name; // not NUL-terminated
+  uint32_t length;
+  bool builtin;     // `${Name}`; kept apart from a `{Name}` property
+} MtlogRenderSlot;
+
+// Compile the template `text` described by `ir`. The program copies what it
+// needs, so neither has to outlive it. Returns NULL if allocation fails.
+MtlogRenderProgram *mtlog_render_compile(const MtlogTemplateIR *ir, const char *text);
+
+// Same, extracting the segments from `text` without a parser.
+MtlogRenderProgram *mtlog_render_compile_text(const char *text, uint32_t length);
+
+void mtlog_render_delete(MtlogRenderProgram *program);
+
+uint32_t mtlog_render_op_count(const MtlogRenderProgram *program);
+uint32_t mtlog_render_slot_count(const MtlogRenderProgram *program);
+MtlogRenderSlot mtlog_render_slot(const MtlogRenderProgram *program, uint32_t slot);
+
+// Append the rendered template to `out`, with `values` indexed by slot. Returns
+// false if the buffer could not grow or a hook failed; `out` then holds a
+// partial rendering.
+bool mtlog_render(const MtlogRenderProgram *program, const MtlogValue *values, const MtlogRenderHooks *hooks,
+                  MtlogRenderBuffer *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_RENDER_H_
@@ -2,48 +2,87 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "char_class.h"
+
 enum TokenType { LITERAL_TEXT };
 
-static inline bool is_ident_start(int32_t c) {
-  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
-}
-static inline bool is_digit(int32_t c) { return c >= '0' && c <= '9'; }
+// The scanner is stateless: every decision is made from the characters
+// ahead on the current line, so there is no payload to allocate and nothing
+// to serialize. Zero-byte external state compares equal everywhere, which lets
+// incremental reparses reuse subtrees across edits.
+void *tree_sitter_mtlog_external_scanner_create() { return NULL; }
 
-typedef struct {
-  bool started; // have we seen any non-newline character yet?
-} Scanner;
+void tree_sitter_mtlog_external_scanner_destroy(void *payload) { (void)payload; }
 
-void *tree_sitter_mtlog_external_scanner_create() {
-  Scanner *s = (Scanner *)calloc(1, sizeof(Scanner));
-  s->started = false;
-  return s;
+unsigned tree_sitter_mtlog_external_scanner_serialize(void *payload, char *buffer) {
+  (void)payload;
+  (void)buffer;
+  return 0;
 }
 
-void tree_sitter_mtlog_external_scanner_destroy(void *payload) {
-  if (payload) free(payload);
+void tree_sitter_mtlog_external_scanner_deserialize(void *payload, const char *buffer, unsigned length) {
+  (void)payload;
+  (void)buffer;
+  (void)length;
 }
 
-unsigned tree_sitter_mtlog_external_scanner_serialize(void *p, char *b) {
-  Scanner *s = (Scanner *)p;
-  if (!s || !b) return 0;
-  b[0] = s->started ? 1 : 0;
-  return 1;
+// Result of looking ahead past an opening '{' or '${'.
+typedef enum {
+  CONSTRUCT_OPEN,       // not a well-formed construct on this line → literal
+  CONSTRUCT_CLOSED,     // well-formed and closed on this line → grammar parses it
+  CONSTRUCT_BUILTIN,    // '{' immediately followed by a '${' opener
+} ConstructResult;
+
+// Consume `name? (':' format)?` the way the grammar would lex it and report
+// whether the closing '}' follows on this line. The lookahead stops at the
+// first character that cannot continue the construct, so every character is
+// inspected a bounded number of times no matter how many braces a line holds.
+static bool scan_name_and_format(TSLexer *lexer) {
+  if (is_ident_start(lexer->lookahead)) {
+    for (;;) {
+      do lexer->advance(lexer, false); while (is_ident_char(lexer->lookahead));
+      if (lexer->lookahead != '.') break;
+      lexer->advance(lexer, false);
+      if (!is_ident_start(lexer->lookahead)) return false;
+    }
+  } else if (is_digit(lexer->lookahead)) {
+    do lexer->advance(lexer, false); while (is_digit(lexer->lookahead));
+  }
+
+  if (lexer->lookahead == ':') {
+    lexer->advance(lexer, false);
+    if (lexer->lookahead == '}') return false; // format_spec is never empty
+    while (lexer->lookahead && lexer->lookahead != '}' && !is_newline(lexer->lookahead)) {
+      lexer->advance(lexer, false);
+    }
+  }
+
+  return lexer->lookahead == '}';
 }
 
-void tree_sitter_mtlog_external_scanner_deserialize(void *p, const char *b, unsigned l) {
-  Scanner *s = (Scanner *)p;
-  if (!s) return;
-  if (b && l >= 1) {
-    s->started = b[0] != 0;
-  } else {
-    s->started = false;
+// Called with '{' consumed: `[@$]? name? (':' format)? '}'`.
+static ConstructResult scan_property_tail(TSLexer *lexer) {
+  if (lexer->lookahead == '@') {
+    lexer->advance(lexer, false);
+  } else if (lexer->lookahead == '$') {
+    lexer->advance(lexer, false);
+    if (lexer->lookahead == '{') return CONSTRUCT_BUILTIN;
   }
+  return scan_name_and_format(lexer) ? CONSTRUCT_CLOSED : CONSTRUCT_OPEN;
+}
+
+// Called with '${' consumed: `name? (':' format)? '}'`.
+static ConstructResult scan_builtin_tail(TSLexer *lexer) {
+  return scan_name_and_format(lexer) ? CONSTRUCT_CLOSED : CONSTRUCT_OPEN;
 }
 
 bool tree_sitter_mtlog_external_scanner_scan(void *payload, TSLexer *lexer, const bool *valid_symbols) {
-  Scanner *state = (Scanner *)payload;
+  (void)payload;
   if (!valid_symbols[LITERAL_TEXT]) return false;
 
+  // Invariant: whenever has_content is set, mark_end has been called at the
+  // current position, so mark_end is only needed where a run of literal text
+  // ends and returning from any case emits exactly that run.
   bool has_content = false;
 
   for (;;) {
@@ -67,149 +106,66 @@ bool tree_sitter_mtlog_external_scanner_scan(void *payload, TSLexer *lexer, cons
         continue;
 
       case '{': {
-        state->started = true;
-        if (!has_content) {
-          // At BOF: peek ahead to determine if this starts a valid construct.
-          // Only advance when we intend to emit literal_text; otherwise, defer to grammar.
-          lexer->mark_end(lexer);             // potential end before '{'
-          lexer->advance(lexer, false);       // consume '{' for inspection
-          int32_t n = lexer->lookahead;
-
-          // If it's a Go-template opener '{{', let grammar handle it (with recovery if unclosed)
-          if (n == '{') {
-            return false;
-          }
-
-          // Single-brace: check if this could be a valid property and if it closes on this line
-          bool maybe_property = (n == '}' || n == ':' || n == '@' || n == '$' || is_ident_start(n) || is_digit(n));
-
-          if (maybe_property) {
-            bool saw_close = false;
-            while (lexer->lookahead && lexer->lookahead != '\n' && lexer->lookahead != '\r') {
-              if (lexer->lookahead == '}') { saw_close = true; break; }
-              lexer->advance(lexer, false);
-            }
-            if (saw_close) {
-              // Well-formed property ahead → let grammar parse it
-              return false;
-            }
-          }
-
-          // Not a valid property on this line → treat as literal
-          has_content = true;
-          continue;
-        }
-
-        // We're in the middle of literal text. Decide whether to stop before
-        // this '{' (if it begins a valid construct that closes on this line),
-        // or to consume it as literal (for invalid/unclosed cases).
-        lexer->mark_end(lexer); // potential end before '{'
-
-        // Peek next char
         lexer->advance(lexer, false); // consume '{' for inspection
-        int32_t n = lexer->lookahead;
-
-        if (n == '{') {
-          // Go-template candidate: look for a matching '}}' before newline/EOF
-          bool saw_close = false;
-          int32_t prev = 0;
-          while (lexer->lookahead && lexer->lookahead != '\n') {
-            if (prev == '}' && lexer->lookahead == '}') { saw_close = true; break; }
-            prev = lexer->lookahead;
-            lexer->advance(lexer, false);
-          }
-
-          if (saw_close) {
-            // End literal before the '{{'
-            lexer->result_symbol = LITERAL_TEXT;
-            return true;
-          }
 
-          // Unclosed '{{' → end literal before '{{' to let grammar recover
-          lexer->result_symbol = LITERAL_TEXT;
-          return true;
+        // Go-template opener '{{': end the literal before it, or let the
+        // grammar handle it (with recovery if unclosed) at token start.
+        if (lexer->lookahead == '{') {
+          if (has_content) { lexer->result_symbol = LITERAL_TEXT; return true; }
+          return false;
         }
 
-        // Single-brace property candidate
-        bool maybe_property = (n == '}' || n == ':' || n == '@' || n == '$' || is_ident_start(n) || is_digit(n));
-        if (maybe_property) {
-          // Look for a closing '}' before newline/EOF
-          bool saw_close = false;
-          while (lexer->lookahead && lexer->lookahead != '\n') {
-            if (lexer->lookahead == '}') { saw_close = true; break; }
-            lexer->advance(lexer, false);
-          }
+        // At token start the '{' alone is the literal if a '${' follows it.
+        if (!has_content) lexer->mark_end(lexer);
 
-          if (saw_close) {
-            // End literal before '{'
+        switch (scan_property_tail(lexer)) {
+          case CONSTRUCT_CLOSED:
+            // Well-formed property ahead → end literal before '{', or let
+            // the grammar parse it when nothing has been collected yet.
+            if (has_content) { lexer->result_symbol = LITERAL_TEXT; return true; }
+            return false;
+
+          case CONSTRUCT_BUILTIN:
+            // '{' is literal; the builtin starts at the '$' we peeked over.
+            // After content the run still ends before the '{', so `x{${A}}`
+            // yields two literal_text nodes: only the character after '$'
+            // tells this from `x{$A}`, mark_end cannot move back to just past
+            // the '{', and the end must already sit before '{' for `{$A}`.
+            // The IR builders fold adjacent literals into one segment.
             lexer->result_symbol = LITERAL_TEXT;
             return true;
-          }
 
-          // Unclosed '{' ... treat the rest of the line as literal
-          lexer->mark_end(lexer);
-          has_content = true;
-          continue;
+          case CONSTRUCT_OPEN:
+            // Not a property on this line → everything inspected is literal.
+            lexer->mark_end(lexer);
+            has_content = true;
+            continue;
         }
-
-        // Definitely not a property — consume as literal
-        has_content = true;
         continue;
       }
 
       case '$': {
-        state->started = true;
-        if (!has_content) {
-          // At BOF: check if a well-formed builtin follows; else treat as literal
-          lexer->advance(lexer, false); // consume '$'
-          if (lexer->lookahead == '{') {
-            bool saw_close = false;
-            while (lexer->lookahead && lexer->lookahead != '\n' && lexer->lookahead != '\r') {
-              if (lexer->lookahead == '}') { saw_close = true; break; }
-              lexer->advance(lexer, false);
-            }
-            if (saw_close) {
-              return false; // real builtin
-            }
-            // Unclosed ${ → literal
-            has_content = true;
-            continue;
-          }
-          // Lone '$' → literal
-          has_content = true;
-          continue;
-        }
-
-        // In the middle of literal text; check for '${...}' with closing '}'
-        lexer->mark_end(lexer); // end before '$'
         lexer->advance(lexer, false); // consume '$' for inspection
-        if (lexer->lookahead == '{') {
-          // Look for a closing '}' before newline/EOF
-          bool saw_close = false;
-          while (lexer->lookahead && lexer->lookahead != '\n') {
-            if (lexer->lookahead == '}') { saw_close = true; break; }
-            lexer->advance(lexer, false);
-          }
 
-          if (saw_close) {
-            lexer->result_symbol = LITERAL_TEXT;
-            return true;
+        if (lexer->lookahead == '{') {
+          lexer->advance(lexer, false);
+          if (scan_builtin_tail(lexer) == CONSTRUCT_CLOSED) {
+            // Well-formed builtin ahead → end literal before '${', or let
+            // the grammar parse it when nothing has been collected yet.
+            if (has_content) { lexer->result_symbol = LITERAL_TEXT; return true; }
+            return false;
           }
-
-          // Unclosed '${' ... treat the rest of the line as literal
-          lexer->mark_end(lexer);
-          has_content = true;
-          continue;
         }
 
-        // Lone '$' — treat as literal
+        // Lone '$' or unclosed '${' → literal
+        lexer->mark_end(lexer);
         has_content = true;
         continue;
       }
 
       default:
-        state->started = true;
-        lexer->advance(lexer, false);
+        // Literal run: consume plain text in bulk and mark its end once.
+        do lexer->advance(lexer, false); while (is_plain(lexer->lookahead));
         lexer->mark_end(lexer);
         has_content = true;
         break;
@@ -0,0 +1,212 @@
+#include "structural.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MTLOG_X86 1
+#endif
+
+#if defined(MTLOG_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MTLOG_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// The AVX2 kernel is compiled for its own target so the rest of the file (and
+// the grammar) keeps the baseline ISA; it only runs when the CPU reports AVX2.
+#if defined(MTLOG_X86) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define MTLOG_HAVE_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MTLOG_TARGET_AVX2
+#else
+#define MTLOG_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+typedef void (*IndexKernel)(const unsigned char *block, MtlogStructuralBlock *out);
+
+// ---------------------------------------------------------------------------
+// Scalar fallback
+
+// Mask slot per byte; slot 0 collects everything that is not structural.
+enum { SLOT_NONE, SLOT_OPEN, SLOT_CLOSE, SLOT_DOLLAR, SLOT_COLON, SLOT_AT, SLOT_LINE_END, SLOT_COUNT };
+
+static const uint8_t STRUCTURAL_SLOT[256] = {
+  [0] = SLOT_LINE_END, ['\n'] = SLOT_LINE_END, ['\r'] = SLOT_LINE_END,
+  ['{'] = SLOT_OPEN, ['}'] = SLOT_CLOSE, ['$'] = SLOT_DOLLAR, [':'] = SLOT_COLON, ['@'] = SLOT_AT,
+};
+
+static void index_scalar(const unsigned char *block, MtlogStructuralBlock *out) {
+  uint64_t masks[SLOT_COUNT] = {0};
+  for (unsigned i = 0; i < MTLOG_STRUCTURAL_BLOCK; i++) {
+    masks[STRUCTURAL_SLOT[block[i]]] |= (uint64_t)1 << i;
+  }
+  out->open_brace = masks[SLOT_OPEN];
+  out->close_brace = masks[SLOT_CLOSE];
+  out->dollar = masks[SLOT_DOLLAR];
+  out->colon = masks[SLOT_COLON];
+  out->at = masks[SLOT_AT];
+  out->line_end = masks[SLOT_LINE_END];
+}
+
+// ---------------------------------------------------------------------------
+// SSE2: four 16-byte lanes per block
+
+#ifdef MTLOG_HAVE_SSE2
+static inline uint64_t sse2_match(__m128i v, char c) {
+  return (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+}
+
+static void index_sse2(const unsigned char *block, MtlogStructuralBlock *out) {
+  MtlogStructuralBlock result = {0};
+  for (unsigned lane = 0; lane < 4; lane++) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(block + lane * 16));
+    unsigned shift = lane * 16;
+    result.open_brace |= sse2_match(v, '{') << shift;
+    result.close_brace |= sse2_match(v, '}') << shift;
+    result.dollar |= sse2_match(v, '$') << shift;
+    result.colon |= sse2_match(v, ':') << shift;
+    result.at |= sse2_match(v, '@') << shift;
+    result.line_end |= (sse2_match(v, '\n') | sse2_match(v, '\r') | sse2_match(v, '\0')) << shift;
+  }
+  *out = result;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// AVX2: two 32-byte lanes per block
+
+#ifdef MTLOG_HAVE_AVX2
+MTLOG_TARGET_AVX2 static inline uint64_t avx2_match(__m256i v, char c) {
+  return (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+}
+
+MTLOG_TARGET_AVX2 static void index_avx2(const unsigned char *block, MtlogStructuralBlock *out) {
+  __m256i lo = _mm256_loadu_si256((const __m256i *)block);
+  __m256i hi = _mm256_loadu_si256((const __m256i *)(block + 32));
+#define MATCH(c) (avx2_match(lo, c) | avx2_match(hi, c) << 32)
+  out->open_brace = MATCH('{');
+  out->close_brace = MATCH('}');
+  out->dollar = MATCH('$');
+  out->colon = MATCH(':');
+  out->at = MATCH('@');
+  out->line_end = MATCH('\n') | MATCH('\r') | MATCH('\0');
+#undef MATCH
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Dispatch
+
+static bool cpu_has_avx2(void) {
+#if defined(MTLOG_HAVE_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+  __cpuid(info, 1);
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false; // OS saves YMM state
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#elif defined(MTLOG_HAVE_AVX2)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+static MtlogStructuralKernel detect(void) {
+  if (cpu_has_avx2()) return MTLOG_KERNEL_AVX2;
+#ifdef MTLOG_HAVE_SSE2
+  return MTLOG_KERNEL_SSE2;
+#else
+  return MTLOG_KERNEL_SCALAR;
+#endif
+}
+
+static IndexKernel kernel_function(MtlogStructuralKernel kernel) {
+  switch (kernel) {
+#ifdef MTLOG_HAVE_AVX2
+    case MTLOG_KERNEL_AVX2: return index_avx2;
+#endif
+#ifdef MTLOG_HAVE_SSE2
+    case MTLOG_KERNEL_SSE2: return index_sse2;
+#endif
+    case MTLOG_KERNEL_SCALAR: return index_scalar;
+    default: return NULL;
+  }
+}
+
+#if defined(_MSC_VER) && !defined(__clang__)
+// Volatile accesses have acquire and release semantics under /volatile:ms.
+#define kernel_load(k) (*(volatile MtlogStructuralKernel *)(k))
+#define kernel_store(k, v) (*(volatile MtlogStructuralKernel *)(k) = (v))
+#define function_load(f) (*(IndexKernel volatile *)(f))
+#define function_store(f, v) (*(IndexKernel volatile *)(f) = (v))
+#else
+#define kernel_load(k) __atomic_load_n((k), __ATOMIC_ACQUIRE)
+#define kernel_store(k, v) __atomic_store_n((k), (v), __ATOMIC_RELEASE)
+#define function_load(f) __atomic_load_n((f), __ATOMIC_ACQUIRE)
+#define function_store(f, v) __atomic_store_n((f), (v), __ATOMIC_RELEASE)
+#endif
+
+// Resolved on first use, possibly by several threads at once; all of them
+// store the same values. The function is published before the kernel, so a
+// thread that sees the kernel set also sees its function.
+static MtlogStructuralKernel active_kernel = MTLOG_KERNEL_AUTO;
+static IndexKernel active_function;
+
+static void publish(MtlogStructuralKernel kernel, IndexKernel function) {
+  function_store(&active_function, function);
+  kernel_store(&active_kernel, kernel);
+}
+
+MtlogStructuralKernel mtlog_structural_kernel(void) {
+  MtlogStructuralKernel kernel = kernel_load(&active_kernel);
+  if (kernel == MTLOG_KERNEL_AUTO) {
+    kernel = detect();
+    publish(kernel, kernel_function(kernel));
+  }
+  return kernel;
+}
+
+bool mtlog_structural_use_kernel(MtlogStructuralKernel kernel) {
+  if (kernel == MTLOG_KERNEL_AUTO) kernel = detect();
+  IndexKernel function = kernel_function(kernel);
+  if (!function || (kernel == MTLOG_KERNEL_AVX2 && !cpu_has_avx2())) return false;
+  publish(kernel, function);
+  return true;
+}
+
+const char *mtlog_structural_kernel_name(MtlogStructuralKernel kernel) {
+  switch (kernel) {
+    case MTLOG_KERNEL_SCALAR: return "scalar";
+    case MTLOG_KERNEL_SSE2: return "sse2";
+    case MTLOG_KERNEL_AVX2: return "avx2";
+    default: return "auto";
+  }
+}
+
+void mtlog_structural_index(const char *buffer, uint32_t length, MtlogStructuralBlock *blocks) {
+  IndexKernel kernel = function_load(&active_function);
+  if (!kernel) {
+    mtlog_structural_kernel();
+    kernel = function_load(&active_function);
+  }
+  const unsigned char *data = (const unsigned char *)buffer;
+
+  uint32_t full = length / MTLOG_STRUCTURAL_BLOCK;
+  for (uint32_t i = 0; i < full; i++) kernel(data + i * MTLOG_STRUCTURAL_BLOCK, &blocks[i]);
+
+  // Copy the tail into a block padded with a byte that matches nothing, so no
+  // kernel reads past the buffer and bits past the end stay clear.
+  uint32_t rest = length % MTLOG_STRUCTURAL_BLOCK;
+  if (rest) {
+    unsigned char tail[MTLOG_STRUCTURAL_BLOCK];
+    memset(tail, ' ', sizeof(tail));
+    memcpy(tail, data + full * MTLOG_STRUCTURAL_BLOCK, rest);
+    kernel(tail, &blocks[full]);
+  }
+}
@@ -0,0 +1,81 @@
+#ifndef TREE_SITTER_MTLOG_STRUCTURAL_H_
+#define TREE_SITTER_MTLOG_STRUCTURAL_H_
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Structural index for bulk extraction.
+//
+// The first stage of the tree-free extractor (properties.h): classify a
+// buffer 64 bytes at a time into one bitmap per delimiter, using SSE2 or AVX2
+// where the CPU has them. The second stage then jumps from one set bit to the
+// next instead of testing every byte, so long literal runs cost a few
+// instructions per 64 bytes. The kernel is chosen once at runtime.
+
+#define MTLOG_STRUCTURAL_BLOCK 64
+
+// Bit i of each mask is set when byte i of the block is that delimiter. Bits
+// past the end of the buffer are clear.
+typedef struct {
+  uint64_t open_brace;  // '{'
+  uint64_t close_brace; // '}'
+  uint64_t dollar;      // '$'
+  uint64_t colon;       // ':'
+  uint64_t at;          // '@'
+  uint64_t line_end;    // '\n', '\r' and NUL, where a construct cannot continue
+} MtlogStructuralBlock;
+
+typedef enum {
+  MTLOG_KERNEL_AUTO,
+  MTLOG_KERNEL_SCALAR,
+  MTLOG_KERNEL_SSE2,
+  MTLOG_KERNEL_AVX2,
+} MtlogStructuralKernel;
+
+// Number of blocks needed to index `length` bytes.
+static inline uint32_t mtlog_structural_block_count(uint32_t length) {
+  return (length + MTLOG_STRUCTURAL_BLOCK - 1) / MTLOG_STRUCTURAL_BLOCK;
+}
+
+// Fill `blocks` (mtlog_structural_block_count(length) entries) for `buffer`.
+void mtlog_structural_index(const char *buffer, uint32_t length, MtlogStructuralBlock *blocks);
+
+// The kernel mtlog_structural_index uses.
+MtlogStructuralKernel mtlog_structural_kernel(void);
+
+// Force a kernel (MTLOG_KERNEL_AUTO restores detection), for benchmarks and
+// tests. Returns false, leaving the current kernel, if the CPU or the build
+// lacks it. Not thread-safe with concurrent indexing.
+bool mtlog_structural_use_kernel(MtlogStructuralKernel kernel);
+
+const char *mtlog_structural_kernel_name(MtlogStructuralKernel kernel);
+
+// Index of the lowest set bit; `mask` must be non-zero.
+static inline unsigned mtlog_lowest_bit(uint64_t mask) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64(&index, mask);
+  return (unsigned)index;
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if (_BitScanForward(&index, (unsigned long)mask)) return (unsigned)index;
+  _BitScanForward(&index, (unsigned long)(mask >> 32));
+  return (unsigned)index + 32;
+#else
+  return (unsigned)__builtin_ctzll(mask);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_STRUCTURAL_H_
@@ -0,0 +1,256 @@
+#include "symbols.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "properties.h"
+
+// Names are stored as records in one byte buffer: an Entry, then the name
+// and a NUL, padded to 4 bytes. A lookup reads a slot and then one record.
+typedef struct {
+  uint32_t id;
+  uint32_t length;
+} Entry;
+
+typedef struct {
+  uint32_t offset;  // of the Entry in bytes
+  uint32_t segment; // first entry in segments
+  uint32_t segment_count;
+} Symbol;
+
+struct MtlogSymbols {
+  Symbol *symbols;
+  uint32_t count;
+  uint32_t capacity;
+  char *bytes;
+  uint32_t byte_count;
+  uint32_t byte_capacity;
+  uint32_t *segments;
+  uint32_t segment_count;
+  uint32_t segment_capacity;
+  uint64_t *slots; // the name's hash above its record offset + 1; 0 when empty; at most half full
+  uint32_t slot_mask;
+};
+
+// Make room for `needed` elements of `size` bytes, doubling the capacity.
+static bool reserve(void **array, uint32_t *capacity, uint32_t needed, size_t size) {
+  if (needed <= *capacity) return true;
+  size_t grown = *capacity ? *capacity : 16;
+  while (grown < needed) grown *= 2;
+  if (grown > UINT32_MAX) grown = UINT32_MAX;
+  void *data = realloc(*array, grown * size);
+  if (!data) return false;
+  *array = data;
+  *capacity = (uint32_t)grown;
+  return true;
+}
+
+// Names are short; eight bytes per multiply, folded to 32 bits.
+static uint32_t name_hash(const char *name, uint32_t length) {
+  const unsigned char *p = (const unsigned char *)name;
+  uint64_t hash = 0x9e3779b97f4a7c15ull ^ length;
+  while (length >= 8) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+    hash ^= hash >> 29;
+    p += 8;
+    length -= 8;
+  }
+  uint64_t tail = 0;
+  for (uint32_t i = 0; i < length; i++) tail |= (uint64_t)p[i] << (8 * i);
+  hash = (hash ^ tail) * 0xd6e8feb86659fd93ull;
+  return (uint32_t)(hash >> 32);
+}
+
+static inline const Entry *entry_at(const MtlogSymbols *symbols, uint32_t offset) {
+  return (const Entry *)(symbols->bytes + offset);
+}
+
+MtlogSymbols *mtlog_symbols_new(void) {
+  MtlogSymbols *symbols = (MtlogSymbols *)calloc(1, sizeof(MtlogSymbols));
+  if (!symbols) return NULL;
+  symbols->slots = (uint64_t *)calloc(64, sizeof(uint64_t));
+  if (!symbols->slots) {
+    free(symbols);
+    return NULL;
+  }
+  symbols->slot_mask = 63;
+  return symbols;
+}
+
+void mtlog_symbols_delete(MtlogSymbols *symbols) {
+  if (!symbols) return;
+  free(symbols->symbols);
+  free(symbols->bytes);
+  free(symbols->segments);
+  free(symbols->slots);
+  free(symbols);
+}
+
+// The slot holding `name`, or the empty slot where it would go.
+static uint64_t *slot_for(const MtlogSymbols *symbols, const char *name, uint32_t length, uint32_t hash) {
+  for (uint32_t i = hash & symbols->slot_mask;; i = (i + 1) & symbols->slot_mask) {
+    uint64_t slot = symbols->slots[i];
+    if (!slot) return &symbols->slots[i];
+    if ((uint32_t)(slot >> 32) != hash) continue;
+    const Entry *entry = entry_at(symbols, (uint32_t)slot - 1);
+    if (entry->length == length && !memcmp(entry + 1, name, length)) return &symbols->slots[i];
+  }
+}
+
+uint32_t mtlog_symbols_find(const MtlogSymbols *symbols, const char *name, uint32_t length) {
+  uint64_t slot = *slot_for(symbols, name, length, name_hash(name, length));
+  return slot ? entry_at(symbols, (uint32_t)slot - 1)->id : MTLOG_SYMBOL_NONE;
+}
+
+static bool grow_slots(MtlogSymbols *symbols) {
+  uint32_t slot_count = (symbols->slot_mask + 1) * 2;
+  uint64_t *slots = (uint64_t *)calloc(slot_count, sizeof(uint64_t));
+  if (!slots) return false;
+  for (uint32_t i = 0; i <= symbols->slot_mask; i++) {
+    uint64_t slot = symbols->slots[i];
+    if (!slot) continue;
+    uint32_t j = (uint32_t)(slot >> 32) & (slot_count - 1);
+    while (slots[j]) j = (j + 1) & (slot_count - 1);
+    slots[j] = slot;
+  }
+  free(symbols->slots);
+  symbols->slots = slots;
+  symbols->slot_mask = slot_count - 1;
+  return true;
+}
+
+static uint32_t intern(MtlogSymbols *symbols, const char *name, uint32_t length, bool split) {
+  uint32_t hash = name_hash(name, length);
+  uint64_t slot = *slot_for(symbols, name, length, hash);
+  if (slot) return entry_at(symbols, (uint32_t)slot - 1)->id;
+
+  // Segments first, so they get the lower symbols.
+  uint32_t segment_count = 1;
+  if (split) {
+    for (uint32_t i = 0; i < length; i++) segment_count += name[i] == '.';
+  }
+  uint32_t segment_ids[16], *segment_buffer = segment_ids;
+  if (segment_count > 1) {
+    if (segment_count > 16 && !(segment_buffer = (uint32_t *)malloc(sizeof(uint32_t) * segment_count))) {
+      return MTLOG_SYMBOL_NONE;
+    }
+    uint32_t start = 0, n = 0;
+    for (uint32_t i = 0; i <= length; i++) {
+      if (i < length && name[i] != '.') continue;
+      segment_buffer[n] = intern(symbols, name + start, i - start, false);
+      if (segment_buffer[n++] == MTLOG_SYMBOL_NONE) break;
+      start = i + 1;
+    }
+    if (segment_buffer[n - 1] == MTLOG_SYMBOL_NONE) {
+      if (segment_buffer != segment_ids) free(segment_buffer);
+      return MTLOG_SYMBOL_NONE;
+    }
+  }
+
+  // Keep the table at most half full.
+  uint32_t id = symbols->count;
+  uint32_t record = (uint32_t)sizeof(Entry) + ((length + 4) & ~3u);
+  bool ok = id < (1u << 30) && length < UINT32_MAX - 16 && record < UINT32_MAX - 1 - symbols->byte_count &&
+            ((id + 1) * 2 <= symbols->slot_mask + 1 || grow_slots(symbols)) &&
+            reserve((void **)&symbols->symbols, &symbols->capacity, id + 1, sizeof(Symbol)) &&
+            reserve((void **)&symbols->bytes, &symbols->byte_capacity, symbols->byte_count + record, 1) &&
+            reserve((void **)&symbols->segments, &symbols->segment_capacity,
+                    symbols->segment_count + segment_count, sizeof(uint32_t));
+  if (ok) {
+    uint32_t offset = symbols->byte_count;
+    symbols->symbols[id] = (Symbol){offset, symbols->segment_count, segment_count};
+    Entry *entry = (Entry *)(symbols->bytes + offset);
+    *entry = (Entry){id, length};
+    memset((char *)(entry + 1) + length, 0, record - sizeof(Entry) - length);
+    if (length) memcpy(entry + 1, name, length);
+    symbols->byte_count += record;
+    if (segment_count > 1) {
+      memcpy(symbols->segments + symbols->segment_count, segment_buffer, sizeof(uint32_t) * segment_count);
+    } else {
+      symbols->segments[symbols->segment_count] = id;
+    }
+    symbols->segment_count += segment_count;
+    symbols->count++;
+    *slot_for(symbols, name, length, hash) = (uint64_t)hash << 32 | (offset + 1);
+  }
+  if (segment_buffer != segment_ids) free(segment_buffer);
+  return ok ? id : MTLOG_SYMBOL_NONE;
+}
+
+uint32_t mtlog_symbols_intern(MtlogSymbols *symbols, const char *name, uint32_t length) {
+  return intern(symbols, name, length, true);
+}
+
+typedef struct {
+  MtlogSymbols *symbols;
+  const char *text;
+  uint32_t *ids;
+  uint32_t capacity;
+  uint32_t count;
+  bool failed;
+} Collector;
+
+static bool collect(const MtlogSegment *segment, void *context) {
+  Collector *collector = (Collector *)context;
+  uint32_t id = mtlog_symbols_intern(collector->symbols, collector->text + segment->name.start,
+                                     segment->name.end - segment->name.start);
+  if (id == MTLOG_SYMBOL_NONE) {
+    collector->failed = true;
+    return false;
+  }
+  if (collector->count < collector->capacity) collector->ids[collector->count] = id;
+  collector->count++;
+  return true;
+}
+
+uint32_t mtlog_symbols_intern_properties(MtlogSymbols *symbols, const char *text, uint32_t length, uint32_t *ids,
+                                         uint32_t capacity) {
+  Collector collector = {symbols, text, ids, capacity, 0, false};
+  mtlog_scan_properties(text, length, collect, &collector);
+  return collector.failed ? MTLOG_SYMBOL_NONE : collector.count;
+}
+
+uint32_t mtlog_symbols_intern_ir(MtlogSymbols *symbols, const MtlogTemplateIR *ir, const char *text, uint32_t *ids,
+                                 uint32_t capacity) {
+  const MtlogSpan *names = mtlog_ir_names(ir);
+  const uint8_t *kinds = mtlog_ir_kinds(ir);
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < ir->segment_count; i++) {
+    if (kinds[i] == MTLOG_SEGMENT_LITERAL) continue;
+    uint32_t id = mtlog_symbols_intern(symbols, text + names[i].start, names[i].end - names[i].start);
+    if (id == MTLOG_SYMBOL_NONE) return MTLOG_SYMBOL_NONE;
+    if (count < capacity) ids[count] = id;
+    count++;
+  }
+  return count;
+}
+
+uint32_t mtlog_symbols_count(const MtlogSymbols *symbols) { return symbols->count; }
+
+const char *mtlog_symbols_name(const MtlogSymbols *symbols, uint32_t id, uint32_t *length) {
+  if (id >= symbols->count) {
+    if (length) *length = 0;
+    return NULL;
+  }
+  const Entry *entry = entry_at(symbols, symbols->symbols[id].offset);
+  if (length) *length = entry->length;
+  return (const char *)(entry + 1);
+}
+
+const uint32_t *mtlog_symbols_segments(const MtlogSymbols *symbols, uint32_t id, uint32_t *count) {
+  if (id >= symbols->count) {
+    *count = 0;
+    return NULL;
+  }
+  const Symbol *symbol = &symbols->symbols[id];
+  *count = symbol->segment_count;
+  return symbols->segments + symbol->segment;
+}
+
+size_t mtlog_symbols_memory(const MtlogSymbols *symbols) {
+  return sizeof(MtlogSymbols) + (size_t)symbols->capacity * sizeof(Symbol) + symbols->byte_capacity +
+         (size_t)symbols->segment_capacity * sizeof(uint32_t) + (size_t)(symbols->slot_mask + 1) * sizeof(uint64_t);
+}
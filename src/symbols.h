@@ -0,0 +1,77 @@
+#ifndef TREE_SITTER_MTLOG_SYMBOLS_H_
+#define TREE_SITTER_MTLOG_SYMBOLS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "template_ir.h"
+
+// Property-name interning.
+//
+// Gives each distinct property name a dense integer symbol, counting from 0
+// in the order first seen, so consumers can key columns and compare names by
+// integer. A dotted name such as `http.method` is also split at each '.' and
+// every segment interned on its own, so `http.method` and `http.status_code`
+// share the symbol of `http`. Segments live in the same table as whole names:
+// the segment `http` and a property named `{http}` are the same symbol.
+//
+//   MtlogSymbols *symbols = mtlog_symbols_new();
+//   uint32_t ids[16];
+//   uint32_t n = mtlog_symbols_intern_properties(symbols, text, length, ids, 16);
+//   // ids[i] is the symbol of the i-th property's name
+//
+//   uint32_t count;
+//   const uint32_t *segments = mtlog_symbols_segments(symbols, ids[0], &count);
+//
+// Names are compared as bytes; `{Level}` and `${Level}` share a symbol. A
+// table is not safe to intern into from several threads at once; lookups may
+// run concurrently with each other but not with interning.
+
+#define MTLOG_SYMBOL_NONE UINT32_MAX
+
+typedef struct MtlogSymbols MtlogSymbols;
+
+// Returns NULL if allocation fails.
+MtlogSymbols *mtlog_symbols_new(void);
+void mtlog_symbols_delete(MtlogSymbols *symbols);
+
+// The symbol of `name`, interning it and its segments if new. Returns
+// MTLOG_SYMBOL_NONE if allocation fails.
+uint32_t mtlog_symbols_intern(MtlogSymbols *symbols, const char *name, uint32_t length);
+
+// The symbol of `name`, or MTLOG_SYMBOL_NONE if it has not been interned.
+uint32_t mtlog_symbols_find(const MtlogSymbols *symbols, const char *name, uint32_t length);
+
+// Extract the properties of template `text` and intern their names in the
+// same pass, writing the first `capacity` symbols to `ids` in template order.
+// Returns the number of properties, or MTLOG_SYMBOL_NONE if allocation fails.
+uint32_t mtlog_symbols_intern_properties(MtlogSymbols *symbols, const char *text, uint32_t length, uint32_t *ids,
+                                         uint32_t capacity);
+
+// Same, for the properties of the template `text` described by `ir`.
+uint32_t mtlog_symbols_intern_ir(MtlogSymbols *symbols, const MtlogTemplateIR *ir, const char *text, uint32_t *ids,
+                                 uint32_t capacity);
+
+uint32_t mtlog_symbols_count(const MtlogSymbols *symbols);
+
+// The name of symbol `id`, NUL-terminated, or NULL if there is no such
+// symbol. Valid until the next intern.
+const char *mtlog_symbols_name(const MtlogSymbols *symbols, uint32_t id, uint32_t *length);
+
+// The segment symbols of `id`: one per '.'-separated part, or just `id`
+// itself for a name without dots. NULL with a count of 0 if there is no such
+// symbol. Valid until the next intern.
+const uint32_t *mtlog_symbols_segments(const MtlogSymbols *symbols, uint32_t id, uint32_t *count);
+
+// Bytes of memory held by the table.
+size_t mtlog_symbols_memory(const MtlogSymbols *symbols);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_SYMBOLS_H_
@@ -0,0 +1,290 @@
+#include "template_cache.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "template_ir.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef SRWLOCK Lock;
+#define lock_init(l) InitializeSRWLock(l)
+#define lock_destroy(l) ((void)(l))
+#define lock_acquire(l) AcquireSRWLockExclusive(l)
+#define lock_release(l) ReleaseSRWLockExclusive(l)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t Lock;
+#define lock_init(l) pthread_mutex_init((l), NULL)
+#define lock_destroy(l) pthread_mutex_destroy(l)
+#define lock_acquire(l) pthread_mutex_lock(l)
+#define lock_release(l) pthread_mutex_unlock(l)
+#endif
+
+// Reference counts are dropped outside the shard lock by release().
+#if defined(_MSC_VER) && !defined(__clang__)
+typedef volatile long RefCount;
+#define ref_increment(r) _InterlockedIncrement(r)
+#define ref_decrement(r) _InterlockedDecrement(r)
+#else
+typedef long RefCount;
+#define ref_increment(r) __atomic_add_fetch((r), 1, __ATOMIC_RELAXED)
+#define ref_decrement(r) __atomic_sub_fetch((r), 1, __ATOMIC_ACQ_REL)
+#endif
+
+#define DEFAULT_CAPACITY 4096
+#define DEFAULT_SHARDS 16
+
+// One allocation per template: the entry, its properties, their compiled
+// formats, then its text.
+typedef struct Entry {
+  MtlogCompiledTemplate compiled; // first, so the public pointer is the entry
+  RefCount references;            // one for the cache while linked, one per acquire
+  struct Entry *bucket_next;
+  struct Entry *lru_prev;         // towards most recently used
+  struct Entry *lru_next;
+} Entry;
+
+typedef struct {
+  Lock lock;
+  Entry **buckets;
+  uint32_t bucket_mask;
+  uint32_t capacity;
+  uint32_t count;
+  Entry *lru_head; // most recently used
+  Entry *lru_tail;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+} Shard;
+
+struct MtlogTemplateCache {
+  Shard *shards;
+  uint32_t shard_count;
+  uint32_t shard_shift; // hash >> shard_shift picks the shard
+};
+
+// ---------------------------------------------------------------------------
+// Hashing
+
+uint64_t mtlog_template_hash(const char *text, uint32_t length) { return mtlog_text_hash(text, length); }
+
+// ---------------------------------------------------------------------------
+// Entries
+
+static bool collect_property(const MtlogSegment *segment, void *context) {
+  Entry *entry = (Entry *)context;
+  MtlogSegment *properties = (MtlogSegment *)(entry + 1);
+  properties[entry->compiled.property_count++] = *segment;
+  return true;
+}
+
+static bool count_property(const MtlogSegment *segment, void *context) {
+  (void)segment;
+  (*(uint32_t *)context)++;
+  return true;
+}
+
+static Entry *entry_new(const char *text, uint32_t length, uint64_t hash) {
+  uint32_t count = 0;
+  mtlog_scan_properties(text, length, count_property, &count);
+
+  size_t size = sizeof(Entry) + count * (sizeof(MtlogSegment) + sizeof(MtlogFormatSpec)) + length + 1;
+  Entry *entry = (Entry *)malloc(size);
+  if (!entry) return NULL;
+
+  MtlogSegment *properties = (MtlogSegment *)(entry + 1);
+  MtlogFormatSpec *formats = (MtlogFormatSpec *)(properties + count);
+  char *copy = (char *)(formats + count);
+  memcpy(copy, text, length);
+  copy[length] = '\0';
+
+  entry->compiled.text = copy;
+  entry->compiled.length = length;
+  entry->compiled.hash = hash;
+  entry->compiled.property_count = 0;
+  entry->compiled.properties = properties;
+  entry->compiled.formats = formats;
+  entry->references = 1;
+  entry->bucket_next = NULL;
+  entry->lru_prev = entry->lru_next = NULL;
+  mtlog_scan_properties(copy, length, collect_property, entry);
+  for (uint32_t i = 0; i < count; i++) {
+    mtlog_format_spec_compile(copy + properties[i].format.start,
+                              properties[i].format.end - properties[i].format.start, &formats[i]);
+  }
+  return entry;
+}
+
+static void entry_release(Entry *entry) {
+  if (ref_decrement(&entry->references) == 0) free(entry);
+}
+
+void mtlog_template_cache_release(const MtlogCompiledTemplate *compiled) {
+  if (compiled) entry_release((Entry *)compiled);
+}
+
+// ---------------------------------------------------------------------------
+// Shards (callers hold the shard lock)
+
+static void lru_unlink(Shard *shard, Entry *entry) {
+  if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+  else shard->lru_head = entry->lru_next;
+  if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+  else shard->lru_tail = entry->lru_prev;
+  entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void lru_push_front(Shard *shard, Entry *entry) {
+  entry->lru_next = shard->lru_head;
+  if (shard->lru_head) shard->lru_head->lru_prev = entry;
+  else shard->lru_tail = entry;
+  shard->lru_head = entry;
+}
+
+static Entry *shard_find(Shard *shard, const char *text, uint32_t length, uint64_t hash) {
+  for (Entry *entry = shard->buckets[hash & shard->bucket_mask]; entry; entry = entry->bucket_next) {
+    if (entry->compiled.hash == hash && entry->compiled.length == length &&
+        memcmp(entry->compiled.text, text, length) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static void shard_remove(Shard *shard, Entry *entry) {
+  Entry **link = &shard->buckets[entry->compiled.hash & shard->bucket_mask];
+  while (*link != entry) link = &(*link)->bucket_next;
+  *link = entry->bucket_next;
+  lru_unlink(shard, entry);
+  shard->count--;
+}
+
+static void shard_insert(Shard *shard, Entry *entry) {
+  if (shard->count == shard->capacity) {
+    Entry *victim = shard->lru_tail;
+    shard_remove(shard, victim);
+    shard->evictions++;
+    entry_release(victim);
+  }
+  Entry **bucket = &shard->buckets[entry->compiled.hash & shard->bucket_mask];
+  entry->bucket_next = *bucket;
+  *bucket = entry;
+  lru_push_front(shard, entry);
+  shard->count++;
+}
+
+// ---------------------------------------------------------------------------
+// Cache
+
+static uint32_t round_up_pow2(uint32_t n) {
+  uint32_t result = 1;
+  while (result < n) result <<= 1;
+  return result;
+}
+
+MtlogTemplateCache *mtlog_template_cache_new(uint32_t capacity, uint32_t shards) {
+  if (capacity == 0) capacity = DEFAULT_CAPACITY;
+  shards = round_up_pow2(shards ? shards : DEFAULT_SHARDS);
+  while (shards > 1 && shards > capacity) shards >>= 1;
+
+  MtlogTemplateCache *self = (MtlogTemplateCache *)calloc(1, sizeof(MtlogTemplateCache));
+  if (!self) return NULL;
+  self->shards = (Shard *)calloc(shards, sizeof(Shard));
+  if (!self->shards) {
+    free(self);
+    return NULL;
+  }
+  self->shard_count = shards;
+  self->shard_shift = 64;
+  for (uint32_t n = shards; n > 1; n >>= 1) self->shard_shift--;
+
+  uint32_t per_shard = (capacity + shards - 1) / shards;
+  uint32_t buckets = round_up_pow2(per_shard);
+  for (uint32_t i = 0; i < shards; i++) {
+    Shard *shard = &self->shards[i];
+    shard->buckets = (Entry **)calloc(buckets, sizeof(Entry *));
+    if (!shard->buckets) {
+      self->shard_count = i;
+      mtlog_template_cache_delete(self);
+      return NULL;
+    }
+    shard->bucket_mask = buckets - 1;
+    shard->capacity = per_shard;
+    lock_init(&shard->lock);
+  }
+  return self;
+}
+
+void mtlog_template_cache_delete(MtlogTemplateCache *self) {
+  if (!self) return;
+  for (uint32_t i = 0; i < self->shard_count; i++) {
+    Shard *shard = &self->shards[i];
+    Entry *entry = shard->lru_head;
+    while (entry) {
+      Entry *next = entry->lru_next;
+      entry_release(entry);
+      entry = next;
+    }
+    free(shard->buckets);
+    lock_destroy(&shard->lock);
+  }
+  free(self->shards);
+  free(self);
+}
+
+static inline Shard *shard_for(MtlogTemplateCache *self, uint64_t hash) {
+  return &self->shards[self->shard_shift == 64 ? 0 : hash >> self->shard_shift];
+}
+
+const MtlogCompiledTemplate *mtlog_template_cache_acquire(MtlogTemplateCache *self, const char *text, uint32_t length) {
+  uint64_t hash = mtlog_template_hash(text, length);
+  Shard *shard = shard_for(self, hash);
+
+  lock_acquire(&shard->lock);
+  Entry *entry = shard_find(shard, text, length, hash);
+  if (entry) {
+    shard->hits++;
+    if (entry != shard->lru_head) {
+      lru_unlink(shard, entry);
+      lru_push_front(shard, entry);
+    }
+    ref_increment(&entry->references);
+    lock_release(&shard->lock);
+    return &entry->compiled;
+  }
+  shard->misses++;
+  lock_release(&shard->lock);
+
+  // Compile outside the lock; another thread may insert the same template
+  // meanwhile, in which case its entry wins and ours is dropped.
+  Entry *created = entry_new(text, length, hash);
+  if (!created) return NULL;
+
+  lock_acquire(&shard->lock);
+  entry = shard_find(shard, text, length, hash);
+  if (!entry) {
+    entry = created;
+    created = NULL;
+    shard_insert(shard, entry);
+  }
+  ref_increment(&entry->references);
+  lock_release(&shard->lock);
+
+  if (created) entry_release(created);
+  return &entry->compiled;
+}
+
+void mtlog_template_cache_stats(MtlogTemplateCache *self, MtlogTemplateCacheStats *stats) {
+  memset(stats, 0, sizeof(*stats));
+  for (uint32_t i = 0; i < self->shard_count; i++) {
+    Shard *shard = &self->shards[i];
+    lock_acquire(&shard->lock);
+    stats->hits += shard->hits;
+    stats->misses += shard->misses;
+    stats->evictions += shard->evictions;
+    stats->entries += shard->count;
+    lock_release(&shard->lock);
+  }
+}
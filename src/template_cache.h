@@ -0,0 +1,75 @@
+#ifndef TREE_SITTER_MTLOG_TEMPLATE_CACHE_H_
+#define TREE_SITTER_MTLOG_TEMPLATE_CACHE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "format_spec.h"
+#include "properties.h"
+
+// Thread-safe cache of compiled templates for log ingestion.
+//
+// Ingest pipelines see a few thousand distinct templates billions of times.
+// The cache maps template text (by hash, confirmed by comparing the text) to
+// its property list, extracted once with mtlog_scan_properties, and each
+// property's compiled format, so a repeated template costs one hash and one
+// lookup instead of a parse.
+//
+// Entries are spread over independently locked shards, each a hash table
+// with its own LRU list bounded to capacity / shards entries. Acquired
+// templates are reference counted and stay valid until released, even if
+// they are evicted in between.
+//
+//   MtlogTemplateCache *cache = mtlog_template_cache_new(0, 0);
+//   const MtlogCompiledTemplate *t = mtlog_template_cache_acquire(cache, text, length);
+//   for (uint32_t i = 0; i < t->property_count; i++) { ... t->properties[i] ... }
+//   mtlog_template_cache_release(t);
+
+typedef struct MtlogTemplateCache MtlogTemplateCache;
+
+typedef struct {
+  const char *text;               // cache-owned copy of the template text
+  uint32_t length;
+  uint64_t hash;
+  uint32_t property_count;
+  const MtlogSegment *properties; // spans are offsets into `text`
+  const MtlogFormatSpec *formats; // parallel to `properties`
+} MtlogCompiledTemplate;
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t entries; // currently cached
+} MtlogTemplateCacheStats;
+
+// Create a cache of at most `capacity` templates split over `shards` locks
+// (rounded up to a power of two). 0 picks 4096 templates and 16 shards.
+// Returns NULL if allocation fails.
+MtlogTemplateCache *mtlog_template_cache_new(uint32_t capacity, uint32_t shards);
+
+// Free the cache. Templates still acquired stay valid until released.
+void mtlog_template_cache_delete(MtlogTemplateCache *self);
+
+// Look up `text`, compiling and inserting it on a miss (evicting the shard's
+// least recently used template if it is full). Returns NULL if allocation
+// fails. Every successful call must be paired with a release.
+const MtlogCompiledTemplate *mtlog_template_cache_acquire(MtlogTemplateCache *self, const char *text, uint32_t length);
+
+// Drop a reference returned by acquire. Does not need the cache to be alive.
+void mtlog_template_cache_release(const MtlogCompiledTemplate *compiled);
+
+// Counters summed over all shards since the cache was created.
+void mtlog_template_cache_stats(MtlogTemplateCache *self, MtlogTemplateCacheStats *stats);
+
+// The hash used as the cache key: mtlog_text_hash from template_ir.h.
+uint64_t mtlog_template_hash(const char *text, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_TEMPLATE_CACHE_H_
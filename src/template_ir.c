@@ -0,0 +1,111 @@
+#include "template_ir.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The layout is part of the ABI; fail the build if it drifts.
+typedef char assert_header_size[sizeof(MtlogTemplateIR) == 24 ? 1 : -1];
+typedef char assert_span_size[sizeof(MtlogSpan) == 8 ? 1 : -1];
+
+#define PER_SEGMENT_BYTES (3 * sizeof(MtlogSpan) + 3)
+
+static size_t block_size(uint32_t count) {
+  size_t size = sizeof(MtlogTemplateIR) + (size_t)count * PER_SEGMENT_BYTES;
+  return (size + 3) & ~(size_t)3;
+}
+
+MtlogTemplateIR *mtlog_ir_from_segments(const MtlogSegment *segments, uint32_t count, uint32_t source_length) {
+  size_t size = block_size(count);
+  if (size > UINT32_MAX) return NULL;
+
+  // calloc: padding and absent spans are zero, so equal templates compare
+  // and hash equal as bytes.
+  MtlogTemplateIR *ir = (MtlogTemplateIR *)calloc(1, size);
+  if (!ir) return NULL;
+  ir->version = MTLOG_IR_VERSION;
+  ir->size = (uint32_t)size;
+  ir->segment_count = count;
+  ir->source_length = source_length;
+
+  MtlogSpan *spans = (MtlogSpan *)(ir + 1);
+  MtlogSpan *names = spans + count;
+  MtlogSpan *formats = names + count;
+  uint8_t *kinds = (uint8_t *)(formats + count);
+  uint8_t *name_kinds = kinds + count;
+  uint8_t *hints = name_kinds + count;
+
+  for (uint32_t i = 0; i < count; i++) {
+    const MtlogSegment *segment = &segments[i];
+    spans[i] = segment->span;
+    kinds[i] = (uint8_t)segment->kind;
+    if (segment->kind == MTLOG_SEGMENT_LITERAL) continue;
+    ir->property_count++;
+    if (segment->name.end > segment->name.start) names[i] = segment->name;
+    if (segment->format.end > segment->format.start) formats[i] = segment->format;
+    name_kinds[i] = (uint8_t)segment->name_kind;
+    hints[i] = (uint8_t)segment->hint;
+  }
+  return ir;
+}
+
+typedef struct {
+  MtlogSegment *items;
+  uint32_t count;
+  uint32_t capacity;
+  bool failed;
+} SegmentBuffer;
+
+static bool append_segment(const MtlogSegment *segment, void *context) {
+  SegmentBuffer *buffer = (SegmentBuffer *)context;
+  if (buffer->count == buffer->capacity) {
+    uint32_t capacity = buffer->capacity * 2;
+    MtlogSegment *items = (MtlogSegment *)realloc(buffer->items, capacity * sizeof(MtlogSegment));
+    if (!items) {
+      buffer->failed = true;
+      return false;
+    }
+    buffer->items = items;
+    buffer->capacity = capacity;
+  }
+  buffer->items[buffer->count++] = *segment;
+  return true;
+}
+
+MtlogTemplateIR *mtlog_ir_from_text(const char *text, uint32_t length) {
+  SegmentBuffer buffer = {NULL, 0, 16, false};
+  buffer.items = (MtlogSegment *)malloc(buffer.capacity * sizeof(MtlogSegment));
+  if (!buffer.items) return NULL;
+
+  mtlog_scan_segments(text, length, append_segment, &buffer);
+  MtlogTemplateIR *ir = buffer.failed ? NULL : mtlog_ir_from_segments(buffer.items, buffer.count, length);
+  free(buffer.items);
+  return ir;
+}
+
+void mtlog_ir_delete(MtlogTemplateIR *ir) { free(ir); }
+
+static bool span_ok(MtlogSpan span, uint32_t length) { return span.start <= span.end && span.end <= length; }
+
+const MtlogTemplateIR *mtlog_ir_check(const void *data, size_t size) {
+  if (!data || size < sizeof(MtlogTemplateIR) || ((uintptr_t)data & 3)) return NULL;
+  const MtlogTemplateIR *ir = (const MtlogTemplateIR *)data;
+  if (ir->version != MTLOG_IR_VERSION || ir->reserved != 0) return NULL;
+  if (ir->segment_count > (UINT32_MAX - sizeof(MtlogTemplateIR)) / PER_SEGMENT_BYTES) return NULL;
+  if (ir->size != block_size(ir->segment_count) || ir->size > size) return NULL;
+
+  const MtlogSpan *spans = mtlog_ir_spans(ir);
+  const MtlogSpan *names = mtlog_ir_names(ir);
+  const MtlogSpan *formats = mtlog_ir_formats(ir);
+  const uint8_t *kinds = mtlog_ir_kinds(ir);
+  uint32_t properties = 0;
+  for (uint32_t i = 0; i < ir->segment_count; i++) {
+    if (kinds[i] > MTLOG_SEGMENT_BUILTIN_PROPERTY) return NULL;
+    if (!span_ok(spans[i], ir->source_length) || !span_ok(names[i], ir->source_length) ||
+        !span_ok(formats[i], ir->source_length)) {
+      return NULL;
+    }
+    if (kinds[i] != MTLOG_SEGMENT_LITERAL) properties++;
+  }
+  return properties == ir->property_count ? ir : NULL;
+}
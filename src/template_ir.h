@@ -0,0 +1,118 @@
+#ifndef TREE_SITTER_MTLOG_TEMPLATE_IR_H_
+#define TREE_SITTER_MTLOG_TEMPLATE_IR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "properties.h"
+
+// Flat template IR.
+//
+// A template's segments as parallel arrays in one contiguous block, so
+// consumers iterate properties with linear memory access instead of walking
+// TSNodes, and a template can be copied, hashed, compared or cached as plain
+// bytes. The block holds no pointers; everything is addressed by offset from
+// its start.
+//
+// Layout (stable for a given MTLOG_IR_VERSION; host byte order):
+//
+//   MtlogTemplateIR  header                      24 bytes
+//   MtlogSpan        spans[segment_count]        whole segment
+//   MtlogSpan        names[segment_count]        name, empty if none
+//   MtlogSpan        formats[segment_count]      format string, empty if none
+//   uint8_t          kinds[segment_count]        MtlogSegmentKind
+//   uint8_t          name_kinds[segment_count]   MtlogNameKind
+//   uint8_t          hints[segment_count]        '@', '$' or 0
+//   zero padding to a multiple of 4 bytes
+//
+// Segments tile the source: literal segments cover everything between
+// properties, newlines included. Spans are byte offsets into the source.
+
+#define MTLOG_IR_VERSION 1
+
+typedef struct {
+  uint32_t version;        // MTLOG_IR_VERSION
+  uint32_t size;           // bytes in the whole block, header included
+  uint32_t segment_count;
+  uint32_t property_count; // segments that are not literal
+  uint32_t source_length;
+  uint32_t reserved;       // zero
+} MtlogTemplateIR;
+
+static inline const MtlogSpan *mtlog_ir_spans(const MtlogTemplateIR *ir) {
+  return (const MtlogSpan *)(ir + 1);
+}
+
+static inline const MtlogSpan *mtlog_ir_names(const MtlogTemplateIR *ir) {
+  return mtlog_ir_spans(ir) + ir->segment_count;
+}
+
+static inline const MtlogSpan *mtlog_ir_formats(const MtlogTemplateIR *ir) {
+  return mtlog_ir_names(ir) + ir->segment_count;
+}
+
+static inline const uint8_t *mtlog_ir_kinds(const MtlogTemplateIR *ir) {
+  return (const uint8_t *)(mtlog_ir_formats(ir) + ir->segment_count);
+}
+
+static inline const uint8_t *mtlog_ir_name_kinds(const MtlogTemplateIR *ir) {
+  return mtlog_ir_kinds(ir) + ir->segment_count;
+}
+
+static inline const uint8_t *mtlog_ir_hints(const MtlogTemplateIR *ir) {
+  return mtlog_ir_name_kinds(ir) + ir->segment_count;
+}
+
+// Build the IR from template text with the tree-free extractor in one pass.
+// Returns NULL if allocation fails. Free with mtlog_ir_delete.
+MtlogTemplateIR *mtlog_ir_from_text(const char *text, uint32_t length);
+
+// Pack `count` segments tiling a source of `source_length` bytes.
+MtlogTemplateIR *mtlog_ir_from_segments(const MtlogSegment *segments, uint32_t count, uint32_t source_length);
+
+void mtlog_ir_delete(MtlogTemplateIR *ir);
+
+// Check that `size` bytes at `data` hold a well-formed IR block of this
+// version (for blocks read from a file or shared memory). Returns the IR, or
+// NULL if the header or any span is out of range.
+const MtlogTemplateIR *mtlog_ir_check(const void *data, size_t size);
+
+// 64-bit hash of template text, eight bytes per step; templates are short, so
+// this stays a few nanoseconds. The template cache keys on it and the registry
+// stores it in its file, so its output must not change without a new
+// MTLOG_REGISTRY_VERSION.
+static inline uint64_t mtlog_text_hash(const char *text, uint32_t length) {
+  const unsigned char *p = (const unsigned char *)text;
+  uint64_t hash = 0x9e3779b97f4a7c15ull ^ length;
+  while (length >= 8) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+    hash ^= hash >> 29;
+    p += 8;
+    length -= 8;
+  }
+  uint64_t tail = 0;
+  for (uint32_t i = 0; i < length; i++) tail |= (uint64_t)p[i] << (8 * i);
+  hash ^= tail;
+  hash ^= hash >> 32;
+  hash *= 0xd6e8feb86659fd93ull;
+  hash ^= hash >> 32;
+  hash *= 0xd6e8feb86659fd93ull;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+// Building the IR from a parse tree is declared in template_ir_tree.h, which
+// needs the tree-sitter runtime.
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_TEMPLATE_IR_H_
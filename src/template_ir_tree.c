@@ -0,0 +1,101 @@
+#include "template_ir_tree.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  MtlogSegment *items;
+  uint32_t count;
+  uint32_t capacity;
+} SegmentBuffer;
+
+static bool push(SegmentBuffer *buffer, const MtlogSegment *segment) {
+  if (buffer->count == buffer->capacity) {
+    uint32_t capacity = buffer->capacity ? buffer->capacity * 2 : 16;
+    MtlogSegment *items = (MtlogSegment *)realloc(buffer->items, capacity * sizeof(MtlogSegment));
+    if (!items) return false;
+    buffer->items = items;
+    buffer->capacity = capacity;
+  }
+  buffer->items[buffer->count++] = *segment;
+  return true;
+}
+
+static bool push_literal(SegmentBuffer *buffer, uint32_t start, uint32_t end) {
+  if (start == end) return true;
+  MtlogSegment literal = {MTLOG_SEGMENT_LITERAL, {start, end}, {end, end}, {end, end}, MTLOG_NAME_NONE, 0};
+  return push(buffer, &literal);
+}
+
+static bool type_is(const char *type, const char *expected) { return strcmp(type, expected) == 0; }
+
+// Fill `segment` from a property node's fields, visiting its children once.
+static void read_property(TSTreeCursor *cursor, const char *text, MtlogSegment *segment) {
+  TSNode node = ts_tree_cursor_current_node(cursor);
+  uint32_t end = ts_node_end_byte(node);
+  segment->span.start = ts_node_start_byte(node);
+  segment->span.end = end;
+  segment->name.start = segment->name.end = end;
+  segment->format.start = segment->format.end = end;
+  segment->name_kind = MTLOG_NAME_NONE;
+  segment->hint = 0;
+
+  if (!ts_tree_cursor_goto_first_child(cursor)) return;
+  do {
+    const char *field = ts_tree_cursor_current_field_name(cursor);
+    if (!field) continue;
+    TSNode child = ts_tree_cursor_current_node(cursor);
+    if (type_is(field, "name")) {
+      const char *type = ts_node_type(child);
+      segment->name.start = ts_node_start_byte(child);
+      segment->name.end = ts_node_end_byte(child);
+      segment->name_kind = type_is(type, "identifier")    ? MTLOG_NAME_IDENTIFIER
+                           : type_is(type, "dotted_name") ? MTLOG_NAME_DOTTED
+                                                          : MTLOG_NAME_NUMERIC;
+    } else if (type_is(field, "hint")) {
+      segment->hint = text[ts_node_start_byte(child)];
+    } else if (type_is(field, "format")) {
+      TSNode string = ts_node_child_by_field_name(child, "format_string", 13);
+      if (!ts_node_is_null(string)) {
+        segment->format.start = ts_node_start_byte(string);
+        segment->format.end = ts_node_end_byte(string);
+      }
+    }
+  } while (ts_tree_cursor_goto_next_sibling(cursor));
+  ts_tree_cursor_goto_parent(cursor);
+}
+
+MtlogTemplateIR *mtlog_ir_from_tree(TSNode root, const char *text, uint32_t length) {
+  SegmentBuffer buffer = {NULL, 0, 0};
+  bool ok = true;
+  uint32_t literal_start = 0;
+
+  TSTreeCursor cursor = ts_tree_cursor_new(root);
+  if (ts_tree_cursor_goto_first_child(&cursor)) {
+    do {
+      const char *type = ts_node_type(ts_tree_cursor_current_node(&cursor));
+      MtlogSegment segment;
+      if (type_is(type, "property")) {
+        segment.kind = MTLOG_SEGMENT_PROPERTY;
+      } else if (type_is(type, "go_property")) {
+        segment.kind = MTLOG_SEGMENT_GO_PROPERTY;
+      } else if (type_is(type, "builtin_property")) {
+        segment.kind = MTLOG_SEGMENT_BUILTIN_PROPERTY;
+      } else {
+        continue; // literal_text and ERROR fold into the surrounding literal
+      }
+      read_property(&cursor, text, &segment);
+      ok = push_literal(&buffer, literal_start, segment.span.start) && push(&buffer, &segment);
+      literal_start = segment.span.end;
+    } while (ok && ts_tree_cursor_goto_next_sibling(&cursor));
+  }
+  ts_tree_cursor_delete(&cursor);
+
+  MtlogTemplateIR *ir = NULL;
+  if (ok && push_literal(&buffer, literal_start, length)) {
+    ir = mtlog_ir_from_segments(buffer.items, buffer.count, length);
+  }
+  free(buffer.items);
+  return ir;
+}
@@ -0,0 +1,22 @@
+#ifndef TREE_SITTER_MTLOG_TEMPLATE_IR_TREE_H_
+#define TREE_SITTER_MTLOG_TEMPLATE_IR_TREE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <tree_sitter/api.h>
+
+#include "template_ir.h"
+
+// Build the IR from the `template` root of a parse of `text`, in one cursor
+// pass over its children. ERROR nodes and the newlines between tokens become
+// literal segments, so for input that parses without errors the result is
+// byte-identical to mtlog_ir_from_text. Returns NULL if allocation fails.
+MtlogTemplateIR *mtlog_ir_from_tree(TSNode root, const char *text, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_MTLOG_TEMPLATE_IR_TREE_H_
@@ -0,0 +1,225 @@
+// Tests for UTF-16 input: templates with Latin-1, BMP and astral characters
+// around every construct, parsed from UTF-16LE, must give the same tree as
+// the UTF-8 parse with every range at the matching code unit. This holds
+// both from one buffer and from an input that returns one code unit per
+// read, splitting every surrogate pair. mtlog_narrow_utf16 followed by the
+// extractor must also find the UTF-8 segments at code-unit offsets.
+//
+//   make -C test/api run TREE_SITTER_DIR=~/tree-sitter
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <tree_sitter/api.h>
+
+#include "properties.h"
+
+const TSLanguage *tree_sitter_mtlog(void);
+
+static int failures;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+#define MAX_TEXT 4096
+#define MAX_SEGMENTS 1024
+
+static const char *const SAMPLES[] = {
+  "Usuário {UserId} não encontrado",
+  "日本語 {Name} テスト {@Order:F2}",
+  "emoji 😀{A} and {B:😀 fmt}",
+  "${Level:u3} ñ {{.Trace}} ü",
+  "{Üser} is literal, {User} is not",
+  "😀😀{{ .A }}\n€ {X}\r\n{0:yyyy-MM-dd} 𝄞",
+  "{{\n.http\n.method}} → {Elapsed:0.000} ms",
+  "unclosed {Name 😀\n{$Error} ${ 𝄞",
+};
+
+// Transcode UTF-8 to UTF-16; map[i] is the code unit at byte offset i.
+static uint32_t to_utf16(const char *text, uint32_t length, uint16_t *units, uint32_t *map) {
+  const unsigned char *s = (const unsigned char *)text;
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < length;) {
+    uint32_t c, size;
+    if (s[i] < 0x80) c = s[i], size = 1;
+    else if (s[i] < 0xE0) c = s[i] & 0x1F, size = 2;
+    else if (s[i] < 0xF0) c = s[i] & 0x0F, size = 3;
+    else c = s[i] & 0x07, size = 4;
+    for (uint32_t k = 1; k < size; k++) c = (c << 6) | (s[i + k] & 0x3F);
+    for (uint32_t k = 0; k < size; k++) map[i + k] = count;
+    if (c >= 0x10000) {
+      units[count++] = (uint16_t)(0xD800 + ((c - 0x10000) >> 10));
+      units[count++] = (uint16_t)(0xDC00 + ((c - 0x10000) & 0x3FF));
+    } else {
+      units[count++] = (uint16_t)c;
+    }
+    i += size;
+  }
+  map[length] = count;
+  return count;
+}
+
+// Same types and shape, UTF-16 byte ranges at the mapped code units.
+static bool same_tree(TSNode utf8, TSNode utf16, const uint32_t *map) {
+  if (strcmp(ts_node_type(utf8), ts_node_type(utf16)) != 0) return false;
+  if (ts_node_start_byte(utf16) != 2 * map[ts_node_start_byte(utf8)]) return false;
+  if (ts_node_end_byte(utf16) != 2 * map[ts_node_end_byte(utf8)]) return false;
+  uint32_t count = ts_node_child_count(utf8);
+  if (ts_node_child_count(utf16) != count) return false;
+  for (uint32_t i = 0; i < count; i++) {
+    if (!same_tree(ts_node_child(utf8, i), ts_node_child(utf16, i), map)) return false;
+  }
+  return true;
+}
+
+typedef struct {
+  const uint16_t *units;
+  uint32_t count;
+} UnitReader;
+
+// One code unit per read, so the runtime must join surrogate pairs itself.
+static const char *read_unit(void *payload, uint32_t byte_index, TSPoint position, uint32_t *bytes_read) {
+  (void)position;
+  const UnitReader *reader = (const UnitReader *)payload;
+  uint32_t unit = byte_index / 2;
+  *bytes_read = unit < reader->count ? 2 : 0;
+  return unit < reader->count ? (const char *)(reader->units + unit) : "";
+}
+
+typedef struct {
+  MtlogSegment items[MAX_SEGMENTS];
+  uint32_t count;
+} SegmentList;
+
+static bool collect(const MtlogSegment *segment, void *context) {
+  SegmentList *list = (SegmentList *)context;
+  if (list->count < MAX_SEGMENTS) list->items[list->count++] = *segment;
+  return true;
+}
+
+static bool same_span(MtlogSpan utf8, MtlogSpan utf16, const uint32_t *map) {
+  return utf16.start == map[utf8.start] && utf16.end == map[utf8.end];
+}
+
+// The narrowed extraction against the UTF-8 one.
+static void check_narrowed(const char *text, uint32_t length, const uint16_t *units, uint32_t count,
+                           const uint32_t *map) {
+  static SegmentList expected, actual;
+  static char narrow[MAX_TEXT];
+  expected.count = actual.count = 0;
+  mtlog_scan_segments(text, length, collect, &expected);
+  mtlog_narrow_utf16(units, count, narrow);
+  mtlog_scan_segments(narrow, count, collect, &actual);
+
+  bool same = expected.count == actual.count;
+  for (uint32_t i = 0; same && i < expected.count; i++) {
+    const MtlogSegment *e = &expected.items[i], *a = &actual.items[i];
+    same = e->kind == a->kind && e->name_kind == a->name_kind && e->hint == a->hint &&
+           same_span(e->span, a->span, map) && same_span(e->name, a->name, map) &&
+           same_span(e->format, a->format, map);
+  }
+  if (!same) {
+    fprintf(stderr, "narrowed segments differ: %.*s\n", (int)length, text);
+    failures++;
+  }
+}
+
+static void check(TSParser *parser, const char *text, uint32_t length) {
+  static uint16_t units[MAX_TEXT];
+  static uint32_t map[MAX_TEXT + 1];
+  uint32_t count = to_utf16(text, length, units, map);
+  check_narrowed(text, length, units, count, map);
+
+  TSTree *utf8 = ts_parser_parse_string(parser, NULL, text, length);
+  TSTree *utf16 = ts_parser_parse_string_encoding(parser, NULL, (const char *)units, 2 * count, TSInputEncodingUTF16LE);
+  UnitReader reader = {units, count};
+  TSInput input = {.payload = &reader, .read = read_unit, .encoding = TSInputEncodingUTF16LE};
+  TSTree *chunked = ts_parser_parse(parser, NULL, input);
+
+  TSNode root = ts_tree_root_node(utf8);
+  if (!same_tree(root, ts_tree_root_node(utf16), map) || !same_tree(root, ts_tree_root_node(chunked), map)) {
+    char *sexp = ts_node_string(root);
+    fprintf(stderr, "UTF-16 tree differs: %.*s\n  UTF-8: %s\n", (int)length, text, sexp);
+    free(sexp);
+    failures++;
+  }
+  ts_tree_delete(utf8);
+  ts_tree_delete(utf16);
+  ts_tree_delete(chunked);
+}
+
+static void test_samples(TSParser *parser) {
+  for (size_t i = 0; i < sizeof(SAMPLES) / sizeof(SAMPLES[0]); i++) {
+    check(parser, SAMPLES[i], (uint32_t)strlen(SAMPLES[i]));
+  }
+}
+
+static uint32_t rng_next(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static const char *const PIECES[] = {
+  "{", "}", "$", "@", ".", ":", "\n", "\r\n", " ", "a", "_", "1", "{{", "}}",
+  "é", "ÿ", "€", "日", "😀", "𝄞", "{Ü", "{A😀}", "{Name}", "{{.User}}", "${Level:u3}", "{Amount:F2}",
+};
+
+static void test_random(TSParser *parser) {
+  uint32_t state = 2024;
+  char text[MAX_TEXT / 4];
+  for (int round = 0; round < 500; round++) {
+    uint32_t target = 1 + rng_next(&state) % 200, length = 0;
+    while (length < target) {
+      const char *piece = PIECES[rng_next(&state) % (sizeof(PIECES) / sizeof(PIECES[0]))];
+      size_t n = strlen(piece);
+      memcpy(text + length, piece, n);
+      length += (uint32_t)n;
+    }
+    check(parser, text, length);
+  }
+}
+
+// An unpaired surrogate has no UTF-8 form; it must read as literal text.
+static void test_lone_surrogate(TSParser *parser) {
+  static const uint16_t units[] = {'{', 'A', '}', ' ', 0xD800, ' ', '{', 'B', '}', 0xDC00};
+  uint32_t count = sizeof(units) / sizeof(units[0]);
+  TSTree *tree = ts_parser_parse_string_encoding(parser, NULL, (const char *)units, 2 * count, TSInputEncodingUTF16LE);
+  TSNode root = ts_tree_root_node(tree);
+  EXPECT(!ts_node_has_error(root));
+  uint32_t properties = 0;
+  for (uint32_t i = 0; i < ts_node_named_child_count(root); i++) {
+    TSNode child = ts_node_named_child(root, i);
+    if (strcmp(ts_node_type(child), "property") == 0) {
+      EXPECT(ts_node_start_byte(child) == (properties ? 12u : 0u));
+      properties++;
+    }
+  }
+  EXPECT(properties == 2);
+  ts_tree_delete(tree);
+
+  char narrow[16];
+  SegmentList list = {.count = 0};
+  mtlog_narrow_utf16(units, count, narrow);
+  EXPECT(mtlog_scan_properties(narrow, count, collect, &list) == 2);
+  EXPECT(list.items[0].span.start == 0 && list.items[1].span.start == 6);
+}
+
+int main(void) {
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_mtlog());
+  test_samples(parser);
+  test_random(parser);
+  test_lone_surrogate(parser);
+  ts_parser_delete(parser);
+  printf("encoding: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,104 @@
+// Tests for structural fingerprints (src/fingerprint.h): each flag makes the
+// fingerprint sensitive to exactly the part it names, literal text is
+// canonicalized, and the IR path agrees with the text path.
+//
+//   make -C test/api run
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fingerprint.h"
+
+static int failures;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+static uint64_t fp(const char *text, uint32_t flags) {
+  return mtlog_fingerprint(text, (uint32_t)strlen(text), flags);
+}
+
+// `a` and `b` group together under `same` flags and apart under `different`.
+static void expect_grouping(const char *a, const char *b, uint32_t same, uint32_t different, int line) {
+  if (fp(a, same) != fp(b, same)) {
+    fprintf(stderr, "%s:%d: \"%s\" and \"%s\" differ under flags %u\n", __FILE__, line, a, b, same);
+    failures++;
+  }
+  if (fp(a, different) == fp(b, different)) {
+    fprintf(stderr, "%s:%d: \"%s\" and \"%s\" collide under flags %u\n", __FILE__, line, a, b, different);
+    failures++;
+  }
+}
+
+#define EXPECT_GROUPING(a, b, same, different) expect_grouping(a, b, same, different, __LINE__)
+
+static void test_sensitivity(void) {
+  const uint32_t L = MTLOG_FINGERPRINT_LITERALS, N = MTLOG_FINGERPRINT_NAMES, H = MTLOG_FINGERPRINT_HINTS,
+                 F = MTLOG_FINGERPRINT_FORMATS, ALL = MTLOG_FINGERPRINT_ALL;
+
+  EXPECT_GROUPING("User {UserId} logged in", "User {Id} logged in", ALL & ~N, N);
+  EXPECT_GROUPING("Order {@Order} created", "Order {Order} created", ALL & ~H, H);
+  EXPECT_GROUPING("Order {$Order} created", "Order {@Order} created", ALL & ~H, H);
+  EXPECT_GROUPING("Total {Amount:F2}", "Total {Amount:F4}", ALL & ~F, F);
+  EXPECT_GROUPING("Total {Amount:F2}", "Total {Amount}", ALL & ~F, F);
+  EXPECT_GROUPING("User {UserId} logged in", "Account {UserId} created", ALL & ~L, L);
+
+  // Property kinds always count.
+  EXPECT(fp("{Name}", 0) != fp("${Name}", 0));
+  EXPECT(fp("{Name}", 0) != fp("{{.Name}}", 0));
+  EXPECT(fp("{Name}", 0) != fp("{Name}{Name}", 0));
+  EXPECT(fp("a {X} b", 0) == fp("{X}", 0));
+
+  // Flags never collide with each other on the same template.
+  EXPECT(fp("User {UserId}", N) != fp("User {UserId}", H));
+  EXPECT(fp("", 0) != fp("", L));
+}
+
+static void test_canonical_literals(void) {
+  const uint32_t L = MTLOG_FINGERPRINT_LITERALS;
+  EXPECT(fp("User  {Id}\tlogged in", L) == fp("User {Id} logged in", L));
+  EXPECT(fp("  User {Id} logged in \n", L) == fp("User {Id} logged in", L));
+  EXPECT(fp("User {Id}", L) == fp("User{Id}", L));
+  EXPECT(fp("User\r\n{Id}", L) == fp("User {Id}", L));
+  EXPECT(fp("ab", L) != fp("a b", L));
+  EXPECT(fp("a{X}b", L) != fp("ab{X}", L));
+  EXPECT(fp("abcdefgh{X}", L) != fp("abcdefg{X}h", L));
+
+  // Text the grammar does not accept as a property is literal.
+  EXPECT(fp("{ UserId }", L) != fp("{UserId}", L));
+  EXPECT(fp("{ UserId }", 0) == fp("", 0));
+}
+
+static void test_ir_agrees(void) {
+  static const char *const TEXTS[] = {
+    "",
+    "plain text only",
+    "User {UserId} logged in from {IP:15} at {Timestamp:HH:mm:ss}",
+    "  {@Order}\n\n{{.Name}}  ${Level:u3} {0} {a.b.c} tail  ",
+    "{ broken {Id:} {{.}} {$",
+  };
+  for (size_t i = 0; i < sizeof(TEXTS) / sizeof(TEXTS[0]); i++) {
+    uint32_t length = (uint32_t)strlen(TEXTS[i]);
+    MtlogTemplateIR *ir = mtlog_ir_from_text(TEXTS[i], length);
+    EXPECT(ir != NULL);
+    if (!ir) continue;
+    for (uint32_t flags = 0; flags <= MTLOG_FINGERPRINT_ALL; flags++) {
+      EXPECT(mtlog_fingerprint_ir(ir, TEXTS[i], flags) == mtlog_fingerprint(TEXTS[i], length, flags));
+    }
+    mtlog_ir_delete(ir);
+  }
+}
+
+int main(void) {
+  test_sensitivity();
+  test_canonical_literals();
+  test_ir_agrees();
+  printf("fingerprint: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+// Tests for compiled format specifiers (src/format_spec.h): classification of
+// format strings and the number, date and level writers.
+//
+//   make -C test/api run
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "format_spec.h"
+
+static int failures;
+
+static MtlogFormatSpec compile(const char *format) {
+  MtlogFormatSpec spec;
+  mtlog_format_spec_compile(format, (uint32_t)strlen(format), &spec);
+  return spec;
+}
+
+static void check(const char *format, const char *actual, uint32_t length, const char *expected, int line) {
+  if (length != strlen(expected) || memcmp(actual, expected, length)) {
+    fprintf(stderr, "%s:%d: \"%s\" wrote \"%.*s\", expected \"%s\"\n", __FILE__, line, format, (int)length, actual,
+            expected);
+    failures++;
+  }
+}
+
+#define EXPECT_KIND(format, expected)                                                                 \
+  do {                                                                                                \
+    MtlogFormatSpec spec_ = compile(format);                                                          \
+    if (spec_.kind != (expected)) {                                                                   \
+      fprintf(stderr, "%s:%d: \"%s\" compiled to kind %d\n", __FILE__, __LINE__, format, spec_.kind); \
+      failures++;                                                                                     \
+    }                                                                                                 \
+  } while (0)
+
+#define EXPECT_FORMAT(writer, format, value, expected)              \
+  do {                                                              \
+    MtlogFormatSpec spec_ = compile(format);                        \
+    char out_[MTLOG_FORMAT_MAX_OUTPUT];                             \
+    uint32_t length_ = writer(&spec_, value, out_);                 \
+    check(format, out_, length_, expected, __LINE__);               \
+  } while (0)
+
+#define EXPECT_LEVEL(format, level, expected)                                          \
+  do {                                                                                 \
+    MtlogFormatSpec spec_ = compile(format);                                           \
+    char out_[MTLOG_FORMAT_MAX_OUTPUT];                                                \
+    uint32_t length_ = mtlog_format_level(&spec_, level, (uint32_t)strlen(level), out_); \
+    check(format, out_, length_, expected, __LINE__);                                  \
+  } while (0)
+
+static void test_kinds(void) {
+  EXPECT_KIND("", MTLOG_FORMAT_NONE);
+  EXPECT_KIND("F2", MTLOG_FORMAT_NUMBER);
+  EXPECT_KIND("X8", MTLOG_FORMAT_NUMBER);
+  EXPECT_KIND("#,##0.00", MTLOG_FORMAT_NUMBER);
+  EXPECT_KIND("000", MTLOG_FORMAT_NUMBER);
+  EXPECT_KIND("0", MTLOG_FORMAT_NUMBER);
+  EXPECT_KIND("HH:mm:ss", MTLOG_FORMAT_DATE);
+  EXPECT_KIND("yyyy-MM-dd HH:mm:ss", MTLOG_FORMAT_DATE);
+  EXPECT_KIND("15:04:05.000", MTLOG_FORMAT_DATE);
+  EXPECT_KIND("u3", MTLOG_FORMAT_LEVEL);
+  EXPECT_KIND("U3", MTLOG_FORMAT_LEVEL);
+  EXPECT_KIND("15", MTLOG_FORMAT_PADDING);
+  EXPECT_KIND("-10", MTLOG_FORMAT_PADDING);
+  EXPECT_KIND("l", MTLOG_FORMAT_UNKNOWN);
+  EXPECT_KIND("{", MTLOG_FORMAT_UNKNOWN);
+  // Digits or letters alone do not make a date.
+  EXPECT_KIND("F255", MTLOG_FORMAT_UNKNOWN);
+  EXPECT_KIND("N200", MTLOG_FORMAT_UNKNOWN);
+  EXPECT_KIND("F-1", MTLOG_FORMAT_UNKNOWN);
+  EXPECT_KIND("F2 ", MTLOG_FORMAT_UNKNOWN);
+  EXPECT_KIND("3PM", MTLOG_FORMAT_UNKNOWN);
+  EXPECT_KIND("ms", MTLOG_FORMAT_UNKNOWN);
+  EXPECT_KIND("H:m", MTLOG_FORMAT_UNKNOWN);
+  EXPECT_KIND("HH:mm xyz", MTLOG_FORMAT_UNKNOWN);
+  EXPECT_KIND("HH:mm 'xyz'", MTLOG_FORMAT_DATE);
+  EXPECT_KIND("2006", MTLOG_FORMAT_DATE);
+  EXPECT_KIND("Jan 2", MTLOG_FORMAT_DATE);
+  // Too long to fit the descriptor.
+  EXPECT_KIND("yyyy yyyy yyyy yyyy yyyy yyyy yyyy yyyy yyyy yyyy yyyy yyyy yyyy", MTLOG_FORMAT_UNKNOWN);
+}
+
+static void test_numbers(void) {
+  EXPECT_FORMAT(mtlog_format_double, "F2", 3.14159, "3.14");
+  EXPECT_FORMAT(mtlog_format_double, "F", 2.0, "2.00");
+  EXPECT_FORMAT(mtlog_format_double, "F0", 2.5, "2");
+  EXPECT_FORMAT(mtlog_format_double, "N2", 1234567.891, "1,234,567.89");
+  EXPECT_FORMAT(mtlog_format_double, "N0", -1234567.5, "-1,234,568");
+  EXPECT_FORMAT(mtlog_format_double, "E3", 12345.678, "1.235E+04");
+  EXPECT_FORMAT(mtlog_format_double, "P1", 0.1234, "12.3%");
+  EXPECT_FORMAT(mtlog_format_double, "G", 0.1, "0.1");
+  EXPECT_FORMAT(mtlog_format_double, "G4", 3.14159, "3.142");
+  EXPECT_FORMAT(mtlog_format_double, "D5", 42.6, "00043");
+  EXPECT_FORMAT(mtlog_format_double, "X", 255.9, "FF");
+  EXPECT_FORMAT(mtlog_format_double, "0.00", 2.5, "2.50");
+  EXPECT_FORMAT(mtlog_format_double, "#,##0.0#", 1234.5, "1,234.5");
+  EXPECT_FORMAT(mtlog_format_double, "#,##0.0#", 1234.567, "1,234.57");
+  EXPECT_FORMAT(mtlog_format_double, "0%", 0.256, "26%");
+  EXPECT_FORMAT(mtlog_format_double, "F2", HUGE_VAL, "+Inf");
+  EXPECT_FORMAT(mtlog_format_double, "u3", 1.5, "1.5");
+
+  EXPECT_FORMAT(mtlog_format_int, "D8", -42, "-00000042");
+  EXPECT_FORMAT(mtlog_format_int, "X8", 255, "000000FF");
+  EXPECT_FORMAT(mtlog_format_int, "x", -1, "ffffffffffffffff");
+  EXPECT_FORMAT(mtlog_format_int, "F2", -12, "-12.00");
+  EXPECT_FORMAT(mtlog_format_int, "N0", 1234567, "1,234,567");
+  EXPECT_FORMAT(mtlog_format_int, "000", 5, "005");
+  EXPECT_FORMAT(mtlog_format_int, "D", INT64_MIN, "-9223372036854775808");
+  EXPECT_FORMAT(mtlog_format_int, "P0", 3, "300%");
+  EXPECT_FORMAT(mtlog_format_uint, "N0", UINT64_MAX, "18,446,744,073,709,551,615");
+  EXPECT_FORMAT(mtlog_format_uint, "HH", 7, "7");
+
+  // The widest output fits MTLOG_FORMAT_MAX_OUTPUT.
+  MtlogFormatSpec spec = compile("N99");
+  char out[MTLOG_FORMAT_MAX_OUTPUT];
+  uint32_t length = mtlog_format_double(&spec, -1.7e308, out);
+  if (length > MTLOG_FORMAT_MAX_OUTPUT || out[0] != '-') {
+    fprintf(stderr, "%s:%d: N99 wrote %u bytes\n", __FILE__, __LINE__, length);
+    failures++;
+  }
+}
+
+static void test_dates(void) {
+  const int64_t t = 1718454245123456789LL; // 2024-06-15T12:24:05.123456789Z, a Saturday
+  const int64_t whole = 1718454245000000000LL;
+  EXPECT_FORMAT(mtlog_format_time, "yyyy-MM-dd HH:mm:ss", t, "2024-06-15 12:24:05");
+  EXPECT_FORMAT(mtlog_format_time, "yyyy-MM-dd HH:mm:ss.fff", t, "2024-06-15 12:24:05.123");
+  EXPECT_FORMAT(mtlog_format_time, "ddd, dd MMM yyyy hh:mm tt", t, "Sat, 15 Jun 2024 12:24 PM");
+  EXPECT_FORMAT(mtlog_format_time, "dddd MMMM d yy 'at' H\\h", t, "Saturday June 15 24 at 12h");
+  EXPECT_FORMAT(mtlog_format_time, "HH:mm:ss.FFFFFFFK", whole, "12:24:05Z");
+  EXPECT_FORMAT(mtlog_format_time, "HH:mm:ss.FFFFFFF", t, "12:24:05.1234567");
+  EXPECT_FORMAT(mtlog_format_time, "15:04:05.000", t, "12:24:05.123");
+  EXPECT_FORMAT(mtlog_format_time, "2006-01-02T15:04:05.999999999Z07:00", t, "2024-06-15T12:24:05.123456789Z");
+  EXPECT_FORMAT(mtlog_format_time, "2006-01-02T15:04:05.999Z07:00", whole, "2024-06-15T12:24:05Z");
+  EXPECT_FORMAT(mtlog_format_time, "Mon Jan _2 15:04:05 MST 2006", 0, "Thu Jan  1 00:00:00 UTC 1970");
+  EXPECT_FORMAT(mtlog_format_time, "January 2, 2006 3:04PM -0700", t, "June 15, 2024 12:24PM +0000");
+  EXPECT_FORMAT(mtlog_format_time, "", -1, "1969-12-31T23:59:59.999999999Z");
+  EXPECT_FORMAT(mtlog_format_time, "F2", 0, "1970-01-01T00:00:00Z");
+  EXPECT_FORMAT(mtlog_format_time, "yyyy-MM-dd", 951782400LL * 1000000000, "2000-02-29");
+}
+
+static void test_levels(void) {
+  EXPECT_LEVEL("u3", "Information", "INF");
+  EXPECT_LEVEL("w3", "Warning", "wrn");
+  EXPECT_LEVEL("U3", "fatal", "FTL");
+  EXPECT_LEVEL("u3", "Custom", "CUS");
+  EXPECT_LEVEL("u", "debug", "DEBUG");
+  EXPECT_LEVEL("w", "ERROR", "error");
+  EXPECT_LEVEL("u2", "Fatal", "FA");
+  EXPECT_LEVEL("F2", "Error", "Error");
+}
+
+int main(void) {
+  test_kinds();
+  test_numbers();
+  test_dates();
+  test_levels();
+  printf("format_spec: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
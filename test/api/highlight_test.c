@@ -0,0 +1,262 @@
+// Parity test for the table-driven highlighter (src/highlight.c): on every
+// input it must report the same highlights as running queries/highlights.scm
+// through a TSQuery, with each node taking the capture of the first pattern
+// that matches it, as `tree-sitter highlight` does. Comparing with the query
+// engine rather than the CLI's output keeps the test independent of the
+// user's theme, which decides which capture names the CLI shows.
+//
+// Inputs are the test/highlight samples and example files, whole and line by
+// line, the test/corpus files and random templates, errors included.
+//
+//   make -C test/api run TREE_SITTER_DIR=~/tree-sitter
+
+#define _POSIX_C_SOURCE 200809L // opendir()
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <tree_sitter/api.h>
+
+#include "highlight.h"
+
+const TSLanguage *tree_sitter_mtlog(void);
+
+#define MAX_HIGHLIGHTS 4096
+
+typedef struct {
+  uint32_t start;
+  uint32_t end;
+  const char *name;
+} Highlight;
+
+typedef struct {
+  Highlight items[MAX_HIGHLIGHTS];
+  uint32_t count;
+} HighlightList;
+
+typedef struct {
+  const void *id;
+  uint32_t pattern;
+  uint32_t capture;
+} Match;
+
+static struct {
+  Match items[MAX_HIGHLIGHTS];
+  uint32_t count;
+} matches;
+
+static HighlightList expected, actual;
+
+static bool collect(const MtlogHighlight *highlight, void *context) {
+  HighlightList *list = (HighlightList *)context;
+  if (list->count < MAX_HIGHLIGHTS) {
+    Highlight item = {highlight->span.start, highlight->span.end, mtlog_highlight_capture_name(highlight->capture)};
+    list->items[list->count++] = item;
+  }
+  return true;
+}
+
+// Keep the capture of the lowest pattern index for each node.
+static void record(TSNode node, uint32_t pattern, uint32_t capture) {
+  for (uint32_t i = 0; i < matches.count; i++) {
+    if (matches.items[i].id == node.id) {
+      if (pattern < matches.items[i].pattern) {
+        matches.items[i].pattern = pattern;
+        matches.items[i].capture = capture;
+      }
+      return;
+    }
+  }
+  if (matches.count < MAX_HIGHLIGHTS) {
+    Match match = {node.id, pattern, capture};
+    matches.items[matches.count++] = match;
+  }
+}
+
+// The query's highlights in pre-order, the order the highlighter reports.
+static void collect_expected(TSNode node, const TSQuery *query) {
+  for (uint32_t i = 0; i < matches.count; i++) {
+    if (matches.items[i].id != node.id) continue;
+    uint32_t start = ts_node_start_byte(node), end = ts_node_end_byte(node), length;
+    if (start < end && expected.count < MAX_HIGHLIGHTS) {
+      Highlight item = {start, end, ts_query_capture_name_for_id(query, matches.items[i].capture, &length)};
+      expected.items[expected.count++] = item;
+    }
+    break;
+  }
+  uint32_t count = ts_node_child_count(node);
+  for (uint32_t i = 0; i < count; i++) collect_expected(ts_node_child(node, i), query);
+}
+
+static void print_list(const char *label, const HighlightList *list, const char *text) {
+  for (uint32_t i = 0; i < list->count; i++) {
+    const Highlight *h = &list->items[i];
+    fprintf(stderr, "    %s %u-%u %s \"%.*s\"\n", label, h->start, h->end, h->name, (int)(h->end - h->start),
+            text + h->start);
+  }
+}
+
+static bool check(TSParser *parser, const TSQuery *query, TSQueryCursor *cursor, const char *label,
+                  const char *text, uint32_t length) {
+  TSTree *tree = ts_parser_parse_string(parser, NULL, text, length);
+  TSNode root = ts_tree_root_node(tree);
+
+  matches.count = 0;
+  ts_query_cursor_exec(cursor, query, root);
+  TSQueryMatch match;
+  while (ts_query_cursor_next_match(cursor, &match)) {
+    for (uint16_t i = 0; i < match.capture_count; i++) {
+      record(match.captures[i].node, match.pattern_index, match.captures[i].index);
+    }
+  }
+  expected.count = 0;
+  collect_expected(root, query);
+
+  actual.count = 0;
+  uint32_t delivered = mtlog_highlight(root, collect, &actual);
+
+  bool ok = delivered == actual.count && expected.count == actual.count;
+  for (uint32_t i = 0; ok && i < expected.count; i++) {
+    const Highlight *e = &expected.items[i], *a = &actual.items[i];
+    ok = e->start == a->start && e->end == a->end && a->name && strcmp(e->name, a->name) == 0;
+  }
+  if (!ok) {
+    fprintf(stderr, "mismatch in %s: \"%.*s\"\n", label, (int)length, text);
+    print_list("query", &expected, text);
+    print_list("table", &actual, text);
+  }
+  ts_tree_delete(tree);
+  return ok;
+}
+
+static char *read_file(const char *path, uint32_t *length) {
+  FILE *file = fopen(path, "rb");
+  if (!file) return NULL;
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  char *data = (char *)malloc((size_t)size + 1);
+  size_t read = fread(data, 1, (size_t)size, file);
+  fclose(file);
+  data[read] = '\0';
+  *length = (uint32_t)read;
+  return data;
+}
+
+// A file as a whole and, if `lines`, each of its lines on its own.
+static int check_file(TSParser *parser, const TSQuery *query, TSQueryCursor *cursor, const char *path, bool lines,
+                      int *cases) {
+  uint32_t length;
+  char *data = read_file(path, &length);
+  if (!data) return 0;
+
+  int failures = !check(parser, query, cursor, path, data, length);
+  (*cases)++;
+  for (char *line = data; lines && line && *line;) {
+    char *end = strchr(line, '\n');
+    if (!end) end = data + length;
+    if (!check(parser, query, cursor, path, line, (uint32_t)(end - line))) failures++;
+    (*cases)++;
+    line = *end ? end + 1 : NULL;
+  }
+
+  free(data);
+  return failures;
+}
+
+static int check_directory(TSParser *parser, const TSQuery *query, TSQueryCursor *cursor, const char *directory,
+                           const char *suffix, bool lines, int *cases) {
+  DIR *dir = opendir(directory);
+  if (!dir) return 0;
+  int failures = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir))) {
+    size_t name_length = strlen(entry->d_name);
+    size_t suffix_length = strlen(suffix);
+    if (name_length < suffix_length || strcmp(entry->d_name + name_length - suffix_length, suffix) != 0) continue;
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+    failures += check_file(parser, query, cursor, path, lines, cases);
+  }
+  closedir(dir);
+  return failures;
+}
+
+// Random templates over the characters that drive the grammar. Inputs with
+// errors are compared too: the query matches inside ERROR nodes, and so
+// must the table.
+static int check_random(TSParser *parser, const TSQuery *query, TSQueryCursor *cursor, int iterations, int *cases) {
+  static const char alphabet[] = "{}{}$$@:..aZ_09 \n";
+  uint32_t state = 0x2545f491;
+  int failures = 0;
+  char text[48];
+  for (int i = 0; i < iterations; i++) {
+    state = state * 1664525u + 1013904223u;
+    uint32_t length = (state >> 24) % sizeof(text);
+    for (uint32_t j = 0; j < length; j++) {
+      state = state * 1664525u + 1013904223u;
+      text[j] = alphabet[(state >> 16) % (sizeof(alphabet) - 1)];
+    }
+    if (!check(parser, query, cursor, "random", text, length)) failures++;
+    (*cases)++;
+  }
+  return failures;
+}
+
+// The table must list the query's capture names in the query's order.
+static int check_names(const TSQuery *query) {
+  uint32_t count = ts_query_capture_count(query);
+  bool same = count == mtlog_highlight_capture_count() && mtlog_highlight_capture_name(count) == NULL;
+  for (uint32_t i = 0; same && i < count; i++) {
+    uint32_t length;
+    const char *name = ts_query_capture_name_for_id(query, i, &length);
+    const char *table = mtlog_highlight_capture_name(i);
+    same = strlen(table) == length && memcmp(name, table, length) == 0;
+  }
+  if (!same) fprintf(stderr, "capture names differ from highlights.scm; run node script/highlight_table.js\n");
+  return same ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+  const char *root = argc > 1 ? argv[1] : "../..";
+  char path[1024];
+
+  snprintf(path, sizeof(path), "%s/queries/highlights.scm", root);
+  uint32_t source_length;
+  char *source = read_file(path, &source_length);
+  if (!source) {
+    fprintf(stderr, "cannot read %s\n", path);
+    return 1;
+  }
+  uint32_t error_offset;
+  TSQueryError error;
+  TSQuery *query = ts_query_new(tree_sitter_mtlog(), source, source_length, &error_offset, &error);
+  free(source);
+  if (!query) {
+    fprintf(stderr, "highlights.scm: query error %d at offset %u\n", (int)error, error_offset);
+    return 1;
+  }
+
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_mtlog());
+  TSQueryCursor *cursor = ts_query_cursor_new();
+
+  int cases = 0;
+  int failures = check_names(query);
+  snprintf(path, sizeof(path), "%s/test/highlight", root);
+  failures += check_directory(parser, query, cursor, path, ".mtlog", true, &cases);
+  snprintf(path, sizeof(path), "%s/examples", root);
+  failures += check_directory(parser, query, cursor, path, ".mtlog", true, &cases);
+  snprintf(path, sizeof(path), "%s/test/corpus", root);
+  failures += check_directory(parser, query, cursor, path, ".txt", false, &cases);
+  failures += check_random(parser, query, cursor, 100000, &cases);
+
+  ts_query_cursor_delete(cursor);
+  ts_parser_delete(parser);
+  ts_query_delete(query);
+  printf("highlight: %d inputs, %d mismatches\n", cases, failures);
+  return failures ? 1 : 0;
+}
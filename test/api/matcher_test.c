@@ -0,0 +1,217 @@
+// Tests for reverse extraction (src/matcher.h): choosing among templates,
+// capture gaps, catch-all templates, and a round trip over many generated
+// templates.
+//
+//   make -C test/api run
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "matcher.h"
+
+static int failures;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+static int32_t add(MtlogMatcher *matcher, const char *text) {
+  return mtlog_matcher_add(matcher, text, (uint32_t)strlen(text));
+}
+
+static int32_t match(const MtlogMatcher *matcher, const char *line, MtlogSpan *captures, uint32_t capacity) {
+  return mtlog_matcher_match(matcher, line, (uint32_t)strlen(line), captures, capacity);
+}
+
+static bool captured(const char *line, MtlogSpan span, const char *expected) {
+  return span.end - span.start == strlen(expected) && !memcmp(line + span.start, expected, strlen(expected));
+}
+
+static void test_basic(void) {
+  MtlogMatcher *matcher = mtlog_matcher_new();
+  int32_t in = add(matcher, "User {UserId} logged in from {IP}");
+  int32_t out = add(matcher, "User {UserId} logged out");
+  int32_t plain = add(matcher, "Service started");
+  EXPECT(in == 0 && out == 1 && plain == 2);
+  EXPECT(mtlog_matcher_template_count(matcher) == 3);
+  EXPECT(mtlog_matcher_property_count(matcher, in) == 2);
+  EXPECT(mtlog_matcher_property_count(matcher, plain) == 0);
+
+  MtlogSpan captures[4];
+  EXPECT(match(matcher, "User alice logged in from 10.0.0.1", captures, 4) == -1); // not built yet
+  EXPECT(mtlog_matcher_build(matcher));
+
+  const char *line = "User alice logged in from 10.0.0.1";
+  EXPECT(match(matcher, line, captures, 4) == in);
+  EXPECT(captured(line, captures[0], "alice"));
+  EXPECT(captured(line, captures[1], "10.0.0.1"));
+
+  line = "User bob smith logged out";
+  EXPECT(match(matcher, line, captures, 4) == out);
+  EXPECT(captured(line, captures[0], "bob smith"));
+
+  EXPECT(match(matcher, "Service started", NULL, 0) == plain);
+  EXPECT(match(matcher, "Service started twice", NULL, 0) == -1);
+  EXPECT(match(matcher, "User alice logged", NULL, 0) == -1);
+  EXPECT(match(matcher, "", NULL, 0) == -1);
+
+  // Captures beyond the capacity are not written.
+  line = "User alice logged in from 10.0.0.1";
+  captures[1] = (MtlogSpan){99, 99};
+  EXPECT(match(matcher, line, captures, 1) == in);
+  EXPECT(captured(line, captures[0], "alice"));
+  EXPECT(captures[1].start == 99);
+
+  // Adding discards the index until the next build.
+  int32_t again = add(matcher, "User {UserId} logged in from {IP} via {Method}");
+  EXPECT(match(matcher, line, NULL, 0) == -1);
+  EXPECT(mtlog_matcher_build(matcher));
+  line = "User alice logged in from 10.0.0.1 via sso";
+  EXPECT(match(matcher, line, captures, 4) == again);
+  EXPECT(captured(line, captures[1], "10.0.0.1"));
+  EXPECT(captured(line, captures[2], "sso"));
+  mtlog_matcher_delete(matcher);
+}
+
+static void test_specificity(void) {
+  MtlogMatcher *matcher = mtlog_matcher_new();
+  int32_t any = add(matcher, "{Message}");
+  int32_t generic = add(matcher, "Request {Path} took {Elapsed} ms");
+  int32_t health = add(matcher, "Request /health took {Elapsed} ms");
+  int32_t duplicate = add(matcher, "Request /health took {Duration:F1} ms");
+  EXPECT(mtlog_matcher_build(matcher));
+
+  MtlogSpan captures[2];
+  const char *line = "Request /health took 3 ms";
+  EXPECT(match(matcher, line, captures, 2) == health); // more literal text, then added first
+  EXPECT(captured(line, captures[0], "3"));
+  EXPECT(match(matcher, "Request /api took 3 ms", captures, 2) == generic);
+  EXPECT(duplicate != health);
+
+  // Nothing else matches: the catch-all takes the whole line.
+  line = "disk full";
+  EXPECT(match(matcher, line, captures, 2) == any);
+  EXPECT(captured(line, captures[0], "disk full"));
+  mtlog_matcher_delete(matcher);
+}
+
+static void test_gaps(void) {
+  MtlogMatcher *matcher = mtlog_matcher_new();
+  int32_t adjacent = add(matcher, "{A}{B} end");
+  int32_t kinds = add(matcher, "${Timestamp} [{{.Level}}] {@Message} ({0})");
+  int32_t edges = add(matcher, "{Head} to {Tail}");
+  EXPECT(mtlog_matcher_build(matcher));
+
+  MtlogSpan captures[4];
+  const char *line = "xy end";
+  EXPECT(match(matcher, line, captures, 4) == adjacent);
+  EXPECT(captured(line, captures[0], ""));
+  EXPECT(captured(line, captures[1], "xy"));
+
+  line = "12:00 [INF] hello (world) (7)";
+  EXPECT(match(matcher, line, captures, 4) == kinds);
+  EXPECT(captured(line, captures[0], "12:00"));
+  EXPECT(captured(line, captures[1], "INF"));
+  EXPECT(captured(line, captures[2], "hello"));
+  EXPECT(captured(line, captures[3], "world) (7"));
+
+  // Gaps take the shortest text from the left; empty values are fine.
+  line = "a to b to c";
+  EXPECT(match(matcher, line, captures, 4) == edges);
+  EXPECT(captured(line, captures[0], "a"));
+  EXPECT(captured(line, captures[1], "b to c"));
+  line = " to ";
+  EXPECT(match(matcher, line, captures, 4) == edges);
+  EXPECT(captured(line, captures[0], "") && captured(line, captures[1], ""));
+  mtlog_matcher_delete(matcher);
+}
+
+static void test_repeated_anchors(void) {
+  // Far more anchor hits than the matcher remembers per line.
+  MtlogMatcher *matcher = mtlog_matcher_new();
+  add(matcher, "{A}, {B}");
+  int32_t tail = add(matcher, "{A}, {B}; done");
+  EXPECT(mtlog_matcher_build(matcher));
+
+  char line[512] = "";
+  for (int i = 0; i < 100; i++) strcat(line, "a, ");
+  strcat(line, "; done");
+  MtlogSpan captures[2];
+  EXPECT(match(matcher, line, captures, 2) == tail);
+  EXPECT(captured(line, captures[0], "a"));
+  mtlog_matcher_delete(matcher);
+}
+
+static uint64_t rng_state = 0x2545f4914f6cdd1dull;
+
+static uint32_t rng_next(uint32_t bound) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (uint32_t)(rng_state % bound);
+}
+
+static void test_round_trip(void) {
+  // Literal words never contain digits and values are only digits, so each
+  // line can only be read back one way.
+  static const char *const WORDS[] = {"user",  "order", "payment", "failed", "retry", "cache", "miss",
+                                      "queue", "disk",  "request", "served",  "from",  "to",    "in",
+                                      "by",    "node",  "shard",   "lease",   "lost",  "owner", "batch"};
+  enum { TEMPLATES = 2000, WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]) };
+  static char texts[TEMPLATES][160];
+  MtlogMatcher *matcher = mtlog_matcher_new();
+  for (int i = 0; i < TEMPLATES; i++) {
+    char *p = texts[i];
+    int properties = 1 + (int)rng_next(4);
+    if (rng_next(4) == 0) p += sprintf(p, "{Lead} ");
+    for (int j = 0; j < properties; j++) {
+      int words = 1 + (int)rng_next(3);
+      for (int k = 0; k < words; k++) p += sprintf(p, "%s ", WORDS[rng_next(WORD_COUNT)]);
+      p += sprintf(p, "{P%d}%s", j, j + 1 < properties ? " " : "");
+    }
+    if (rng_next(2)) sprintf(p, " %s", WORDS[rng_next(WORD_COUNT)]);
+    EXPECT(add(matcher, texts[i]) == i);
+  }
+  EXPECT(mtlog_matcher_build(matcher));
+
+  for (int n = 0; n < 20000; n++) {
+    int id = (int)rng_next(TEMPLATES);
+    char line[512], values[8][16];
+    uint32_t value_count = 0, length = 0;
+    for (const char *p = texts[id]; *p;) {
+      if (*p == '{') {
+        sprintf(values[value_count], "%u", rng_next(1000000));
+        length += (uint32_t)sprintf(line + length, "%s", values[value_count++]);
+        p = strchr(p, '}') + 1;
+      } else {
+        line[length++] = *p++;
+      }
+    }
+    line[length] = 0;
+
+    MtlogSpan captures[8];
+    int32_t found = mtlog_matcher_match(matcher, line, length, captures, 8);
+    if (found != id && (found < 0 || strcmp(texts[found], texts[id]) != 0)) {
+      fprintf(stderr, "round trip: \"%s\" from \"%s\" matched %d\n", line, texts[id], found);
+      failures++;
+      continue;
+    }
+    for (uint32_t i = 0; i < value_count; i++) EXPECT(captured(line, captures[i], values[i]));
+  }
+  mtlog_matcher_delete(matcher);
+}
+
+int main(void) {
+  test_basic();
+  test_specificity();
+  test_gaps();
+  test_repeated_anchors();
+  test_round_trip();
+  printf("matcher: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+// Tests for multi-threaded extraction (src/parallel.h): where text may be cut,
+// then the parallel IR against mtlog_ir_from_text, byte for byte, on random
+// text full of constructs that straddle lines, for several thread counts and
+// chunk sizes down to a single byte.
+//
+//   make -C test/api run
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parallel.h"
+
+static int failures;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+static uint32_t boundary(const char *text, uint32_t from) {
+  return mtlog_line_boundary(text, (uint32_t)strlen(text), from);
+}
+
+static void test_boundary(void) {
+  EXPECT(boundary("User {UserId}\nOrder {Id}\n", 0) == 14);
+  EXPECT(boundary("User {UserId}\nOrder {Id}\n", 14) == 25);
+  EXPECT(boundary("no line end", 0) == 11);
+  EXPECT(boundary("", 0) == 0);
+  EXPECT(boundary("\r\n\r\nx", 0) == 2);
+
+  // Not inside a Go-template property, which may run across lines.
+  const char *go = "{{\n.User\n.Name\n}} logged in\nnext";
+  EXPECT(boundary(go, 0) == 28);
+  EXPECT(boundary("Ready {{\n", 0) == 9);
+  EXPECT(boundary("{{ .User }}\nx", 0) == 12);
+  // A single '{' cannot span lines.
+  EXPECT(boundary("User {UserId\nx", 0) == 13);
+
+  // One-word lines are cut at every line end, however far back the line
+  // start is, and so are lines after a '{{' that is never closed.
+  static char words[64 * 8 + 1];
+  for (uint32_t i = 0; i < 64; i++) memcpy(words + i * 8, "Started\n", 8);
+  for (uint32_t from = 0; from < 64 * 8; from += 8) {
+    EXPECT(boundary(words, from) == from + 8);
+    EXPECT(mtlog_line_boundary_after(words, 64 * 8, from, from) == from + 8);
+  }
+  static char after[4 + 64 * 8 + 1];
+  memcpy(after, "{{\n.", 4);
+  memcpy(after + 4, words, sizeof(words));
+  EXPECT(boundary(after, 0) == 3);
+  EXPECT(boundary(after, 300) == 300 + 8);
+
+  // However far a property's line ends run, it is not cut.
+  static char spread[4 + 2 + 300 + 7 + 6 + 1];
+  uint32_t n = 0;
+  memcpy(spread, "pre\n{{", 6), n = 6;
+  memset(spread + n, '\n', 300), n += 300;
+  memcpy(spread + n, ".Name}}\npost\n", 13), n += 13;
+  EXPECT(boundary(spread, 0) == 4);
+  EXPECT(boundary(spread, 4) == n - 5);
+  EXPECT(boundary(spread, 200) == n - 5);
+  EXPECT(mtlog_line_boundary_after(spread, n, 4, 200) == n - 5);
+}
+
+static void expect_same(const char *text, uint32_t length, uint32_t threads, uint32_t chunk_size) {
+  MtlogTemplateIR *expected = mtlog_ir_from_text(text, length);
+  MtlogTemplateIR *actual = mtlog_ir_from_text_parallel(text, length, threads, chunk_size);
+  bool same = expected && actual && actual->size == expected->size && !memcmp(actual, expected, expected->size);
+  if (!same) {
+    fprintf(stderr, "mismatch: %u bytes, %u threads, chunks of %u\n", length, threads, chunk_size);
+    failures++;
+  }
+  EXPECT(!actual || mtlog_ir_check(actual, actual->size) == actual);
+  mtlog_ir_delete(expected);
+  mtlog_ir_delete(actual);
+}
+
+static uint32_t rng_next(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static const char *const PIECES[] = {
+  "{", "}", "$", "@", ".", ":", "\n", "\r\n", " ", "a", "Z", "1", "_", "{{", "}}",
+  "{UserId}", "{@Order}", "{Amount:F2}", "${Level:u3}", "{{.User}}", "{{\n.User\n}}",
+  "{{.http\n.method}}", "{{\n", "{0}", "text ", "{Name:yyyy-MM-dd\n",
+};
+
+static void test_random(void) {
+  uint32_t state = 12345;
+  static char text[1 << 16];
+  static const uint32_t THREADS[] = {1, 2, 3, 8};
+  static const uint32_t CHUNKS[] = {1, 7, 64, 1000, 0};
+  for (int round = 0; round < 40; round++) {
+    uint32_t target = 1 + rng_next(&state) % 4000, length = 0;
+    while (length < target) {
+      const char *piece = PIECES[rng_next(&state) % (sizeof(PIECES) / sizeof(PIECES[0]))];
+      size_t n = strlen(piece);
+      memcpy(text + length, piece, n);
+      length += (uint32_t)n;
+    }
+    for (size_t t = 0; t < sizeof(THREADS) / sizeof(THREADS[0]); t++) {
+      for (size_t c = 0; c < sizeof(CHUNKS) / sizeof(CHUNKS[0]); c++) expect_same(text, length, THREADS[t], CHUNKS[c]);
+    }
+  }
+  expect_same("", 0, 4, 1);
+  static char spread[2 + 300 + 7];
+  memcpy(spread, "{{", 2);
+  memset(spread + 2, '\n', 300);
+  memcpy(spread + 302, ".Name}}", 7);
+  static char text_spread[4 + sizeof(spread) + 6];
+  memcpy(text_spread, "pre\n", 4);
+  memcpy(text_spread + 4, spread, sizeof(spread));
+  memcpy(text_spread + 4 + sizeof(spread), "\npost\n", 6);
+  expect_same(text_spread, sizeof(text_spread), 2, 8);
+  expect_same(text_spread, sizeof(text_spread), 4, 1);
+  expect_same("\n\n\n", 3, 4, 1);
+}
+
+static void test_large(void) {
+  // Several default-sized chunks of log-like lines.
+  uint32_t length = 5u << 20, state = 99;
+  char *text = (char *)malloc(length);
+  uint32_t at = 0;
+  while (at < length) {
+    char line[128];
+    int n = snprintf(line, sizeof(line), "[%u] User {UserId} took {Elapsed:0.000} ms{{.trace\n.id}}\n",
+                     rng_next(&state) % 1000);
+    uint32_t take = length - at < (uint32_t)n ? length - at : (uint32_t)n;
+    memcpy(text + at, line, take);
+    at += take;
+  }
+  expect_same(text, length, 4, 0);
+  expect_same(text, length, 0, 100000);
+  free(text);
+}
+
+int main(void) {
+  test_boundary();
+  test_random();
+  test_large();
+  printf("parallel: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+// Tests for the parser pool (src/parser_pool.h): checkout and return on one
+// thread, running dry and overflowing, then more threads than parsers
+// parsing at once and each getting the tree a private parser would.
+//
+// Build with CFLAGS="-O1 -g -fsanitize=thread" to check the pool and the
+// scanner for races.
+//
+//   make -C test/api run TREE_SITTER_DIR=~/tree-sitter
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser_pool.h"
+
+const TSLanguage *tree_sitter_mtlog(void);
+
+#define POOL_SIZE 4
+#define THREADS 16
+#define ROUNDS 200
+
+static int failures;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+static const char *const TEMPLATES[] = {
+  "User {UserId} logged in from {IP}",
+  "Order {@Order} created with total {Amount:F2}",
+  "{$Error} at {Timestamp:yyyy-MM-dd HH:mm:ss}",
+  "Request to {http.method} {Path} returned {StatusCode} in {Elapsed:0.000} ms",
+  "${Level:u3} {{.UserId}} {0}",
+  "Unclosed {brace and {Valid}\nsecond line {Other}",
+  "{{ literal braces }} and {",
+  "",
+};
+
+#define TEMPLATE_COUNT (sizeof(TEMPLATES) / sizeof(TEMPLATES[0]))
+
+static char *expected[TEMPLATE_COUNT];
+
+static char *tree_string(TSParser *parser, const char *text) {
+  TSTree *tree = ts_parser_parse_string(parser, NULL, text, (uint32_t)strlen(text));
+  if (!tree) return NULL;
+  char *string = ts_node_string(ts_tree_root_node(tree));
+  ts_tree_delete(tree);
+  return string;
+}
+
+static void test_single_thread(void) {
+  MtlogParserPool *pool = mtlog_parser_pool_new(POOL_SIZE);
+  EXPECT(pool != NULL);
+  if (!pool) return;
+
+  MtlogParserPoolStats stats;
+  mtlog_parser_pool_stats(pool, &stats);
+  EXPECT(stats.size == POOL_SIZE && stats.idle == POOL_SIZE);
+
+  // Parsers come out ready to parse, and distinct.
+  TSParser *parsers[POOL_SIZE + 1];
+  for (int i = 0; i < POOL_SIZE; i++) {
+    parsers[i] = mtlog_parser_pool_checkout(pool);
+    EXPECT(parsers[i] != NULL);
+    for (int j = 0; j < i; j++) EXPECT(parsers[i] != parsers[j]);
+  }
+  char *string = tree_string(parsers[0], TEMPLATES[0]);
+  EXPECT(string && !strcmp(string, expected[0]));
+  free(string);
+
+  // A dry pool creates a parser rather than failing, and a full pool
+  // deletes the extra one on return.
+  mtlog_parser_pool_stats(pool, &stats);
+  EXPECT(stats.idle == 0 && stats.overflows == 0);
+  parsers[POOL_SIZE] = mtlog_parser_pool_checkout(pool);
+  EXPECT(parsers[POOL_SIZE] != NULL);
+  mtlog_parser_pool_stats(pool, &stats);
+  EXPECT(stats.overflows == 1);
+  for (int i = 0; i <= POOL_SIZE; i++) mtlog_parser_pool_return(pool, parsers[i]);
+  mtlog_parser_pool_stats(pool, &stats);
+  EXPECT(stats.idle == POOL_SIZE && stats.discards == 1);
+
+  // One thread keeps getting the parser it returned.
+  TSParser *first = mtlog_parser_pool_checkout(pool);
+  mtlog_parser_pool_return(pool, first);
+  EXPECT(mtlog_parser_pool_checkout(pool) == first);
+  mtlog_parser_pool_return(pool, first);
+  mtlog_parser_pool_return(pool, NULL);
+  mtlog_parser_pool_delete(pool);
+
+  pool = mtlog_parser_pool_new(0);
+  EXPECT(pool != NULL);
+  if (pool) {
+    mtlog_parser_pool_stats(pool, &stats);
+    EXPECT(stats.size == 64 && stats.idle == 64);
+  }
+  mtlog_parser_pool_delete(pool);
+}
+
+typedef struct {
+  pthread_t thread;
+  MtlogParserPool *pool;
+  int index;
+  int mismatches;
+} Worker;
+
+static void *run_worker(void *argument) {
+  Worker *worker = (Worker *)argument;
+  for (int round = 0; round < ROUNDS; round++) {
+    size_t t = (size_t)(round + worker->index) % TEMPLATE_COUNT;
+    TSParser *parser = mtlog_parser_pool_checkout(worker->pool);
+    char *string = parser ? tree_string(parser, TEMPLATES[t]) : NULL;
+    mtlog_parser_pool_return(worker->pool, parser);
+    worker->mismatches += !string || strcmp(string, expected[t]) != 0;
+    free(string);
+  }
+  return NULL;
+}
+
+static void test_threads(void) {
+  // Four times as many threads as parsers, so checkouts collide and the
+  // pool overflows.
+  MtlogParserPool *pool = mtlog_parser_pool_new(POOL_SIZE);
+  EXPECT(pool != NULL);
+  if (!pool) return;
+  Worker workers[THREADS];
+  for (int i = 0; i < THREADS; i++) {
+    workers[i] = (Worker){0};
+    workers[i].pool = pool;
+    workers[i].index = i;
+    EXPECT(pthread_create(&workers[i].thread, NULL, run_worker, &workers[i]) == 0);
+  }
+  int mismatches = 0;
+  for (int i = 0; i < THREADS; i++) {
+    pthread_join(workers[i].thread, NULL);
+    mismatches += workers[i].mismatches;
+  }
+  EXPECT(mismatches == 0);
+
+  // Every parser is back: the ones created with the pool or for an
+  // overflow, less the ones deleted on return. A sweep can miss a slot that
+  // frees up behind it, so overflows and discards need not match exactly.
+  MtlogParserPoolStats stats;
+  mtlog_parser_pool_stats(pool, &stats);
+  EXPECT(stats.idle > 0 && stats.idle <= POOL_SIZE);
+  EXPECT(stats.idle == POOL_SIZE + stats.overflows - stats.discards);
+  mtlog_parser_pool_delete(pool);
+}
+
+int main(void) {
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_mtlog());
+  for (size_t i = 0; i < TEMPLATE_COUNT; i++) expected[i] = tree_string(parser, TEMPLATES[i]);
+  ts_parser_delete(parser);
+
+  test_single_thread();
+  test_threads();
+
+  for (size_t i = 0; i < TEMPLATE_COUNT; i++) free(expected[i]);
+  printf("parser_pool: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,299 @@
+// Differential test for the tree-free extractor (src/properties.c): every
+// property the grammar produces outside an ERROR node must be reported by
+// mtlog_scan_properties with the same spans, and nothing else. For inputs
+// without errors, the template IR built from the tree and from the text must
+// also be byte-identical (src/template_ir.h).
+//
+// Inputs are the test/corpus cases, the lines of the test/highlight samples
+// and example files, and a batch of random templates over the characters
+// that matter.
+//
+//   make -C test/api run TREE_SITTER_DIR=~/tree-sitter
+
+#define _POSIX_C_SOURCE 200809L // opendir()
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <tree_sitter/api.h>
+
+#include "properties.h"
+#include "template_ir_tree.h"
+
+const TSLanguage *tree_sitter_mtlog(void);
+
+#define MAX_SEGMENTS 4096
+
+typedef struct {
+  MtlogSegment items[MAX_SEGMENTS];
+  uint32_t count;
+} SegmentList;
+
+static const char *KIND_NAMES[] = {"literal", "property", "go_property", "builtin_property"};
+
+static bool collect(const MtlogSegment *segment, void *context) {
+  SegmentList *list = (SegmentList *)context;
+  if (list->count < MAX_SEGMENTS) list->items[list->count++] = *segment;
+  return true;
+}
+
+static MtlogSpan span_of(TSNode node) {
+  MtlogSpan span = {0, 0};
+  if (!ts_node_is_null(node)) {
+    span.start = ts_node_start_byte(node);
+    span.end = ts_node_end_byte(node);
+  }
+  return span;
+}
+
+// Build the segment the extractor should report for a property node.
+static MtlogSegment expected_segment(TSNode node, const char *text) {
+  MtlogSegment segment = {0};
+  const char *type = ts_node_type(node);
+  segment.kind = strcmp(type, "property") == 0      ? MTLOG_SEGMENT_PROPERTY
+                 : strcmp(type, "go_property") == 0 ? MTLOG_SEGMENT_GO_PROPERTY
+                                                    : MTLOG_SEGMENT_BUILTIN_PROPERTY;
+  segment.span = span_of(node);
+
+  TSNode name = ts_node_child_by_field_name(node, "name", 4);
+  segment.name = span_of(name);
+  if (!ts_node_is_null(name)) {
+    const char *name_type = ts_node_type(name);
+    segment.name_kind = strcmp(name_type, "identifier") == 0    ? MTLOG_NAME_IDENTIFIER
+                        : strcmp(name_type, "dotted_name") == 0 ? MTLOG_NAME_DOTTED
+                                                                : MTLOG_NAME_NUMERIC;
+  }
+
+  TSNode format = ts_node_child_by_field_name(node, "format", 6);
+  if (!ts_node_is_null(format)) {
+    segment.format = span_of(ts_node_child_by_field_name(format, "format_string", 13));
+  }
+
+  TSNode hint = ts_node_child_by_field_name(node, "hint", 4);
+  if (!ts_node_is_null(hint)) segment.hint = text[ts_node_start_byte(hint)];
+  return segment;
+}
+
+// Collect property nodes in document order, skipping anything under ERROR.
+static void collect_expected(TSNode node, const char *text, SegmentList *list) {
+  if (ts_node_is_error(node)) return;
+  const char *type = ts_node_type(node);
+  if (strcmp(type, "property") == 0 || strcmp(type, "go_property") == 0 ||
+      strcmp(type, "builtin_property") == 0) {
+    if (list->count < MAX_SEGMENTS) list->items[list->count++] = expected_segment(node, text);
+    return;
+  }
+  uint32_t count = ts_node_child_count(node);
+  for (uint32_t i = 0; i < count; i++) collect_expected(ts_node_child(node, i), text, list);
+}
+
+static bool same_span(MtlogSpan a, MtlogSpan b, bool absent_ok) {
+  if (absent_ok && a.start == a.end && b.start == b.end) return true;
+  return a.start == b.start && a.end == b.end;
+}
+
+static bool same_segment(const MtlogSegment *a, const MtlogSegment *b) {
+  return a->kind == b->kind && same_span(a->span, b->span, false) &&
+         same_span(a->name, b->name, true) && same_span(a->format, b->format, true) &&
+         a->name_kind == b->name_kind && a->hint == b->hint;
+}
+
+static void print_segment(const char *label, const MtlogSegment *segment, const char *text) {
+  fprintf(stderr, "    %s %s %u-%u \"%.*s\"\n", label, KIND_NAMES[segment->kind], segment->span.start,
+          segment->span.end, (int)(segment->span.end - segment->span.start), text + segment->span.start);
+}
+
+static SegmentList expected, actual;
+
+// Both IR builders must agree byte for byte, and the result must pass its own
+// validation.
+static bool check_ir(TSNode root, const char *label, const char *text, uint32_t length) {
+  MtlogTemplateIR *from_tree = mtlog_ir_from_tree(root, text, length);
+  MtlogTemplateIR *from_text = mtlog_ir_from_text(text, length);
+  bool ok = from_tree && from_text && from_tree->size == from_text->size &&
+            memcmp(from_tree, from_text, from_tree->size) == 0 &&
+            mtlog_ir_check(from_text, from_text->size) == from_text;
+  if (!ok) fprintf(stderr, "IR mismatch in %s: \"%.*s\"\n", label, (int)length, text);
+  mtlog_ir_delete(from_tree);
+  mtlog_ir_delete(from_text);
+  return ok;
+}
+
+// Compare the extractor with the parser on one input. With `error_free`, an
+// input whose tree contains errors is skipped instead of compared.
+static bool check(TSParser *parser, const char *label, const char *text, uint32_t length, bool error_free) {
+  TSTree *tree = ts_parser_parse_string(parser, NULL, text, length);
+  TSNode root = ts_tree_root_node(tree);
+  if (error_free && ts_node_has_error(root)) {
+    ts_tree_delete(tree);
+    return true;
+  }
+
+  expected.count = 0;
+  actual.count = 0;
+  collect_expected(root, text, &expected);
+  mtlog_scan_properties(text, length, collect, &actual);
+  bool ir_ok = ts_node_has_error(root) || check_ir(root, label, text, length);
+  ts_tree_delete(tree);
+
+  bool ok = expected.count == actual.count;
+  for (uint32_t i = 0; ok && i < expected.count; i++) {
+    ok = same_segment(&expected.items[i], &actual.items[i]);
+  }
+  if (!ok) {
+    fprintf(stderr, "mismatch in %s: \"%.*s\"\n", label, (int)length, text);
+    for (uint32_t i = 0; i < expected.count; i++) print_segment("parser ", &expected.items[i], text);
+    for (uint32_t i = 0; i < actual.count; i++) print_segment("scanner", &actual.items[i], text);
+  }
+  return ok && ir_ok;
+}
+
+static char *read_file(const char *path, uint32_t *length) {
+  FILE *file = fopen(path, "rb");
+  if (!file) return NULL;
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  char *data = (char *)malloc((size_t)size + 1);
+  size_t read = fread(data, 1, (size_t)size, file);
+  fclose(file);
+  data[read] = '\0';
+  *length = (uint32_t)read;
+  return data;
+}
+
+// Next line at or after `line` (a line start) that begins with `prefix`.
+static char *find_line(char *line, const char *prefix) {
+  size_t length = strlen(prefix);
+  while (line && strncmp(line, prefix, length) != 0) {
+    line = strchr(line, '\n');
+    if (line) line++;
+  }
+  return line;
+}
+
+static char *next_line(char *line) {
+  char *newline = strchr(line, '\n');
+  return newline ? newline + 1 : NULL;
+}
+
+// Run every case of a corpus file: the input is the text between the closing
+// '===' header line and the '---' divider, without surrounding newlines.
+static int check_corpus(TSParser *parser, const char *path, int *cases) {
+  uint32_t length;
+  char *data = read_file(path, &length);
+  if (!data) return 0;
+
+  int failures = 0;
+  char *line = data;
+  while ((line = find_line(line, "==="))) {
+    char *name = next_line(line);
+    char *close = name ? find_line(name, "===") : NULL;
+    char *input = close ? next_line(close) : NULL;
+    char *divider = input ? find_line(input, "---") : NULL;
+    if (!divider) break;
+
+    char *start = input;
+    char *end = divider;
+    while (start < end && (*start == '\n' || *start == '\r')) start++;
+    while (end > start && (end[-1] == '\n' || end[-1] == '\r')) end--;
+
+    char label[256];
+    int name_length = (int)(close - name);
+    while (name_length > 0 && (name[name_length - 1] == '\n' || name[name_length - 1] == '\r')) name_length--;
+    snprintf(label, sizeof(label), "%s: %.*s", path, name_length, name);
+    if (!check(parser, label, start, (uint32_t)(end - start), false)) failures++;
+    (*cases)++;
+
+    line = next_line(divider);
+  }
+
+  free(data);
+  return failures;
+}
+
+// Check each line of a sample file on its own. Samples exercise error
+// recovery too, so lines that do not parse cleanly are skipped.
+static int check_lines(TSParser *parser, const char *path, int *cases) {
+  uint32_t length;
+  char *data = read_file(path, &length);
+  if (!data) return 0;
+
+  int failures = 0;
+  for (char *line = data; line && *line; line = next_line(line)) {
+    char *end = strchr(line, '\n');
+    if (!end) end = data + length;
+    if (!check(parser, path, line, (uint32_t)(end - line), true)) failures++;
+    (*cases)++;
+  }
+
+  free(data);
+  return failures;
+}
+
+static int check_directory(TSParser *parser, const char *directory, const char *suffix, bool corpus, int *cases) {
+  DIR *dir = opendir(directory);
+  if (!dir) return 0;
+  int failures = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir))) {
+    size_t name_length = strlen(entry->d_name);
+    size_t suffix_length = strlen(suffix);
+    if (name_length < suffix_length || strcmp(entry->d_name + name_length - suffix_length, suffix) != 0) continue;
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+    if (corpus) {
+      failures += check_corpus(parser, path, cases);
+    } else {
+      failures += check_lines(parser, path, cases);
+    }
+  }
+  closedir(dir);
+  return failures;
+}
+
+// Random templates over the characters that drive the grammar. Only inputs
+// that parse without errors are compared: error recovery may salvage
+// properties the extractor deliberately reports as literal text.
+static int check_random(TSParser *parser, int iterations, int *cases) {
+  static const char alphabet[] = "{}{}$$@:..aZ_09 \n\r";
+  uint32_t state = 0x9e3779b9;
+  int failures = 0;
+  char text[48];
+  for (int i = 0; i < iterations; i++) {
+    state = state * 1664525u + 1013904223u;
+    uint32_t length = (state >> 24) % sizeof(text);
+    for (uint32_t j = 0; j < length; j++) {
+      state = state * 1664525u + 1013904223u;
+      text[j] = alphabet[(state >> 16) % (sizeof(alphabet) - 1)];
+    }
+    if (!check(parser, "random", text, length, true)) failures++;
+    (*cases)++;
+  }
+  return failures;
+}
+
+int main(int argc, char **argv) {
+  const char *root = argc > 1 ? argv[1] : "../..";
+  char directory[1024];
+
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_mtlog());
+
+  int cases = 0;
+  int failures = 0;
+  snprintf(directory, sizeof(directory), "%s/test/corpus", root);
+  failures += check_directory(parser, directory, ".txt", true, &cases);
+  snprintf(directory, sizeof(directory), "%s/test/highlight", root);
+  failures += check_directory(parser, directory, ".mtlog", false, &cases);
+  snprintf(directory, sizeof(directory), "%s/examples", root);
+  failures += check_directory(parser, directory, ".mtlog", false, &cases);
+  failures += check_random(parser, 200000, &cases);
+
+  ts_parser_delete(parser);
+  printf("properties: %d inputs, %d mismatches\n", cases, failures);
+  return failures ? 1 : 0;
+}
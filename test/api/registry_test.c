@@ -0,0 +1,322 @@
+// Tests for the shared-memory template registry (src/registry.h): IDs and IRs
+// on one process, reopening after close, running out of room, rejecting
+// files that are not registries, recovering from inserts cut short, then
+// several processes interning the same templates at once and agreeing on
+// every ID.
+//
+//   make -C test/api run
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "registry.h"
+
+#define TEMPLATES 512
+#define PROCESSES 8
+
+static int failures;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+static char directory[] = "/tmp/mtlog-registry-XXXXXX";
+
+static const char *path_for(const char *name) {
+  static char path[128];
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+  return path;
+}
+
+static int32_t intern(MtlogRegistry *registry, const char *text) {
+  return mtlog_registry_intern(registry, text, (uint32_t)strlen(text));
+}
+
+static int32_t find(const MtlogRegistry *registry, const char *text) {
+  return mtlog_registry_find(registry, text, (uint32_t)strlen(text));
+}
+
+static void test_basic(void) {
+  const char *path = path_for("basic");
+  MtlogRegistry *registry = mtlog_registry_open(path, 16, 4096);
+  EXPECT(registry != NULL);
+  if (!registry) return;
+
+  const char *login = "User {UserId} logged in from {IP}";
+  EXPECT(find(registry, login) == -1);
+  EXPECT(intern(registry, login) == 0);
+  EXPECT(intern(registry, "Order {@Order} created") == 1);
+  EXPECT(intern(registry, "") == 2);
+  EXPECT(intern(registry, login) == 0);
+  EXPECT(find(registry, login) == 0);
+  EXPECT(find(registry, "User {UserId} logged in") == -1);
+
+  uint32_t length = 0;
+  const char *text = mtlog_registry_text(registry, 0, &length);
+  EXPECT(text && length == strlen(login) && !memcmp(text, login, length) && text[length] == 0);
+
+  // The stored IR is the one the extractor builds, and passes the checks for
+  // blocks read from shared memory.
+  const MtlogTemplateIR *ir = mtlog_registry_ir(registry, 0);
+  MtlogTemplateIR *expected = mtlog_ir_from_text(login, (uint32_t)strlen(login));
+  EXPECT(ir && mtlog_ir_check(ir, ir->size) == ir);
+  EXPECT(ir && ir->size == expected->size && !memcmp(ir, expected, expected->size));
+  EXPECT(ir && ir->property_count == 2);
+  mtlog_ir_delete(expected);
+
+  EXPECT(mtlog_registry_ir(registry, 3) == NULL);
+  EXPECT(mtlog_registry_text(registry, 3, &length) == NULL && length == 0);
+  EXPECT(mtlog_registry_ir(registry, 1u << 31) == NULL);
+
+  // A caller-supplied IR is stored as given.
+  const char *plain = "Service started";
+  MtlogTemplateIR *plain_ir = mtlog_ir_from_text(plain, (uint32_t)strlen(plain));
+  EXPECT(mtlog_registry_intern_ir(registry, plain, (uint32_t)strlen(plain), plain_ir) == 3);
+  EXPECT(mtlog_registry_ir(registry, 3) && mtlog_registry_ir(registry, 3)->segment_count == 1);
+  mtlog_ir_delete(plain_ir);
+
+  MtlogRegistryStats stats;
+  mtlog_registry_stats(registry, &stats);
+  EXPECT(stats.max_templates == 16 && stats.templates == 4);
+  EXPECT(stats.record_bytes == 4096 && stats.used_bytes > 0 && stats.used_bytes <= 4096);
+  mtlog_registry_close(registry);
+
+  // Reopening, as a restarted worker would, keeps every ID and the original
+  // sizes.
+  registry = mtlog_registry_open(path, 1000, 0);
+  EXPECT(registry != NULL);
+  if (!registry) return;
+  EXPECT(find(registry, login) == 0);
+  EXPECT(find(registry, "") == 2);
+  EXPECT(intern(registry, "Order {@Order} created") == 1);
+  EXPECT(intern(registry, "Order {@Order} shipped") == 4);
+  mtlog_registry_stats(registry, &stats);
+  EXPECT(stats.max_templates == 16 && stats.templates == 5);
+  mtlog_registry_close(registry);
+  unlink(path);
+}
+
+static void test_full(void) {
+  const char *path = path_for("full");
+  MtlogRegistry *registry = mtlog_registry_open(path, 2, 0);
+  EXPECT(registry != NULL);
+  if (!registry) return;
+  EXPECT(intern(registry, "a {A}") == 0);
+  EXPECT(intern(registry, "b {B}") == 1);
+  EXPECT(intern(registry, "c {C}") == -1);
+  EXPECT(intern(registry, "a {A}") == 0);
+  mtlog_registry_close(registry);
+  unlink(path);
+
+  // Record space runs out before the IDs do.
+  registry = mtlog_registry_open(path, 100, 256);
+  EXPECT(registry != NULL);
+  if (!registry) return;
+  EXPECT(intern(registry, "User {UserId} logged in") == 0);
+  int32_t id = 0;
+  char text[64];
+  for (int i = 0; i < 10 && id >= 0; i++) {
+    snprintf(text, sizeof(text), "Template number %d with {Value}", i);
+    id = intern(registry, text);
+  }
+  EXPECT(id == -1);
+  EXPECT(find(registry, "User {UserId} logged in") == 0);
+  mtlog_registry_close(registry);
+  unlink(path);
+}
+
+static void test_invalid(void) {
+  const char *path = path_for("invalid");
+  FILE *file = fopen(path, "wb");
+  char garbage[4096];
+  memset(garbage, 0x5a, sizeof(garbage));
+  fwrite(garbage, 1, sizeof(garbage), file);
+  fclose(file);
+  EXPECT(mtlog_registry_open(path, 0, 0) == NULL);
+  unlink(path);
+
+  file = fopen(path, "wb");
+  fclose(file);
+  EXPECT(mtlog_registry_open(path, 0, 0) == NULL);
+  unlink(path);
+
+  EXPECT(mtlog_registry_open("/nonexistent-directory/registry", 0, 0) == NULL);
+}
+
+// Header fields read from the file directly, to put it in the state a worker
+// killed mid-insert leaves behind.
+#define HEADER_SLOT_COUNT 20
+#define HEADER_IDS_OFFSET 24
+#define HEADER_SLOTS_OFFSET 32
+
+static uint64_t header_field(int fd, off_t at, size_t size) {
+  uint64_t value = 0;
+  EXPECT(pread(fd, &value, size, at) == (ssize_t)size);
+  return value;
+}
+
+static void clear_id(int fd, uint32_t id) {
+  uint32_t zero = 0;
+  off_t at = (off_t)header_field(fd, HEADER_IDS_OFFSET, 8) + (off_t)id * 4;
+  EXPECT(pwrite(fd, &zero, sizeof(zero), at) == (ssize_t)sizeof(zero));
+}
+
+// Empty every slot; with one template in the registry, that is its slot.
+static void clear_slots(int fd) {
+  uint32_t count = (uint32_t)header_field(fd, HEADER_SLOT_COUNT, 4);
+  off_t at = (off_t)header_field(fd, HEADER_SLOTS_OFFSET, 8);
+  uint64_t zero = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    EXPECT(pwrite(fd, &zero, sizeof(zero), at + (off_t)i * 8) == (ssize_t)sizeof(zero));
+  }
+}
+
+static void test_interrupted(void) {
+  const char *path = path_for("interrupted");
+  const char *login = "User {UserId} logged in";
+  uint32_t length = 0;
+
+  // Killed after publishing the slot but before the ID entry: the template is
+  // found under its ID, and finding it makes the ID resolve again.
+  MtlogRegistry *registry = mtlog_registry_open(path, 16, 4096);
+  EXPECT(registry != NULL);
+  if (!registry) return;
+  EXPECT(intern(registry, login) == 0);
+  mtlog_registry_close(registry);
+  int fd = open(path, O_RDWR);
+  EXPECT(fd >= 0);
+  if (fd < 0) return;
+  clear_id(fd, 0);
+  registry = mtlog_registry_open(path, 0, 0);
+  EXPECT(registry != NULL);
+  if (!registry) return;
+  EXPECT(mtlog_registry_text(registry, 0, &length) == NULL);
+  EXPECT(find(registry, login) == 0);
+  const char *text = mtlog_registry_text(registry, 0, &length);
+  EXPECT(text && length == strlen(login) && !memcmp(text, login, length));
+  EXPECT(mtlog_registry_ir(registry, 0) != NULL);
+  clear_id(fd, 0);
+  EXPECT(intern(registry, login) == 0);
+  EXPECT(mtlog_registry_text(registry, 0, &length) != NULL);
+  mtlog_registry_close(registry);
+
+  // Killed after writing the record but before publishing the slot: the ID is
+  // lost, and interning the template again gives it a new one.
+  clear_slots(fd);
+  clear_id(fd, 0);
+  registry = mtlog_registry_open(path, 0, 0);
+  EXPECT(registry != NULL);
+  if (!registry) return;
+  EXPECT(find(registry, login) == -1);
+  EXPECT(mtlog_registry_text(registry, 0, &length) == NULL);
+  EXPECT(intern(registry, login) == 1);
+  EXPECT(find(registry, login) == 1);
+  EXPECT(mtlog_registry_text(registry, 1, &length) != NULL && length == strlen(login));
+  EXPECT(mtlog_registry_text(registry, 0, &length) == NULL);
+  mtlog_registry_close(registry);
+  close(fd);
+  unlink(path);
+}
+
+// Every child opens the registry itself (the first one creates it), interns
+// all templates in its own order, and reports the IDs it got.
+static void run_child(const char *path, const char (*texts)[64], int process, int out) {
+  MtlogRegistry *registry = mtlog_registry_open(path, 4 * TEMPLATES, 0);
+  int32_t ids[TEMPLATES];
+  for (int i = 0; i < TEMPLATES; i++) ids[i] = -2;
+  if (registry) {
+    for (int n = 0; n < TEMPLATES; n++) {
+      int i = (n * (2 * process + 1) + process * 37) % TEMPLATES;
+      ids[i] = mtlog_registry_intern(registry, texts[i], (uint32_t)strlen(texts[i]));
+    }
+    for (int i = 0; i < TEMPLATES; i++) {
+      if (mtlog_registry_find(registry, texts[i], (uint32_t)strlen(texts[i])) != ids[i]) ids[i] = -3;
+    }
+    mtlog_registry_close(registry);
+  }
+  ssize_t written = write(out, ids, sizeof(ids));
+  _exit(written == (ssize_t)sizeof(ids) ? 0 : 1);
+}
+
+static void test_processes(void) {
+  const char *path = path_for("shared");
+  static char texts[TEMPLATES][64];
+  for (int i = 0; i < TEMPLATES; i++) snprintf(texts[i], sizeof(texts[i]), "Event %d for {UserId} took {Elapsed}", i);
+
+  int pipes[PROCESSES][2];
+  pid_t children[PROCESSES];
+  for (int p = 0; p < PROCESSES; p++) {
+    if (pipe(pipes[p]) != 0) return;
+    children[p] = fork();
+    if (children[p] == 0) {
+      close(pipes[p][0]);
+      run_child(path, (const char (*)[64])texts, p, pipes[p][1]);
+    }
+    close(pipes[p][1]);
+  }
+
+  static int32_t ids[PROCESSES][TEMPLATES];
+  for (int p = 0; p < PROCESSES; p++) {
+    size_t got = 0;
+    while (got < sizeof(ids[p])) {
+      ssize_t n = read(pipes[p][0], (char *)ids[p] + got, sizeof(ids[p]) - got);
+      if (n <= 0) break;
+      got += (size_t)n;
+    }
+    close(pipes[p][0]);
+    int status = 0;
+    waitpid(children[p], &status, 0);
+    EXPECT(got == sizeof(ids[p]) && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+
+  // All processes agree, and each ID leads back to its template.
+  MtlogRegistry *registry = mtlog_registry_open(path, 0, 0);
+  EXPECT(registry != NULL);
+  if (!registry) return;
+  static bool seen[4 * TEMPLATES];
+  int mismatches = 0;
+  for (int i = 0; i < TEMPLATES; i++) {
+    int32_t id = ids[0][i];
+    for (int p = 1; p < PROCESSES; p++) mismatches += ids[p][i] != id;
+    if (id < 0 || id >= 4 * TEMPLATES || seen[id]) {
+      mismatches++;
+      continue;
+    }
+    seen[id] = true;
+    uint32_t length = 0;
+    const char *text = mtlog_registry_text(registry, (uint32_t)id, &length);
+    mismatches += !text || length != strlen(texts[i]) || memcmp(text, texts[i], length) != 0;
+  }
+  EXPECT(mismatches == 0);
+  MtlogRegistryStats stats;
+  mtlog_registry_stats(registry, &stats);
+  EXPECT(stats.templates >= TEMPLATES);
+  mtlog_registry_close(registry);
+  unlink(path);
+}
+
+int main(void) {
+  if (!mkdtemp(directory)) {
+    perror("mkdtemp");
+    return 1;
+  }
+  test_basic();
+  test_full();
+  test_invalid();
+  test_interrupted();
+  test_processes();
+  rmdir(directory);
+  printf("registry: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,216 @@
+// Tests for the template renderer (src/render.h): slots, scalar output, hint
+// and format hooks, fallbacks for missing values, and buffer growth.
+//
+//   make -C test/api run
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "render.h"
+
+static int failures;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+#define EXPECT_OUTPUT(out, expected)                                                          \
+  do {                                                                                        \
+    if ((out).length != strlen(expected) || memcmp((out).data, expected, (out).length)) {     \
+      fprintf(stderr, "%s:%d: rendered \"%.*s\", expected \"%s\"\n", __FILE__, __LINE__,      \
+              (int)(out).length, (out).data, expected);                                       \
+      failures++;                                                                             \
+    }                                                                                         \
+  } while (0)
+
+static MtlogRenderProgram *compile(const char *text) {
+  return mtlog_render_compile_text(text, (uint32_t)strlen(text));
+}
+
+static MtlogValue string_value(const char *text) {
+  MtlogValue value = {MTLOG_VALUE_STRING, (uint32_t)strlen(text), {.string = text}};
+  return value;
+}
+
+static bool tagged(MtlogRenderBuffer *out, const char *tag, const MtlogValue *value, const char *format,
+                   uint32_t format_length) {
+  if (!mtlog_render_append(out, tag, strlen(tag))) return false;
+  if (value->kind == MTLOG_VALUE_STRING && !mtlog_render_append(out, value->as.string, value->length)) return false;
+  if (format_length && (!mtlog_render_append(out, "|", 1) || !mtlog_render_append(out, format, format_length))) {
+    return false;
+  }
+  return mtlog_render_append(out, ">", 1);
+}
+
+static bool destructure(MtlogRenderBuffer *out, const MtlogValue *value, const char *format, uint32_t format_length,
+                        void *context) {
+  (void)context;
+  return tagged(out, "<d:", value, format, format_length);
+}
+
+static bool stringify(MtlogRenderBuffer *out, const MtlogValue *value, const char *format, uint32_t format_length,
+                      void *context) {
+  (void)context;
+  return tagged(out, "<s:", value, format, format_length);
+}
+
+static bool format(MtlogRenderBuffer *out, const MtlogValue *value, const char *format, uint32_t format_length,
+                   void *context) {
+  ++*(int *)context;
+  return tagged(out, "<f:", value, format, format_length);
+}
+
+static bool grow(MtlogRenderBuffer *buffer, size_t capacity) {
+  size_t next = buffer->capacity ? buffer->capacity : 1;
+  while (next < capacity) next *= 2;
+  char *data = (char *)realloc(buffer->data, next);
+  if (!data) return false;
+  ++*(int *)buffer->context;
+  buffer->data = data;
+  buffer->capacity = next;
+  return true;
+}
+
+static void test_slots(void) {
+  MtlogRenderProgram *program = compile("{A} {B} {A} ${A} {{.B}} {@A:x} {0}");
+  EXPECT(mtlog_render_slot_count(program) == 4);
+  MtlogRenderSlot slot = mtlog_render_slot(program, 2);
+  EXPECT(slot.builtin && slot.length == 1 && slot.name[0] == 'A');
+  slot = mtlog_render_slot(program, 3);
+  EXPECT(!slot.builtin && slot.length == 1 && slot.name[0] == '0');
+  EXPECT(mtlog_render_op_count(program) == 13);
+  mtlog_render_delete(program);
+}
+
+static void test_scalars(void) {
+  MtlogRenderProgram *program = compile("{A}|{B}|{C}|{D}|{E}|{F}|{G}|{H}|{I}");
+  MtlogValue values[9] = {
+    {MTLOG_VALUE_NULL, 0, {0}},
+    {MTLOG_VALUE_BOOL, 0, {.boolean = true}},
+    {MTLOG_VALUE_INT, 0, {.integer = INT64_MIN}},
+    {MTLOG_VALUE_UINT, 0, {.uinteger = UINT64_MAX}},
+    {MTLOG_VALUE_DOUBLE, 0, {.number = 0.1}},
+    {MTLOG_VALUE_DOUBLE, 0, {.number = 1.0 / 3.0}},
+    {MTLOG_VALUE_DOUBLE, 0, {.number = -HUGE_VAL}},
+    string_value("text"),
+    {MTLOG_VALUE_MISSING, 0, {0}},
+  };
+  char storage[256];
+  MtlogRenderBuffer out = {storage, 0, sizeof(storage), NULL, NULL};
+  EXPECT(mtlog_render(program, values, NULL, &out));
+  EXPECT_OUTPUT(out, "null|true|-9223372036854775808|18446744073709551615|0.1|0.33333333333333331|-Inf|text|{I}");
+  mtlog_render_delete(program);
+}
+
+static void test_hooks(void) {
+  MtlogRenderProgram *program = compile("User {@User} said {$Text} at {Time:HH:mm} in {Place} ({Opaque}) {{.Go}}");
+  int formatted = 0;
+  MtlogRenderHooks hooks = {destructure, stringify, format, &formatted};
+  MtlogValue values[6] = {
+    string_value("u"), string_value("t"), string_value("12"), string_value("p"),
+    {MTLOG_VALUE_OPAQUE, 0, {.opaque = &formatted}}, string_value("g"),
+  };
+  char storage[256];
+  MtlogRenderBuffer out = {storage, 0, sizeof(storage), NULL, NULL};
+  EXPECT(mtlog_render(program, values, &hooks, &out));
+  EXPECT_OUTPUT(out, "User <d:u> said <s:t> at <f:12|HH:mm> in p (<s:>) g");
+  EXPECT(formatted == 1);
+
+  // Without hooks, hints are ignored and opaque values keep the source text.
+  out.length = 0;
+  EXPECT(mtlog_render(program, values, NULL, &out));
+  EXPECT_OUTPUT(out, "User u said t at 12 in p ({Opaque}) g");
+  mtlog_render_delete(program);
+}
+
+static void test_formats(void) {
+  MtlogRenderProgram *program =
+      compile("{Amount:F2} {Id:X4} {At:yyyy-MM-dd HH:mm} ${Level:u3} [{Ip:15}] [{Name:-6}] {Amount:N0} {Note:F2}");
+  MtlogValue values[7] = {
+    {MTLOG_VALUE_DOUBLE, 0, {.number = 1234.567}},
+    {MTLOG_VALUE_INT, 0, {.integer = 255}},
+    {MTLOG_VALUE_TIME, 0, {.integer = 1718454245123456789LL}},
+    string_value("Warning"),
+    string_value("10.0.0.1"),
+    string_value("bob"),
+    string_value("n/a"),
+  };
+  char storage[256];
+  MtlogRenderBuffer out = {storage, 0, sizeof(storage), NULL, NULL};
+  EXPECT(mtlog_render(program, values, NULL, &out));
+  EXPECT_OUTPUT(out, "1234.57 00FF 2024-06-15 12:24 WRN [       10.0.0.1] [bob   ] 1,235 n/a");
+
+  // A format that does not fit the value goes to the format hook.
+  int formatted = 0;
+  MtlogRenderHooks hooks = {NULL, NULL, format, &formatted};
+  out.length = 0;
+  EXPECT(mtlog_render(program, values, &hooks, &out));
+  EXPECT_OUTPUT(out, "1234.57 00FF 2024-06-15 12:24 WRN [       10.0.0.1] [bob   ] 1,235 <f:n/a|F2>");
+  EXPECT(formatted == 1);
+
+  // Padding applies to hook output too, and can grow the buffer.
+  MtlogRenderProgram *padded = compile("[{@V:-40}]");
+  hooks.destructure = destructure;
+  int grows = 0;
+  MtlogRenderBuffer grown = {NULL, 0, 0, grow, &grows};
+  EXPECT(mtlog_render(padded, values, &hooks, &grown));
+  EXPECT_OUTPUT(grown, "[<d:|-40>                                ]");
+  free(grown.data);
+  mtlog_render_delete(padded);
+  mtlog_render_delete(program);
+}
+
+static void test_literals(void) {
+  // Text the grammar treats as literal is copied verbatim.
+  MtlogRenderProgram *program = compile("a { b } {{ c }} {Id:} $ x\n{Id}");
+  MtlogValue value = string_value("42");
+  char storage[64];
+  MtlogRenderBuffer out = {storage, 0, sizeof(storage), NULL, NULL};
+  EXPECT(mtlog_render(program, &value, NULL, &out));
+  EXPECT_OUTPUT(out, "a { b } {{ c }} {Id:} $ x\n42");
+  EXPECT(mtlog_render_op_count(program) == 2);
+  mtlog_render_delete(program);
+
+  program = compile("");
+  out.length = 0;
+  EXPECT(mtlog_render(program, NULL, NULL, &out) && out.length == 0);
+  mtlog_render_delete(program);
+}
+
+static void test_buffer(void) {
+  MtlogRenderProgram *program = compile("value={V} and some literal text");
+  MtlogValue value = string_value("abcdefghijklmnopqrstuvwxyz");
+
+  char small[8];
+  MtlogRenderBuffer fixed = {small, 0, sizeof(small), NULL, NULL};
+  EXPECT(!mtlog_render(program, &value, NULL, &fixed));
+  EXPECT(fixed.length <= sizeof(small));
+
+  int grows = 0;
+  MtlogRenderBuffer out = {NULL, 0, 0, grow, &grows};
+  for (int i = 0; i < 100; i++) {
+    out.length = 0;
+    EXPECT(mtlog_render(program, &value, NULL, &out));
+  }
+  EXPECT_OUTPUT(out, "value=abcdefghijklmnopqrstuvwxyz and some literal text");
+  EXPECT(grows > 0 && grows <= 7); // only while the first event grows it
+  free(out.data);
+  mtlog_render_delete(program);
+}
+
+int main(void) {
+  test_slots();
+  test_scalars();
+  test_hooks();
+  test_formats();
+  test_literals();
+  test_buffer();
+  printf("render: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
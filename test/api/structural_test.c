@@ -0,0 +1,113 @@
+// Checks every structural index kernel the CPU supports against a byte-wise
+// reference on random buffers, including lengths that end mid-block. The
+// kernel is first resolved by several threads at once, which must all index
+// correctly (run under -fsanitize=thread to check the publication too).
+//
+//   make -C test/api run
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "structural.h"
+
+#define MAX_LENGTH 4096
+
+static void reference_index(const unsigned char *data, uint32_t length, MtlogStructuralBlock *blocks) {
+  memset(blocks, 0, mtlog_structural_block_count(length) * sizeof(MtlogStructuralBlock));
+  for (uint32_t i = 0; i < length; i++) {
+    MtlogStructuralBlock *block = &blocks[i / MTLOG_STRUCTURAL_BLOCK];
+    uint64_t bit = (uint64_t)1 << (i % MTLOG_STRUCTURAL_BLOCK);
+    switch (data[i]) {
+      case '{': block->open_brace |= bit; break;
+      case '}': block->close_brace |= bit; break;
+      case '$': block->dollar |= bit; break;
+      case ':': block->colon |= bit; break;
+      case '@': block->at |= bit; break;
+      case '\0':
+      case '\n':
+      case '\r': block->line_end |= bit; break;
+    }
+  }
+}
+
+static bool same_block(const MtlogStructuralBlock *a, const MtlogStructuralBlock *b) {
+  return a->open_brace == b->open_brace && a->close_brace == b->close_brace && a->dollar == b->dollar &&
+         a->colon == b->colon && a->at == b->at && a->line_end == b->line_end;
+}
+
+#define FIRST_USE_THREADS 8
+
+typedef struct {
+  pthread_t thread;
+  unsigned char data[1000];
+  bool ok;
+} FirstUse;
+
+static void *first_use(void *argument) {
+  FirstUse *use = (FirstUse *)argument;
+  MtlogStructuralBlock expected[16], actual[16];
+  reference_index(use->data, sizeof(use->data), expected);
+  mtlog_structural_index((const char *)use->data, sizeof(use->data), actual);
+  use->ok = true;
+  for (uint32_t b = 0; b < mtlog_structural_block_count(sizeof(use->data)); b++) {
+    use->ok = use->ok && same_block(&expected[b], &actual[b]);
+  }
+  return NULL;
+}
+
+// Concurrent first calls, before anything has resolved the kernel.
+static int check_first_use(void) {
+  static FirstUse uses[FIRST_USE_THREADS];
+  for (int t = 0; t < FIRST_USE_THREADS; t++) {
+    for (size_t i = 0; i < sizeof(uses[t].data); i++) uses[t].data[i] = "{a}$:@\n "[(i * 7 + (size_t)t) % 8];
+    pthread_create(&uses[t].thread, NULL, first_use, &uses[t]);
+  }
+  int failures = 0;
+  for (int t = 0; t < FIRST_USE_THREADS; t++) {
+    pthread_join(uses[t].thread, NULL);
+    if (!uses[t].ok) failures++;
+  }
+  if (failures) fprintf(stderr, "first use: %d threads indexed wrongly\n", failures);
+  return failures;
+}
+
+int main(void) {
+  static const MtlogStructuralKernel KERNELS[] = {MTLOG_KERNEL_SCALAR, MTLOG_KERNEL_SSE2, MTLOG_KERNEL_AVX2};
+  static const char alphabet[] = "{}$:@\n\r\0a \x80\xff";
+  static unsigned char data[MAX_LENGTH];
+  static MtlogStructuralBlock expected[MAX_LENGTH / MTLOG_STRUCTURAL_BLOCK], actual[MAX_LENGTH / MTLOG_STRUCTURAL_BLOCK];
+
+  uint32_t state = 12345;
+  int failures = check_first_use();
+  int kernels = 0;
+  for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); k++) {
+    if (!mtlog_structural_use_kernel(KERNELS[k])) continue;
+    kernels++;
+    for (int i = 0; i < 2000; i++) {
+      state = state * 1664525u + 1013904223u;
+      uint32_t length = (state >> 8) % (MAX_LENGTH + 1);
+      for (uint32_t j = 0; j < length; j++) {
+        state = state * 1664525u + 1013904223u;
+        data[j] = (unsigned char)alphabet[(state >> 16) % (sizeof(alphabet) - 1)];
+      }
+
+      reference_index(data, length, expected);
+      mtlog_structural_index((const char *)data, length, actual);
+      for (uint32_t b = 0; b < mtlog_structural_block_count(length); b++) {
+        if (!same_block(&expected[b], &actual[b])) {
+          fprintf(stderr, "%s: mismatch in block %u of a %u-byte buffer\n",
+                  mtlog_structural_kernel_name(KERNELS[k]), b, length);
+          failures++;
+          break;
+        }
+      }
+    }
+  }
+  mtlog_structural_use_kernel(MTLOG_KERNEL_AUTO);
+
+  printf("structural: %d kernels, %d mismatches (detected %s)\n", kernels, failures,
+         mtlog_structural_kernel_name(mtlog_structural_kernel()));
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+// Tests for property-name interning (src/symbols.h): dense symbols, dotted
+// segments, interning during extraction and from an IR, and growth past the
+// initial table.
+//
+//   make -C test/api run
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symbols.h"
+
+static int failures;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+static uint32_t intern(MtlogSymbols *symbols, const char *name) {
+  return mtlog_symbols_intern(symbols, name, (uint32_t)strlen(name));
+}
+
+static uint32_t find(const MtlogSymbols *symbols, const char *name) {
+  return mtlog_symbols_find(symbols, name, (uint32_t)strlen(name));
+}
+
+static bool named(const MtlogSymbols *symbols, uint32_t id, const char *expected) {
+  uint32_t length;
+  const char *name = mtlog_symbols_name(symbols, id, &length);
+  return name && length == strlen(expected) && !memcmp(name, expected, length) && name[length] == 0;
+}
+
+static void test_basic(void) {
+  MtlogSymbols *symbols = mtlog_symbols_new();
+  EXPECT(find(symbols, "UserId") == MTLOG_SYMBOL_NONE);
+  EXPECT(intern(symbols, "UserId") == 0);
+  EXPECT(intern(symbols, "0") == 1);
+  EXPECT(intern(symbols, "UserId") == 0);
+  EXPECT(find(symbols, "UserId") == 0);
+  EXPECT(find(symbols, "userid") == MTLOG_SYMBOL_NONE);
+  EXPECT(mtlog_symbols_count(symbols) == 2);
+  EXPECT(named(symbols, 0, "UserId") && named(symbols, 1, "0"));
+
+  uint32_t count, length;
+  const uint32_t *segments = mtlog_symbols_segments(symbols, 0, &count);
+  EXPECT(count == 1 && segments[0] == 0);
+  EXPECT(mtlog_symbols_name(symbols, 2, &length) == NULL && length == 0);
+  EXPECT(mtlog_symbols_segments(symbols, 2, &count) == NULL && count == 0);
+  mtlog_symbols_delete(symbols);
+}
+
+static void test_dotted(void) {
+  MtlogSymbols *symbols = mtlog_symbols_new();
+  uint32_t method = intern(symbols, "http.method");
+  uint32_t http = find(symbols, "http");
+  uint32_t method_segment = find(symbols, "method");
+  // Segments are interned first.
+  EXPECT(http == 0 && method_segment == 1 && method == 2);
+
+  uint32_t count;
+  const uint32_t *segments = mtlog_symbols_segments(symbols, method, &count);
+  EXPECT(count == 2 && segments[0] == http && segments[1] == method_segment);
+
+  uint32_t status = intern(symbols, "http.response.status_code");
+  segments = mtlog_symbols_segments(symbols, status, &count);
+  EXPECT(count == 3 && segments[0] == http && named(symbols, segments[1], "response") &&
+         named(symbols, segments[2], "status_code"));
+
+  // A segment and a property of the same name are one symbol.
+  EXPECT(intern(symbols, "http") == http);
+  EXPECT(named(symbols, status, "http.response.status_code"));
+
+  // Empty segments are names too.
+  uint32_t odd = intern(symbols, "a..b");
+  segments = mtlog_symbols_segments(symbols, odd, &count);
+  EXPECT(count == 3 && named(symbols, segments[1], ""));
+
+  // More segments than fit on the stack.
+  char deep[128] = "s";
+  for (int i = 0; i < 20; i++) strcat(deep, ".s");
+  uint32_t id = intern(symbols, deep);
+  segments = mtlog_symbols_segments(symbols, id, &count);
+  EXPECT(count == 21 && segments[0] == find(symbols, "s") && segments[20] == segments[0]);
+  mtlog_symbols_delete(symbols);
+}
+
+static void test_properties(void) {
+  MtlogSymbols *symbols = mtlog_symbols_new();
+  const char *text = "{http.method} {Path} by {UserId}, {{.UserId}} ${Level:u3} {0} {UserId}";
+  uint32_t ids[8];
+  uint32_t n = mtlog_symbols_intern_properties(symbols, text, (uint32_t)strlen(text), ids, 8);
+  EXPECT(n == 7);
+  EXPECT(named(symbols, ids[0], "http.method") && named(symbols, ids[1], "Path"));
+  EXPECT(ids[2] == ids[3] && ids[2] == ids[6] && named(symbols, ids[2], "UserId"));
+  EXPECT(named(symbols, ids[4], "Level") && named(symbols, ids[5], "0"));
+
+  // Only `capacity` symbols are written, but every name is interned.
+  uint32_t few[2] = {99, 99};
+  const char *other = "{A} {B} {C}";
+  EXPECT(mtlog_symbols_intern_properties(symbols, other, (uint32_t)strlen(other), few, 1) == 3);
+  EXPECT(named(symbols, few[0], "A") && few[1] == 99);
+  EXPECT(find(symbols, "C") != MTLOG_SYMBOL_NONE);
+
+  // The IR gives the same symbols.
+  MtlogTemplateIR *ir = mtlog_ir_from_text(text, (uint32_t)strlen(text));
+  uint32_t from_ir[8];
+  EXPECT(mtlog_symbols_intern_ir(symbols, ir, text, from_ir, 8) == 7);
+  EXPECT(!memcmp(ids, from_ir, sizeof(uint32_t) * 7));
+  mtlog_ir_delete(ir);
+  mtlog_symbols_delete(symbols);
+}
+
+static void test_growth(void) {
+  MtlogSymbols *symbols = mtlog_symbols_new();
+  char name[32];
+  for (uint32_t i = 0; i < 100000; i++) {
+    snprintf(name, sizeof(name), "Property%u", i);
+    if (intern(symbols, name) != i) {
+      failures++;
+      break;
+    }
+  }
+  EXPECT(mtlog_symbols_count(symbols) == 100000);
+  for (uint32_t i = 0; i < 100000; i += 997) {
+    snprintf(name, sizeof(name), "Property%u", i);
+    EXPECT(find(symbols, name) == i && named(symbols, i, name));
+  }
+  EXPECT(mtlog_symbols_memory(symbols) > 100000 * 16);
+  mtlog_symbols_delete(symbols);
+}
+
+int main(void) {
+  test_basic();
+  test_dotted();
+  test_properties();
+  test_growth();
+  printf("symbols: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+// Tests for the compiled-template cache (src/template_cache.h): counters and
+// LRU eviction on one thread, then consistency under concurrent acquire,
+// eviction and release. Build with -fsanitize=thread to check for races.
+//
+//   make -C test/api run
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "template_cache.h"
+
+#define TEMPLATES 500
+#define THREADS 8
+
+static int failures;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+static char texts[TEMPLATES][64];
+static MtlogTemplateCache *shared_cache;
+static int thread_failures;
+
+static const MtlogCompiledTemplate *acquire(MtlogTemplateCache *cache, const char *text) {
+  return mtlog_template_cache_acquire(cache, text, (uint32_t)strlen(text));
+}
+
+static void test_single_thread(void) {
+  // One shard of two entries, so eviction order is fully determined.
+  MtlogTemplateCache *cache = mtlog_template_cache_new(2, 1);
+  MtlogTemplateCacheStats stats;
+
+  const MtlogCompiledTemplate *a = acquire(cache, "User {UserId} from {IP:15}");
+  EXPECT(a && a->property_count == 2);
+  EXPECT(strncmp(a->text + a->properties[1].format.start, "15", 2) == 0);
+  EXPECT(a->formats[0].kind == MTLOG_FORMAT_NONE);
+  EXPECT(a->formats[1].kind == MTLOG_FORMAT_PADDING && a->formats[1].width == 15);
+  const MtlogCompiledTemplate *again = acquire(cache, "User {UserId} from {IP:15}");
+  EXPECT(again == a);
+  mtlog_template_cache_release(again);
+
+  mtlog_template_cache_release(acquire(cache, "B {b}"));
+  mtlog_template_cache_release(acquire(cache, "User {UserId} from {IP:15}")); // B is now least recent
+  mtlog_template_cache_release(acquire(cache, "C {c}"));                      // evicts B
+
+  mtlog_template_cache_stats(cache, &stats);
+  EXPECT(stats.hits == 2 && stats.misses == 3 && stats.evictions == 1 && stats.entries == 2);
+
+  mtlog_template_cache_release(acquire(cache, "B {b}")); // miss, evicts the template still held
+  mtlog_template_cache_stats(cache, &stats);
+  EXPECT(stats.misses == 4 && stats.evictions == 2);
+  EXPECT(strcmp(a->text, "User {UserId} from {IP:15}") == 0); // held reference survives eviction
+  mtlog_template_cache_release(a);
+
+  const MtlogCompiledTemplate *kept = acquire(cache, "D {@d}");
+  mtlog_template_cache_delete(cache);
+  EXPECT(kept->property_count == 1 && kept->properties[0].hint == '@'); // survives the cache
+  mtlog_template_cache_release(kept);
+}
+
+static void *run_thread(void *argument) {
+  uint32_t state = (uint32_t)(size_t)argument;
+  for (int i = 0; i < 100000; i++) {
+    state = state * 1664525u + 1013904223u;
+    int k = (int)((state >> 8) % TEMPLATES);
+    const MtlogCompiledTemplate *t = acquire(shared_cache, texts[k]);
+    if (!t || strcmp(t->text, texts[k]) != 0 || t->property_count != (uint32_t)(k % 4)) {
+      __atomic_add_fetch(&thread_failures, 1, __ATOMIC_RELAXED);
+    }
+    mtlog_template_cache_release(t);
+  }
+  return NULL;
+}
+
+static void test_concurrent(void) {
+  for (int k = 0; k < TEMPLATES; k++) {
+    int length = snprintf(texts[k], sizeof(texts[k]), "template %d", k);
+    for (int p = 0; p < k % 4; p++) length += snprintf(texts[k] + length, sizeof(texts[k]) - (size_t)length, " {P%d}", p);
+  }
+
+  // Smaller than the working set, so threads constantly evict each other's
+  // templates while holding references.
+  shared_cache = mtlog_template_cache_new(128, 8);
+  pthread_t threads[THREADS];
+  for (int i = 0; i < THREADS; i++) pthread_create(&threads[i], NULL, run_thread, (void *)(size_t)(i + 1));
+  for (int i = 0; i < THREADS; i++) pthread_join(threads[i], NULL);
+
+  MtlogTemplateCacheStats stats;
+  mtlog_template_cache_stats(shared_cache, &stats);
+  EXPECT(thread_failures == 0);
+  EXPECT(stats.hits + stats.misses == (uint64_t)THREADS * 100000);
+  EXPECT(stats.entries <= 128 && stats.evictions > 0);
+  mtlog_template_cache_delete(shared_cache);
+}
+
+int main(void) {
+  test_single_thread();
+  test_concurrent();
+  printf("template_cache: %d failures\n", failures);
+  return failures ? 1 : 0;
+}
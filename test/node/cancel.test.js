@@ -0,0 +1,73 @@
+// Cancelling background extraction, and catalogs whose ArrayBuffer is taken
+// away while the worker reads it.
+//
+//   npm run test:node
+
+const test = require('node:test');
+const assert = require('node:assert');
+const v8 = require('v8');
+const vm = require('vm');
+const Mtlog = require('../..');
+
+// A catalog long enough that the worker is still going when the test acts.
+function bigCatalog(lines = 200000) {
+  const text = Array.from({ length: 64 }, (_, i) => `User {UserId} item ${i} {{.Name}} \${Level:u3}\n`).join('');
+  const buffer = Buffer.alloc(text.length * Math.ceil(lines / 64));
+  for (let at = 0; at < buffer.length; at += text.length) buffer.write(text, at, 'latin1');
+  return buffer;
+}
+
+test('an already aborted signal rejects without starting', async () => {
+  const controller = new AbortController();
+  controller.abort();
+  await assert.rejects(Mtlog.extractAsync('User {Id}', { signal: controller.signal }), { name: 'AbortError' });
+  await assert.rejects(Mtlog.parseManyAsync(['User {Id}'], { signal: controller.signal }), { name: 'AbortError' });
+});
+
+test('aborting mid-batch rejects with the signal reason', async () => {
+  const controller = new AbortController();
+  const pending = Mtlog.extractAsync(bigCatalog(), { signal: controller.signal });
+  controller.abort();
+  await assert.rejects(pending, { name: 'AbortError' });
+
+  const reason = new Error('shutting down');
+  const other = new AbortController();
+  const batch = Array.from({ length: 100000 }, (_, i) => `Item ${i} {Id}`);
+  const many = Mtlog.parseManyAsync(batch, { signal: other.signal });
+  setImmediate(() => other.abort(reason));
+  await assert.rejects(many, (error) => error === reason);
+});
+
+test('cancel() stops the worker before its next template', async () => {
+  const error = await new Promise((resolve) => {
+    const task = Mtlog.startExtract(bigCatalog(), {}, (e) => resolve(e));
+    task.cancel();
+  });
+  assert.ok(error instanceof Error);
+  assert.strictEqual(error.message, 'cancelled');
+});
+
+test('aborting after completion changes nothing', async () => {
+  const controller = new AbortController();
+  const result = await Mtlog.extractAsync('User {Id}\nOrder {N}\n', { signal: controller.signal });
+  controller.abort();
+  assert.deepStrictEqual([...result.templates], [0, 9, 10, 19]);
+});
+
+test('a catalog whose ArrayBuffer is transferred mid-extraction is still read whole', async () => {
+  v8.setFlagsFromString('--expose-gc');
+  const gc = vm.runInNewContext('gc');
+  const expected = await Mtlog.extractAsync(bigCatalog(50000));
+
+  const catalog = bigCatalog(50000);
+  const pending = Mtlog.extractAsync(catalog);
+  // Detach the Buffer's ArrayBuffer and drop the new owner, then churn the
+  // heap so freed memory would be reused.
+  structuredClone(catalog.buffer, { transfer: [catalog.buffer] });
+  assert.strictEqual(catalog.length, 0);
+  gc();
+  for (let i = 0; i < 8; i++) Buffer.alloc(expected.templates.length * 8, '}');
+  gc();
+
+  assert.deepStrictEqual(await pending, expected);
+});
@@ -0,0 +1,64 @@
+// {encoding: 'utf16'}: offsets are code units, so they index the JS strings
+// directly, on Latin-1, CJK and astral text alike.
+//
+//   npm run test:node
+
+const test = require('node:test');
+const assert = require('node:assert');
+const Mtlog = require('../..');
+
+const TEMPLATES = [
+  'Café {User} à {Count:N0}',
+  '日本語 {User} から {{.Name}} へ ${Level:u3}',
+  '😀 {@Order} 🚀 {$Error}',
+  `${'語'.repeat(5000)} {Late} ${'é'.repeat(10)}`,
+];
+
+// The text of each non-literal segment of template i.
+function properties(result, templates) {
+  const found = [];
+  for (let i = 0; i < templates.length; i++) {
+    for (let s = result.offsets[i]; s < result.offsets[i + 1]; s++) {
+      if (result.kinds[s] === Mtlog.SEGMENT.LITERAL) continue;
+      found.push(templates[i].slice(result.spans[2 * s], result.spans[2 * s + 1]));
+    }
+  }
+  return found;
+}
+
+const EXPECTED = ['{User}', '{Count:N0}', '{User}', '{{.Name}}', '${Level:u3}', '{@Order}', '{$Error}', '{Late}'];
+
+test('parseMany reports code-unit offsets', () => {
+  const result = Mtlog.parseMany(TEMPLATES, { encoding: 'utf16' });
+  assert.deepStrictEqual(properties(result, TEMPLATES), EXPECTED);
+  const last = TEMPLATES.length - 1;
+  const end = result.spans[2 * (result.offsets[last + 1] - 1) + 1];
+  assert.strictEqual(end, TEMPLATES[last].length);
+});
+
+test('names are code-unit offsets too', () => {
+  const result = Mtlog.parseMany(['日本 {User.Id}'], { encoding: 'utf16' });
+  const s = [...result.kinds].indexOf(Mtlog.SEGMENT.PROPERTY);
+  assert.strictEqual('日本 {User.Id}'.slice(result.names[2 * s], result.names[2 * s + 1]), 'User.Id');
+});
+
+test('parseManyAsync matches parseMany', async () => {
+  const result = await Mtlog.parseManyAsync(TEMPLATES, { encoding: 'utf16' });
+  assert.deepStrictEqual(result, Mtlog.parseMany(TEMPLATES, { encoding: 'utf16' }));
+});
+
+test('extractAsync of a string catalog indexes the catalog', async () => {
+  const catalog = TEMPLATES.join('\n');
+  const result = await Mtlog.extractAsync(catalog, { encoding: 'utf16' });
+  const found = [];
+  for (let s = 0; s < result.kinds.length; s++) {
+    if (result.kinds[s] !== Mtlog.SEGMENT.LITERAL) found.push(catalog.slice(result.spans[2 * s], result.spans[2 * s + 1]));
+  }
+  assert.deepStrictEqual(found, EXPECTED);
+});
+
+test('utf8 offsets stay in bytes', () => {
+  const result = Mtlog.parseMany(['é {A}']);
+  const s = [...result.kinds].indexOf(Mtlog.SEGMENT.PROPERTY);
+  assert.deepStrictEqual([result.spans[2 * s], result.spans[2 * s + 1]], [3, 6]);
+});
@@ -0,0 +1,36 @@
+// extractAsync: each template of a catalog gets its own byte range, cut at
+// line ends outside Go-template properties.
+//
+//   npm run test:node
+
+const test = require('node:test');
+const assert = require('node:assert');
+const Mtlog = require('../..');
+
+function ranges(templates) {
+  const result = [];
+  for (let i = 0; i < templates.length; i += 2) result.push([templates[i], templates[i + 1]]);
+  return result;
+}
+
+test('one-word lines past the lookbehind are separate templates', async () => {
+  const lines = Array.from({ length: 64 }, (_, i) => `Started${i % 10}`);
+  const catalog = Buffer.from(lines.join('\n') + '\n');
+  assert.ok(catalog.length > 256);
+  const { templates } = await Mtlog.extractAsync(catalog);
+  assert.deepStrictEqual(ranges(templates), lines.map((_, i) => [i * 9, i * 9 + 8]));
+});
+
+test('a Go-template property across lines stays one template', async () => {
+  const catalog = Buffer.from('User {{\n.Name\n}} in\r\nOrder {Id}\n');
+  const { templates } = await Mtlog.extractAsync(catalog);
+  assert.deepStrictEqual(ranges(templates), [[0, 19], [21, 31]]);
+});
+
+test('a Go-template property with a long run of line ends stays one template', async () => {
+  const property = `{{${'\n'.repeat(300)}.Name}}`;
+  const catalog = Buffer.from(`pre\n${property}\npost\n`);
+  const { templates } = await Mtlog.extractAsync(catalog);
+  const start = 4 + property.length + 1;
+  assert.deepStrictEqual(ranges(templates), [[0, 3], [4, 4 + property.length], [start, start + 4]]);
+});
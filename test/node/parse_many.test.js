@@ -0,0 +1,82 @@
+// parseMany and parseManyAsync: one result for a whole batch, in input order,
+// from strings, Buffers and slices alike.
+//
+//   npm run test:node
+
+const test = require('node:test');
+const assert = require('node:assert');
+const Mtlog = require('../..');
+
+// [kind, text] of every segment of template i.
+function segments(result, templates, i) {
+  const text = Buffer.isBuffer(templates[i]) || templates[i] instanceof Uint8Array
+    ? Buffer.from(templates[i]).toString('latin1')
+    : templates[i];
+  const found = [];
+  for (let s = result.offsets[i]; s < result.offsets[i + 1]; s++) {
+    found.push([result.kinds[s], text.slice(result.spans[2 * s], result.spans[2 * s + 1])]);
+  }
+  return found;
+}
+
+const { LITERAL, PROPERTY, GO_PROPERTY, BUILTIN_PROPERTY } = Mtlog.SEGMENT;
+
+test('templates come back in input order', () => {
+  const templates = ['User {UserId}', '', '{{.Name}} done', '${Level:u3}', 'plain'];
+  const result = Mtlog.parseMany(templates);
+  assert.strictEqual(result.offsets.length, templates.length + 1);
+  assert.deepStrictEqual(segments(result, templates, 0), [[LITERAL, 'User '], [PROPERTY, '{UserId}']]);
+  assert.deepStrictEqual(segments(result, templates, 1), []);
+  assert.deepStrictEqual(segments(result, templates, 2), [[GO_PROPERTY, '{{.Name}}'], [LITERAL, ' done']]);
+  assert.deepStrictEqual(segments(result, templates, 3), [[BUILTIN_PROPERTY, '${Level:u3}']]);
+  assert.deepStrictEqual(segments(result, templates, 4), [[LITERAL, 'plain']]);
+  assert.strictEqual(result.offsets[templates.length], result.kinds.length);
+});
+
+test('a large batch keeps its order', () => {
+  const templates = Array.from({ length: 5000 }, (_, i) => `Item ${i} {Id${i}}`);
+  const result = Mtlog.parseMany(templates);
+  for (let i = 0; i < templates.length; i += 499) {
+    assert.deepStrictEqual(segments(result, templates, i), [[LITERAL, `Item ${i} `], [PROPERTY, `{Id${i}}`]]);
+  }
+});
+
+test('a bad element fails the batch with its index', async () => {
+  for (const bad of [42, null, undefined, {}, ['x']]) {
+    assert.throws(() => Mtlog.parseMany(['ok', 'fine', bad]), {
+      name: 'TypeError',
+      message: 'templates[2] must be a string or a Buffer',
+    });
+  }
+  await assert.rejects(Mtlog.parseManyAsync(['ok', 7]), {
+    name: 'TypeError',
+    message: 'templates[1] must be a string or a Buffer',
+  });
+  assert.throws(() => Mtlog.parseMany('User {Id}'), { name: 'TypeError', message: 'templates must be an array' });
+  assert.throws(() => Mtlog.parseMany([], { encoding: 'latin1' }), TypeError);
+});
+
+test('strings, Buffers and slices mix in one batch', () => {
+  const backing = Buffer.from('xxUser {Id}yy');
+  const templates = ['Café {A}', Buffer.from('Café {B}'), backing.subarray(2, 11), new Uint8Array(Buffer.from('{C}'))];
+  const result = Mtlog.parseMany(templates);
+  // UTF-8 throughout: 'é' is two bytes in the string as in the Buffer.
+  assert.deepStrictEqual([result.spans[2], result.spans[3]], [6, 9]);
+  assert.deepStrictEqual([result.spans[6], result.spans[7]], [6, 9]);
+  assert.deepStrictEqual(segments(result, templates, 2), [[LITERAL, 'User '], [PROPERTY, '{Id}']]);
+  assert.deepStrictEqual(segments(result, templates, 3), [[PROPERTY, '{C}']]);
+});
+
+test('utf16 applies to strings; Buffers stay UTF-8', () => {
+  const templates = ['Café {A}', Buffer.from('Café {B}')];
+  const result = Mtlog.parseMany(templates, { encoding: 'utf16' });
+  assert.deepStrictEqual([result.spans[2], result.spans[3]], [5, 8]);
+  assert.deepStrictEqual([result.spans[6], result.spans[7]], [6, 9]);
+});
+
+test('parseManyAsync matches parseMany', async () => {
+  const templates = ['User {UserId}', Buffer.from('{{.Name}}'), '', '日本 {X}'];
+  for (const encoding of ['utf8', 'utf16']) {
+    assert.deepStrictEqual(await Mtlog.parseManyAsync(templates, { encoding }), Mtlog.parseMany(templates, { encoding }));
+  }
+});